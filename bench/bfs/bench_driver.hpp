@@ -15,6 +15,8 @@
 #include <metall/detail/memory.hpp>
 
 #include "kernel.hpp"
+#include "direction_optimizing_kernel.hpp"
+#include "../data_structure/csr_graph.hpp"
 #include <metall/utility/open_mp.hpp>
 
 namespace bfs_bench {
@@ -35,13 +37,15 @@ struct bench_options {
   std::string graph_key_name{"adj_list"};
   vertex_id_type root_vertex_id{0};
   vertex_id_type max_vertex_id{0};
+  bool direction_optimizing{false};
+  bool undirected{false};
 };
 
 template <typename vertex_id_type>
 bool parse_options(int argc, char **argv,
                    bench_options<vertex_id_type> *option) {
   int p;
-  while ((p = ::getopt(argc, argv, "g:k:r:m:")) != -1) {
+  while ((p = ::getopt(argc, argv, "g:k:r:m:du")) != -1) {
     switch (p) {
       case 'g': {
         option->graph_file_name_list.clear();
@@ -63,6 +67,14 @@ bool parse_options(int argc, char **argv,
         option->max_vertex_id = static_cast<vertex_id_type>(std::stoll(optarg));
         break;
 
+      case 'd':
+        option->direction_optimizing = true;
+        break;
+
+      case 'u':
+        option->undirected = true;
+        break;
+
       default:
         std::cerr << "Invalid option" << std::endl;
         return false;
@@ -81,7 +93,9 @@ bool parse_options(int argc, char **argv,
 
   std::cout << "graph_key_name: " << option->graph_key_name
             << "\nroot_vertex_id: " << option->root_vertex_id
-            << "\nmax_vertex_id: " << option->max_vertex_id << std::endl;
+            << "\nmax_vertex_id: " << option->max_vertex_id
+            << "\ndirection_optimizing: " << option->direction_optimizing
+            << "\nundirected: " << option->undirected << std::endl;
   std::cout << "graph_file_name: " << std::endl;
   for (const auto &name : option->graph_file_name_list) {
     std::cout << " " << name << std::endl;
@@ -107,6 +121,13 @@ typename graph_type::key_type find_max_id(const graph_type &graph) {
   return max_id;
 }
 
+template <typename vertex_id_type, typename index_type, typename allocator_type>
+vertex_id_type find_max_id(
+    const data_structure::csr_graph<vertex_id_type, index_type, allocator_type>
+        &graph) {
+  return graph.num_vertices() == 0 ? 0 : graph.num_vertices() - 1;
+}
+
 // ---------------------------------------- //
 // Find root
 // ---------------------------------------- //
@@ -123,6 +144,19 @@ typename graph_type::key_type find_root(const graph_type &graph) {
   std::abort();
 }
 
+template <typename vertex_id_type, typename index_type, typename allocator_type>
+vertex_id_type find_root(
+    const data_structure::csr_graph<vertex_id_type, index_type, allocator_type>
+        &graph) {
+  for (std::size_t v = 0; v < graph.num_vertices(); ++v) {
+    if (graph.num_values(v) > 0) {
+      return v;
+    }
+  }
+  std::cerr << "Cannot find a vertex that has an edge" << std::endl;
+  std::abort();
+}
+
 // ---------------------------------------- //
 // Utility
 // ---------------------------------------- //
@@ -188,7 +222,11 @@ void run_bench(const graph_type &graph,
     print_omp_configuration();
     print_current_num_page_faults();
     const auto start = mdtl::elapsed_time_sec();
-    kernel(graph, &data);
+    if (option.direction_optimizing) {
+      direction_optimizing_kernel(graph, new_root, option.undirected, &data);
+    } else {
+      kernel(graph, &data);
+    }
     const auto elapsed_time = mdtl::elapsed_time_sec(start);
     std::cout << "Finished BFS (s)\t" << elapsed_time << std::endl;
     print_current_num_page_faults();
@@ -0,0 +1,293 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_BENCH_BFS_DIRECTION_OPTIMIZING_KERNEL_HPP
+#define METALL_BENCH_BFS_DIRECTION_OPTIMIZING_KERNEL_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include <metall/detail/builtin_functions.hpp>
+#include <metall/utility/open_mp.hpp>
+#include "kernel.hpp"
+
+namespace bfs_bench {
+
+/// \brief A bitmap whose bits can be set by multiple threads.
+class atomic_bitmap {
+ public:
+  explicit atomic_bitmap(const std::size_t num_bits)
+      : m_num_words((num_bits + 63) / 64),
+        m_words(std::make_unique<std::atomic<uint64_t>[]>(m_num_words)) {
+    reset();
+  }
+
+  void reset() {
+    OMP_DIRECTIVE(parallel for)
+    for (std::size_t i = 0; i < m_num_words; ++i) {
+      m_words[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  bool test(const std::size_t i) const {
+    return m_words[i / 64].load(std::memory_order_relaxed) & priv_mask(i);
+  }
+
+  /// \brief Sets a bit.
+  /// \return True if this call set the bit; false if it was already set.
+  bool set(const std::size_t i) {
+    const auto mask = priv_mask(i);
+    // Reads first to avoid making the cache line exclusive needlessly
+    if (m_words[i / 64].load(std::memory_order_relaxed) & mask) return false;
+    return !(m_words[i / 64].fetch_or(mask, std::memory_order_relaxed) & mask);
+  }
+
+  std::size_t num_words() const { return m_num_words; }
+
+  uint64_t word(const std::size_t w) const {
+    return m_words[w].load(std::memory_order_relaxed);
+  }
+
+  void swap(atomic_bitmap &other) noexcept {
+    std::swap(m_num_words, other.m_num_words);
+    std::swap(m_words, other.m_words);
+  }
+
+ private:
+  static uint64_t priv_mask(const std::size_t i) { return 1ULL << (i % 64); }
+
+  std::size_t m_num_words;
+  std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+};
+
+/// \brief A frontier queue that threads append to in batches.
+/// Each thread fills its own buffer and reserves a range of the shared array
+/// with a single atomic operation per batch.
+template <typename vertex_id_type>
+class frontier_queue {
+ public:
+  static constexpr std::size_t k_local_buffer_size = 1024;
+
+  explicit frontier_queue(const std::size_t capacity) : m_queue(capacity) {}
+
+  class local_buffer {
+   public:
+    explicit local_buffer(frontier_queue *queue) : m_queue(queue) {
+      m_buffer.reserve(k_local_buffer_size);
+    }
+    ~local_buffer() { flush(); }
+
+    void push(const vertex_id_type v) {
+      m_buffer.push_back(v);
+      if (m_buffer.size() == k_local_buffer_size) flush();
+    }
+
+    void flush() {
+      if (m_buffer.empty()) return;
+      const auto offset =
+          m_queue->m_size.fetch_add(m_buffer.size(), std::memory_order_relaxed);
+      std::copy(m_buffer.begin(), m_buffer.end(),
+                m_queue->m_queue.begin() + offset);
+      m_buffer.clear();
+    }
+
+   private:
+    frontier_queue *m_queue;
+    std::vector<vertex_id_type> m_buffer;
+  };
+
+  std::size_t size() const { return m_size.load(std::memory_order_relaxed); }
+  bool empty() const { return size() == 0; }
+  void clear() { m_size.store(0, std::memory_order_relaxed); }
+  const vertex_id_type &operator[](const std::size_t i) const {
+    return m_queue[i];
+  }
+
+  void swap(frontier_queue &other) noexcept {
+    m_queue.swap(other.m_queue);
+    const auto size = m_size.load(std::memory_order_relaxed);
+    m_size.store(other.m_size.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    other.m_size.store(size, std::memory_order_relaxed);
+  }
+
+ private:
+  std::vector<vertex_id_type> m_queue;
+  std::atomic<std::size_t> m_size{0};
+};
+
+namespace dobfs_detail {
+
+template <typename graph_type, typename vertex_id_type>
+std::size_t top_down_step(const graph_type &graph,
+                          const frontier_queue<vertex_id_type> &current,
+                          frontier_queue<vertex_id_type> &next,
+                          atomic_bitmap &visited,
+                          const bfs_data::level_type next_level,
+                          bfs_data *data) {
+  std::size_t scout_count = 0;
+  OMP_DIRECTIVE(parallel reduction(+ : scout_count)) {
+    typename frontier_queue<vertex_id_type>::local_buffer buffer(&next);
+    OMP_DIRECTIVE(for schedule(dynamic, 64) nowait)
+    for (std::size_t i = 0; i < current.size(); ++i) {
+      const auto source = current[i];
+      if (graph.num_values(source) == 0) continue;
+      for (auto itr = graph.values_begin(source),
+                end = graph.values_end(source);
+           itr != end; ++itr) {
+        const vertex_id_type neighbor = *itr;
+        if (visited.set(neighbor)) {
+          data->level[neighbor] = next_level;
+          buffer.push(neighbor);
+          scout_count += graph.num_values(neighbor);
+        }
+      }
+    }
+  }
+  return scout_count;
+}
+
+// Requires an undirected graph, i.e., the neighbors of a vertex must be also
+// its in-neighbors.
+template <typename graph_type>
+std::size_t bottom_up_step(const graph_type &graph, const atomic_bitmap &front,
+                           atomic_bitmap &next, atomic_bitmap &visited,
+                           const bfs_data::level_type next_level,
+                           bfs_data *data) {
+  using vertex_id_type = typename graph_type::key_type;
+  const std::size_t num_vertices = data->level.size();
+  next.reset();
+  std::size_t awake_count = 0;
+  OMP_DIRECTIVE(parallel for schedule(dynamic, 1024) reduction(+ : awake_count))
+  for (std::size_t v = 0; v < num_vertices; ++v) {
+    if (data->level[v] != bfs_data::k_infinite_level) continue;
+    const auto vertex = static_cast<vertex_id_type>(v);
+    if (graph.num_values(vertex) == 0) continue;
+    for (auto itr = graph.values_begin(vertex), end = graph.values_end(vertex);
+         itr != end; ++itr) {
+      if (front.test(*itr)) {
+        data->level[v] = next_level;
+        visited.set(v);
+        next.set(v);
+        ++awake_count;
+        break;
+      }
+    }
+  }
+  return awake_count;
+}
+
+template <typename vertex_id_type>
+void queue_to_bitmap(const frontier_queue<vertex_id_type> &queue,
+                     atomic_bitmap &bitmap) {
+  bitmap.reset();
+  OMP_DIRECTIVE(parallel for)
+  for (std::size_t i = 0; i < queue.size(); ++i) {
+    bitmap.set(queue[i]);
+  }
+}
+
+template <typename vertex_id_type>
+void bitmap_to_queue(const atomic_bitmap &bitmap,
+                     frontier_queue<vertex_id_type> &queue) {
+  queue.clear();
+  OMP_DIRECTIVE(parallel) {
+    typename frontier_queue<vertex_id_type>::local_buffer buffer(&queue);
+    OMP_DIRECTIVE(for nowait)
+    for (std::size_t w = 0; w < bitmap.num_words(); ++w) {
+      for (uint64_t bits = bitmap.word(w); bits; bits &= bits - 1) {
+        buffer.push(static_cast<vertex_id_type>(
+            w * 64 + metall::mtlldetail::ctzll(bits)));
+      }
+    }
+  }
+}
+
+}  // namespace dobfs_detail
+
+/// \brief Runs a frontier-based, direction-optimizing BFS (Beamer et al.,
+/// SC'12). Top-down steps expand an explicit frontier queue, so the work is
+/// proportional to the edges of the frontier rather than all vertices.
+/// Bottom-up steps are used when the frontier is large; they are enabled only
+/// if 'undirected' is true.
+/// The visited set and the bottom-up frontiers are atomic bitmaps;
+/// each thread collects newly visited vertices in its own buffer.
+/// \param graph A graph; must provide key_type, num_values(), values_begin(),
+/// and values_end().
+/// \param root The BFS root. data must be initialized with it.
+/// \param undirected If true, assumes the graph is undirected.
+/// \param data BFS data initialized by initialize().
+/// \return The maximum level.
+template <typename graph_type>
+bfs_data::level_type direction_optimizing_kernel(
+    const graph_type &graph, const typename graph_type::key_type root,
+    const bool undirected, bfs_data *data) {
+  using vertex_id_type = typename graph_type::key_type;
+  // Parameters recommended in the paper
+  constexpr std::size_t k_alpha = 15;
+  constexpr std::size_t k_beta = 18;
+
+  const std::size_t num_vertices = data->level.size();
+
+  std::size_t edges_to_check = 0;
+  OMP_DIRECTIVE(parallel for reduction(+ : edges_to_check))
+  for (std::size_t v = 0; v < num_vertices; ++v) {
+    edges_to_check += graph.num_values(static_cast<vertex_id_type>(v));
+  }
+
+  atomic_bitmap visited(num_vertices);
+  visited.set(root);
+  frontier_queue<vertex_id_type> current(num_vertices);
+  frontier_queue<vertex_id_type> next(num_vertices);
+  {
+    typename frontier_queue<vertex_id_type>::local_buffer buffer(&current);
+    buffer.push(root);
+  }
+
+  std::unique_ptr<atomic_bitmap> front;
+  std::unique_ptr<atomic_bitmap> next_front;
+
+  bfs_data::level_type level = 0;
+  std::size_t scout_count = graph.num_values(root);
+  while (!current.empty()) {
+    if (undirected && scout_count > edges_to_check / k_alpha) {
+      if (!front) {
+        front = std::make_unique<atomic_bitmap>(num_vertices);
+        next_front = std::make_unique<atomic_bitmap>(num_vertices);
+      }
+      dobfs_detail::queue_to_bitmap(current, *front);
+      std::size_t awake_count = current.size();
+      std::size_t old_awake_count = 0;
+      do {
+        old_awake_count = awake_count;
+        awake_count = dobfs_detail::bottom_up_step(
+            graph, *front, *next_front, visited, level + 1, data);
+        front->swap(*next_front);
+        ++level;
+      } while (awake_count >= old_awake_count ||
+               awake_count > num_vertices / k_beta);
+      dobfs_detail::bitmap_to_queue(*front, current);
+      scout_count = 1;
+    } else {
+      edges_to_check -= std::min(edges_to_check, scout_count);
+      next.clear();
+      scout_count = dobfs_detail::top_down_step(graph, current, next, visited,
+                                                level + 1, data);
+      current.swap(next);
+      ++level;
+    }
+  }
+
+  // The last step always finds no vertex
+  return level - 1;
+}
+
+}  // namespace bfs_bench
+
+#endif  // METALL_BENCH_BFS_DIRECTION_OPTIMIZING_KERNEL_HPP
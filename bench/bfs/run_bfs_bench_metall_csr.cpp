@@ -0,0 +1,73 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+/// \brief Compares BFS on an adjacency list and on a CSR graph.
+/// Converts the adjacency list constructed by run_adj_list_bench_metall into a
+/// CSR graph in the same datastore (if it does not exist yet) and runs BFS on
+/// the both layouts.
+/// The CSR graph is stored with the name '<graph_key_name>_csr'.
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+
+#include <metall/metall.hpp>
+#include "../data_structure/multithread_adjacency_list.hpp"
+#include "../data_structure/csr_graph.hpp"
+#include "bench_driver.hpp"
+
+using namespace bfs_bench;
+
+using vertex_id_type = uint64_t;
+
+using adjacency_list_type = data_structure::multithread_adjacency_list<
+    vertex_id_type, vertex_id_type,
+    typename metall::manager::allocator_type<std::byte>>;
+
+using csr_graph_type = data_structure::csr_graph<
+    vertex_id_type, uint64_t,
+    typename metall::manager::allocator_type<std::byte>>;
+
+int main(int argc, char *argv[]) {
+  bench_options<vertex_id_type> option;
+  if (!parse_options(argc, argv, &option)) {
+    std::abort();
+  }
+
+  {
+    metall::manager manager(metall::open_only, option.graph_file_name_list[0]);
+    auto adj_list =
+        manager.find<adjacency_list_type>(option.graph_key_name.c_str()).first;
+    if (!adj_list) {
+      std::cerr << "Cannot find " << option.graph_key_name << std::endl;
+      std::abort();
+    }
+
+    const auto csr_key_name = option.graph_key_name + "_csr";
+    auto csr = manager.find<csr_graph_type>(csr_key_name.c_str()).first;
+    if (!csr) {
+      std::cout << "\nBuild CSR graph" << std::endl;
+      const auto start = mdtl::elapsed_time_sec();
+      csr = manager.construct<csr_graph_type>(csr_key_name.c_str())(
+          manager.get_allocator());
+      csr->build(*adj_list);
+      csr->sort_neighbors();
+      manager.flush();
+      const auto elapsed_time = mdtl::elapsed_time_sec(start);
+      std::cout << "Finished building CSR graph (s)\t" << elapsed_time
+                << std::endl;
+    }
+    std::cout << "#of vertices\t" << csr->num_vertices() << "\n#of edges\t"
+              << csr->num_edges() << std::endl;
+
+    std::cout << "\n---------- Adjacency list ----------" << std::endl;
+    run_bench(*adj_list, option);
+
+    std::cout << "\n---------- CSR graph ----------" << std::endl;
+    run_bench(*csr, option);
+  }
+
+  return 0;
+}
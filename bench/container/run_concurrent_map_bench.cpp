@@ -0,0 +1,104 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+/// \brief Benchmarks the concurrent map container with read-heavy workloads.
+/// Usage:
+/// ./run_concurrent_map_bench
+/// # modify the values in the main(), if needed.
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <metall/metall.hpp>
+#include <metall/container/concurrent_map.hpp>
+#include <metall/detail/time.hpp>
+#include <metall/utility/random.hpp>
+
+namespace mdtl = metall::mtlldetail;
+
+using map_type = metall::container::concurrent_map<
+    uint64_t, uint64_t, std::less<uint64_t>, std::hash<uint64_t>,
+    metall::manager::allocator_type<std::pair<const uint64_t, uint64_t>>>;
+
+// Each thread looks up random keys in 'maps[thread_no % maps.size()]' and
+// updates one key every 'write_interval' operations.
+double run_bench(const std::vector<map_type *> &maps,
+                 const std::size_t num_threads, const std::size_t num_keys,
+                 const std::size_t num_ops_per_thread,
+                 const std::size_t write_interval) {
+  std::atomic<uint64_t> checksum{0};
+  std::vector<std::thread> threads;
+
+  const auto start = mdtl::elapsed_time_sec();
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      auto *const map = maps[t % maps.size()];
+      metall::utility::rand_1024 rnd(t + 1);
+      uint64_t sum = 0;
+      for (std::size_t i = 0; i < num_ops_per_thread; ++i) {
+        const uint64_t key = rnd() % num_keys;
+        if (write_interval > 0 && i % write_interval == 0) {
+          map->edit(key, [](uint64_t &v) { ++v; });
+        } else {
+          map->visit(key, [&sum](const uint64_t &v) { sum += v; });
+        }
+      }
+      checksum += sum;  // Keeps the lookups from being optimized out
+    });
+  }
+  for (auto &th : threads) th.join();
+  const auto elapsed_time = mdtl::elapsed_time_sec(start);
+  return static_cast<double>(num_threads * num_ops_per_thread) / elapsed_time;
+}
+
+int main() {
+  const std::size_t num_keys = 1ULL << 20ULL;
+  const std::size_t num_ops_per_thread = 1ULL << 22ULL;
+  const std::size_t max_num_threads =
+      std::max(std::thread::hardware_concurrency(), 1U);
+
+  metall::manager mngr(metall::create_only, "/tmp/metall");
+
+  std::vector<map_type *> maps;
+  for (std::size_t t = 0; t < max_num_threads; ++t) {
+    maps.push_back(mngr.construct<map_type>(metall::anonymous_instance)(
+        mngr.get_allocator()));
+  }
+  {
+    const auto start = mdtl::elapsed_time_sec();
+    for (auto *map : maps) {
+      for (uint64_t k = 0; k < num_keys; ++k) {
+        map->insert(std::make_pair(k, k));
+      }
+    }
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+    std::cout << "Insertion took (s)\t" << elapsed_time << std::endl;
+  }
+
+  std::cout << "#threads\tShared map, reads only (Mops/s)"
+            << "\tShared map, 95% reads (Mops/s)"
+            << "\tMap per thread, 95% reads (Mops/s)" << std::endl;
+  for (std::size_t num_threads = 1; num_threads <= max_num_threads;
+       num_threads *= 2) {
+    const std::vector<map_type *> shared_map{maps[0]};
+    std::cout << num_threads << "\t"
+              << run_bench(shared_map, num_threads, num_keys,
+                           num_ops_per_thread, 0) /
+                     1e6
+              << "\t"
+              << run_bench(shared_map, num_threads, num_keys,
+                           num_ops_per_thread, 20) /
+                     1e6
+              << "\t"
+              << run_bench(maps, num_threads, num_keys, num_ops_per_thread,
+                           20) /
+                     1e6
+              << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+/// \brief Benchmarks string_key_store against a node-based hash map.
+/// Measures insertion time, lookup time, and memory usage per key.
+/// Also measures the bulk insertion and lookup throughput of
+/// concurrent_string_key_store (requires OpenMP to run in parallel).
+/// Usage:
+/// ./run_string_key_store_bench
+/// # modify the values in the main(), if needed.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <boost/unordered_map.hpp>
+#include <boost/container/string.hpp>
+#include <metall/container/string_key_store.hpp>
+#include <metall/container/concurrent_string_key_store.hpp>
+#include <metall/detail/hash.hpp>
+#include <metall/detail/time.hpp>
+#include <metall/utility/open_mp.hpp>
+
+#include "../utility/counting_allocator.hpp"
+
+namespace mdtl = metall::mtlldetail;
+
+using bench_utility::counting_allocator;
+
+std::size_t num_allocated_bytes() {
+  return bench_utility::allocation_counter::num_allocated_bytes.load();
+}
+
+std::vector<std::string> gen_keys(const std::size_t num_keys,
+                                  const std::size_t max_length) {
+  std::mt19937_64 rnd(123);
+  std::vector<std::string> keys(num_keys);
+  for (auto &key : keys) {
+    const auto length = 1 + rnd() % max_length;
+    for (std::size_t i = 0; i < length; ++i) {
+      key.push_back(static_cast<char>('a' + rnd() % 26));
+    }
+  }
+  return keys;
+}
+
+template <typename inserter_type, typename finder_type>
+void run_bench(const std::string &name, const std::vector<std::string> &keys,
+               const inserter_type &inserter, const finder_type &finder) {
+  const auto bytes_before = num_allocated_bytes();
+  {
+    const auto start = mdtl::elapsed_time_sec();
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      inserter(keys[i], i);
+    }
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+    std::cout << name << " insertion took (s)\t" << elapsed_time << std::endl;
+  }
+  std::cout << name << " bytes per key\t"
+            << static_cast<double>(num_allocated_bytes() - bytes_before) /
+                   keys.size()
+            << std::endl;
+  {
+    std::size_t num_found = 0;
+    const auto start = mdtl::elapsed_time_sec();
+    for (const auto &key : keys) {
+      num_found += finder(key);
+    }
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+    std::cout << name << " find took (s)\t" << elapsed_time << "\t("
+              << num_found << " found)" << std::endl;
+  }
+}
+
+int main() {
+  const std::size_t num_keys = 1ULL << 22ULL;
+
+  for (const std::size_t max_length : {16, 64}) {
+    const auto keys = gen_keys(num_keys, max_length);
+    std::cout << "#keys\t" << keys.size() << "\tmax key length\t"
+              << max_length << std::endl;
+
+    {
+      using string_type =
+          boost::container::basic_string<char, std::char_traits<char>,
+                                         counting_allocator<char>>;
+      using map_type =
+          boost::unordered_map<string_type, uint64_t, mdtl::str_hash<>,
+                               std::equal_to<string_type>,
+                               counting_allocator<std::pair<const string_type,
+                                                            uint64_t>>>;
+      map_type map;
+      run_bench(
+          "Boost unordered_map", keys,
+          [&map](const std::string &key, const uint64_t value) {
+            map.emplace(string_type(key.data(), key.size()), value);
+          },
+          [&map](const std::string &key) {
+            return map.count(string_type(key.data(), key.size()));
+          });
+    }
+
+    {
+      metall::container::string_key_store<uint64_t,
+                                          counting_allocator<std::byte>>
+          store(true, 123);
+      run_bench(
+          "string_key_store", keys,
+          [&store](const std::string &key, const uint64_t value) {
+            store.insert(key, value);
+          },
+          [&store](const std::string &key) { return store.count(key); });
+    }
+
+    {
+      metall::container::concurrent_string_key_store<
+          uint64_t, counting_allocator<std::byte>>
+          store(true, 123);
+      std::vector<std::pair<std::string, uint64_t>> items;
+      items.reserve(keys.size());
+      for (std::size_t i = 0; i < keys.size(); ++i) {
+        items.emplace_back(keys[i], i);
+      }
+
+      const auto bytes_before = num_allocated_bytes();
+      {
+        const auto start = mdtl::elapsed_time_sec();
+        store.bulk_insert(items.begin(), items.end());
+        const auto elapsed_time = mdtl::elapsed_time_sec(start);
+        std::cout << "concurrent_string_key_store bulk insertion took (s)\t"
+                  << elapsed_time << std::endl;
+      }
+      std::cout << "concurrent_string_key_store bytes per key\t"
+                << static_cast<double>(num_allocated_bytes() - bytes_before) /
+                       keys.size()
+                << std::endl;
+      {
+        std::size_t num_found = 0;
+        const auto start = mdtl::elapsed_time_sec();
+        OMP_DIRECTIVE(parallel for reduction(+ : num_found))
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+          num_found += store.count(keys[i]);
+        }
+        const auto elapsed_time = mdtl::elapsed_time_sec(start);
+        std::cout << "concurrent_string_key_store parallel find took (s)\t"
+                  << elapsed_time << "\t(" << num_found << " found)" << std::endl;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: (Apache-2.0 OR MIT)
 
 /// \brief Benchmarks the STL map container using different allocators.
+/// Also compares the concurrent map containers.
 /// Usage:
 /// ./run_map_bench
 /// # modify the values in the main(), if needed.
@@ -12,11 +13,51 @@
 #include <unordered_map>
 #include <boost/unordered_map.hpp>
 #include <metall/container/unordered_map.hpp>
+#include <metall/container/concurrent_map.hpp>
 #include <metall/metall.hpp>
 #include <metall/detail/time.hpp>
+#include <metall/utility/open_mp.hpp>
+
+// Boost 1.81 or later is required
+#if BOOST_VERSION >= 108100
+#include <metall/container/concurrent_unordered_flat_map.hpp>
+#endif
 
 #include "bench_common.hpp"
 
+// Inserts the keys one by one, then looks them up in parallel.
+template <typename map_type>
+void run_concurrent_map_bench(
+    const std::string &name,
+    const std::vector<std::pair<uint64_t, uint64_t>> &inputs) {
+  metall::manager mngr(metall::create_only, "/tmp/metall");
+  auto *map = mngr.construct<map_type>(metall::anonymous_instance)(
+      mngr.get_allocator());
+
+  {
+    const auto start = mdtl::elapsed_time_sec();
+    for (const auto &kv : inputs) {
+      map->insert(std::make_pair(kv.first, uint64_t(0)));
+      map->insert(std::make_pair(kv.second, uint64_t(0)));
+    }
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+    std::cout << name << " insertion took (s)\t" << elapsed_time << std::endl;
+  }
+
+  {
+    const auto start = mdtl::elapsed_time_sec();
+    std::size_t num_found = 0;
+    OMP_DIRECTIVE(parallel for reduction(+ : num_found))
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+      num_found += map->visit(inputs[i].first, [](const uint64_t &) {});
+      num_found += map->visit(inputs[i].second, [](const uint64_t &) {});
+    }
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+    std::cout << name << " parallel lookup took (s)\t" << elapsed_time
+              << "\t(" << num_found << " found)" << std::endl;
+  }
+}
+
 int main() {
   std::size_t scale = 17;
   std::size_t num_inputs = (1ULL << scale) * 16;
@@ -65,5 +106,30 @@ int main() {
               << std::endl;
   }
 
+  run_concurrent_map_bench<metall::container::concurrent_map<
+      uint64_t, uint64_t, std::less<uint64_t>, std::hash<uint64_t>,
+      metall::manager::allocator_type<std::pair<const uint64_t, uint64_t>>>>(
+      "concurrent_map with Metall", inputs);
+
+#if BOOST_VERSION >= 108100
+  using cufmap_type =
+      metall::container::concurrent_unordered_flat_map<uint64_t, uint64_t>;
+  run_concurrent_map_bench<cufmap_type>(
+      "concurrent_unordered_flat_map with Metall", inputs);
+
+  {
+    metall::manager mngr(metall::create_only, "/tmp/metall");
+    auto *map = mngr.construct<cufmap_type>(metall::anonymous_instance)(
+        mngr.get_allocator());
+
+    const auto start = mdtl::elapsed_time_sec();
+    map->insert(inputs.begin(), inputs.end());
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+    std::cout << "concurrent_unordered_flat_map with Metall bulk insertion "
+                 "(first elements only) took (s)\t"
+              << elapsed_time << std::endl;
+  }
+#endif
+
   return 0;
 }
\ No newline at end of file
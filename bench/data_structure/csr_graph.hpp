@@ -0,0 +1,228 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_BENCH_DATA_STRUCTURE_CSR_GRAPH_HPP
+#define METALL_BENCH_DATA_STRUCTURE_CSR_GRAPH_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+#include <metall/container/vector.hpp>
+#include <metall/utility/open_mp.hpp>
+
+namespace data_structure {
+
+/// \brief A static graph in the compressed sparse row (CSR) format.
+/// The offsets and the neighbors are stored in two contiguous arrays so that
+/// traversals read the edges of a vertex sequentially.
+/// Vertex IDs are expected to be dense, i.e., in [0, num_vertices()).
+/// \tparam _vertex_id_type A vertex ID type.
+/// \tparam _index_type An index type of the neighbor array.
+/// \tparam _base_allocator_type An allocator type.
+template <typename _vertex_id_type, typename _index_type = uint64_t,
+          typename _base_allocator_type = std::allocator<std::byte>>
+class csr_graph {
+ public:
+  using key_type = _vertex_id_type;
+  using value_type = _vertex_id_type;
+  using index_type = _index_type;
+
+ private:
+  template <typename T>
+  using other_allocator_type = typename std::allocator_traits<
+      _base_allocator_type>::template rebind_alloc<T>;
+
+  using offset_list_type =
+      metall::container::vector<index_type, other_allocator_type<index_type>>;
+  using neighbor_list_type =
+      metall::container::vector<value_type, other_allocator_type<value_type>>;
+
+ public:
+  using const_value_iterator = typename neighbor_list_type::const_iterator;
+
+  explicit csr_graph(
+      const _base_allocator_type &allocator = _base_allocator_type())
+      : m_offsets(allocator), m_neighbors(allocator) {}
+
+  ~csr_graph() = default;
+
+  /// \brief Builds the graph from an adjacency list, replacing the current
+  /// contents. The adjacency list must provide keys_begin(), keys_end(),
+  /// num_values(), values_begin(), and values_end().
+  /// Degrees and neighbors are copied in parallel if OpenMP is enabled.
+  /// \param adjacency_list An adjacency list to convert.
+  template <typename adjacency_list_type>
+  void build(const adjacency_list_type &adjacency_list) {
+    std::vector<key_type> sources;
+    for (auto itr = adjacency_list.keys_begin(),
+              end = adjacency_list.keys_end();
+         itr != end; ++itr) {
+      sources.push_back(itr->first);
+    }
+
+    // The vertex with the largest ID may not have any outgoing edge
+    key_type max_id = 0;
+    index_type num_edges = 0;
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1024) reduction(max : max_id) reduction(+ : num_edges))
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+      const auto &source = sources[i];
+      max_id = std::max(max_id, source);
+      num_edges += adjacency_list.num_values(source);
+      for (auto itr = adjacency_list.values_begin(source),
+                end = adjacency_list.values_end(source);
+           itr != end; ++itr) {
+        max_id = std::max(max_id, *itr);
+      }
+    }
+
+    priv_allocate_offsets(sources.empty() ? 0 : max_id + 1);
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1024))
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+      m_offsets[sources[i] + 1] = adjacency_list.num_values(sources[i]);
+    }
+    priv_prefix_sum();
+    assert(m_offsets.back() == num_edges);
+
+    priv_allocate_neighbors(num_edges);
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1024))
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+      const auto &source = sources[i];
+      std::copy(adjacency_list.values_begin(source),
+                adjacency_list.values_end(source),
+                m_neighbors.begin() + m_offsets[source]);
+    }
+  }
+
+  /// \brief Builds the graph from an edge list, replacing the current
+  /// contents. If the iterators are not random access iterators, e.g., an
+  /// input stream, the edges are buffered into a temporary array first.
+  /// The edges are counted and scattered in parallel if OpenMP is enabled.
+  /// \param first The beginning of the edge list. Each element must have
+  /// 'first' (source) and 'second' (destination).
+  /// \param last The end of the edge list.
+  /// \param num_vertices The number of vertices.
+  /// If 0 is given, it is computed from the maximum vertex ID.
+  template <typename edge_iterator>
+  void build(edge_iterator first, edge_iterator last,
+             std::size_t num_vertices = 0) {
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                    typename std::iterator_traits<
+                                        edge_iterator>::iterator_category>) {
+      priv_build_from_edges(first, last, num_vertices);
+    } else {
+      std::vector<std::pair<key_type, value_type>> edges;
+      for (; first != last; ++first) {
+        edges.emplace_back(first->first, first->second);
+      }
+      priv_build_from_edges(edges.begin(), edges.end(), num_vertices);
+    }
+  }
+
+  /// \brief Sorts the neighbors of each vertex in ascending order.
+  void sort_neighbors() {
+    const std::size_t n = num_vertices();
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1024))
+    for (std::size_t v = 0; v < n; ++v) {
+      std::sort(m_neighbors.begin() + m_offsets[v],
+                m_neighbors.begin() + m_offsets[v + 1]);
+    }
+  }
+
+  std::size_t num_vertices() const {
+    return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+  }
+
+  std::size_t num_edges() const { return m_neighbors.size(); }
+
+  std::size_t num_values(const key_type &key) const {
+    if (static_cast<std::size_t>(key) >= num_vertices()) return 0;
+    return m_offsets[key + 1] - m_offsets[key];
+  }
+
+  const_value_iterator values_begin(const key_type &key) const {
+    assert(static_cast<std::size_t>(key) < num_vertices());
+    return m_neighbors.cbegin() + m_offsets[key];
+  }
+
+  const_value_iterator values_end(const key_type &key) const {
+    assert(static_cast<std::size_t>(key) < num_vertices());
+    return m_neighbors.cbegin() + m_offsets[key + 1];
+  }
+
+  _base_allocator_type get_allocator() const {
+    return m_offsets.get_allocator();
+  }
+
+ private:
+  // Releases the old array before allocating a new one so that the peak memory
+  // usage does not double.
+  void priv_allocate_offsets(const std::size_t num_vertices) {
+    m_offsets.clear();
+    m_offsets.shrink_to_fit();
+    m_offsets.resize(num_vertices + 1, 0);
+  }
+
+  void priv_allocate_neighbors(const std::size_t num_edges) {
+    m_neighbors.clear();
+    m_neighbors.shrink_to_fit();
+    m_neighbors.resize(num_edges);
+  }
+
+  // Converts the degrees stored at [1, num_vertices] into offsets.
+  void priv_prefix_sum() {
+    for (std::size_t i = 1; i < m_offsets.size(); ++i) {
+      m_offsets[i] += m_offsets[i - 1];
+    }
+  }
+
+  template <typename random_access_iterator>
+  void priv_build_from_edges(random_access_iterator first,
+                             random_access_iterator last,
+                             std::size_t num_vertices) {
+    const std::size_t num_edges = std::distance(first, last);
+    if (num_vertices == 0) {
+      key_type max_id = 0;
+      OMP_DIRECTIVE(parallel for reduction(max : max_id))
+      for (std::size_t i = 0; i < num_edges; ++i) {
+        const auto &edge = first[i];
+        max_id = std::max(max_id, std::max<key_type>(edge.first, edge.second));
+      }
+      num_vertices = (num_edges == 0) ? 0 : max_id + 1;
+    }
+
+    priv_allocate_offsets(num_vertices);
+    OMP_DIRECTIVE(parallel for)
+    for (std::size_t i = 0; i < num_edges; ++i) {
+      assert(static_cast<std::size_t>(first[i].first) < num_vertices);
+      OMP_DIRECTIVE(atomic)
+      ++m_offsets[first[i].first + 1];
+    }
+    priv_prefix_sum();
+
+    // Scatters the edges using a transient copy of the offsets as cursors
+    std::vector<index_type> cursors(m_offsets.begin(), m_offsets.end() - 1);
+    priv_allocate_neighbors(num_edges);
+    OMP_DIRECTIVE(parallel for)
+    for (std::size_t i = 0; i < num_edges; ++i) {
+      index_type position;
+      OMP_DIRECTIVE(atomic capture)
+      position = cursors[first[i].first]++;
+      m_neighbors[position] = first[i].second;
+    }
+  }
+
+  offset_list_type m_offsets;
+  neighbor_list_type m_neighbors;
+};
+
+}  // namespace data_structure
+
+#endif  // METALL_BENCH_DATA_STRUCTURE_CSR_GRAPH_HPP
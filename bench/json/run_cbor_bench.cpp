@@ -0,0 +1,84 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+// Compares the CBOR export/import with the JSON text path (serialize/parse)
+// in terms of encoded size and encode/decode time.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include <metall/json/json.hpp>
+#include <metall/detail/time.hpp>
+
+namespace mj = metall::json;
+namespace mdtl = metall::mtlldetail;
+
+using value_type = mj::value<std::allocator<std::byte>>;
+
+// Generates an array of records that have the same keys.
+value_type gen_records(const std::size_t num_records) {
+  value_type jv;
+  auto &arr = jv.emplace_array();
+  arr.resize(num_records);
+  for (std::size_t i = 0; i < num_records; ++i) {
+    auto &obj = arr[i].emplace_object();
+    obj["identifier"] = i;
+    obj["name"] = "name-" + std::to_string(i % 1000);
+    obj["score"] = 0.25 * static_cast<double>(i);
+    obj["valid"] = (i % 2 == 0);
+    obj["note"] = nullptr;
+    obj["offset"] = -static_cast<std::int64_t>(i) * 100000;
+    auto &tags = obj["tags"].emplace_array();
+    tags.resize(2);
+    tags[0] = "tag-" + std::to_string(i % 10);
+    tags[1] = "category-" + std::to_string(i % 100);
+  }
+  return jv;
+}
+
+template <typename encode_func, typename decode_func>
+void run_bench(const std::string &name, const value_type &jv,
+               encode_func encode, decode_func decode) {
+  const auto encode_start = mdtl::elapsed_time_sec();
+  const auto encoded = encode(jv);
+  const auto encode_time = mdtl::elapsed_time_sec(encode_start);
+
+  const auto decode_start = mdtl::elapsed_time_sec();
+  const auto decoded = decode(encoded);
+  const auto decode_time = mdtl::elapsed_time_sec(decode_start);
+
+  if (decoded != jv) {
+    std::cerr << name << ": decoded value does not match" << std::endl;
+    std::abort();
+  }
+
+  std::cout << name << "\t" << encoded.size() << "\t" << encode_time << "\t"
+            << decode_time << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const std::size_t num_records =
+      (argc > 1) ? std::stoull(argv[1]) : (1ULL << 20ULL);
+
+  const auto jv = gen_records(num_records);
+  std::cout << "#records\t" << num_records << std::endl;
+  std::cout << "Format\tBytes\tEncode (s)\tDecode (s)" << std::endl;
+
+  run_bench(
+      "text", jv, [](const value_type &v) { return mj::serialize(v); },
+      [](const std::string &s) { return mj::parse(s); });
+  run_bench(
+      "cbor", jv, [](const value_type &v) { return mj::to_cbor(v, false); },
+      [](const std::vector<std::uint8_t> &b) { return mj::from_cbor(b); });
+  run_bench(
+      "cbor+stringref", jv,
+      [](const value_type &v) { return mj::to_cbor(v, true); },
+      [](const std::vector<std::uint8_t> &b) { return mj::from_cbor(b); });
+
+  return 0;
+}
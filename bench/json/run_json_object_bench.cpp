@@ -0,0 +1,93 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+// Compares the JSON object implementations in terms of lookup latency and
+// memory usage per key across object sizes.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <metall/json/json.hpp>
+#include <metall/json/details/compact_object.hpp>
+#include <metall/json/details/indexed_object.hpp>
+#include <metall/json/details/flat_indexed_object.hpp>
+#include <metall/json/details/adaptive_object.hpp>
+#include <metall/detail/time.hpp>
+
+#include "../utility/counting_allocator.hpp"
+
+namespace mj = metall::json;
+namespace mdtl = metall::mtlldetail;
+
+std::size_t num_allocated_bytes() {
+  return bench_utility::allocation_counter::num_allocated_bytes.load();
+}
+
+using alloc_type = bench_utility::counting_allocator<std::byte>;
+
+std::vector<std::string> gen_keys(const std::size_t num_keys) {
+  std::vector<std::string> keys;
+  keys.reserve(num_keys);
+  for (std::size_t i = 0; i < num_keys; ++i) {
+    // Mix of keys that are stored inline and out of line
+    keys.emplace_back((i % 2 == 0) ? "k" + std::to_string(i)
+                                   : "long-key-name-" + std::to_string(i));
+  }
+  return keys;
+}
+
+template <typename object_type>
+void run_bench(const std::string &name, const std::size_t num_keys,
+               const std::size_t num_lookups) {
+  const auto keys = gen_keys(num_keys);
+
+  // Look up the keys in a random order
+  std::vector<std::size_t> lookup_order(num_lookups);
+  std::mt19937_64 rnd(123);
+  for (auto &i : lookup_order) i = rnd() % num_keys;
+
+  const auto bytes_before = num_allocated_bytes();
+  {
+    object_type obj{alloc_type{}};
+    for (std::size_t i = 0; i < num_keys; ++i) {
+      obj[keys[i]] = i;
+    }
+    const auto bytes = num_allocated_bytes() - bytes_before + sizeof(obj);
+
+    std::size_t sum = 0;
+    const auto start = mdtl::elapsed_time_sec();
+    for (const auto i : lookup_order) {
+      sum += obj.at(keys[i]).as_uint64();
+    }
+    const auto elapsed_time = mdtl::elapsed_time_sec(start);
+
+    std::cout << name << "\t" << num_keys << "\t"
+              << static_cast<double>(bytes) / num_keys << "\t"
+              << elapsed_time / num_lookups * 1e9 << "\t(" << sum << ")"
+              << std::endl;
+  }
+}
+
+int main() {
+  const std::size_t num_lookups = 1ULL << 22ULL;
+
+  std::cout << "Object\t#keys\tBytes per key\tLookup (ns)" << std::endl;
+  for (std::size_t num_keys = 1; num_keys <= 4096; num_keys *= 2) {
+    run_bench<mj::jsndtl::compact_object<alloc_type>>("compact", num_keys,
+                                                      num_lookups);
+    run_bench<mj::jsndtl::indexed_object<alloc_type>>("indexed", num_keys,
+                                                      num_lookups);
+    run_bench<mj::jsndtl::flat_indexed_object<alloc_type>>(
+        "flat_indexed", num_keys, num_lookups);
+    run_bench<mj::jsndtl::adaptive_object<alloc_type>>("adaptive", num_keys,
+                                                       num_lookups);
+  }
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_BENCH_UTILITY_COUNTING_ALLOCATOR_HPP
+#define METALL_BENCH_UTILITY_COUNTING_ALLOCATOR_HPP
+
+#include <memory>
+#include <atomic>
+#include <cstddef>
+
+namespace bench_utility {
+
+/// \brief Counters updated by counting_allocator.
+/// Shared by all counting_allocator instances.
+struct allocation_counter {
+  /// \brief The number of allocate() calls.
+  static inline std::atomic<std::size_t> num_allocations{0};
+  /// \brief The number of bytes currently allocated.
+  static inline std::atomic<std::size_t> num_allocated_bytes{0};
+};
+
+/// \brief An allocator that allocates memory using std::allocator and counts
+/// the allocations in allocation_counter.
+/// Used to measure the memory usage of containers.
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  counting_allocator() = default;
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U> &) noexcept {}
+
+  T *allocate(const std::size_t n) {
+    allocation_counter::num_allocations.fetch_add(1,
+                                                  std::memory_order_relaxed);
+    allocation_counter::num_allocated_bytes.fetch_add(
+        n * sizeof(T), std::memory_order_relaxed);
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T *const p, const std::size_t n) noexcept {
+    allocation_counter::num_allocated_bytes.fetch_sub(
+        n * sizeof(T), std::memory_order_relaxed);
+    std::allocator<T>{}.deallocate(p, n);
+  }
+};
+
+template <typename T, typename U>
+inline bool operator==(const counting_allocator<T> &,
+                       const counting_allocator<U> &) noexcept {
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const counting_allocator<T> &,
+                       const counting_allocator<U> &) noexcept {
+  return false;
+}
+
+}  // namespace bench_utility
+#endif  // METALL_BENCH_UTILITY_COUNTING_ALLOCATOR_HPP
@@ -0,0 +1,86 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include <iostream>
+
+#include <metall/container/vector.hpp>
+#include <metall/container/map.hpp>
+#include <metall/utility/metall_mpi_adaptor.hpp>
+#include <metall/utility/metall_mpi_repartition.hpp>
+#include <metall/utility/filesystem.hpp>
+
+using vector_type = metall::container::vector<int>;
+using map_type = metall::container::map<int, double>;
+
+int main(int argc, char **argv) {
+  ::MPI_Init(&argc, &argv);
+  int rank;
+  int size;
+  ::MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  ::MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // Datastores created by a different number of ranks cannot be overwritten
+  if (rank == 0) {
+    metall::utility::filesystem::remove("/tmp/metall_mpi_source");
+    metall::utility::filesystem::remove("/tmp/metall_mpi_repartitioned");
+  }
+  ::MPI_Barrier(MPI_COMM_WORLD);
+
+  // Creates a datastore using half of the ranks
+  MPI_Comm half_comm;
+  ::MPI_Comm_split(MPI_COMM_WORLD, rank < (size + 1) / 2, rank, &half_comm);
+  if (rank < (size + 1) / 2) {
+    metall::utility::metall_mpi_adaptor mpi_adaptor(
+        metall::create_only, "/tmp/metall_mpi_source", half_comm);
+    auto &manager = mpi_adaptor.get_local_manager();
+    auto *vec = manager.construct<vector_type>("vec")(manager.get_allocator());
+    auto *map = manager.construct<map_type>("map")(manager.get_allocator());
+    for (int i = 0; i < 10; ++i) {
+      vec->push_back(rank * 10 + i);
+      (*map)[rank * 10 + i] = (rank * 10 + i) * 0.5;
+    }
+  }
+  ::MPI_Comm_free(&half_comm);
+  ::MPI_Barrier(MPI_COMM_WORLD);
+
+  // Redistributes the elements to all ranks
+  {
+    metall::utility::metall_mpi_adaptor mpi_adaptor(
+        metall::create_only, "/tmp/metall_mpi_repartitioned");
+    const bool ret = metall::utility::repartition_named_container<vector_type>(
+        "/tmp/metall_mpi_source", "vec", mpi_adaptor,
+        [](const int value, const int num_partitions) {
+          return value % num_partitions;
+        });
+
+    // Elements of a map are sent as well.
+    // A small batch size makes the elements be sent in multiple exchanges.
+    const bool map_ret =
+        metall::utility::repartition_named_container<map_type>(
+            "/tmp/metall_mpi_source", "map", mpi_adaptor,
+            [](const map_type::value_type &item, const int num_partitions) {
+              return item.first % num_partitions;
+            },
+            MPI_COMM_WORLD, 4);
+
+    auto &manager = mpi_adaptor.get_local_manager();
+    const auto *vec = manager.find<vector_type>("vec").first;
+    std::cout << "Rank " << rank << " (" << (ret ? "succeeded" : "failed")
+              << ") has";
+    for (const auto value : *vec) std::cout << " " << value;
+    std::cout << std::endl;
+
+    const auto *map = manager.find<map_type>("map").first;
+    std::cout << "Rank " << rank << " (" << (map_ret ? "succeeded" : "failed")
+              << ") has";
+    for (const auto &[key, value] : *map) {
+      std::cout << " " << key << ":" << value;
+    }
+    std::cout << std::endl;
+  }
+  ::MPI_Finalize();
+
+  return 0;
+}
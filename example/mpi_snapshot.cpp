@@ -0,0 +1,40 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include <iostream>
+
+#include <metall/utility/metall_mpi_adaptor.hpp>
+
+int main(int argc, char **argv) {
+  ::MPI_Init(&argc, &argv);
+  {
+    metall::utility::metall_mpi_adaptor mpi_adaptor(
+        metall::create_only, "/tmp/metall_mpi", MPI_COMM_WORLD, true);
+    auto &metall_manager = mpi_adaptor.get_local_manager();
+    auto rank = metall_manager.construct<int>("my-rank")();
+    ::MPI_Comm_rank(MPI_COMM_WORLD, rank);
+
+    // At most 4 ranks on each node take their snapshots at the same time
+    metall::utility::metall_mpi_adaptor::collective_copy_options options;
+    options.max_concurrent_per_node = 4;
+    const auto report =
+        mpi_adaptor.snapshot("/tmp/metall_mpi_snapshot", options, true);
+
+    if (*rank == 0) {
+      std::cout << "Succeeded: " << report.succeeded << "\n"
+                << "#of nodes: " << report.num_nodes << "\n"
+                << "Total bytes: " << report.total_bytes << "\n"
+                << "Elapsed time (s): " << report.elapsed_time_sec << "\n"
+                << "Rank time (s) min/mean/max: " << report.min_rank_time_sec
+                << " / " << report.mean_rank_time_sec << " / "
+                << report.max_rank_time_sec << "\n"
+                << "Throughput (bytes/s): " << report.throughput()
+                << std::endl;
+    }
+  }
+  ::MPI_Finalize();
+
+  return 0;
+}
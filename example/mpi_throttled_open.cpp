@@ -0,0 +1,51 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include <iostream>
+
+#include <metall/utility/metall_mpi_adaptor.hpp>
+
+int main(int argc, char **argv) {
+  ::MPI_Init(&argc, &argv);
+  int rank;
+  ::MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  {
+    metall::utility::metall_mpi_adaptor mpi_adaptor(
+        metall::create_only, "/tmp/metall_mpi", MPI_COMM_WORLD, true);
+    auto &metall_manager = mpi_adaptor.get_local_manager();
+    metall_manager.construct<int>("my-rank")(rank);
+    metall_manager.construct<int>("num-opens")(0);
+  }
+
+  // At most 2 ranks on each node open their datastores at the same time.
+  // The same limit applies to closing them in the destructor.
+  metall::utility::metall_mpi_adaptor::collective_open_options options;
+  options.max_concurrent_per_node = 2;
+
+  {
+    metall::utility::metall_mpi_adaptor mpi_adaptor(
+        metall::open_only, "/tmp/metall_mpi", options);
+    auto &metall_manager = mpi_adaptor.get_local_manager();
+    ++*metall_manager.find<int>("num-opens").first;
+  }
+
+  {
+    metall::utility::metall_mpi_adaptor mpi_adaptor(
+        metall::open_read_only, "/tmp/metall_mpi", options);
+    auto &metall_manager = mpi_adaptor.get_local_manager();
+
+    // The line below should print out:
+    // "Rank x opened value x, opened 1 time(s) with write access"
+    // , where x is a number
+    std::cout << "Rank " << rank << " opened value "
+              << *metall_manager.find<int>("my-rank").first << ", opened "
+              << *metall_manager.find<int>("num-opens").first
+              << " time(s) with write access" << std::endl;
+  }
+  ::MPI_Finalize();
+
+  return 0;
+}
@@ -8,6 +8,8 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <metall/tags.hpp>
 #include <metall/stl_allocator.hpp>
@@ -146,6 +148,18 @@ class basic_manager {
   /// \brief Path type
   using path_type = typename manager_kernel_type::path_type;
 
+  /// \brief Allocator statistics type
+  using allocator_statistics_type = kernel::allocator_statistics;
+
+  /// \brief Fragmentation report type
+  using fragmentation_report_type = kernel::fragmentation_report;
+
+  /// \brief Compaction result type
+  using compaction_result_type = kernel::compaction_result;
+
+  /// \brief Consistency report type
+  using consistency_report_type = kernel::consistency_report;
+
  private:
   // -------------------- //
   // Private types and static values
@@ -429,6 +443,100 @@ class basic_manager {
     return std::make_pair(nullptr, 0);
   }
 
+  /// \brief Tries to find previously created named objects.
+  /// This function is faster than calling find() for each name,
+  /// as it takes the lock of the attributed object directories only once.
+  /// \copydoc doc_object_attrb_obj_family
+  /// \copydoc doc_object_attrb_obj_const_thread_safe
+  ///
+  /// \details
+  /// Example:
+  /// \code
+  /// auto ret = basic_manager.find_many<T>({"Name0", "Name1"});
+  /// \endcode
+  ///
+  /// \tparam T  The type of the objects.
+  /// \param names The names of the objects.
+  /// \return Returns a pair of a pointer to the object and the count for each
+  /// name, in the same order as names. If not present, nullptr is returned
+  /// for the name. Returns an empty vector on error.
+  template <typename T>
+  std::vector<std::pair<T *, size_type>> find_many(
+      const std::vector<std::string> &names) const noexcept {
+    if (!check_sanity()) {
+      return {};
+    }
+
+    try {
+      return m_kernel->template find_many<T>(names);
+    } catch (...) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "An exception has been thrown");
+    }
+
+    return {};
+  }
+
+  /// \brief Constructs a named object of type T for each name.
+  /// This function is faster than calling construct() for each name,
+  /// as it takes the lock of the attributed object directories only once.
+  /// \copydoc doc_object_attrb_obj_family
+  /// \copydoc doc_thread_safe_alloc
+  ///
+  /// \details
+  /// Each object receives the same arguments.
+  /// If T's constructor throws, the function throws that exception.
+  /// The objects that have not been constructed yet are freed;
+  /// the objects constructed before are kept.
+  ///
+  /// Example:
+  /// \code
+  /// std::vector<T *> ptrs =
+  ///     basic_manager.construct_many<T>({"Name0", "Name1"}, arg1, arg2...);
+  /// \endcode
+  ///
+  /// \tparam T The type of the objects.
+  /// \param names Unique names of the objects.
+  /// \param args The arguments passed to T's constructor.
+  /// \return The pointers to the constructed objects, in the same order as
+  /// names. Contains nullptr for a name that was used or if it failed to
+  /// allocate memory.
+  template <typename T, typename... Args>
+  std::vector<T *> construct_many(const std::vector<std::string> &names,
+                                  const Args &...args) {
+    if (!check_sanity()) {
+      return std::vector<T *>(names.size(), nullptr);
+    }
+    return m_kernel->template construct_many<T>(names, false, args...);
+  }
+
+  /// \brief Tries to find already constructed objects. Constructs an object
+  /// of type T for each name that does not exist.
+  /// This function is faster than calling find_or_construct() for each name,
+  /// as it takes the lock of the attributed object directories only once.
+  /// \copydoc doc_object_attrb_obj_family
+  /// \copydoc doc_thread_safe_alloc
+  ///
+  /// \details
+  /// Each object receives the same arguments.
+  /// If T's constructor throws, the function throws that exception.
+  /// The objects that have not been constructed yet are freed;
+  /// the objects constructed before are kept.
+  ///
+  /// \tparam T The type of the objects.
+  /// \param names The names of the objects.
+  /// \param args The arguments passed to T's constructor.
+  /// \return The pointers to the found or constructed objects, in the same
+  /// order as names. Contains nullptr if it failed to allocate memory.
+  template <typename T, typename... Args>
+  std::vector<T *> find_or_construct_many(
+      const std::vector<std::string> &names, const Args &...args) {
+    if (!check_sanity()) {
+      return std::vector<T *>(names.size(), nullptr);
+    }
+    return m_kernel->template construct_many<T>(names, true, args...);
+  }
+
   /// \brief Destroys a previously created object.
   /// Calls the destructor and frees the memory.
   /// \copydoc doc_object_attrb_obj_family
@@ -942,6 +1050,30 @@ class basic_manager {
 
   // void deallocate_many(multiallocation_chain &chain);
 
+  /// \brief Changes the size of the allocated memory, like std::realloc().
+  /// Memory larger than the internal chunk size is expanded in place
+  /// if the address range that follows it is unused.
+  /// \copydoc doc_thread_safe_alloc
+  ///
+  /// \param addr A pointer to the allocated memory or nullptr.
+  /// \param nbytes A new size in bytes.
+  /// \return Returns a pointer to the reallocated memory, which may be
+  /// different from addr. On failure, returns nullptr and addr is left
+  /// untouched.
+  void *reallocate(void *addr, size_type nbytes) noexcept {
+    if (!check_sanity()) {
+      return nullptr;
+    }
+    try {
+      return m_kernel->reallocate(addr, nbytes);
+    } catch (...) {
+      m_kernel.reset(nullptr);
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "An exception has been thrown");
+    }
+    return nullptr;
+  }
+
   /// \brief Check if all allocated memory has been deallocated.
   /// \copydoc doc_no_alloc_thread_safe
   ///
@@ -1114,6 +1246,40 @@ class basic_manager {
     return false;
   }
 
+  /// \brief Checks the management data of a data store in depth using
+  /// multiple threads, optionally repairing it.
+  /// \copydoc doc_thread_safe
+  ///
+  /// \details
+  /// Unlike consistent(), this function also checks a data store that was not
+  /// closed properly. It verifies that the chunk directory and the bin
+  /// directory agree and that all named, unique, and anonymous objects point
+  /// to allocated memory.
+  /// With repair, broken chunks and dangling objects are dropped,
+  /// the repaired management data is written back, and the data store is
+  /// marked as properly closed.
+  /// As management data is written only when a data store is closed,
+  /// a repaired data store reflects the state at the last close;
+  /// restoring a snapshot can be a better choice.
+  /// The data store must not be open.
+  /// \param path Path to a data store.
+  /// \param repair If true, repairs the found problems.
+  /// \param max_num_threads The maximum number of threads to use.
+  /// If <= 0 is given, the value is automatically determined.
+  /// \return A consistency report.
+  static consistency_report_type check_consistency(
+      const path_type &path, const bool repair = false,
+      const int max_num_threads = 0) noexcept {
+    try {
+      return manager_kernel_type::check_consistency(path, repair,
+                                                    max_num_threads);
+    } catch (...) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "An exception has been thrown");
+    }
+    return consistency_report_type{};
+  }
+
   /// \brief Returns a UUID of the data store.
   /// \copydoc doc_thread_safe
   ///
@@ -1405,6 +1571,96 @@ class basic_manager {
   bool check_sanity() const noexcept { return !!m_kernel && m_kernel->good(); }
 
   // ---------- For profiling and debug ---------- //
+  /// \brief Returns a snapshot of the allocator statistics, such as the
+  /// number of allocations per object size, object cache hits and misses,
+  /// and lock contentions.
+  /// The counters are always on and cheap to read; unlike profile(),
+  /// this function does not stop or slow down allocations.
+  /// Counters are values since the datastore was created or opened,
+  /// except for bytes_in_use.
+  /// \copydoc doc_thread_safe
+  ///
+  /// \return A snapshot of the statistics. Returns a default-constructed
+  /// object on error.
+  allocator_statistics_type get_allocator_statistics() const noexcept {
+    if (!check_sanity()) {
+      return allocator_statistics_type{};
+    }
+    try {
+      return m_kernel->get_allocator_statistics();
+    } catch (...) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "An exception has been thrown");
+    }
+    return allocator_statistics_type{};
+  }
+
+  /// \brief Analyzes the fragmentation of the internal chunks holding small
+  /// objects, e.g., how many chunks compact() could free.
+  /// This function releases the object caches, like profile().
+  /// \copydoc doc_single_thread
+  ///
+  /// \param sparse_occupancy A chunk is counted as sparse if its slot
+  /// occupancy is equal to or less than this value.
+  /// \return A fragmentation report. Returns a default-constructed object on
+  /// error.
+  fragmentation_report_type analyze_fragmentation(
+      const double sparse_occupancy = 0.5) noexcept {
+    if (!check_sanity()) {
+      return fragmentation_report_type{};
+    }
+    try {
+      return m_kernel->analyze_fragmentation(sparse_occupancy);
+    } catch (...) {
+      m_kernel.reset(nullptr);
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "An exception has been thrown");
+    }
+    return fragmentation_report_type{};
+  }
+
+  /// \brief Compacts small objects: moves live objects out of sparse
+  /// internal chunks into denser ones and frees the emptied chunks,
+  /// releasing their DRAM and file space.
+  ///
+  /// \details
+  /// Metall cannot find pointers to a moved object; the relocator is
+  /// responsible for moving each object and fixing up the pointers to it,
+  /// e.g., in the containers that hold it. Note that offset_ptr members are
+  /// self-relative; objects containing them must be moved by their move
+  /// constructor (or an equivalent), not by memcpy.
+  /// Objects allocated by construct() and its variants are never relocated.
+  /// \copydoc doc_single_thread
+  /// No other thread may use this manager or the objects in it while this
+  /// function runs.
+  ///
+  /// \tparam relocator_type A callable type whose signature is
+  /// bool(void *src, void *dst, size_type nbytes).
+  /// \param relocator Called for each object to relocate. nbytes is the size
+  /// of the internal slots, which can be larger than the requested size.
+  /// It must move the object from src to dst and return true,
+  /// or return false to keep the object in place.
+  /// It must not allocate or deallocate memory through this manager.
+  /// \param max_occupancy Only chunks whose slot occupancy is equal to or less
+  /// than this value are evacuated.
+  /// \return The result of the compaction. Returns a default-constructed
+  /// object on error.
+  template <typename relocator_type>
+  compaction_result_type compact(relocator_type relocator,
+                                 const double max_occupancy = 0.5) noexcept {
+    if (!check_sanity()) {
+      return compaction_result_type{};
+    }
+    try {
+      return m_kernel->compact(max_occupancy, std::move(relocator));
+    } catch (...) {
+      m_kernel.reset(nullptr);
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "An exception has been thrown");
+    }
+    return compaction_result_type{};
+  }
+
 #if !defined(DOXYGEN_SKIP)
   /// \brief Prints out profiling information.
   /// \tparam out_stream_type A type of out stream.
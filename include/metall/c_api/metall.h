@@ -8,6 +8,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +21,25 @@ extern "C" {
  */
 typedef struct metall_manager metall_manager;
 
+/**
+ * \brief Snapshot of the allocator statistics of a metall manager
+ * \note Counters are values since the datastore was created or opened, except for bytes_in_use
+ */
+typedef struct metall_allocator_statistics {
+  uint64_t num_allocations;
+  uint64_t num_deallocations;
+  uint64_t num_in_place_resizes;
+  uint64_t num_cache_hits;
+  uint64_t num_cache_misses;
+  uint64_t num_bin_lock_acquisitions;
+  uint64_t num_bin_lock_contentions;
+  uint64_t bin_lock_wait_time_ns;
+  uint64_t num_segment_extensions;
+  uint64_t num_free_region_calls;
+  uint64_t free_region_bytes;
+  uint64_t bytes_in_use;
+} metall_allocator_statistics;
+
 /**
  * \brief Attempts to open the metall datastore at path
  * \param path path to datastore
@@ -122,6 +142,16 @@ void* metall_find(metall_manager* manager, const char* name);
  */
 bool metall_named_free(metall_manager* manager, const char* name);
 
+/**
+ * \brief Takes a snapshot of the allocator statistics without stopping allocations
+ * \param manager manager to read the statistics of
+ * \param stats pointer to store the statistics
+ * \return true on success, otherwise returns false and sets errno to one of the following values
+ *      - EINVAL if stats is NULL or the manager is not in a valid state
+ */
+bool metall_get_allocator_statistics(metall_manager* manager,
+                                     metall_allocator_statistics* stats);
+
 #ifdef __cplusplus
 }
 #endif
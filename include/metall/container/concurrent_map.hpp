@@ -8,10 +8,14 @@
 
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
 #include <boost/container/vector.hpp>
 #include <boost/container/map.hpp>
 #include <boost/container/scoped_allocator.hpp>
-#include <metall/utility/mutex.hpp>
+#include <metall/detail/transient_lock_table.hpp>
 #include <metall/utility/container_of_containers_iterator_adaptor.hpp>
 
 /// \namespace metall::container
@@ -19,13 +23,22 @@
 namespace metall::container {
 
 /// \brief A concurrent map container which can be stored in persistent memory.
-/// This container does not allocate mutex objects internally, but allocates
-/// them as static objects. To achieve high concurrency, this container
-/// allocates multiple banks, where a bank consists of an actual STL map object
-/// and a mutex object. \tparam _key_type A key type. \tparam _mapped_type A
-/// mapped type. \tparam _compare A key compare. \tparam _bank_no_hasher A key
-/// hasher. \tparam _allocator An allocator. \tparam k_num_banks The number of
-/// banks to be allocated.
+/// To achieve high concurrency, this container allocates multiple banks, where
+/// a bank consists of an actual STL map object and a reader-writer lock.
+/// The locks belong to each container instance but are allocated in transient
+/// (process-local) memory, i.e., they are never stored in persistent memory.
+/// Lookups take a bank lock in shared mode; thus, they can run concurrently
+/// with each other and safely with modifications.
+/// find() returns an iterator after releasing the lock; use visit() to read
+/// an element while other threads may modify the container.
+/// \warning The persistent layout of this class has changed from the
+/// versions that used static mutex objects: the item count is an atomic
+/// variable and a transient lock table, which holds a few words of cache, was
+/// added. A concurrent_map object stored by those versions cannot be used.
+/// \tparam _key_type A key type. \tparam _mapped_type A mapped type.
+/// \tparam _compare A key compare. \tparam _bank_no_hasher A key hasher.
+/// \tparam _allocator An allocator. \tparam k_num_banks The number of banks to
+/// be allocated.
 template <typename _key_type, typename _mapped_type,
           typename _compare = std::less<_key_type>,
           typename _bank_no_hasher = std::hash<_key_type>,
@@ -45,6 +58,9 @@ class concurrent_map {
       internal_map_type,
       boost::container::scoped_allocator_adaptor<banked_map_allocator_type>>;
 
+  using lock_table_type = mtlldetail::transient_lock_table<k_num_banks>;
+  using mutex_type = typename lock_table_type::mutex_type;
+
  public:
   // -------------------- //
   // Public types and static values
@@ -72,6 +88,20 @@ class concurrent_map {
   explicit concurrent_map(const _allocator &allocator = _allocator())
       : m_banked_map(k_num_banks, allocator), m_num_items(0) {}
 
+  /// \brief Copy constructor.
+  /// This function is not thread-safe.
+  concurrent_map(const concurrent_map &other)
+      : m_banked_map(other.m_banked_map),
+        m_num_items(other.m_num_items.load()) {}
+
+  /// \brief Copy assignment operator.
+  /// This function is not thread-safe.
+  concurrent_map &operator=(const concurrent_map &other) {
+    m_banked_map = other.m_banked_map;
+    m_num_items = other.m_num_items.load();
+    return *this;
+  }
+
   // -------------------- //
   // Public methods
   // -------------------- //
@@ -81,12 +111,13 @@ class concurrent_map {
   /// which is either 1 or 0.
   size_type count(const key_type &key) const {
     const auto bank_no = calc_bank_no(key);
+    std::shared_lock<mutex_type> lock(priv_bank_mutex(bank_no));
     return m_banked_map[bank_no].count(key);
   }
 
   /// \brief Returns the number of elements in the container.
   /// \return The number of elements in the container.
-  size_type size() const { return m_num_items; }
+  size_type size() const { return m_num_items.load(std::memory_order_relaxed); }
 
   // ---------- Modifier ---------- //
   /// \brief Inserts element into the container
@@ -95,10 +126,10 @@ class concurrent_map {
   /// whether the insertion took place.
   bool insert(value_type &&value) {
     const auto bank_no = calc_bank_no(value.first);
-    auto lock = metall::utility::mutex::mutex_lock<k_num_banks>(bank_no);
+    std::unique_lock<mutex_type> lock(priv_bank_mutex(bank_no));
     const bool ret =
         m_banked_map[bank_no].insert(std::forward<value_type>(value)).second;
-    m_num_items += (ret) ? 1 : 0;
+    if (ret) m_num_items.fetch_add(1, std::memory_order_relaxed);
     return ret;
   }
 
@@ -106,16 +137,11 @@ class concurrent_map {
   /// If no element exists with an equivalent key, this container creates a new
   /// element with key. \param key A key of the element to edit. \return A pair
   /// of a reference to the element and a mutex ownership wrapper.
-  std::pair<mapped_type &, std::unique_lock<std::mutex>> scoped_edit(
+  std::pair<mapped_type &, std::unique_lock<mutex_type>> scoped_edit(
       const key_type &key) {
     const auto bank_no = calc_bank_no(key);
-    auto lock = metall::utility::mutex::mutex_lock<k_num_banks>(bank_no);
-    if (!count(key)) {
-      [[maybe_unused]] const bool ret = register_key_no_lock(key);
-      assert(ret);
-      ++m_num_items;
-    }
-    return std::make_pair(std::ref(m_banked_map[bank_no].at(key)),
+    std::unique_lock<mutex_type> lock(priv_bank_mutex(bank_no));
+    return std::make_pair(std::ref(priv_find_or_register_no_lock(key, bank_no)),
                           std::move(lock));
   }
 
@@ -126,13 +152,8 @@ class concurrent_map {
   void edit(const key_type &key,
             const std::function<void(mapped_type &mapped_value)> &editor) {
     const auto bank_no = calc_bank_no(key);
-    auto lock = metall::utility::mutex::mutex_lock<k_num_banks>(bank_no);
-    if (!count(key)) {
-      [[maybe_unused]] const bool ret = register_key_no_lock(key);
-      assert(ret);
-      ++m_num_items;
-    }
-    editor(m_banked_map[bank_no].at(key));
+    std::unique_lock<mutex_type> lock(priv_bank_mutex(bank_no));
+    editor(priv_find_or_register_no_lock(key, bank_no));
   }
 
   // ---------- Iterator ---------- //
@@ -153,11 +174,15 @@ class concurrent_map {
 
   // ---------- Look up ---------- //
   /// \brief Finds an element with an equivalent key.
+  /// The returned iterator is not protected by any lock; the element must not
+  /// be modified or erased by other threads while the iterator is used.
+  /// Use visit() to read an element concurrently with modifications.
   /// \param key A key value of the element to search for
   /// \return An iterator to an element with an equivalent key.
   /// If no such element is found, the returned iterator will be equal to end().
   const_iterator find(const key_type &key) const {
     const auto bank_no = calc_bank_no(key);
+    std::shared_lock<mutex_type> lock(priv_bank_mutex(bank_no));
     auto itr = m_banked_map[bank_no].find(key);
     if (itr != m_banked_map[bank_no].end()) {
       return const_iterator(m_banked_map.cbegin(), itr, m_banked_map.cend());
@@ -165,6 +190,26 @@ class concurrent_map {
     return cend();
   }
 
+  /// \brief Reads an element with an equivalent key.
+  /// The element is read while holding the bank lock in shared mode.
+  /// Thus, multiple threads can read elements in the same bank concurrently,
+  /// and modifications to the bank are blocked until 'reader' returns.
+  /// \param key A key value of the element to read.
+  /// \param reader A function object which takes a const reference to the
+  /// mapped value. It must not modify the container.
+  /// \return True if an element with an equivalent key was found and
+  /// 'reader' was called; otherwise, false.
+  template <typename reader_function>
+  bool visit(const key_type &key, reader_function &&reader) const {
+    const auto bank_no = calc_bank_no(key);
+    std::shared_lock<mutex_type> lock(priv_bank_mutex(bank_no));
+    const auto &bank = m_banked_map[bank_no];
+    const auto itr = bank.find(key);
+    if (itr == bank.end()) return false;
+    reader(static_cast<const mapped_type &>(itr->second));
+    return true;
+  }
+
   // ---------- Allocator ---------- //
   /// \brief Returns the allocator associated with the container.
   /// \return An object of the associated allocator.
@@ -177,13 +222,20 @@ class concurrent_map {
     return _bank_no_hasher()(key) % k_num_banks;
   }
 
-  bool register_key_no_lock(const key_type &key) {
-    const auto bank_no = calc_bank_no(key);
-    return m_banked_map[bank_no].try_emplace(key).second;
+  mapped_type &priv_find_or_register_no_lock(const key_type &key,
+                                             const uint64_t bank_no) {
+    auto ret = m_banked_map[bank_no].try_emplace(key);
+    if (ret.second) m_num_items.fetch_add(1, std::memory_order_relaxed);
+    return ret.first->second;
+  }
+
+  mutex_type &priv_bank_mutex(const uint64_t bank_no) const {
+    return m_locks[bank_no];
   }
 
   banked_map_type m_banked_map;
-  size_type m_num_items;
+  std::atomic<size_type> m_num_items;
+  lock_table_type m_locks;
 };
 
 }  // namespace metall::container
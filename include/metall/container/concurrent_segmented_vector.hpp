@@ -0,0 +1,521 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_CONTAINER_CONCURRENT_SEGMENTED_VECTOR_HPP
+#define METALL_CONTAINER_CONCURRENT_SEGMENTED_VECTOR_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include <metall/offset_ptr.hpp>
+#include <metall/detail/builtin_functions.hpp>
+
+namespace metall::container {
+
+/// \brief An append-only vector which can be stored in persistent memory and
+/// supports lock-free concurrent appends.
+/// Elements are stored in fixed-size segments that are never relocated; thus,
+/// growing the vector never copies elements and references to elements stay
+/// valid until the vector is cleared or destroyed.
+/// A thread appends elements by reserving slots with a single atomic
+/// operation and constructing the elements in the reserved slots.
+/// Segments are allocated on demand by the first thread that needs them.
+///
+/// Segments are found through a segment table, whose i-th block holds 2^i
+/// segment slots; the table blocks are also allocated on demand and never
+/// relocated. The table stores self-relative offsets, so that the vector can
+/// be reattached at a different address, e.g., when a Metall datastore is
+/// reopened.
+///
+/// size() is the number of reserved slots. An element appended by another
+/// thread is visible only after the threads synchronize, e.g., at the end of a
+/// parallel region.
+/// Appends and element accesses can be performed concurrently;
+/// clear() and the destructor cannot.
+/// \tparam _value_type A value type.
+/// \tparam _allocator_type An allocator type.
+/// \tparam k_segment_size_log2 Log2 of the number of elements in a segment.
+template <typename _value_type,
+          typename _allocator_type = std::allocator<_value_type>,
+          std::size_t k_segment_size_log2 = 16>
+class concurrent_segmented_vector {
+ private:
+  template <bool is_const>
+  class iterator_impl;
+
+ public:
+  // -------------------- //
+  // Public types and static values
+  // -------------------- //
+  using value_type = _value_type;
+  using allocator_type = typename std::allocator_traits<
+      _allocator_type>::template rebind_alloc<value_type>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using iterator = iterator_impl<false>;
+  using const_iterator = iterator_impl<true>;
+
+  /// \brief The number of elements in a segment.
+  static constexpr size_type k_segment_size = size_type(1)
+                                              << k_segment_size_log2;
+
+ private:
+  using slot_type = std::atomic<std::uint64_t>;
+  using slot_allocator_type = typename std::allocator_traits<
+      _allocator_type>::template rebind_alloc<slot_type>;
+
+  // Block b holds 2^b segment slots, which is enough for any index
+  static constexpr size_type k_num_table_blocks = 64 - k_segment_size_log2;
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "64-bit atomics must be lock-free");
+
+ public:
+  // -------------------- //
+  // Constructor & assign operator
+  // -------------------- //
+  /// \brief Constructor.
+  /// \param allocator An allocator object.
+  explicit concurrent_segmented_vector(
+      const allocator_type &allocator = allocator_type())
+      : m_allocator(allocator) {
+    for (auto &slot : m_table) slot.store(0, std::memory_order_relaxed);
+  }
+
+  /// \brief Destructor.
+  /// This function is not thread-safe.
+  ~concurrent_segmented_vector() noexcept {
+    clear();
+    priv_deallocate_all();
+  }
+
+  // The table holds self-relative offsets
+  concurrent_segmented_vector(const concurrent_segmented_vector &) = delete;
+  concurrent_segmented_vector(concurrent_segmented_vector &&) = delete;
+  concurrent_segmented_vector &operator=(const concurrent_segmented_vector &) =
+      delete;
+  concurrent_segmented_vector &operator=(concurrent_segmented_vector &&) =
+      delete;
+
+  // -------------------- //
+  // Public methods
+  // -------------------- //
+  // ---------- Modifier ---------- //
+  /// \brief Appends an element.
+  /// This function is thread-safe.
+  /// \param value A value to append.
+  /// \return The index of the appended element.
+  size_type push_back(const value_type &value) { return emplace_back(value); }
+
+  /// \brief Appends an element.
+  /// This function is thread-safe.
+  /// \param value A value to append.
+  /// \return The index of the appended element.
+  size_type push_back(value_type &&value) {
+    return emplace_back(std::move(value));
+  }
+
+  /// \brief Constructs an element at the end of the vector.
+  /// This function is thread-safe.
+  /// \param args Arguments to forward to the constructor of the element.
+  /// \return The index of the appended element.
+  template <typename... args_type>
+  size_type emplace_back(args_type &&...args) {
+    const auto index = m_size.fetch_add(1, std::memory_order_relaxed);
+    auto *const segment =
+        priv_get_or_allocate_segment(index >> k_segment_size_log2);
+    std::allocator_traits<allocator_type>::construct(
+        m_allocator, segment + (index & (k_segment_size - 1)),
+        std::forward<args_type>(args)...);
+    return index;
+  }
+
+  /// \brief Appends the elements in [first, last) to consecutive positions.
+  /// Reserves all slots with a single atomic operation; thus, the elements are
+  /// not interleaved with elements appended by other threads.
+  /// This function is thread-safe.
+  /// \param first The beginning of the elements to append.
+  /// \param last The end of the elements to append.
+  /// \return The index of the first appended element.
+  template <typename forward_iterator>
+  size_type append(forward_iterator first, forward_iterator last) {
+    const size_type n = std::distance(first, last);
+    const auto begin = m_size.fetch_add(n, std::memory_order_relaxed);
+    priv_for_each_range(begin, begin + n,
+                        [this, &first](value_type *const data,
+                                       const size_type length) {
+                          for (size_type i = 0; i < length; ++i, ++first) {
+                            std::allocator_traits<allocator_type>::construct(
+                                m_allocator, data + i, *first);
+                          }
+                        });
+    return begin;
+  }
+
+  /// \brief Appends n copies of a value to consecutive positions.
+  /// This function is thread-safe.
+  /// \param n The number of elements to append.
+  /// \param value A value to copy.
+  /// \return The index of the first appended element.
+  size_type grow_by(const size_type n,
+                    const value_type &value = value_type()) {
+    const auto begin = m_size.fetch_add(n, std::memory_order_relaxed);
+    priv_for_each_range(
+        begin, begin + n,
+        [this, &value](value_type *const data, const size_type length) {
+          for (size_type i = 0; i < length; ++i) {
+            std::allocator_traits<allocator_type>::construct(m_allocator,
+                                                             data + i, value);
+          }
+        });
+    return begin;
+  }
+
+  /// \brief Allocates the segments to hold at least n elements.
+  /// This function is thread-safe.
+  /// \param n The number of elements.
+  void reserve(const size_type n) {
+    for (size_type s = 0; s * k_segment_size < n; ++s) {
+      priv_get_or_allocate_segment(s);
+    }
+  }
+
+  /// \brief Destroys all elements.
+  /// Allocated segments are kept and reused.
+  /// This function is not thread-safe.
+  void clear() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+      priv_for_each_range(0, size(),
+                          [this](value_type *const data, const size_type n) {
+                            for (size_type i = 0; i < n; ++i) {
+                              std::allocator_traits<allocator_type>::destroy(
+                                  m_allocator, data + i);
+                            }
+                          });
+    }
+    m_size.store(0, std::memory_order_relaxed);
+  }
+
+  // ---------- Element access ---------- //
+  /// \brief Accesses an element.
+  /// \param index The index of the element.
+  /// \return A reference to the element.
+  reference operator[](const size_type index) {
+    return priv_segment(index >> k_segment_size_log2)[index &
+                                                     (k_segment_size - 1)];
+  }
+
+  /// \brief Accesses an element.
+  /// \param index The index of the element.
+  /// \return A const reference to the element.
+  const_reference operator[](const size_type index) const {
+    return priv_segment(index >> k_segment_size_log2)[index &
+                                                     (k_segment_size - 1)];
+  }
+
+  /// \brief Accesses an element with bounds checking.
+  /// Throws std::out_of_range if index is equal to or larger than size().
+  /// \param index The index of the element.
+  /// \return A reference to the element.
+  reference at(const size_type index) {
+    priv_check_range(index);
+    return (*this)[index];
+  }
+
+  /// \brief Accesses an element with bounds checking.
+  /// Throws std::out_of_range if index is equal to or larger than size().
+  /// \param index The index of the element.
+  /// \return A const reference to the element.
+  const_reference at(const size_type index) const {
+    priv_check_range(index);
+    return (*this)[index];
+  }
+
+  // ---------- Capacity ---------- //
+  /// \brief Returns the number of elements, including the elements that are
+  /// being appended by other threads.
+  /// \return The number of elements.
+  size_type size() const { return m_size.load(std::memory_order_relaxed); }
+
+  /// \brief Checks if the vector is empty.
+  /// \return True if the vector is empty.
+  bool empty() const { return size() == 0; }
+
+  /// \brief Returns the number of allocated segments.
+  /// Segments are allocated in order except while appends are in progress.
+  /// \return The number of allocated segments.
+  size_type num_segments() const {
+    size_type count = 0;
+    for (size_type b = 0; b < k_num_table_blocks; ++b) {
+      const auto *const block = priv_load<slot_type>(m_table[b]);
+      if (!block) break;
+      for (size_type i = 0; i < priv_block_size(b); ++i) {
+        if (block[i].load(std::memory_order_relaxed) != 0) ++count;
+      }
+    }
+    return count;
+  }
+
+  // ---------- Iterator ---------- //
+  iterator begin() { return iterator(this, 0); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator cbegin() const { return const_iterator(this, 0); }
+  iterator end() { return iterator(this, size()); }
+  const_iterator end() const { return const_iterator(this, size()); }
+  const_iterator cend() const { return const_iterator(this, size()); }
+
+  // ---------- Allocator ---------- //
+  /// \brief Returns the allocator associated with the container.
+  /// \return An object of the associated allocator.
+  allocator_type get_allocator() const { return m_allocator; }
+
+ private:
+  // -------------------- //
+  // Private methods
+  // -------------------- //
+  // Segment s is at position s + 1 - 2^b of block b = floor(log2(s + 1)).
+  static size_type priv_block_no(const size_type segment_no) {
+    return 63 - mtlldetail::clzll(segment_no + 1);
+  }
+
+  static size_type priv_block_size(const size_type block_no) {
+    return size_type(1) << block_no;
+  }
+
+  // Loads a pointer stored as an offset from the slot itself
+  template <typename pointee_type>
+  static pointee_type *priv_load(const slot_type &slot) {
+    const auto offset = slot.load(std::memory_order_acquire);
+    if (offset == 0) return nullptr;
+    return reinterpret_cast<pointee_type *>(
+        reinterpret_cast<std::uintptr_t>(&slot) + offset);
+  }
+
+  // Stores a pointer if the slot is empty.
+  // Returns the pointer stored in the slot.
+  template <typename pointee_type>
+  static pointee_type *priv_publish(slot_type &slot, pointee_type *const ptr) {
+    std::uint64_t expected = 0;
+    const std::uint64_t offset = reinterpret_cast<std::uintptr_t>(ptr) -
+                                 reinterpret_cast<std::uintptr_t>(&slot);
+    if (slot.compare_exchange_strong(expected, offset,
+                                     std::memory_order_acq_rel)) {
+      return ptr;
+    }
+    return reinterpret_cast<pointee_type *>(
+        reinterpret_cast<std::uintptr_t>(&slot) + expected);
+  }
+
+  template <typename allocator, typename pointee_type>
+  static void priv_deallocate(allocator &alloc, pointee_type *const ptr,
+                              const size_type n) {
+    using pointer = typename std::allocator_traits<allocator>::pointer;
+    std::allocator_traits<allocator>::deallocate(
+        alloc, std::pointer_traits<pointer>::pointer_to(*ptr), n);
+  }
+
+  slot_type *priv_get_or_allocate_block(const size_type block_no) {
+    auto *block = priv_load<slot_type>(m_table[block_no]);
+    if (block) return block;
+
+    slot_allocator_type alloc(m_allocator);
+    const auto n = priv_block_size(block_no);
+    auto *const new_block = metall::to_raw_pointer(
+        std::allocator_traits<slot_allocator_type>::allocate(alloc, n));
+    for (size_type i = 0; i < n; ++i) {
+      new (new_block + i) slot_type(0);
+    }
+    block = priv_publish(m_table[block_no], new_block);
+    if (block != new_block) {  // Another thread won
+      priv_deallocate(alloc, new_block, n);
+    }
+    return block;
+  }
+
+  value_type *priv_get_or_allocate_segment(const size_type segment_no) {
+    const auto block_no = priv_block_no(segment_no);
+    auto &slot = priv_get_or_allocate_block(
+        block_no)[segment_no + 1 - priv_block_size(block_no)];
+    auto *segment = priv_load<value_type>(slot);
+    if (segment) return segment;
+
+    auto *const new_segment =
+        metall::to_raw_pointer(std::allocator_traits<allocator_type>::allocate(
+            m_allocator, k_segment_size));
+    segment = priv_publish(slot, new_segment);
+    if (segment != new_segment) {  // Another thread won
+      priv_deallocate(m_allocator, new_segment, k_segment_size);
+    }
+    return segment;
+  }
+
+  // The segment must be allocated
+  value_type *priv_segment(const size_type segment_no) const {
+    const auto block_no = priv_block_no(segment_no);
+    const auto *const block = priv_load<slot_type>(m_table[block_no]);
+    assert(block);
+    auto *const segment = priv_load<value_type>(
+        block[segment_no + 1 - priv_block_size(block_no)]);
+    assert(segment);
+    return segment;
+  }
+
+  // Calls a function with each contiguous range of [begin, end),
+  // allocating segments if needed.
+  template <typename function_type>
+  void priv_for_each_range(const size_type begin, const size_type end,
+                           function_type function) {
+    for (size_type i = begin; i < end;) {
+      const auto offset = i & (k_segment_size - 1);
+      const auto length = std::min(k_segment_size - offset, end - i);
+      function(priv_get_or_allocate_segment(i >> k_segment_size_log2) + offset,
+               length);
+      i += length;
+    }
+  }
+
+  void priv_check_range(const size_type index) const {
+    if (index >= size()) {
+      throw std::out_of_range("concurrent_segmented_vector: out of range");
+    }
+  }
+
+  void priv_deallocate_all() noexcept {
+    slot_allocator_type slot_alloc(m_allocator);
+    for (size_type b = 0; b < k_num_table_blocks; ++b) {
+      auto *const block = priv_load<slot_type>(m_table[b]);
+      if (!block) continue;
+      for (size_type i = 0; i < priv_block_size(b); ++i) {
+        auto *const segment = priv_load<value_type>(block[i]);
+        if (segment) priv_deallocate(m_allocator, segment, k_segment_size);
+      }
+      priv_deallocate(slot_alloc, block, priv_block_size(b));
+      m_table[b].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // -------------------- //
+  // Private fields
+  // -------------------- //
+  allocator_type m_allocator;
+  std::atomic<size_type> m_size{0};
+  std::array<slot_type, k_num_table_blocks> m_table;
+};
+
+/// \brief A random access iterator of concurrent_segmented_vector.
+/// Looks up the segment table on every access.
+template <typename _value_type, typename _allocator_type,
+          std::size_t k_segment_size_log2>
+template <bool is_const>
+class concurrent_segmented_vector<_value_type, _allocator_type,
+                                  k_segment_size_log2>::iterator_impl {
+ private:
+  using container_pointer =
+      std::conditional_t<is_const, const concurrent_segmented_vector *,
+                         concurrent_segmented_vector *>;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = _value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer =
+      std::conditional_t<is_const, const value_type *, value_type *>;
+  using reference =
+      std::conditional_t<is_const, const value_type &, value_type &>;
+
+  iterator_impl() = default;
+  iterator_impl(container_pointer container, const size_type index)
+      : m_container(container), m_index(index) {}
+
+  // Converts a non-const iterator to a const one
+  template <bool other_is_const,
+            typename = std::enable_if_t<is_const && !other_is_const>>
+  iterator_impl(const iterator_impl<other_is_const> &other)
+      : m_container(other.m_container), m_index(other.m_index) {}
+
+  reference operator*() const { return (*m_container)[m_index]; }
+  pointer operator->() const { return &(*m_container)[m_index]; }
+  reference operator[](const difference_type n) const {
+    return (*m_container)[m_index + n];
+  }
+
+  iterator_impl &operator++() {
+    ++m_index;
+    return *this;
+  }
+  iterator_impl operator++(int) {
+    auto tmp = *this;
+    ++m_index;
+    return tmp;
+  }
+  iterator_impl &operator--() {
+    --m_index;
+    return *this;
+  }
+  iterator_impl operator--(int) {
+    auto tmp = *this;
+    --m_index;
+    return tmp;
+  }
+  iterator_impl &operator+=(const difference_type n) {
+    m_index += n;
+    return *this;
+  }
+  iterator_impl &operator-=(const difference_type n) {
+    m_index -= n;
+    return *this;
+  }
+  iterator_impl operator+(const difference_type n) const {
+    return iterator_impl(m_container, m_index + n);
+  }
+  iterator_impl operator-(const difference_type n) const {
+    return iterator_impl(m_container, m_index - n);
+  }
+  difference_type operator-(const iterator_impl &other) const {
+    return difference_type(m_index) - difference_type(other.m_index);
+  }
+
+  bool operator==(const iterator_impl &other) const {
+    return m_index == other.m_index;
+  }
+  bool operator!=(const iterator_impl &other) const {
+    return m_index != other.m_index;
+  }
+  bool operator<(const iterator_impl &other) const {
+    return m_index < other.m_index;
+  }
+  bool operator>(const iterator_impl &other) const {
+    return m_index > other.m_index;
+  }
+  bool operator<=(const iterator_impl &other) const {
+    return m_index <= other.m_index;
+  }
+  bool operator>=(const iterator_impl &other) const {
+    return m_index >= other.m_index;
+  }
+
+ private:
+  template <bool>
+  friend class iterator_impl;
+
+  container_pointer m_container{nullptr};
+  size_type m_index{0};
+};
+
+}  // namespace metall::container
+
+#endif  // METALL_CONTAINER_CONCURRENT_SEGMENTED_VECTOR_HPP
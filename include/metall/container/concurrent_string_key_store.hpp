@@ -0,0 +1,342 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_CONTAINER_CONCURRENT_STRING_KEY_STORE_HPP
+#define METALL_CONTAINER_CONCURRENT_STRING_KEY_STORE_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+#include <metall/container/vector.hpp>
+#include <metall/container/string_key_store.hpp>
+#include <metall/detail/transient_lock_table.hpp>
+#include <metall/utility/open_mp.hpp>
+#include <metall/metall.hpp>
+
+namespace metall::container {
+
+namespace {
+namespace mc = metall::container;
+}
+
+/// \brief A thread-safe key-value store that uses string for its key.
+/// Elements are partitioned by the hash value of their keys into
+/// 'k_num_shards' independent string_key_store objects (shards), each of which
+/// is protected by its own reader-writer lock. The locks are allocated in
+/// transient (process-local) memory.
+/// \warning This container is designed to work as the top-level container,
+/// i.e., it does not work if used inside another container.
+/// \tparam _value_type A value type.
+/// \tparam allocator_type An allocator type.
+/// \tparam k_num_shards The number of shards.
+template <typename _value_type,
+          typename allocator_type = metall::manager::allocator_type<std::byte>,
+          std::size_t k_num_shards = 64>
+class concurrent_string_key_store {
+ private:
+  template <typename T>
+  using other_allocator =
+      typename std::allocator_traits<allocator_type>::template rebind_alloc<T>;
+
+  using shard_type = string_key_store<_value_type, allocator_type>;
+  using shard_storage_type = mc::vector<shard_type, other_allocator<shard_type>>;
+  using lock_table_type = mtlldetail::transient_lock_table<k_num_shards>;
+  using mutex_type = typename lock_table_type::mutex_type;
+
+ public:
+  using key_type = typename shard_type::key_type;
+  using value_type = typename shard_type::value_type;
+
+  /// \brief Constructor.
+  /// \param allocator An allocator object.
+  explicit concurrent_string_key_store(
+      const allocator_type &allocator = allocator_type())
+      : concurrent_string_key_store(false, 123, allocator) {}
+
+  /// \brief Constructor.
+  /// \param unique Accept duplicate keys if false is specified.
+  /// \param hash_seed Hash function seed.
+  /// \param allocator An allocator object.
+  concurrent_string_key_store(
+      const bool unique, const uint64_t hash_seed,
+      const allocator_type &allocator = allocator_type())
+      : m_shards(allocator) {
+    // Shards are constructed one by one because string_key_store does not
+    // support uses-allocator construction.
+    m_shards.reserve(k_num_shards);
+    for (std::size_t i = 0; i < k_num_shards; ++i) {
+      m_shards.emplace_back(unique, hash_seed, allocator);
+    }
+  }
+
+  /// \brief Copy constructor.
+  /// This function is not thread-safe.
+  concurrent_string_key_store(const concurrent_string_key_store &) = default;
+
+  /// \brief Copy assignment operator.
+  /// This function is not thread-safe.
+  concurrent_string_key_store &operator=(
+      const concurrent_string_key_store &) = default;
+
+  /// \brief Returns the number of shards.
+  /// \return The number of shards.
+  static constexpr std::size_t num_shards() { return k_num_shards; }
+
+  /// \brief Inserts a key with the default value.
+  /// If the unique parameter in the constructor was set to true and a duplicate
+  /// key item already exists, this function does nothing and returns false.
+  /// \param key A key to insert.
+  /// \return True if an item is inserted; otherwise, false.
+  bool insert(const key_type &key) {
+    const auto shard_no = priv_shard_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[shard_no]);
+    return m_shards[shard_no].insert(key);
+  }
+
+  /// \brief Inserts an item.
+  /// If the unique parameter was set to true in the constructor and a
+  /// duplicate key item exists, this function updates the value of the
+  /// existing one. \param key A key to insert. \param value A value to insert.
+  /// \return Always true.
+  bool insert(const key_type &key, const value_type &value) {
+    const auto shard_no = priv_shard_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[shard_no]);
+    return m_shards[shard_no].insert(key, value);
+  }
+
+  /// \brief Insert() with move operator version.
+  /// \param key A key to insert.
+  /// \param value A value to insert.
+  /// \return Always true.
+  bool insert(const key_type &key, value_type &&value) {
+    const auto shard_no = priv_shard_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[shard_no]);
+    return m_shards[shard_no].insert(key, std::move(value));
+  }
+
+  /// \brief Inserts items read from a range [first, last).
+  /// This function is not an overload of insert() so that it is not picked
+  /// for insert(key, value) with two arguments of the same type, e.g., string
+  /// literals.
+  /// Items are read into a buffer of 'chunk_size' items, grouped by shard, and
+  /// inserted into the shards in parallel if OpenMP is enabled. Each shard is
+  /// locked once per chunk. Thus, the range can be a single-pass stream, e.g.,
+  /// an iterator that parses input lines.
+  /// This function can be called concurrently with the other functions.
+  /// \param first The beginning of the range. Must point to a pair-like object
+  /// whose 'first' is convertible to key_type and whose 'second' is convertible
+  /// to value_type.
+  /// \param last The end of the range.
+  /// \param chunk_size The number of items to buffer.
+  /// \return The number of items read.
+  template <typename input_iterator>
+  std::size_t bulk_insert(input_iterator first, input_iterator last,
+                          const std::size_t chunk_size = 1ULL << 16ULL) {
+    std::vector<std::pair<std::string, value_type>> buffer;
+    buffer.reserve(chunk_size);
+    std::size_t num_read = 0;
+    while (first != last) {
+      buffer.clear();
+      for (; first != last && buffer.size() < chunk_size; ++first) {
+        buffer.emplace_back(std::string(key_type(first->first)),
+                            first->second);
+      }
+      priv_insert_chunk(buffer);
+      num_read += buffer.size();
+    }
+    return num_read;
+  }
+
+  /// \brief Counts the number of items associated with the key.
+  /// \param key A key to count.
+  /// \return The number of items associated with the key.
+  std::size_t count(const key_type &key) const {
+    const auto shard_no = priv_shard_no(key);
+    std::shared_lock<mutex_type> lock(m_locks[shard_no]);
+    return m_shards[shard_no].count(key);
+  }
+
+  /// \brief Returns the number of elements in this container.
+  /// The value may be outdated when returned if other threads modify the
+  /// container concurrently.
+  /// \return The number of elements in this container.
+  std::size_t size() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < k_num_shards; ++i) {
+      std::shared_lock<mutex_type> lock(m_locks[i]);
+      total += m_shards[i].size();
+    }
+    return total;
+  }
+
+  /// \brief Removes all elements with the key equivalent to key.
+  /// \param key The key of elements to remove.
+  /// \return The number of elements removed.
+  std::size_t erase(const key_type &key) {
+    const auto shard_no = priv_shard_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[shard_no]);
+    return m_shards[shard_no].erase(key);
+  }
+
+  /// \brief Clear all contents.
+  /// This function is not thread-safe.
+  void clear() {
+    for (auto &shard : m_shards) shard.clear();
+  }
+
+  /// \brief Reads the values of the elements with 'key'.
+  /// The shard is locked in shared mode while 'reader' is called.
+  /// \param key The key of elements to read.
+  /// \param reader A function object which takes a const reference to a value.
+  /// \return The number of elements read.
+  template <typename reader_function>
+  std::size_t visit(const key_type &key, reader_function &&reader) const {
+    const auto shard_no = priv_shard_no(key);
+    std::shared_lock<mutex_type> lock(m_locks[shard_no]);
+    const auto &shard = m_shards[shard_no];
+    std::size_t num_read = 0;
+    const auto range = shard.equal_range(key);
+    for (auto loc = range.first; loc != range.second; ++loc) {
+      reader(shard.value(loc));
+      ++num_read;
+    }
+    return num_read;
+  }
+
+  /// \brief Edits the values of the elements with 'key' exclusively.
+  /// \param key The key of elements to edit.
+  /// \param editor A function object which takes a reference to a value.
+  /// \return The number of elements edited.
+  template <typename editor_function>
+  std::size_t edit(const key_type &key, editor_function &&editor) {
+    const auto shard_no = priv_shard_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[shard_no]);
+    auto &shard = m_shards[shard_no];
+    std::size_t num_edited = 0;
+    const auto range = shard.equal_range(key);
+    for (auto loc = range.first; loc != range.second; ++loc) {
+      editor(shard.value(loc));
+      ++num_edited;
+    }
+    return num_edited;
+  }
+
+  /// \brief Calls a function for each element in the container.
+  /// Shards are processed in parallel if OpenMP is enabled; thus, 'func' must
+  /// be thread-safe. Each shard is locked in shared mode while it is
+  /// processed. \param func A function object which takes a key (key_type) and
+  /// a const reference to a value.
+  template <typename function>
+  void for_each(const function &func) const {
+    OMP_DIRECTIVE(parallel for schedule(dynamic))
+    for (std::size_t i = 0; i < k_num_shards; ++i) {
+      for_each_in_shard(i, func);
+    }
+  }
+
+  /// \brief Calls a function for each element in a shard.
+  /// The shard is locked in shared mode while it is processed.
+  /// Applications can process shards in parallel with their own threads.
+  /// \param shard_no A shard number in [0, num_shards()).
+  /// \param func A function object which takes a key (key_type) and a const
+  /// reference to a value.
+  template <typename function>
+  void for_each_in_shard(const std::size_t shard_no,
+                         const function &func) const {
+    std::shared_lock<mutex_type> lock(m_locks[shard_no]);
+    const auto &shard = m_shards[shard_no];
+    for (auto loc = shard.begin(); loc != shard.end(); ++loc) {
+      func(shard.key(loc), shard.value(loc));
+    }
+  }
+
+  /// \brief Reserves space for at least the specified number of elements.
+  /// Assumes that elements are spread evenly over the shards.
+  /// This function is not thread-safe.
+  /// \param count The number of elements to reserve space for.
+  void reserve(const std::size_t count) {
+    for (auto &shard : m_shards) {
+      shard.reserve((count + k_num_shards - 1) / k_num_shards);
+    }
+  }
+
+  /// \brief Returns an instance of the internal allocator.
+  /// \return An instance of the internal allocator.
+  allocator_type get_allocator() const { return m_shards.get_allocator(); }
+
+  /// \brief Returns if this container inserts keys uniquely.
+  /// \return True if this container inserts key avoiding duplicates; otherwise
+  /// false.
+  bool unique() const { return m_shards.front().unique(); }
+
+  /// \brief Returns the hash seed.
+  /// \return Hash seed.
+  uint64_t hash_seed() const { return m_shards.front().hash_seed(); }
+
+ private:
+  // Mixes the hash value (the finalizer of MurmurHash3) so that the shard
+  // number does not correlate with the slot positions in the shards.
+  std::size_t priv_shard_no(const key_type &key) const {
+    uint64_t h = shard_type::priv_hash_key(key, hash_seed());
+    h ^= h >> 33ULL;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33ULL;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33ULL;
+    return h % k_num_shards;
+  }
+
+  void priv_insert_chunk(std::vector<std::pair<std::string, value_type>> &chunk) {
+    // Counting sort of the items by shard number
+    std::vector<std::size_t> shard_offsets(k_num_shards + 1, 0);
+    std::vector<uint32_t> shard_nos(chunk.size());
+    for (std::size_t i = 0; i < chunk.size(); ++i) {
+      shard_nos[i] = static_cast<uint32_t>(priv_shard_no(chunk[i].first));
+      ++shard_offsets[shard_nos[i] + 1];
+    }
+    for (std::size_t s = 0; s < k_num_shards; ++s) {
+      shard_offsets[s + 1] += shard_offsets[s];
+    }
+    // Keeps the input order within each shard
+    std::vector<std::size_t> sorted(chunk.size());
+    {
+      auto positions = shard_offsets;
+      for (std::size_t i = 0; i < chunk.size(); ++i) {
+        sorted[positions[shard_nos[i]]++] = i;
+      }
+    }
+
+    OMP_DIRECTIVE(parallel for schedule(dynamic))
+    for (std::size_t s = 0; s < k_num_shards; ++s) {
+      if (shard_offsets[s] == shard_offsets[s + 1]) continue;
+      std::unique_lock<mutex_type> lock(m_locks[s]);
+      auto &shard = m_shards[s];
+      // Grows geometrically; reserving the exact size for every chunk would
+      // reallocate the whole shard each time.
+      const auto required =
+          shard.size() + (shard_offsets[s + 1] - shard_offsets[s]);
+      if (required > shard.capacity()) {
+        shard.reserve(std::max(required, shard.capacity() * 2));
+      }
+      for (auto i = shard_offsets[s]; i < shard_offsets[s + 1]; ++i) {
+        auto &item = chunk[sorted[i]];
+        shard.insert(item.first, std::move(item.second));
+      }
+    }
+  }
+
+  shard_storage_type m_shards;
+  lock_table_type m_locks;
+};
+
+}  // namespace metall::container
+
+#endif  // METALL_CONTAINER_CONCURRENT_STRING_KEY_STORE_HPP
@@ -0,0 +1,351 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_CONTAINER_CONCURRENT_UNORDERED_FLAT_MAP_HPP
+#define METALL_CONTAINER_CONCURRENT_UNORDERED_FLAT_MAP_HPP
+
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include <iterator>
+#include <cstdint>
+#include <boost/container/vector.hpp>
+#include <boost/container/scoped_allocator.hpp>
+#include <metall/container/unordered_flat_map.hpp>
+#include <metall/detail/transient_lock_table.hpp>
+#include <metall/utility/container_of_containers_iterator_adaptor.hpp>
+#include <metall/utility/open_mp.hpp>
+
+namespace metall::container {
+
+/// \brief A concurrent hash map container which can be stored in persistent
+/// memory. Like concurrent_map, this container consists of multiple banks,
+/// where a bank consists of an unordered_flat_map object (an open-addressing
+/// hash table) and a reader-writer lock. The locks belong to each container
+/// instance but are allocated in transient (process-local) memory.
+/// Compared with concurrent_map, a lookup does not follow a chain of tree
+/// nodes and an insertion does not allocate a node per element.
+/// \tparam Key A key type. \tparam T A mapped type.
+/// \tparam Hash A key hasher, which is used to select a bank and inside banks.
+/// \tparam KeyEqual A key equal function.
+/// \tparam Allocator An allocator. \tparam k_num_banks The number of banks to
+/// be allocated.
+template <class Key, class T, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = manager::allocator_type<std::pair<const Key, T>>,
+          std::size_t k_num_banks = 1024>
+class concurrent_unordered_flat_map {
+ private:
+  template <typename U>
+  using other_allocator_type =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+  using bank_type = unordered_flat_map<Key, T, Hash, KeyEqual, Allocator>;
+  using bank_allocator_type = other_allocator_type<bank_type>;
+  using banks_type = boost::container::vector<
+      bank_type,
+      boost::container::scoped_allocator_adaptor<bank_allocator_type>>;
+
+  using lock_table_type = mtlldetail::transient_lock_table<k_num_banks>;
+  using mutex_type = typename lock_table_type::mutex_type;
+
+ public:
+  // -------------------- //
+  // Public types and static values
+  // -------------------- //
+  /// \brief A key type.
+  using key_type = typename bank_type::key_type;
+  /// \brief A mapped type.
+  using mapped_type = typename bank_type::mapped_type;
+  /// \brief A value type (i.e., std::pair<const key_type, mapped_type>).
+  using value_type = typename bank_type::value_type;
+  /// \brief A unsigned integer type (usually std::size_t).
+  using size_type = typename bank_type::size_type;
+  /// \brief A hasher type.
+  using hasher = Hash;
+  /// \brief A key equal function type.
+  using key_equal = KeyEqual;
+  /// \brief An allocator type.
+  using allocator_type = Allocator;
+
+  /// \brief A const iterator type.
+  using const_iterator =
+      metall::utility::container_of_containers_iterator_adaptor<
+          typename banks_type::const_iterator,
+          typename bank_type::const_iterator>;
+
+  // -------------------- //
+  // Constructor & assign operator
+  // -------------------- //
+  explicit concurrent_unordered_flat_map(
+      const allocator_type &allocator = allocator_type())
+      : m_banks(k_num_banks, allocator), m_num_items(0) {}
+
+  /// \brief Copy constructor.
+  /// This function is not thread-safe.
+  concurrent_unordered_flat_map(const concurrent_unordered_flat_map &other)
+      : m_banks(other.m_banks), m_num_items(other.m_num_items.load()) {}
+
+  /// \brief Copy assignment operator.
+  /// This function is not thread-safe.
+  concurrent_unordered_flat_map &operator=(
+      const concurrent_unordered_flat_map &other) {
+    m_banks = other.m_banks;
+    m_num_items = other.m_num_items.load();
+    return *this;
+  }
+
+  // -------------------- //
+  // Public methods
+  // -------------------- //
+  /// \brief Returns the number of banks.
+  /// \return The number of banks.
+  static constexpr size_type num_banks() { return k_num_banks; }
+
+  /// \brief Returns the number of elements matching specific key.
+  /// \param key A key value of the elements to count.
+  /// \return The number of elements with key that compares equivalent to key,
+  /// which is either 1 or 0.
+  size_type count(const key_type &key) const {
+    const auto bank_no = calc_bank_no(key);
+    std::shared_lock<mutex_type> lock(m_locks[bank_no]);
+    return m_banks[bank_no].count(key);
+  }
+
+  /// \brief Returns the number of elements in the container.
+  /// \return The number of elements in the container.
+  size_type size() const { return m_num_items.load(std::memory_order_relaxed); }
+
+  /// \brief Checks if the container has no elements.
+  /// \return True if the container is empty; otherwise, false.
+  bool empty() const { return size() == 0; }
+
+  // ---------- Modifier ---------- //
+  /// \brief Inserts element into the container
+  /// if the container doesn't already contain an element with an equivalent
+  /// key. \param value An element value to insert. \return A bool denoting
+  /// whether the insertion took place.
+  bool insert(const value_type &value) {
+    const auto bank_no = calc_bank_no(value.first);
+    std::unique_lock<mutex_type> lock(m_locks[bank_no]);
+    return priv_count_insertion(m_banks[bank_no].insert(value).second);
+  }
+
+  /// \brief Inserts element into the container
+  /// if the container doesn't already contain an element with an equivalent
+  /// key. \param value An element value to insert. \return A bool denoting
+  /// whether the insertion took place.
+  bool insert(value_type &&value) {
+    const auto bank_no = calc_bank_no(value.first);
+    std::unique_lock<mutex_type> lock(m_locks[bank_no]);
+    return priv_count_insertion(
+        m_banks[bank_no].insert(std::move(value)).second);
+  }
+
+  /// \brief Inserts elements in a range [first, last).
+  /// Elements whose keys already exist in the container are not inserted.
+  /// The elements are first grouped by bank so that each bank is locked only
+  /// once; the banks are filled in parallel if OpenMP is enabled.
+  /// If the range contains multiple elements with an equivalent key, which
+  /// one is inserted is unspecified.
+  /// This function can be called concurrently with the other functions.
+  /// \param first The beginning of the range. Must be a forward iterator that
+  /// points to a pair-like object.
+  /// \param last The end of the range.
+  /// \return The number of elements inserted.
+  template <typename forward_iterator>
+  size_type insert(forward_iterator first, forward_iterator last) {
+    // Counting sort of the elements by bank number
+    std::vector<size_type> bank_offsets(k_num_banks + 1, 0);
+    std::vector<uint32_t> bank_nos;
+    for (auto itr = first; itr != last; ++itr) {
+      const auto bank_no = calc_bank_no(itr->first);
+      bank_nos.push_back(static_cast<uint32_t>(bank_no));
+      ++bank_offsets[bank_no + 1];
+    }
+    for (std::size_t b = 0; b < k_num_banks; ++b) {
+      bank_offsets[b + 1] += bank_offsets[b];
+    }
+    std::vector<forward_iterator> sorted(bank_nos.size());
+    {
+      auto positions = bank_offsets;
+      std::size_t i = 0;
+      for (auto itr = first; itr != last; ++itr, ++i) {
+        sorted[positions[bank_nos[i]]++] = itr;
+      }
+    }
+
+    size_type num_inserted = 0;
+    OMP_DIRECTIVE(parallel for schedule(dynamic) reduction(+ : num_inserted))
+    for (std::size_t b = 0; b < k_num_banks; ++b) {
+      if (bank_offsets[b] == bank_offsets[b + 1]) continue;
+      std::unique_lock<mutex_type> lock(m_locks[b]);
+      auto &bank = m_banks[b];
+      bank.reserve(bank.size() + (bank_offsets[b + 1] - bank_offsets[b]));
+      for (auto i = bank_offsets[b]; i < bank_offsets[b + 1]; ++i) {
+        num_inserted +=
+            bank.try_emplace(sorted[i]->first, sorted[i]->second).second ? 1
+                                                                         : 0;
+      }
+    }
+    m_num_items.fetch_add(num_inserted, std::memory_order_relaxed);
+    return num_inserted;
+  }
+
+  /// \brief Provides a way to edit an element exclusively.
+  /// If no element exists with an equivalent key, this container creates a new
+  /// element with key. \param key A key of the element to edit. \return A pair
+  /// of a reference to the element and a mutex ownership wrapper.
+  /// The reference is invalidated if the element is moved by an insertion
+  /// into the same bank; thus, it must not be used after the lock is released.
+  std::pair<mapped_type &, std::unique_lock<mutex_type>> scoped_edit(
+      const key_type &key) {
+    const auto bank_no = calc_bank_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[bank_no]);
+    return std::make_pair(std::ref(priv_find_or_register_no_lock(key, bank_no)),
+                          std::move(lock));
+  }
+
+  /// \brief Provides a way to edit an element exclusively.
+  /// If no element exists with an equivalent key, this container creates a new
+  /// element with key. \param key A key of the element to edit. \param editor A
+  /// function object which edits an element.
+  void edit(const key_type &key,
+            const std::function<void(mapped_type &mapped_value)> &editor) {
+    const auto bank_no = calc_bank_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[bank_no]);
+    editor(priv_find_or_register_no_lock(key, bank_no));
+  }
+
+  /// \brief Erases an element with an equivalent key.
+  /// \param key A key value of the element to erase.
+  /// \return The number of elements erased, which is either 1 or 0.
+  size_type erase(const key_type &key) {
+    const auto bank_no = calc_bank_no(key);
+    std::unique_lock<mutex_type> lock(m_locks[bank_no]);
+    const auto num_erased = m_banks[bank_no].erase(key);
+    m_num_items.fetch_sub(num_erased, std::memory_order_relaxed);
+    return num_erased;
+  }
+
+  /// \brief Reserves space for at least the specified number of elements.
+  /// Assumes that elements are spread evenly over the banks.
+  /// This function is not thread-safe.
+  /// \param count The number of elements to reserve space for.
+  void reserve(const size_type count) {
+    const auto count_per_bank = (count + k_num_banks - 1) / k_num_banks;
+    for (auto &bank : m_banks) {
+      bank.reserve(count_per_bank);
+    }
+  }
+
+  // ---------- Look up ---------- //
+  /// \brief Reads an element with an equivalent key.
+  /// The element is read while holding the bank lock in shared mode.
+  /// Thus, multiple threads can read elements in the same bank concurrently,
+  /// and modifications to the bank are blocked until 'reader' returns.
+  /// \param key A key value of the element to read.
+  /// \param reader A function object which takes a const reference to the
+  /// mapped value. It must not modify the container.
+  /// \return True if an element with an equivalent key was found and
+  /// 'reader' was called; otherwise, false.
+  template <typename reader_function>
+  bool visit(const key_type &key, reader_function &&reader) const {
+    const auto bank_no = calc_bank_no(key);
+    std::shared_lock<mutex_type> lock(m_locks[bank_no]);
+    const auto &bank = m_banks[bank_no];
+    const auto itr = bank.find(key);
+    if (itr == bank.end()) return false;
+    reader(static_cast<const mapped_type &>(itr->second));
+    return true;
+  }
+
+  // ---------- Iterator ---------- //
+  /// \brief Calls a function for each element in the container.
+  /// Banks are processed in parallel if OpenMP is enabled; thus, 'func' must
+  /// be thread-safe. Each bank is locked in shared mode while it is processed.
+  /// \param func A function object which takes a const reference to a
+  /// value_type object.
+  template <typename function>
+  void for_each(const function &func) const {
+    OMP_DIRECTIVE(parallel for schedule(dynamic))
+    for (std::size_t b = 0; b < k_num_banks; ++b) {
+      for_each_in_bank(b, func);
+    }
+  }
+
+  /// \brief Calls a function for each element in a bank.
+  /// The bank is locked in shared mode while it is processed.
+  /// Applications can process banks in parallel with their own threads.
+  /// \param bank_no A bank number in [0, num_banks()).
+  /// \param func A function object which takes a const reference to a
+  /// value_type object.
+  template <typename function>
+  void for_each_in_bank(const size_type bank_no, const function &func) const {
+    std::shared_lock<mutex_type> lock(m_locks[bank_no]);
+    for (const auto &elem : m_banks[bank_no]) {
+      func(elem);
+    }
+  }
+
+  /// \brief Returns an iterator to the first element of the map.
+  /// Iterators are not protected by any lock; the container must not be
+  /// modified while iterators are used.
+  /// \return A const iterator to the first element.
+  const_iterator cbegin() const {
+    return const_iterator(m_banks.cbegin(), m_banks.cend());
+  }
+
+  /// \brief Returns an iterator to the element following the last element of
+  /// the map.
+  /// \return A const iterator to the element following the last element.
+  const_iterator cend() const {
+    return const_iterator(m_banks.cend(), m_banks.cend());
+  }
+
+  // ---------- Allocator ---------- //
+  /// \brief Returns the allocator associated with the container.
+  /// \return An object of the associated allocator.
+  allocator_type get_allocator() const {
+    return allocator_type(m_banks.get_allocator());
+  }
+
+ private:
+  // Mixes the hash value (the finalizer of MurmurHash3) so that the bank
+  // number does not depend only on the low bits of a weak hash value, e.g.,
+  // std::hash of an integer.
+  static uint64_t calc_bank_no(const key_type &key) {
+    uint64_t h = hasher()(key);
+    h ^= h >> 33ULL;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33ULL;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33ULL;
+    return h % k_num_banks;
+  }
+
+  bool priv_count_insertion(const bool inserted) {
+    if (inserted) m_num_items.fetch_add(1, std::memory_order_relaxed);
+    return inserted;
+  }
+
+  mapped_type &priv_find_or_register_no_lock(const key_type &key,
+                                             const uint64_t bank_no) {
+    auto ret = m_banks[bank_no].try_emplace(key);
+    priv_count_insertion(ret.second);
+    return ret.first->second;
+  }
+
+  banks_type m_banks;
+  std::atomic<size_type> m_num_items;
+  lock_table_type m_locks;
+};
+
+}  // namespace metall::container
+
+#endif  // METALL_CONTAINER_CONCURRENT_UNORDERED_FLAT_MAP_HPP
@@ -0,0 +1,348 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_CONTAINER_EXPERIMENT_JGRAPH_BULK_LOADER_HPP
+#define METALL_CONTAINER_EXPERIMENT_JGRAPH_BULK_LOADER_HPP
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <metall/container/experimental/jgraph/jgraph.hpp>
+#include <metall/json/json.hpp>
+#include <metall/utility/open_mp.hpp>
+
+namespace metall::container::experimental::jgraph {
+
+/// \brief Loads vertices and edges from JSON Lines files into a jgraph in
+/// parallel. Each line of a vertex file is a JSON object that has a vertex ID;
+/// each line of an edge file is a JSON object that has source and destination
+/// vertex IDs. The whole JSON object becomes the value of the vertex or edge.
+/// IDs can be strings or integers.
+///
+/// Files are split into line-aligned chunks that are read and parsed in
+/// parallel; the values are constructed with the allocator of the graph, i.e.,
+/// directly in persistent memory if the graph is.
+/// Parsed records are partitioned by the bank of their (source) vertex, which
+/// is determined by the hash value of the vertex ID, and each bank is updated
+/// by a single thread. Therefore, no lock is used.
+/// Lines that are not JSON objects or do not have the required keys are
+/// skipped.
+/// \tparam graph_type A jgraph type.
+template <typename graph_type>
+class bulk_loader {
+ public:
+  using allocator_type = typename graph_type::allocator_type;
+  using value_type = typename graph_type::value_type;
+
+  /// \brief Constructor.
+  /// \param graph A graph to load data into.
+  /// \param id_key The key of vertex IDs in vertex JSON objects.
+  /// \param source_key The key of source vertex IDs in edge JSON objects.
+  /// \param destination_key The key of destination vertex IDs in edge JSON
+  /// objects.
+  explicit bulk_loader(graph_type *graph, std::string id_key = "id",
+                       std::string source_key = "start",
+                       std::string destination_key = "end")
+      : m_graph(graph),
+        m_id_key(std::move(id_key)),
+        m_source_key(std::move(source_key)),
+        m_destination_key(std::move(destination_key)) {}
+
+  /// \brief Sets the number of bytes each thread reads at once.
+  /// \param chunk_size A chunk size in bytes.
+  void set_chunk_size(const std::size_t chunk_size) {
+    m_chunk_size = std::max(chunk_size, std::size_t(1));
+  }
+
+  /// \brief Sets the number of chunks parsed before their records are
+  /// inserted into the graph. Parsed records are held in memory until then.
+  /// \param num_chunks The number of chunks.
+  void set_num_chunks_per_round(const std::size_t num_chunks) {
+    m_num_chunks_per_round = std::max(num_chunks, std::size_t(1));
+  }
+
+  /// \brief Loads vertices. If a vertex already exists, its value is
+  /// overwritten.
+  /// \param file_paths A list of vertex JSON Lines files.
+  /// \return The number of vertex lines loaded.
+  std::size_t load_vertices(const std::vector<std::string> &file_paths) {
+    std::size_t num_loaded = 0;
+    priv_for_each_round(file_paths, [this, &num_loaded](
+                                        const std::vector<chunk> &chunks) {
+      num_loaded += priv_load_vertex_chunks(chunks);
+    });
+    return num_loaded;
+  }
+
+  /// \brief Loads edges. Vertices that do not exist are registered with null
+  /// values.
+  /// \param file_paths A list of edge JSON Lines files.
+  /// \param undirected If true, each edge is also added to the edge list of
+  /// its destination vertex, as jgraph::register_edge() does.
+  /// \return The number of edge lines loaded.
+  std::size_t load_edges(const std::vector<std::string> &file_paths,
+                         const bool undirected = false) {
+    std::size_t num_loaded = 0;
+    priv_for_each_round(file_paths, [this, undirected, &num_loaded](
+                                        const std::vector<chunk> &chunks) {
+      num_loaded += priv_load_edge_chunks(chunks, undirected);
+    });
+    return num_loaded;
+  }
+
+ private:
+  static constexpr std::size_t k_num_banks = graph_type::k_num_banks;
+  using internal_id_type = typename graph_type::internal_id_type;
+
+  struct chunk {
+    std::string file_path;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  struct vertex_record {
+    std::string id;
+    value_type value;
+  };
+
+  struct edge_record {
+    std::string source_id;
+    std::string destination_id;
+    value_type value;
+  };
+
+  struct mirror_record {
+    internal_id_type destination;
+    internal_id_type source;
+    internal_id_type edge_id;
+  };
+
+  // [chunk or source bank][bank] -> records
+  template <typename record_type>
+  using bucket_table_type =
+      std::vector<std::vector<std::vector<record_type>>>;
+
+  template <typename record_type>
+  static bucket_table_type<record_type> priv_make_buckets(
+      const std::size_t num_rows) {
+    return bucket_table_type<record_type>(
+        num_rows, std::vector<std::vector<record_type>>(k_num_banks));
+  }
+
+  template <typename function_type>
+  void priv_for_each_round(const std::vector<std::string> &file_paths,
+                           function_type function) const {
+    std::vector<chunk> chunks;
+    for (const auto &path : file_paths) {
+      std::error_code ec;
+      const auto file_size = std::filesystem::file_size(path, ec);
+      if (ec) {
+        std::cerr << "Failed to open " << path << ": " << ec.message()
+                  << std::endl;
+        continue;
+      }
+      for (std::size_t begin = 0; begin < file_size; begin += m_chunk_size) {
+        chunks.push_back(
+            chunk{path, begin, std::min(begin + m_chunk_size, file_size)});
+        if (chunks.size() >= m_num_chunks_per_round) {
+          function(chunks);
+          chunks.clear();
+        }
+      }
+    }
+    if (!chunks.empty()) function(chunks);
+  }
+
+  // Reads the lines that start in [begin, end) of a chunk.
+  // A line that starts in a chunk may end in the next one.
+  template <typename function_type>
+  static void priv_for_each_line(const chunk &chk, function_type function) {
+    std::ifstream ifs(chk.file_path, std::ios::binary);
+    if (!ifs.is_open()) {
+      std::cerr << "Failed to open " << chk.file_path << std::endl;
+      return;
+    }
+
+    std::size_t pos = chk.begin;
+    std::string line;
+    if (pos > 0) {
+      // Skips the line that started in the previous chunk
+      ifs.seekg(pos - 1);
+      std::getline(ifs, line);
+      pos += line.size();
+    }
+
+    while (pos < chk.end && std::getline(ifs, line)) {
+      pos += line.size() + 1;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.empty()) continue;
+      function(line);
+    }
+  }
+
+  // Converts a JSON value that represents a vertex ID into a string.
+  // Returns false if the value is not a string or an integer.
+  static bool priv_to_id(const value_type &value, std::string *id) {
+    if (value.is_string()) {
+      id->assign(value.as_string().data(), value.as_string().size());
+    } else if (value.is_int64()) {
+      *id = std::to_string(value.as_int64());
+    } else if (value.is_uint64()) {
+      *id = std::to_string(value.as_uint64());
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool priv_find_id(const value_type &json, const std::string &key,
+                    std::string *id) const {
+    if (!json.is_object()) return false;
+    const auto &object = json.as_object();
+    const auto itr = object.find(key);
+    if (itr == object.end()) return false;
+    return priv_to_id(itr->value(), id);
+  }
+
+  value_type priv_parse(const std::string &line) const {
+    return mj::parse(line, m_graph->get_allocator());
+  }
+
+  std::size_t priv_load_vertex_chunks(const std::vector<chunk> &chunks) {
+    auto buckets = priv_make_buckets<vertex_record>(chunks.size());
+
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1))
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+      priv_for_each_line(chunks[c], [this, &buckets, c](const auto &line) {
+        vertex_record record{std::string(), priv_parse(line)};
+        if (!priv_find_id(record.value, m_id_key, &record.id)) return;
+        const auto bank = graph_type::priv_bank_of(std::string_view(record.id));
+        buckets[c][bank].emplace_back(std::move(record));
+      });
+    }
+
+    std::size_t num_loaded = 0;
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1) reduction(+ : num_loaded))
+    for (std::size_t bank = 0; bank < k_num_banks; ++bank) {
+      for (auto &chunk_buckets : buckets) {
+        for (auto &record : chunk_buckets[bank]) {
+          const auto internal_id = m_graph->priv_register_vertex(record.id);
+          m_graph->priv_vertex_data(internal_id).value() =
+              std::move(record.value);
+          ++num_loaded;
+        }
+        chunk_buckets[bank].clear();
+        chunk_buckets[bank].shrink_to_fit();
+      }
+    }
+
+    return num_loaded;
+  }
+
+  std::size_t priv_load_edge_chunks(const std::vector<chunk> &chunks,
+                                    const bool undirected) {
+    // Parses edges; an edge goes to the bank of its source vertex.
+    // Vertex IDs go to their banks so that missing vertices are registered.
+    auto edge_buckets = priv_make_buckets<edge_record>(chunks.size());
+    auto vertex_buckets = priv_make_buckets<std::string>(chunks.size());
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1))
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+      priv_for_each_line(
+          chunks[c], [this, &edge_buckets, &vertex_buckets, c](const auto &line) {
+            edge_record record{std::string(), std::string(), priv_parse(line)};
+            if (!priv_find_id(record.value, m_source_key, &record.source_id) ||
+                !priv_find_id(record.value, m_destination_key,
+                              &record.destination_id)) {
+              return;
+            }
+            const auto src_bank =
+                graph_type::priv_bank_of(std::string_view(record.source_id));
+            const auto dst_bank = graph_type::priv_bank_of(
+                std::string_view(record.destination_id));
+            vertex_buckets[c][src_bank].push_back(record.source_id);
+            vertex_buckets[c][dst_bank].push_back(record.destination_id);
+            edge_buckets[c][src_bank].emplace_back(std::move(record));
+          });
+    }
+
+    // Registers vertices
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1))
+    for (std::size_t bank = 0; bank < k_num_banks; ++bank) {
+      for (auto &chunk_buckets : vertex_buckets) {
+        for (const auto &id : chunk_buckets[bank]) {
+          m_graph->priv_register_vertex(id);
+        }
+        chunk_buckets[bank].clear();
+        chunk_buckets[bank].shrink_to_fit();
+      }
+    }
+
+    // Adds edges to the source vertices.
+    // Vertex ID tables are only read at this point.
+    auto mirror_buckets =
+        priv_make_buckets<mirror_record>(undirected ? k_num_banks : 0);
+    std::size_t num_loaded = 0;
+    OMP_DIRECTIVE(parallel for schedule(dynamic, 1) reduction(+ : num_loaded))
+    for (std::size_t bank = 0; bank < k_num_banks; ++bank) {
+      for (auto &chunk_buckets : edge_buckets) {
+        for (auto &record : chunk_buckets[bank]) {
+          const auto src =
+              m_graph->priv_get_vertex_internal_id(record.source_id);
+          const auto dst =
+              m_graph->priv_get_vertex_internal_id(record.destination_id);
+          const auto edge_id =
+              m_graph
+                  ->priv_register_out_edge(src, dst, record.source_id,
+                                           record.destination_id)
+                  .second;
+          m_graph->priv_edge_data(edge_id).value() = std::move(record.value);
+          if (undirected) {
+            mirror_buckets[bank][graph_type::priv_bank_of(dst)].push_back(
+                mirror_record{dst, src, edge_id});
+          }
+          ++num_loaded;
+        }
+        chunk_buckets[bank].clear();
+        chunk_buckets[bank].shrink_to_fit();
+      }
+    }
+
+    // Adds undirected edges to the destination vertices
+    if (undirected) {
+      OMP_DIRECTIVE(parallel for schedule(dynamic, 1))
+      for (std::size_t bank = 0; bank < k_num_banks; ++bank) {
+        for (auto &src_bank_buckets : mirror_buckets) {
+          for (const auto &record : src_bank_buckets[bank]) {
+            m_graph->priv_register_in_edge(record.destination, record.source,
+                                           record.edge_id);
+          }
+          src_bank_buckets[bank].clear();
+          src_bank_buckets[bank].shrink_to_fit();
+        }
+      }
+    }
+
+    return num_loaded;
+  }
+
+  graph_type *m_graph;
+  std::string m_id_key;
+  std::string m_source_key;
+  std::string m_destination_key;
+  std::size_t m_chunk_size{std::size_t(1) << 26};
+  std::size_t m_num_chunks_per_round{256};
+};
+
+}  // namespace metall::container::experimental::jgraph
+
+#endif  // METALL_CONTAINER_EXPERIMENT_JGRAPH_BULK_LOADER_HPP
@@ -0,0 +1,635 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_CONTAINER_EXPERIMENT_JGRAPH_DENSE_JGRAPH_HPP
+#define METALL_CONTAINER_EXPERIMENT_JGRAPH_DENSE_JGRAPH_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <limits>
+#include <charconv>
+#include <unordered_map>
+
+#include <metall/container/vector.hpp>
+#include <metall/container/scoped_allocator.hpp>
+#include <metall/container/experimental/jgraph/jgraph.hpp>
+#include <metall/json/json.hpp>
+
+namespace metall::container::experimental::jgraph {
+
+namespace {
+namespace mc = metall::container;
+namespace mj = metall::json;
+}  // namespace
+
+namespace jgdtl {
+template <typename adj_list_edge_list_iterator_type,
+          typename storage_pointer_type>
+class dense_edge_iterator_impl;
+}  // namespace jgdtl
+
+/// \brief A JSON graph container for graphs whose vertex IDs are dense
+/// non-negative integers.
+/// Vertices are stored in a vector indexed by their IDs and edges are stored
+/// in a vector indexed by the order of registration. Each vertex has a
+/// contiguous array of (neighbor index, edge index) pairs.
+/// Thus, no hash table lookup is required to access vertices and edges.
+/// Registering a vertex whose ID is N also registers all vertices whose IDs
+/// are less than N (their values are null). To keep a single large ID in the
+/// input from allocating a huge amount of memory, vertex indices larger than
+/// max_vertex_index() are rejected.
+/// \tparam _allocator_type An allocator type.
+template <typename _allocator_type = std::allocator<std::byte>>
+class dense_jgraph {
+ public:
+  using allocator_type = _allocator_type;
+
+  /// \brief The type of vertex ID (a decimal string).
+  using id_type = std::string_view;
+
+  /// \brief The type of vertex index and edge index.
+  using index_type = uint64_t;
+
+  /// \brief JSON value type every vertex and edge has,
+  using value_type = mj::value<allocator_type>;
+
+  /// \brief Index that represents an invalid vertex.
+  static constexpr index_type k_invalid_index =
+      std::numeric_limits<index_type>::max();
+
+  /// \brief The default maximum vertex index (about 16M vertices).
+  static constexpr index_type k_default_max_vertex_index =
+      (1ULL << 24ULL) - 1;
+
+ private:
+  template <typename T>
+  using other_allocator =
+      typename std::allocator_traits<allocator_type>::template rebind_alloc<T>;
+
+  template <typename T>
+  using other_scoped_allocator =
+      mc::scoped_allocator_adaptor<other_allocator<T>>;
+
+  using string_type =
+      mc::basic_string<char, std::char_traits<char>, other_allocator<char>>;
+
+  class vertex_data_type {
+   public:
+    using allocator_type = _allocator_type;
+
+    explicit vertex_data_type(const allocator_type &allocator = allocator_type())
+        : m_id(allocator), m_value(allocator) {}
+
+    /// \brief Copy constructor
+    vertex_data_type(const vertex_data_type &) = default;
+
+    /// \brief Allocator-extended copy constructor
+    vertex_data_type(const vertex_data_type &other, const allocator_type &alloc)
+        : m_id(other.m_id, alloc), m_value(other.m_value, alloc) {}
+
+    /// \brief Move constructor
+    vertex_data_type(vertex_data_type &&) noexcept = default;
+
+    /// \brief Allocator-extended move constructor
+    vertex_data_type(vertex_data_type &&other,
+                     const allocator_type &alloc) noexcept
+        : m_id(std::move(other.m_id), alloc),
+          m_value(std::move(other.m_value), alloc) {}
+
+    /// \brief Copy assignment operator
+    vertex_data_type &operator=(const vertex_data_type &) = default;
+
+    /// \brief Move assignment operator
+    vertex_data_type &operator=(vertex_data_type &&) noexcept = default;
+
+    const id_type id() const { return id_type(m_id); }
+
+    value_type &value() { return m_value; }
+
+    const value_type &value() const { return m_value; }
+
+   private:
+    friend class dense_jgraph;
+
+    string_type m_id;
+    value_type m_value;
+  };
+
+  using vertex_storage_type =
+      mc::vector<vertex_data_type, other_scoped_allocator<vertex_data_type>>;
+
+  class edge_data_type {
+   public:
+    using allocator_type = _allocator_type;
+
+    explicit edge_data_type(const index_type source_index,
+                            const index_type destination_index,
+                            const allocator_type &allocator = allocator_type())
+        : m_source_index(source_index),
+          m_destination_index(destination_index),
+          m_value(allocator) {}
+
+    /// \brief Copy constructor
+    edge_data_type(const edge_data_type &) = default;
+
+    /// \brief Allocator-extended copy constructor
+    edge_data_type(const edge_data_type &other, const allocator_type &alloc)
+        : m_source_index(other.m_source_index),
+          m_destination_index(other.m_destination_index),
+          m_value(other.m_value, alloc) {}
+
+    /// \brief Move constructor
+    edge_data_type(edge_data_type &&) noexcept = default;
+
+    /// \brief Allocator-extended move constructor
+    edge_data_type(edge_data_type &&other, const allocator_type &alloc) noexcept
+        : m_source_index(other.m_source_index),
+          m_destination_index(other.m_destination_index),
+          m_value(std::move(other.m_value), alloc) {}
+
+    /// \brief Copy assignment operator
+    edge_data_type &operator=(const edge_data_type &) = default;
+
+    /// \brief Move assignment operator
+    edge_data_type &operator=(edge_data_type &&) noexcept = default;
+
+    index_type source_index() const { return m_source_index; }
+
+    index_type destination_index() const { return m_destination_index; }
+
+    value_type &value() { return m_value; }
+
+    const value_type &value() const { return m_value; }
+
+   private:
+    index_type m_source_index;
+    index_type m_destination_index;
+    value_type m_value;
+  };
+
+  using edge_storage_type =
+      mc::vector<edge_data_type, other_scoped_allocator<edge_data_type>>;
+
+  // Adj-list
+  using adj_list_edge_type = std::pair<index_type,   // neighbor index
+                                       index_type>;  // edge index
+  using adj_list_edge_list_type =
+      mc::vector<adj_list_edge_type, other_allocator<adj_list_edge_type>>;
+  using adj_list_type =
+      mc::vector<adj_list_edge_list_type,
+                 other_scoped_allocator<adj_list_edge_list_type>>;
+
+ public:
+  /// \brief Vertex iterator.
+  using vertex_iterator = typename vertex_storage_type::iterator;
+
+  /// \brief Const vertex iterator.
+  using const_vertex_iterator = typename vertex_storage_type::const_iterator;
+
+  /// \brief Edge iterator.
+  using edge_iterator = jgdtl::dense_edge_iterator_impl<
+      typename adj_list_edge_list_type::const_iterator,
+      typename std::pointer_traits<typename std::allocator_traits<
+          allocator_type>::pointer>::template rebind<edge_storage_type>>;
+
+  /// \brief Const edge iterator.
+  using const_edge_iterator = jgdtl::dense_edge_iterator_impl<
+      typename adj_list_edge_list_type::const_iterator,
+      typename std::pointer_traits<typename std::allocator_traits<
+          allocator_type>::pointer>::template rebind<const edge_storage_type>>;
+
+  /// \brief Constructor
+  /// \param alloc An allocator object
+  explicit dense_jgraph(const allocator_type &alloc = allocator_type())
+      : dense_jgraph(k_default_max_vertex_index, alloc) {}
+
+  /// \brief Constructor
+  /// \param max_vertex_index The maximum vertex index this graph accepts.
+  /// \param alloc An allocator object
+  explicit dense_jgraph(const index_type max_vertex_index,
+                        const allocator_type &alloc = allocator_type())
+      : m_max_vertex_index(max_vertex_index),
+        m_vertex_storage(alloc),
+        m_edge_storage(alloc),
+        m_adj_list(alloc) {}
+
+  /// \brief Returns the maximum vertex index this graph accepts.
+  /// \return The maximum vertex index.
+  index_type max_vertex_index() const { return m_max_vertex_index; }
+
+  /// \brief Converts a vertex ID to a vertex index.
+  /// Only the canonical form of a decimal is accepted so that distinct IDs
+  /// never map to the same index, e.g., "007" is rejected while "7" and "0"
+  /// are accepted.
+  /// \param vertex_id A vertex ID.
+  /// \return The index of the vertex. If 'vertex_id' is not a decimal
+  /// non-negative integer in canonical form, returns k_invalid_index.
+  static index_type to_index(const id_type &vertex_id) {
+    if (vertex_id.empty() || (vertex_id.size() > 1 && vertex_id[0] == '0')) {
+      return k_invalid_index;
+    }
+    index_type index = k_invalid_index;
+    const auto *const last = vertex_id.data() + vertex_id.size();
+    const auto ret = std::from_chars(vertex_id.data(), last, index);
+    if (ret.ec != std::errc() || ret.ptr != last) {
+      return k_invalid_index;
+    }
+    return index;
+  }
+
+  /// \brief Checks if a vertex exists.
+  /// \param vertex_index A vertex index to check.
+  /// \return Returns true if the vertex exists; otherwise, returns false.
+  bool has_vertex(const index_type vertex_index) const {
+    return vertex_index < m_vertex_storage.size();
+  }
+
+  /// \brief Checks if a vertex exists.
+  /// \param vertex_id A vertex ID to check.
+  /// \return Returns true if the vertex exists; otherwise, returns false.
+  bool has_vertex(const id_type &vertex_id) const {
+    return has_vertex(to_index(vertex_id));
+  }
+
+  std::size_t has_edges(const index_type source_vertex_index,
+                        const index_type destination_vertex_index) const {
+    if (!has_vertex(source_vertex_index)) return 0;
+    std::size_t count = 0;
+    for (const auto &edge : m_adj_list[source_vertex_index]) {
+      count += (edge.first == destination_vertex_index);
+    }
+    return count;
+  }
+
+  std::size_t has_edges(const id_type &source_vertex_id,
+                        const id_type &destination_vertex_id) const {
+    return has_edges(to_index(source_vertex_id),
+                     to_index(destination_vertex_id));
+  }
+
+  /// \brief Registers a vertex and all vertices whose indices are smaller
+  /// than it.
+  /// \param vertex_index A vertex index.
+  /// \return An iterator to the vertex. If 'vertex_index' is larger than
+  /// max_vertex_index(), returns vertices_end() and registers nothing.
+  vertex_iterator register_vertex(const index_type vertex_index) {
+    if (vertex_index == k_invalid_index || vertex_index > m_max_vertex_index) {
+      return vertices_end();
+    }
+    if (!has_vertex(vertex_index)) {
+      const auto old_size = m_vertex_storage.size();
+      m_vertex_storage.resize(vertex_index + 1);
+      m_adj_list.resize(vertex_index + 1);
+      for (auto i = old_size; i < m_vertex_storage.size(); ++i) {
+        const auto id = std::to_string(i);
+        m_vertex_storage[i].m_id.assign(id.data(), id.size());
+      }
+    }
+    return m_vertex_storage.begin() + vertex_index;
+  }
+
+  /// \brief Registers a vertex.
+  /// \param vertex_id A vertex ID.
+  /// \return An iterator to the vertex. If 'vertex_id' is not a decimal
+  /// non-negative integer or is larger than max_vertex_index(), returns
+  /// vertices_end().
+  vertex_iterator register_vertex(const id_type &vertex_id) {
+    return register_vertex(to_index(vertex_id));
+  }
+
+  edge_iterator register_edge(const index_type source_vertex_index,
+                              const index_type destination_vertex_index,
+                              const bool undirected = false) {
+    const auto max_index =
+        std::max(source_vertex_index, destination_vertex_index);
+    if (max_index == k_invalid_index || max_index > m_max_vertex_index) {
+      return edge_iterator();
+    }
+    register_vertex(max_index);
+
+    const index_type edge_index = m_edge_storage.size();
+    m_edge_storage.emplace_back(source_vertex_index, destination_vertex_index);
+
+    auto &edge_list = m_adj_list[source_vertex_index];
+    edge_list.emplace_back(destination_vertex_index, edge_index);
+    if (undirected) {
+      m_adj_list[destination_vertex_index].emplace_back(source_vertex_index,
+                                                        edge_index);
+    }
+    return edge_iterator(edge_list.cend() - 1, edge_list.cend(),
+                         &m_edge_storage);
+  }
+
+  edge_iterator register_edge(const id_type &source_vertex_id,
+                              const id_type &destination_vertex_id,
+                              const bool undirected = false) {
+    return register_edge(to_index(source_vertex_id),
+                         to_index(destination_vertex_id), undirected);
+  }
+
+  vertex_iterator find_vertex(const index_type vertex_index) {
+    if (!has_vertex(vertex_index)) return vertices_end();
+    return m_vertex_storage.begin() + vertex_index;
+  }
+
+  const_vertex_iterator find_vertex(const index_type vertex_index) const {
+    if (!has_vertex(vertex_index)) return vertices_end();
+    return m_vertex_storage.cbegin() + vertex_index;
+  }
+
+  vertex_iterator find_vertex(const id_type &vertex_id) {
+    return find_vertex(to_index(vertex_id));
+  }
+
+  const_vertex_iterator find_vertex(const id_type &vertex_id) const {
+    return find_vertex(to_index(vertex_id));
+  }
+
+  std::pair<edge_iterator, edge_iterator> find_edges(
+      const index_type source_vertex_index,
+      const index_type destination_vertex_index) {
+    if (!has_vertex(source_vertex_index) ||
+        !has_vertex(destination_vertex_index)) {
+      return std::make_pair(edge_iterator{}, edge_iterator{});
+    }
+    const auto &edge_list = m_adj_list[source_vertex_index];
+    return std::make_pair(
+        edge_iterator{edge_list.cbegin(), edge_list.cend(), &m_edge_storage,
+                      destination_vertex_index},
+        edge_iterator{edge_list.cend(), edge_list.cend(), &m_edge_storage,
+                      destination_vertex_index});
+  }
+
+  std::pair<edge_iterator, edge_iterator> find_edges(
+      const id_type &source_vertex_id, const id_type &destination_vertex_id) {
+    return find_edges(to_index(source_vertex_id),
+                      to_index(destination_vertex_id));
+  }
+
+  /// \brief Returns the number of vertices.
+  /// \return The number of vertices.
+  std::size_t num_vertices() const { return m_vertex_storage.size(); }
+
+  /// \brief Returns the number of edges.
+  /// \return The number of edges.
+  std::size_t num_edges() const { return m_edge_storage.size(); }
+
+  /// \brief Returns the degree of a vertex.
+  /// \param vertex_index A vertex index.
+  /// \return Returns the degree of the vertex.
+  /// If the vertex does not exist, returns 0.
+  std::size_t degree(const index_type vertex_index) const {
+    if (!has_vertex(vertex_index)) return 0;
+    return m_adj_list[vertex_index].size();
+  }
+
+  std::size_t degree(const id_type &vertex_id) const {
+    return degree(to_index(vertex_id));
+  }
+
+  vertex_iterator vertices_begin() { return m_vertex_storage.begin(); }
+
+  const_vertex_iterator vertices_begin() const {
+    return m_vertex_storage.cbegin();
+  }
+
+  vertex_iterator vertices_end() { return m_vertex_storage.end(); }
+
+  const_vertex_iterator vertices_end() const { return m_vertex_storage.cend(); }
+
+  edge_iterator edges_begin(const index_type vertex_index) {
+    if (!has_vertex(vertex_index)) return edge_iterator();
+    const auto &edge_list = m_adj_list[vertex_index];
+    return edge_iterator{edge_list.cbegin(), edge_list.cend(),
+                         &m_edge_storage};
+  }
+
+  const_edge_iterator edges_begin(const index_type vertex_index) const {
+    if (!has_vertex(vertex_index)) return const_edge_iterator();
+    const auto &edge_list = m_adj_list[vertex_index];
+    return const_edge_iterator{edge_list.cbegin(), edge_list.cend(),
+                               &m_edge_storage};
+  }
+
+  edge_iterator edges_end(const index_type vertex_index) {
+    if (!has_vertex(vertex_index)) return edge_iterator();
+    const auto &edge_list = m_adj_list[vertex_index];
+    return edge_iterator{edge_list.cend(), edge_list.cend(), &m_edge_storage};
+  }
+
+  const_edge_iterator edges_end(const index_type vertex_index) const {
+    if (!has_vertex(vertex_index)) return const_edge_iterator();
+    const auto &edge_list = m_adj_list[vertex_index];
+    return const_edge_iterator{edge_list.cend(), edge_list.cend(),
+                               &m_edge_storage};
+  }
+
+  edge_iterator edges_begin(const id_type &vid) {
+    return edges_begin(to_index(vid));
+  }
+
+  const_edge_iterator edges_begin(const id_type &vid) const {
+    return edges_begin(to_index(vid));
+  }
+
+  edge_iterator edges_end(const id_type &vid) {
+    return edges_end(to_index(vid));
+  }
+
+  const_edge_iterator edges_end(const id_type &vid) const {
+    return edges_end(to_index(vid));
+  }
+
+  /// \brief Rebuilds a jgraph into this container, replacing the current
+  /// contents. All vertex IDs in 'graph' must be decimal non-negative
+  /// integers in canonical form (see to_index()). Vertex IDs, edges, and their values are copied; an undirected
+  /// edge keeps a single edge value shared by both end points.
+  /// Each per-vertex edge array is allocated exactly once.
+  /// \param graph A source graph.
+  /// \return Returns true on success. If a vertex ID is not an integer or is
+  /// larger than max_vertex_index(), returns false and leaves this container
+  /// empty.
+  bool compact(const jgraph<allocator_type> &graph) {
+    clear();
+
+    index_type max_index = 0;
+    for (auto itr = graph.vertices_begin(), end = graph.vertices_end();
+         itr != end; ++itr) {
+      const auto index = to_index(itr->id());
+      if (index == k_invalid_index || index > m_max_vertex_index) return false;
+      max_index = std::max(max_index, index);
+    }
+    if (graph.num_vertices() == 0) return true;
+
+    register_vertex(max_index);
+    m_edge_storage.reserve(graph.num_edges());
+    for (auto itr = graph.vertices_begin(), end = graph.vertices_end();
+         itr != end; ++itr) {
+      auto &vertex = m_vertex_storage[to_index(itr->id())];
+      vertex.m_id.assign(itr->id().data(), itr->id().size());
+      vertex.m_value = itr->value();
+      m_adj_list[to_index(itr->id())].reserve(graph.degree(itr->id()));
+    }
+
+    // An undirected edge appears in the edge lists of both end points but is
+    // stored only once in the source graph.
+    std::unordered_map<const void *, index_type> edge_indices;
+    edge_indices.reserve(graph.num_edges());
+    for (auto vitr = graph.vertices_begin(), vend = graph.vertices_end();
+         vitr != vend; ++vitr) {
+      const auto vertex_index = to_index(vitr->id());
+      for (auto eitr = graph.edges_begin(vitr->id()),
+                eend = graph.edges_end(vitr->id());
+           eitr != eend; ++eitr) {
+        const auto &edge = *eitr;
+        const auto src = to_index(edge.source_id());
+        const auto dst = to_index(edge.destination_id());
+        auto ret = edge_indices.emplace(&edge, m_edge_storage.size());
+        if (ret.second) {
+          m_edge_storage.emplace_back(src, dst);
+          m_edge_storage.back().value() = edge.value();
+        }
+        m_adj_list[vertex_index].emplace_back(
+            (src == vertex_index) ? dst : src, ret.first->second);
+      }
+    }
+    return true;
+  }
+
+  /// \brief Removes all vertices and edges.
+  void clear() {
+    m_vertex_storage.clear();
+    m_edge_storage.clear();
+    m_adj_list.clear();
+  }
+
+  allocator_type get_allocator() const {
+    return m_vertex_storage.get_allocator();
+  }
+
+ private:
+  index_type m_max_vertex_index;
+  vertex_storage_type m_vertex_storage;
+  edge_storage_type m_edge_storage;
+  adj_list_type m_adj_list;
+};
+
+namespace jgdtl {
+
+/// \brief Edge iterator of dense_jgraph.
+/// Iterates over a contiguous edge array of a vertex. If a destination is
+/// given, skips the edges to other vertices.
+template <typename adj_list_edge_list_iterator_type,
+          typename storage_pointer_type>
+class dense_edge_iterator_impl {
+ private:
+  static constexpr bool is_const_value = std::is_const_v<
+      typename std::pointer_traits<storage_pointer_type>::element_type>;
+
+  // Memo: this type will be always non-const even element_type is const
+  using raw_value_type = typename std::pointer_traits<
+      storage_pointer_type>::element_type::value_type;
+
+  using index_type = typename std::iterator_traits<
+      adj_list_edge_list_iterator_type>::value_type::first_type;
+  static constexpr index_type k_no_filter =
+      std::numeric_limits<index_type>::max();
+
+ public:
+  using value_type =
+      std::conditional_t<is_const_value, const raw_value_type, raw_value_type>;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using difference_type = typename std::iterator_traits<
+      adj_list_edge_list_iterator_type>::difference_type;
+
+  dense_edge_iterator_impl()
+      : m_current_pos(), m_end_pos(), m_storage_pointer(nullptr) {}
+
+  dense_edge_iterator_impl(adj_list_edge_list_iterator_type begin_pos,
+                           adj_list_edge_list_iterator_type end_pos,
+                           storage_pointer_type storage,
+                           const index_type destination = k_no_filter)
+      : m_current_pos(begin_pos),
+        m_end_pos(end_pos),
+        m_storage_pointer(storage),
+        m_destination(destination) {
+    priv_skip();
+  }
+
+  dense_edge_iterator_impl(const dense_edge_iterator_impl &) = default;
+  dense_edge_iterator_impl(dense_edge_iterator_impl &&) noexcept = default;
+
+  dense_edge_iterator_impl &operator=(const dense_edge_iterator_impl &) =
+      default;
+  dense_edge_iterator_impl &operator=(dense_edge_iterator_impl &&) noexcept =
+      default;
+
+  dense_edge_iterator_impl &operator++() {
+    ++m_current_pos;
+    priv_skip();
+    return *this;
+  }
+
+  dense_edge_iterator_impl operator++(int) {
+    dense_edge_iterator_impl tmp(*this);
+    operator++();
+    return tmp;
+  }
+
+  bool equal(const dense_edge_iterator_impl &other) const {
+    return m_current_pos == other.m_current_pos;
+  }
+
+  /// \brief Returns the index of the other end of the edge.
+  index_type neighbor_index() const { return m_current_pos->first; }
+
+  pointer operator->() const { return &(operator*()); }
+
+  reference operator*() const {
+    return (*m_storage_pointer)[m_current_pos->second];
+  }
+
+ private:
+  void priv_skip() {
+    if (m_destination == k_no_filter) return;
+    while (m_current_pos != m_end_pos &&
+           m_current_pos->first != m_destination) {
+      ++m_current_pos;
+    }
+  }
+
+  adj_list_edge_list_iterator_type m_current_pos;
+  adj_list_edge_list_iterator_type m_end_pos;
+  storage_pointer_type m_storage_pointer;
+  index_type m_destination{k_no_filter};
+};
+
+template <typename adj_list_edge_list_iterator_type,
+          typename storage_pointer_type>
+inline bool operator==(
+    const dense_edge_iterator_impl<adj_list_edge_list_iterator_type,
+                                   storage_pointer_type> &lhs,
+    const dense_edge_iterator_impl<adj_list_edge_list_iterator_type,
+                                   storage_pointer_type> &rhs) {
+  return lhs.equal(rhs);
+}
+
+template <typename adj_list_edge_list_iterator_type,
+          typename storage_pointer_type>
+inline bool operator!=(
+    const dense_edge_iterator_impl<adj_list_edge_list_iterator_type,
+                                   storage_pointer_type> &lhs,
+    const dense_edge_iterator_impl<adj_list_edge_list_iterator_type,
+                                   storage_pointer_type> &rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace jgdtl
+
+}  // namespace metall::container::experimental::jgraph
+
+#endif  // METALL_CONTAINER_EXPERIMENT_JGRAPH_DENSE_JGRAPH_HPP
@@ -16,6 +16,7 @@
 #include <metall/container/vector.hpp>
 #include <metall/container/scoped_allocator.hpp>
 #include <metall/utility/hash.hpp>
+#include <metall/utility/container_of_containers_iterator_adaptor.hpp>
 #include <metall/json/json.hpp>
 
 /// \namespace metall::container::experimental
@@ -36,6 +37,9 @@ namespace mj = metall::json;
 template <typename allocator_type>
 class jgraph;
 
+template <typename graph_type>
+class bulk_loader;
+
 namespace jgdtl {
 template <typename storage_iterator_type>
 class vertex_iterator_impl;
@@ -56,6 +60,13 @@ class jgraph {
   /// \brief JSON value type every vertex and edge has,
   using value_type = mj::value<allocator_type>;
 
+  /// \brief The number of banks.
+  /// Vertices are partitioned into banks by the hash values of their IDs.
+  /// An edge is stored in the bank of its source vertex.
+  /// Operations on different banks touch disjoint data, which bulk_loader
+  /// uses to insert vertices and edges in parallel without locks.
+  static constexpr std::size_t k_num_banks = 64;
+
  private:
   template <typename T>
   using other_allocator =
@@ -121,6 +132,9 @@ class jgraph {
                         metall::utility::hash<>, std::equal_to<>,
                         other_scoped_allocator<std::pair<const internal_id_type,
                                                          vertex_data_type>>>;
+  using vertex_storage_bank_table_type =
+      mc::vector<vertex_storage_type,
+                 other_scoped_allocator<vertex_storage_type>>;
 
   class edge_data_type {
    public:
@@ -187,6 +201,8 @@ class jgraph {
                         metall::utility::hash<>, std::equal_to<>,
                         other_scoped_allocator<
                             std::pair<const internal_id_type, edge_data_type>>>;
+  using edge_storage_bank_table_type =
+      mc::vector<edge_storage_type, other_scoped_allocator<edge_storage_type>>;
 
   // Adj-list
   using adj_list_edge_list_type =
@@ -201,42 +217,57 @@ class jgraph {
       adj_list_edge_list_type, std::hash<internal_id_type>, std::equal_to<>,
       other_scoped_allocator<
           std::pair<const internal_id_type, adj_list_edge_list_type>>>;
+  using adj_list_bank_table_type =
+      mc::vector<adj_list_type, other_scoped_allocator<adj_list_type>>;
 
   // ID tables
   using id_table_type = mc::unordered_map<
       internal_id_type, string_type, std::hash<internal_id_type>,
       std::equal_to<>,
       other_scoped_allocator<std::pair<const internal_id_type, string_type>>>;
+  using id_table_bank_table_type =
+      mc::vector<id_table_type, other_scoped_allocator<id_table_type>>;
+
+  template <typename T>
+  using bank_counter_table_type = mc::vector<T, other_allocator<T>>;
 
  public:
   /// \brief Vertex iterator over a container of vertex data,
   /// which is metall::container::experimental::json::key_value_pair_type.
-  using vertex_iterator =
-      jgdtl::vertex_iterator_impl<typename vertex_storage_type::iterator>;
+  using vertex_iterator = jgdtl::vertex_iterator_impl<
+      metall::utility::container_of_containers_iterator_adaptor<
+          typename vertex_storage_bank_table_type::iterator,
+          typename vertex_storage_type::iterator>>;
 
   /// \brief Const vertex iterator.
-  using const_vertex_iterator =
-      jgdtl::vertex_iterator_impl<typename vertex_storage_type::const_iterator>;
+  using const_vertex_iterator = jgdtl::vertex_iterator_impl<
+      metall::utility::container_of_containers_iterator_adaptor<
+          typename vertex_storage_bank_table_type::const_iterator,
+          typename vertex_storage_type::const_iterator>>;
 
   /// \brief Edge iterator over a container of edge data,
   /// which is metall::container::experimental::json::key_value_pair_type.
   using edge_iterator = jgdtl::edge_iterator_impl<
       typename adj_list_edge_list_type::iterator,
-      typename std::pointer_traits<typename std::allocator_traits<
-          allocator_type>::pointer>::template rebind<edge_storage_type>>;
+      typename std::pointer_traits<
+          typename std::allocator_traits<allocator_type>::pointer>::
+          template rebind<edge_storage_bank_table_type>>;
   /// \brief Const edge iterator.
   using const_edge_iterator = jgdtl::edge_iterator_impl<
       typename adj_list_edge_list_type::const_iterator,
-      typename std::pointer_traits<typename std::allocator_traits<
-          allocator_type>::pointer>::template rebind<const edge_storage_type>>;
+      typename std::pointer_traits<
+          typename std::allocator_traits<allocator_type>::pointer>::
+          template rebind<const edge_storage_bank_table_type>>;
 
   /// \brief Constructor
   /// \param alloc An allocator object
   explicit jgraph(const allocator_type &alloc = allocator_type())
-      : m_vertex_storage(alloc),
-        m_edge_storage(alloc),
-        m_adj_list(alloc),
-        m_vertex_id_table(alloc) {}
+      : m_vertex_storage(k_num_banks, alloc),
+        m_edge_storage(k_num_banks, alloc),
+        m_adj_list(k_num_banks, alloc),
+        m_vertex_id_table(k_num_banks, alloc),
+        m_max_edge_ids(k_num_banks, 0, alloc),
+        m_max_vid_distances(k_num_banks, 0, alloc) {}
 
   /// \brief Checks if a vertex exists.
   /// \param vertex_id A vertex ID to check.
@@ -253,59 +284,50 @@ class jgraph {
     const auto dst = priv_get_vertex_internal_id(destination_vertex_id);
     if (dst == k_max_internal_id) return 0;
 
-    const auto &edge_list = m_adj_list.at(src);
+    const auto &edge_list = m_adj_list[priv_bank_of(src)].at(src);
     return edge_list.count(dst);
   }
 
   vertex_iterator register_vertex(const id_type &vertex_id) {
-    auto internal_id = priv_get_vertex_internal_id(vertex_id);
-    if (internal_id != k_max_internal_id) {
-      return vertex_iterator(m_vertex_storage.find(internal_id));
-    }
-
-    internal_id = priv_generate_vertex_internal_id(vertex_id);
-
-    m_adj_list.emplace(internal_id,
-                       adj_list_edge_list_type{m_adj_list.get_allocator()});
-
-    auto ret = m_vertex_storage.emplace(
-        internal_id,
-        vertex_data_type{vertex_id, m_vertex_storage.get_allocator()});
-    return vertex_iterator(ret.first);
+    const auto internal_id = priv_register_vertex(vertex_id);
+    const auto bank = priv_bank_of(internal_id);
+    return priv_make_vertex_iterator(bank,
+                                     m_vertex_storage[bank].find(internal_id));
   }
 
   edge_iterator register_edge(const id_type &source_vertex_id,
                               const id_type &destination_vertex_id,
                               const bool undirected = false) {
-    register_vertex(source_vertex_id);
-    register_vertex(destination_vertex_id);
-
-    const auto src_internal_id = priv_get_vertex_internal_id(source_vertex_id);
-    assert(src_internal_id != k_max_internal_id);
-    const auto dst_internal_id =
-        priv_get_vertex_internal_id(destination_vertex_id);
-    assert(dst_internal_id != k_max_internal_id);
-    const auto edge_id = priv_generate_edge_id();
+    const auto src_internal_id = priv_register_vertex(source_vertex_id);
+    const auto dst_internal_id = priv_register_vertex(destination_vertex_id);
 
-    auto itr = m_adj_list.at(src_internal_id).emplace(dst_internal_id, edge_id);
+    const auto ret =
+        priv_register_out_edge(src_internal_id, dst_internal_id,
+                               source_vertex_id, destination_vertex_id);
     if (undirected) {
-      m_adj_list.at(dst_internal_id).emplace(src_internal_id, edge_id);
+      priv_register_in_edge(dst_internal_id, src_internal_id, ret.second);
     }
-
-    m_edge_storage.emplace(
-        edge_id, edge_data_type{source_vertex_id, destination_vertex_id,
-                                edge_id, m_edge_storage.get_allocator()});
-    return edge_iterator(itr, &m_edge_storage);
+    return edge_iterator(ret.first, &m_edge_storage);
   }
 
   vertex_iterator find_vertex(const id_type &vertex_id) {
-    return vertex_iterator(
-        m_vertex_storage.find(priv_get_vertex_internal_id(vertex_id)));
+    const auto internal_id = priv_get_vertex_internal_id(vertex_id);
+    if (internal_id == k_max_internal_id) {
+      return vertices_end();
+    }
+    const auto bank = priv_bank_of(internal_id);
+    return priv_make_vertex_iterator(bank,
+                                     m_vertex_storage[bank].find(internal_id));
   }
 
   const_vertex_iterator find_vertex(const id_type &vertex_id) const {
-    return const_vertex_iterator(
-        m_vertex_storage.find(priv_get_vertex_internal_id(vertex_id)));
+    const auto internal_id = priv_get_vertex_internal_id(vertex_id);
+    if (internal_id == k_max_internal_id) {
+      return vertices_end();
+    }
+    const auto bank = priv_bank_of(internal_id);
+    return priv_make_vertex_iterator(bank,
+                                     m_vertex_storage[bank].find(internal_id));
   }
 
   std::pair<edge_iterator, edge_iterator> find_edges(
@@ -319,7 +341,8 @@ class jgraph {
       return std::make_pair(edge_iterator{}, edge_iterator{});
     }
 
-    auto &edge_list = m_adj_list.at(src_internal_id);
+    auto &edge_list =
+        m_adj_list[priv_bank_of(src_internal_id)].at(src_internal_id);
     auto range = edge_list.equal_range(dst_internal_id);
     return std::make_pair(edge_iterator{range.first, &m_edge_storage},
                           edge_iterator{range.second, &m_edge_storage});
@@ -327,11 +350,19 @@ class jgraph {
 
   /// \brief Returns the number of vertices.
   /// \return The number of vertices.
-  std::size_t num_vertices() const { return m_vertex_storage.size(); }
+  std::size_t num_vertices() const {
+    std::size_t count = 0;
+    for (const auto &bank : m_vertex_storage) count += bank.size();
+    return count;
+  }
 
   /// \brief Returns the number of edges.
   /// \return The number of edges.
-  std::size_t num_edges() const { return m_edge_storage.size(); }
+  std::size_t num_edges() const {
+    std::size_t count = 0;
+    for (const auto &bank : m_edge_storage) count += bank.size();
+    return count;
+  }
 
   /// \brief Returns the degree of the vertex corresponds to 'vid'.
   /// \param vertex_id A vertex ID.
@@ -343,23 +374,26 @@ class jgraph {
       return 0;
     }
 
-    return m_adj_list.at(internal_id).size();
+    return m_adj_list[priv_bank_of(internal_id)].at(internal_id).size();
   }
 
   vertex_iterator vertices_begin() {
-    return vertex_iterator(m_vertex_storage.begin());
+    return vertex_iterator(
+        {m_vertex_storage.begin(), m_vertex_storage.end()});
   }
 
   const_vertex_iterator vertices_begin() const {
-    return const_vertex_iterator(m_vertex_storage.begin());
+    return const_vertex_iterator(
+        {m_vertex_storage.cbegin(), m_vertex_storage.cend()});
   }
 
   vertex_iterator vertices_end() {
-    return vertex_iterator(m_vertex_storage.end());
+    return vertex_iterator({m_vertex_storage.end(), m_vertex_storage.end()});
   }
 
   const_vertex_iterator vertices_end() const {
-    return const_vertex_iterator(m_vertex_storage.end());
+    return const_vertex_iterator(
+        {m_vertex_storage.cend(), m_vertex_storage.cend()});
   }
 
   edge_iterator edges_begin(const id_type &vid) {
@@ -367,7 +401,9 @@ class jgraph {
     if (internal_id == k_max_internal_id) {
       return edge_iterator();
     }
-    return edge_iterator{m_adj_list.at(internal_id).begin(), &m_edge_storage};
+    return edge_iterator{
+        m_adj_list[priv_bank_of(internal_id)].at(internal_id).begin(),
+        &m_edge_storage};
   }
 
   const_edge_iterator edges_begin(const id_type &vid) const {
@@ -375,8 +411,9 @@ class jgraph {
     if (internal_id == k_max_internal_id) {
       return const_edge_iterator();
     }
-    return const_edge_iterator{m_adj_list.at(internal_id).begin(),
-                               &m_edge_storage};
+    return const_edge_iterator{
+        m_adj_list[priv_bank_of(internal_id)].at(internal_id).begin(),
+        &m_edge_storage};
   }
 
   edge_iterator edges_end(const id_type &vid) {
@@ -384,7 +421,9 @@ class jgraph {
     if (internal_id == k_max_internal_id) {
       return edge_iterator();
     }
-    return edge_iterator{m_adj_list.at(internal_id).end(), &m_edge_storage};
+    return edge_iterator{
+        m_adj_list[priv_bank_of(internal_id)].at(internal_id).end(),
+        &m_edge_storage};
   }
 
   const_edge_iterator edges_end(const id_type &vid) const {
@@ -392,8 +431,9 @@ class jgraph {
     if (internal_id == k_max_internal_id) {
       return const_edge_iterator();
     }
-    return const_edge_iterator{m_adj_list.at(internal_id).end(),
-                               &m_edge_storage};
+    return const_edge_iterator{
+        m_adj_list[priv_bank_of(internal_id)].at(internal_id).end(),
+        &m_edge_storage};
   }
 
   allocator_type get_allocator() const {
@@ -401,20 +441,70 @@ class jgraph {
   }
 
  private:
+  template <typename>
+  friend class bulk_loader;
+
+  // Internal IDs of the same bank have the same remainder modulo k_num_banks;
+  // ID collisions are resolved by probing with a stride of k_num_banks
+  // (wrapping around 2^64, which is a multiple of k_num_banks).
+  static_assert((k_num_banks & (k_num_banks - 1)) == 0,
+                "k_num_banks must be a power of 2");
+
+  static std::size_t priv_bank_of(const internal_id_type internal_id) {
+    return internal_id % k_num_banks;
+  }
+
+  static std::size_t priv_bank_of(const id_type &vid) {
+    return priv_bank_of(priv_hash_id(vid));
+  }
+
+  template <typename outer_iterator_type, typename inner_iterator_type>
+  static auto priv_make_vertex_iterator(
+      const outer_iterator_type &outer_begin,
+      const outer_iterator_type &outer_end, const std::size_t bank,
+      const inner_iterator_type &inner) {
+    using adaptor_type =
+        metall::utility::container_of_containers_iterator_adaptor<
+            outer_iterator_type, inner_iterator_type>;
+    // The adaptor moves an inner end iterator to the next element
+    if (inner == std::end(*(outer_begin + bank))) {
+      return jgdtl::vertex_iterator_impl<adaptor_type>(
+          adaptor_type(outer_end, outer_end));
+    }
+    return jgdtl::vertex_iterator_impl<adaptor_type>(
+        adaptor_type(outer_begin + bank, inner, outer_end));
+  }
+
+  vertex_iterator priv_make_vertex_iterator(
+      const std::size_t bank,
+      const typename vertex_storage_type::iterator &inner) {
+    return priv_make_vertex_iterator(m_vertex_storage.begin(),
+                                     m_vertex_storage.end(), bank, inner);
+  }
+
+  const_vertex_iterator priv_make_vertex_iterator(
+      const std::size_t bank,
+      const typename vertex_storage_type::const_iterator &inner) const {
+    return priv_make_vertex_iterator(m_vertex_storage.cbegin(),
+                                     m_vertex_storage.cend(), bank, inner);
+  }
+
   internal_id_type priv_get_vertex_internal_id(
       const std::string_view &vid) const {
-    auto hash = priv_hash_id(vid.data());
+    auto hash = priv_hash_id(vid);
+    const auto bank = priv_bank_of(hash);
+    const auto &id_table = m_vertex_id_table[bank];
 
-    for (std::size_t d = 0; d <= m_max_vid_distance; ++d) {
-      const auto vitr = m_vertex_id_table.find(hash);
-      if (vitr == m_vertex_id_table.end()) {
+    for (std::size_t d = 0; d <= m_max_vid_distances[bank]; ++d) {
+      const auto vitr = id_table.find(hash);
+      if (vitr == id_table.end()) {
         break;
       }
 
       if (vitr->second == vid) {
         return hash;
       }
-      hash = (hash + 1) % k_max_internal_id;
+      hash += k_num_banks;
     }
 
     return k_max_internal_id;  // Couldn't find
@@ -422,32 +512,93 @@ class jgraph {
 
   internal_id_type priv_generate_vertex_internal_id(
       const std::string_view &vid) {
-    auto hash = priv_hash_id(vid.data());
+    auto hash = priv_hash_id(vid);
+    const auto bank = priv_bank_of(hash);
+    auto &id_table = m_vertex_id_table[bank];
 
     std::size_t distance = 0;
-    while (m_vertex_id_table.count(hash) > 0) {
-      hash = (hash + 1) % k_max_internal_id;
+    while (hash == k_max_internal_id || id_table.count(hash) > 0) {
+      hash += k_num_banks;
       ++distance;
     }
-    m_max_vid_distance = std::max(distance, m_max_vid_distance);
+    m_max_vid_distances[bank] = std::max(distance, m_max_vid_distances[bank]);
 
-    m_vertex_id_table[hash] = vid.data();
+    id_table[hash].assign(vid.data(), vid.size());
 
     return hash;
   }
 
-  internal_id_type priv_generate_edge_id() { return ++m_max_edge_id; }
+  // Registers a vertex if it does not exist.
+  // Only touches the bank of the vertex.
+  internal_id_type priv_register_vertex(const id_type &vertex_id) {
+    auto internal_id = priv_get_vertex_internal_id(vertex_id);
+    if (internal_id != k_max_internal_id) {
+      return internal_id;
+    }
+
+    internal_id = priv_generate_vertex_internal_id(vertex_id);
+    const auto bank = priv_bank_of(internal_id);
+
+    m_adj_list[bank].emplace(
+        internal_id, adj_list_edge_list_type{m_adj_list.get_allocator()});
+
+    m_vertex_storage[bank].emplace(
+        internal_id,
+        vertex_data_type{vertex_id, m_vertex_storage.get_allocator()});
+    return internal_id;
+  }
+
+  // Adds an edge to the edge list of the source vertex and allocates the edge
+  // data. Only touches the bank of the source vertex.
+  std::pair<typename adj_list_edge_list_type::iterator, internal_id_type>
+  priv_register_out_edge(const internal_id_type src_internal_id,
+                         const internal_id_type dst_internal_id,
+                         const id_type &source_vertex_id,
+                         const id_type &destination_vertex_id) {
+    const auto bank = priv_bank_of(src_internal_id);
+    const auto edge_id = priv_generate_edge_id(bank);
+    auto itr =
+        m_adj_list[bank].at(src_internal_id).emplace(dst_internal_id, edge_id);
+    m_edge_storage[bank].emplace(
+        edge_id, edge_data_type{source_vertex_id, destination_vertex_id,
+                                edge_id, m_edge_storage.get_allocator()});
+    return std::make_pair(itr, edge_id);
+  }
+
+  // Adds an edge to the edge list of the destination vertex.
+  // Only touches the bank of the destination vertex.
+  void priv_register_in_edge(const internal_id_type dst_internal_id,
+                             const internal_id_type src_internal_id,
+                             const internal_id_type edge_id) {
+    m_adj_list[priv_bank_of(dst_internal_id)]
+        .at(dst_internal_id)
+        .emplace(src_internal_id, edge_id);
+  }
+
+  edge_data_type &priv_edge_data(const internal_id_type edge_id) {
+    return m_edge_storage[priv_bank_of(edge_id)].at(edge_id);
+  }
+
+  vertex_data_type &priv_vertex_data(const internal_id_type internal_id) {
+    return m_vertex_storage[priv_bank_of(internal_id)].at(internal_id);
+  }
+
+  // Edge IDs are unique across banks and an edge ID is in the same bank as
+  // its source vertex.
+  internal_id_type priv_generate_edge_id(const std::size_t bank) {
+    return (++m_max_edge_ids[bank]) * k_num_banks + bank;
+  }
 
   static internal_id_type priv_hash_id(const std::string_view &id) {
     return metall::mtlldetail::murmur_hash_64a(id.data(), id.length(), 1234);
   }
 
-  vertex_storage_type m_vertex_storage;
-  edge_storage_type m_edge_storage;
-  adj_list_type m_adj_list;
-  id_table_type m_vertex_id_table;
-  internal_id_type m_max_edge_id{0};
-  std::size_t m_max_vid_distance{0};
+  vertex_storage_bank_table_type m_vertex_storage;
+  edge_storage_bank_table_type m_edge_storage;
+  adj_list_bank_table_type m_adj_list;
+  id_table_bank_table_type m_vertex_id_table;
+  bank_counter_table_type<internal_id_type> m_max_edge_ids;
+  bank_counter_table_type<std::size_t> m_max_vid_distances;
 };
 
 namespace jgdtl {
@@ -527,16 +678,20 @@ class edge_iterator_impl {
   static constexpr bool is_const_value = std::is_const_v<
       typename std::pointer_traits<storage_pointer_type>::element_type>;
 
+  // A bank table, i.e., a vector of edge storages
+  using raw_storage_type = std::remove_const_t<
+      typename std::pointer_traits<storage_pointer_type>::element_type>;
+
   // Memo: this type will be always non-const even element_type is const
-  using raw_value_type = typename std::pointer_traits<
-      storage_pointer_type>::element_type::mapped_type;
+  using raw_value_type =
+      typename raw_storage_type::value_type::mapped_type;
 
  public:
   using value_type =
       std::conditional_t<is_const_value, const raw_value_type, raw_value_type>;
   using pointer = typename std::pointer_traits<
-      typename std::pointer_traits<storage_pointer_type>::element_type::
-          iterator::pointer>::template rebind<value_type>;
+      typename raw_storage_type::value_type::iterator::pointer>::
+      template rebind<value_type>;
   using reference = value_type &;
   using difference_type = typename std::iterator_traits<
       adj_list_edge_list_iterator_type>::difference_type;
@@ -568,27 +723,22 @@ class edge_iterator_impl {
     return m_current_pos == other.m_current_pos;
   }
 
-  pointer operator->() {
-    const auto &edge_id = m_current_pos->second;
-    return &(m_storage_pointer->at(edge_id));
-  }
+  pointer operator->() { return &(priv_edge()); }
 
-  const pointer operator->() const {
-    const auto &edge_id = m_current_pos->second;
-    return &(m_storage_pointer->at(edge_id));
-  }
+  const pointer operator->() const { return &(priv_edge()); }
 
-  reference operator*() {
-    const auto &edge_id = m_current_pos->second;
-    return (m_storage_pointer->at(edge_id));
-  }
+  reference operator*() { return priv_edge(); }
+
+  const reference operator*() const { return priv_edge(); }
 
-  const reference operator*() const {
+ private:
+  // An edge is stored in the bank that is the edge ID modulo #of banks.
+  reference priv_edge() const {
     const auto &edge_id = m_current_pos->second;
-    return (m_storage_pointer->at(edge_id));
+    auto &bank_table = *m_storage_pointer;
+    return bank_table[edge_id % bank_table.size()].at(edge_id);
   }
 
- private:
   adj_list_edge_list_iterator_type m_current_pos;
   storage_pointer_type m_storage_pointer;
 };
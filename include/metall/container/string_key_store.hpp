@@ -3,14 +3,18 @@
 //
 // SPDX-License-Identifier: (Apache-2.0 OR MIT)
 
-#ifndef METALL_CONTAINER_CONCURRENT_STRING_KEY_STORE_HPP
-#define METALL_CONTAINER_CONCURRENT_STRING_KEY_STORE_HPP
+#ifndef METALL_CONTAINER_STRING_KEY_STORE_HPP
+#define METALL_CONTAINER_STRING_KEY_STORE_HPP
 
 #include <memory>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <tuple>
-#include <metall/container/unordered_map.hpp>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+#include <metall/container/vector.hpp>
 #include <metall/container/string.hpp>
 #include <metall/container/scoped_allocator.hpp>
 #include <metall/container/string_key_store_locator.hpp>
@@ -22,7 +26,16 @@ namespace {
 namespace mc = metall::container;
 }
 
+template <typename, typename, std::size_t>
+class concurrent_string_key_store;
+
 /// \brief A ke-value store that uses string for its key.
+/// Elements are stored contiguously in a vector. A flat open-addressing hash
+/// table (linear probing), whose slots hold a hash tag and an element
+/// position, is used to find elements. Thus, a lookup probes contiguous
+/// memory and does not allocate or follow a node per element.
+/// Short keys are stored inline in the element thanks to the small string
+/// optimization of the string type.
 /// \warning This container is designed to work as the top-level container,
 /// i.e., it does not work if used inside another container.
 /// \tparam _value_type A value type.
@@ -39,31 +52,88 @@ class string_key_store {
   using other_scoped_allocator =
       mc::scoped_allocator_adaptor<other_allocator<T>>;
 
-  using internal_id_type = uint64_t;
+  using hash_type = uint64_t;
   using internal_string_type =
       mc::basic_string<char, std::char_traits<char>, other_allocator<char>>;
-  using internal_value_type = std::tuple<internal_string_type, _value_type>;
+  // Key, value, and the hash value of the key.
+  using internal_value_type =
+      std::tuple<internal_string_type, _value_type, hash_type>;
+  using entry_storage_type =
+      mc::vector<internal_value_type,
+                 other_scoped_allocator<internal_value_type>>;
+
+  // A slot of the hash table.
+  // The upper k_tag_bits bits hold a tag taken from the hash value of the key
+  // and the lower bits hold the position of the element in the entry storage.
+  // 0 means an empty slot.
+  using slot_type = uint64_t;
+  using slot_table_type = mc::vector<slot_type, other_allocator<slot_type>>;
+  static constexpr std::size_t k_tag_bits = 24;
+  static constexpr std::size_t k_position_bits = 64 - k_tag_bits;
+  static constexpr slot_type k_position_mask =
+      (slot_type(1) << k_position_bits) - 1;
+  static constexpr slot_type k_empty_slot = 0;
+  static constexpr std::size_t k_min_num_slots = 16;
+  static constexpr std::size_t k_npos = std::numeric_limits<std::size_t>::max();
+
+  // The cursor held by the locator.
+  // Points to an element in the entry storage. If the cursor was made from a
+  // key, it also holds the position of the slot so that it can advance to the
+  // next element with the same key.
+  class cursor {
+   public:
+    cursor(const string_key_store *store, const std::size_t position,
+           const std::size_t slot_position = k_npos)
+        : m_store(store),
+          m_position(position),
+          m_slot_position(slot_position) {}
+
+    cursor &operator++() {
+      if (m_slot_position == k_npos) {
+        ++m_position;
+      } else {
+        m_slot_position = m_store->priv_find_slot(
+            m_store->key_at(m_position), m_store->hash_at(m_position),
+            m_store->priv_next_slot(m_slot_position));
+        m_position = m_store->priv_position_or_end(m_slot_position);
+      }
+      return *this;
+    }
+
+    bool operator==(const cursor &other) const {
+      if (m_store != other.m_store) return false;
+      // All positions at or beyond the last element represent the end; thus,
+      // an end locator stays valid after elements are erased.
+      const auto size = m_store->size();
+      return (m_position >= size && other.m_position >= size) ||
+             m_position == other.m_position;
+    }
+
+    bool operator!=(const cursor &other) const { return !(*this == other); }
+
+    std::size_t position() const { return m_position; }
+
+    std::size_t slot_position() const { return m_slot_position; }
 
-  using map_type = mc::unordered_multimap<
-      internal_id_type, internal_value_type, std::hash<internal_id_type>,
-      std::equal_to<internal_id_type>,
-      other_scoped_allocator<
-          std::pair<const internal_id_type, internal_value_type>>>;
+   private:
+    const string_key_store *m_store;
+    std::size_t m_position;
+    std::size_t m_slot_position;
+  };
+  friend class cursor;
 
-  /// Used for representing 'invalid key'.
-  static constexpr internal_id_type k_max_internal_id =
-      std::numeric_limits<internal_id_type>::max();
+  template <typename, typename, std::size_t>
+  friend class concurrent_string_key_store;
 
  public:
   using key_type = std::string_view;
   using value_type = _value_type;
-  using locator_type =
-      string_key_store_locator<typename map_type::const_iterator>;
+  using locator_type = string_key_store_locator<cursor>;
 
   /// \brief Constructor.
   /// \param allocator An allocator object.
   explicit string_key_store(const allocator_type &allocator = allocator_type())
-      : m_map(allocator) {}
+      : m_entries(allocator), m_slots(allocator) {}
 
   /// \brief Constructor.
   /// \param unique Accept duplicate keys if false is specified.
@@ -71,7 +141,10 @@ class string_key_store {
   /// \param allocator An allocator object.
   string_key_store(const bool unique, const uint64_t hash_seed,
                    const allocator_type &allocator = allocator_type())
-      : m_unique(unique), m_hash_seed(hash_seed), m_map(allocator) {}
+      : m_unique(unique),
+        m_hash_seed(hash_seed),
+        m_entries(allocator),
+        m_slots(allocator) {}
 
   /// \brief Copy constructor
   string_key_store(const string_key_store &) = default;
@@ -80,7 +153,9 @@ class string_key_store {
   string_key_store(const string_key_store &other, const allocator_type &alloc)
       : m_unique(other.m_unique),
         m_hash_seed(other.m_hash_seed),
-        m_map(other.m_map, alloc) {}
+        m_entries(other.m_entries, alloc),
+        m_slots(other.m_slots, alloc),
+        m_max_probe_distance(other.m_max_probe_distance) {}
 
   /// \brief Move constructor
   string_key_store(string_key_store &&) noexcept = default;
@@ -90,7 +165,9 @@ class string_key_store {
                    const allocator_type &alloc) noexcept
       : m_unique(other.m_unique),
         m_hash_seed(other.m_hash_seed),
-        m_map(std::move(other.m_map), alloc) {}
+        m_entries(std::move(other.m_entries), alloc),
+        m_slots(std::move(other.m_slots), alloc),
+        m_max_probe_distance(other.m_max_probe_distance) {}
 
   /// \brief Copy assignment operator
   string_key_store &operator=(const string_key_store &) = default;
@@ -104,8 +181,8 @@ class string_key_store {
   /// \param key A key to insert.
   /// \return True if an item is inserted; otherwise, false.
   bool insert(const key_type &key) {
-    const auto internal_id = priv_find_or_generate_internal_id(key);
-    if (m_unique && m_map.count(internal_id) == 1) {
+    const auto hash = priv_hash_key(key, m_hash_seed);
+    if (m_unique && priv_find_slot(key, hash) != k_npos) {
       return false;
     }
 
@@ -114,10 +191,10 @@ class string_key_store {
     // of uses-allocator construction. This is why we use tuple for
     // internal_value_type.
     auto internal_value =
-        internal_value_type{std::allocator_arg, m_map.get_allocator()};
-    std::get<0>(internal_value) = key;
-
-    m_map.emplace(internal_id, std::move(internal_value));
+        internal_value_type{std::allocator_arg, m_entries.get_allocator()};
+    std::get<0>(internal_value).assign(key.data(), key.size());
+    std::get<2>(internal_value) = hash;
+    priv_emplace(std::move(internal_value));
 
     return true;
   }
@@ -128,17 +205,17 @@ class string_key_store {
   /// value of the existing one. \param key A key to insert. \param value A
   /// value to insert. \return Always true.
   bool insert(const key_type &key, const value_type &value) {
-    const auto internal_id = priv_find_or_generate_internal_id(key);
-
-    assert(!m_unique || m_map.count(internal_id) <= 1);
-    if (m_unique && m_map.count(internal_id) == 1) {
-      assert(m_map.count(internal_id) == 1);
-      std::get<1>(m_map.find(internal_id)->second) = value;
-    } else {
-      m_map.emplace(internal_id, internal_value_type{std::allocator_arg,
-                                                     m_map.get_allocator(),
-                                                     key.data(), value});
+    const auto hash = priv_hash_key(key, m_hash_seed);
+    if (m_unique) {
+      const auto slot_position = priv_find_slot(key, hash);
+      if (slot_position != k_npos) {
+        std::get<1>(priv_entry_at(slot_position)) = value;
+        return true;
+      }
     }
+    priv_emplace(internal_value_type{std::allocator_arg,
+                                     m_entries.get_allocator(),
+                                     priv_make_string(key), value, hash});
     return true;
   }
 
@@ -147,68 +224,75 @@ class string_key_store {
   /// \param value A value to insert.
   /// \return Always true.
   bool insert(const key_type &key, value_type &&value) {
-    const auto internal_id = priv_find_or_generate_internal_id(key);
-
-    assert(!m_unique || m_map.count(internal_id) <= 1);
-    if (m_unique && m_map.count(internal_id) == 1) {
-      std::get<1>(m_map.find(internal_id)->second) = std::move(value);
-    } else {
-      m_map.emplace(internal_id, internal_value_type{
-                                     std::allocator_arg, m_map.get_allocator(),
-                                     key.data(), std::move(value)});
+    const auto hash = priv_hash_key(key, m_hash_seed);
+    if (m_unique) {
+      const auto slot_position = priv_find_slot(key, hash);
+      if (slot_position != k_npos) {
+        std::get<1>(priv_entry_at(slot_position)) = std::move(value);
+        return true;
+      }
     }
+    priv_emplace(internal_value_type{
+        std::allocator_arg, m_entries.get_allocator(), priv_make_string(key),
+        std::move(value), hash});
     return true;
   }
 
   /// \brief Clear all contents. This call does not reduce the memory usage.
   void clear() {
-    m_map.clear();
-    m_max_id_probe_distance = 0;
+    m_entries.clear();
+    std::fill(m_slots.begin(), m_slots.end(), k_empty_slot);
+    m_max_probe_distance = 0;
   }
 
   /// \brief Counts the number of items associated with the key.
   /// \param key A key to count.
   /// \return The number of items associated with the key.
   std::size_t count(const key_type &key) const {
-    const auto internal_id = priv_find_internal_id(key);
-    return m_map.count(internal_id);
+    const auto hash = priv_hash_key(key, m_hash_seed);
+    std::size_t num_found = 0;
+    for (auto slot_position = priv_find_slot(key, hash); slot_position != k_npos;
+         slot_position =
+             priv_find_slot(key, hash, priv_next_slot(slot_position))) {
+      ++num_found;
+      if (m_unique) break;
+    }
+    return num_found;
   }
 
   /// \brief Returns the number of elements in this container.
   /// \return The number of elements in this container.
-  std::size_t size() const { return m_map.size(); }
+  std::size_t size() const { return m_entries.size(); }
 
   /// \brief Returns the key of the element at 'position'.
   /// \param position A locator object.
   /// \return The key of the element at 'position'.
   const key_type key(const locator_type &position) const {
-    const auto &key = std::get<0>(position.m_iterator->second);
-    return key_type(key.c_str());
+    return key_at(position.m_iterator.position());
   }
 
   /// \brief Returns the value of the element at 'position'.
   /// \param position A locator object.
   /// \return The value of the element at 'position'.
   value_type &value(const locator_type &position) {
-    // Convert to a non-const iterator
-    auto non_const_iterator =
-        m_map.erase(position.m_iterator, position.m_iterator);
-    return std::get<1>(non_const_iterator->second);
+    return std::get<1>(m_entries[position.m_iterator.position()]);
   }
 
   /// \brief Returns the value of the element at 'position'.
   /// \param position A locator object.
   /// \return The value of the element at 'position' as const.
   const value_type &value(const locator_type &position) const {
-    return std::get<1>(position.m_iterator->second);
+    return std::get<1>(m_entries[position.m_iterator.position()]);
   }
 
   /// \brief Finds an element with key equivalent to 'key'.
   /// \param key The key of an element to find.
   /// \return An locator object that points the found element.
   locator_type find(const key_type &key) const {
-    const auto internal_id = priv_find_internal_id(key);
-    return locator_type(m_map.find(internal_id));
+    const auto slot_position =
+        priv_find_slot(key, priv_hash_key(key, m_hash_seed));
+    return locator_type(
+        cursor(this, priv_position_or_end(slot_position), slot_position));
   }
 
   /// \brief Returns a range containing all elements with key key in the
@@ -217,55 +301,95 @@ class string_key_store {
   /// the first element of the range, and the second points to the element
   /// following the last element of the range.
   std::pair<locator_type, locator_type> equal_range(const key_type &key) const {
-    const auto internal_id = priv_find_internal_id(key);
-    const auto range = m_map.equal_range(internal_id);
-    return std::make_pair(locator_type(range.first),
-                          locator_type(range.second));
+    // Incrementing a locator made from a key, or erasing the element it points
+    // to, moves it to the next element with the same key. After the last one,
+    // it becomes the end; thus, the end bounds the elements with the key.
+    return std::make_pair(find(key), end());
   }
 
   /// \brief Return an iterator that points the first element in the container.
   /// \return An iterator that points the first element in the container.
-  locator_type begin() const { return locator_type(m_map.begin()); }
+  locator_type begin() const { return locator_type(cursor(this, 0)); }
 
   /// \brief Returns an iterator to the element following the last element.
   /// \return An iterator to the element following the last element.
-  locator_type end() const { return locator_type(m_map.end()); }
+  locator_type end() const {
+    return locator_type(cursor(this, m_entries.size()));
+  }
 
   /// \brief Removes all elements with the key equivalent to key.
   /// \param key The key of elements to remove.
   /// \return The number of elements removed.
   std::size_t erase(const key_type &key) {
-    const auto internal_id = priv_find_internal_id(key);
-    return m_map.erase(internal_id);
+    const auto hash = priv_hash_key(key, m_hash_seed);
+    std::size_t num_erased = 0;
+    // Erasing an element shifts the following slots back; thus, restart the
+    // search from the beginning of the probe sequence every time.
+    for (auto slot_position = priv_find_slot(key, hash); slot_position != k_npos;
+         slot_position = priv_find_slot(key, hash)) {
+      priv_erase(slot_position);
+      ++num_erased;
+    }
+    return num_erased;
   }
 
   /// \brief Removes the element at 'position'.
+  /// The last element is moved to 'position'; thus, this function invalidates
+  /// locators that point to the last element.
   /// \param position The position of an element to remove.
   /// \return A locator that points to the next element of the removed one.
+  /// If 'position' was made from a key, e.g., by find() or equal_range(),
+  /// the returned locator points to the next element with the same key.
   locator_type erase(const locator_type &position) {
     if (position == end()) return end();
-    return locator_type(m_map.erase(position.m_iterator));
+    const auto entry_position = position.m_iterator.position();
+    const auto slot_position = position.m_iterator.slot_position();
+    if (slot_position == k_npos) {
+      priv_erase(priv_find_slot_of(entry_position));
+      return locator_type(cursor(this, entry_position));
+    }
+
+    // Backward-shift deletion moves only the slots following the erased one;
+    // thus, the remaining elements with the key are found from the same slot.
+    const std::string key(key_at(entry_position));
+    const auto hash = hash_at(entry_position);
+    priv_erase(slot_position);
+    const auto next_slot_position = priv_find_slot(key, hash, slot_position);
+    return locator_type(cursor(this, priv_position_or_end(next_slot_position),
+                               next_slot_position));
   }
 
   /// \brief Returns the maximum ID probe distance.
-  /// In other words, the maximum number of key pairs that have the same hash
-  /// value. \return The maximum ID probe distance.
-  std::size_t max_id_probe_distance() const { return m_max_id_probe_distance; }
+  /// In other words, the maximum number of slots probed to find an element
+  /// in the hash table, minus one.
+  /// \return The maximum ID probe distance.
+  std::size_t max_id_probe_distance() const { return m_max_probe_distance; }
 
   /// \brief Rehash elements.
+  /// Rebuilds the hash table with the minimum number of slots for the current
+  /// number of elements and releases unused capacity.
   void rehash() {
-    auto old_map = map_type(get_allocator());
-    std::swap(old_map, m_map);
-    m_map.clear();
-    assert(m_map.empty());
-    for (auto &elem : old_map) {
-      insert(std::get<0>(elem.second), std::move(std::get<1>(elem.second)));
+    m_entries.shrink_to_fit();
+    priv_rebuild_slots(priv_num_slots_for(m_entries.size()));
+  }
+
+  /// \brief Returns the number of elements that can be held without
+  /// reallocating the element storage.
+  /// \return The capacity of the element storage.
+  std::size_t capacity() const { return m_entries.capacity(); }
+
+  /// \brief Reserves space for at least the specified number of elements.
+  /// \param count The number of elements to reserve space for.
+  void reserve(const std::size_t count) {
+    m_entries.reserve(count);
+    if (priv_num_slots_for(count) > m_slots.size()) {
+      priv_rebuild_slots(priv_num_slots_for(count));
     }
   }
 
   /// \brief Returns an instance of the internal allocator.
   /// \return An instance of the internal allocator.
-  allocator_type get_allocator() { return m_map.get_allocator(); }
+  allocator_type get_allocator() const { return m_entries.get_allocator(); }
 
   /// \brief Returns if this container inserts keys uniquely.
   /// \return True if this container inserts key avoiding duplicates; otherwise
@@ -274,84 +398,172 @@ class string_key_store {
 
   /// \brief Returns the hash seed.
   /// \return Hash seed.
-  bool hash_seed() const { return m_hash_seed; }
+  uint64_t hash_seed() const { return m_hash_seed; }
 
  private:
-  /// \brief Generates a new internal ID for 'key'.
-  internal_id_type priv_generate_internal_id(const key_type &key) {
-    auto internal_id = priv_hash_key(key, m_hash_seed);
-
-    std::size_t distance = 0;
-    while (m_map.count(internal_id) > 0) {
-      internal_id = priv_increment_internal_id(internal_id);
-      ++distance;
-    }
-    m_max_id_probe_distance = std::max(distance, m_max_id_probe_distance);
+  internal_string_type priv_make_string(const key_type &key) const {
+    return internal_string_type(
+        key.data(), key.size(),
+        other_allocator<char>(m_entries.get_allocator()));
+  }
 
-    return internal_id;
+  key_type key_at(const std::size_t position) const {
+    const auto &key = std::get<0>(m_entries[position]);
+    return key_type(key.data(), key.size());
   }
 
-  /// \brief Finds the internal ID that corresponds with 'key'.
-  /// If this container does not have an element with 'key',
-  /// returns k_max_internal_id.
-  internal_id_type priv_find_internal_id(const key_type &key) const {
-    auto internal_id = priv_hash_key(key, m_hash_seed);
+  hash_type hash_at(const std::size_t position) const {
+    return std::get<2>(m_entries[position]);
+  }
 
-    for (std::size_t d = 0; d <= m_max_id_probe_distance; ++d) {
-      const auto itr = m_map.find(internal_id);
-      if (itr == m_map.end()) {
-        break;
-      }
+  static slot_type priv_tag(const hash_type hash) {
+    const auto tag = hash >> k_position_bits;
+    return (tag == 0) ? 1 : tag;
+  }
+
+  static slot_type priv_make_slot(const hash_type hash,
+                                  const std::size_t position) {
+    assert(position <= k_position_mask);
+    return (priv_tag(hash) << k_position_bits) | slot_type(position);
+  }
 
-      if (std::get<0>(itr->second) == key) {
-        return internal_id;
+  static std::size_t priv_entry_position(const slot_type slot) {
+    return std::size_t(slot & k_position_mask);
+  }
+
+  internal_value_type &priv_entry_at(const std::size_t slot_position) {
+    return m_entries[priv_entry_position(m_slots[slot_position])];
+  }
+
+  std::size_t priv_home(const hash_type hash) const {
+    return std::size_t(hash & (m_slots.size() - 1));
+  }
+
+  std::size_t priv_next_slot(const std::size_t slot_position) const {
+    return (slot_position + 1) & (m_slots.size() - 1);
+  }
+
+  std::size_t priv_position_or_end(const std::size_t slot_position) const {
+    return (slot_position == k_npos)
+               ? m_entries.size()
+               : priv_entry_position(m_slots[slot_position]);
+  }
+
+  /// \brief Finds the slot of an element with 'key'.
+  /// \param start The slot to start probing from. If k_npos is given, starts
+  /// from the home slot of 'hash'.
+  /// \return The position of the slot; k_npos if not found.
+  std::size_t priv_find_slot(const key_type &key, const hash_type hash,
+                             std::size_t start = k_npos) const {
+    if (m_slots.empty()) return k_npos;
+    const auto tag = priv_tag(hash);
+    const auto home = priv_home(hash);
+    std::size_t i = (start == k_npos) ? home : start;
+    // A slot whose element is further from its home than 'max distance'
+    // cannot exist, which bounds the search.
+    for (; ((i - home) & (m_slots.size() - 1)) <= m_max_probe_distance;
+         i = priv_next_slot(i)) {
+      const auto slot = m_slots[i];
+      if (slot == k_empty_slot) break;
+      if ((slot >> k_position_bits) == tag &&
+          key_at(priv_entry_position(slot)) == key) {
+        return i;
       }
-      internal_id = priv_increment_internal_id(internal_id);
     }
+    return k_npos;
+  }
+
+  /// \brief Finds the slot that points to the element at 'position'.
+  std::size_t priv_find_slot_of(const std::size_t position) const {
+    for (std::size_t i = priv_home(hash_at(position));; i = priv_next_slot(i)) {
+      assert(m_slots[i] != k_empty_slot);
+      if (priv_entry_position(m_slots[i]) == position) return i;
+    }
+  }
+
+  static std::size_t priv_num_slots_for(const std::size_t num_entries) {
+    // Keep the load factor at or below 3/4
+    std::size_t num_slots = k_min_num_slots;
+    while (num_entries * 4 > num_slots * 3) num_slots *= 2;
+    return num_slots;
+  }
+
+  void priv_insert_slot(const hash_type hash, const std::size_t position) {
+    const auto home = priv_home(hash);
+    std::size_t i = home;
+    while (m_slots[i] != k_empty_slot) i = priv_next_slot(i);
+    m_slots[i] = priv_make_slot(hash, position);
+    m_max_probe_distance = std::max(m_max_probe_distance,
+                                    (i - home) & (m_slots.size() - 1));
+  }
+
+  void priv_rebuild_slots(const std::size_t num_slots) {
+    assert((num_slots & (num_slots - 1)) == 0);
+    m_slots.assign(num_slots, k_empty_slot);
+    m_max_probe_distance = 0;
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+      priv_insert_slot(hash_at(i), i);
+    }
+  }
 
-    return k_max_internal_id;  // Couldn't find
+  void priv_emplace(internal_value_type &&internal_value) {
+    m_entries.emplace_back(std::move(internal_value));
+    const auto position = m_entries.size() - 1;
+    if (m_entries.size() * 4 > m_slots.size() * 3) {
+      priv_rebuild_slots(priv_num_slots_for(m_entries.size()));
+    } else {
+      priv_insert_slot(hash_at(position), position);
+    }
   }
 
-  /// \brief Finds the internal ID that corresponds to 'key'.
-  /// If this container does not have an element with 'key',
-  /// Generate a new internal ID.
-  internal_id_type priv_find_or_generate_internal_id(const key_type &key) {
-    auto internal_id = priv_find_internal_id(key);
-    if (internal_id == k_max_internal_id) {  // Couldn't find
-      // Generate a new one.
-      internal_id = priv_generate_internal_id(key);
+  /// \brief Erases the element pointed by the slot at 'slot_position'.
+  void priv_erase(const std::size_t slot_position) {
+    const auto position = priv_entry_position(m_slots[slot_position]);
+
+    // Backward-shift deletion: move the following slots back so that no
+    // tombstone is needed.
+    const auto mask = m_slots.size() - 1;
+    std::size_t hole = slot_position;
+    for (std::size_t i = priv_next_slot(hole); m_slots[i] != k_empty_slot;
+         i = priv_next_slot(i)) {
+      const auto home = priv_home(hash_at(priv_entry_position(m_slots[i])));
+      // The slot can be moved to the hole only if its home is not in the
+      // cyclic range (hole, i].
+      if (((i - home) & mask) >= ((i - hole) & mask)) {
+        m_slots[hole] = m_slots[i];
+        hole = i;
+      }
+    }
+    m_slots[hole] = k_empty_slot;
+
+    // Move the last element to the erased position.
+    const auto last = m_entries.size() - 1;
+    if (position != last) {
+      const auto last_slot = priv_find_slot_of(last);
+      m_slots[last_slot] = priv_make_slot(hash_at(last), position);
+      m_entries[position] = std::move(m_entries[last]);
     }
-    return internal_id;
+    m_entries.pop_back();
   }
 
-  static internal_id_type priv_hash_key(const key_type &key,
-                                        [[maybe_unused]] const uint64_t seed) {
+  static hash_type priv_hash_key(const key_type &key,
+                                 [[maybe_unused]] const uint64_t seed) {
 #ifdef METALL_CONTAINER_STRING_KEY_STORE_USE_SIMPLE_HASH
-    internal_id_type hash = key.empty() ? 0 : (uint8_t)key[0] % 2;
+    hash_type hash = key.empty() ? 0 : (uint8_t)key[0] % 2;
 #else
-    auto hash = (internal_id_type)metall::mtlldetail::murmur_hash_64a(
+    auto hash = (hash_type)metall::mtlldetail::murmur_hash_64a(
         key.data(), (int)key.length(), seed);
 #endif
-    if (hash == k_max_internal_id) {
-      hash = priv_increment_internal_id(hash);
-    }
-    assert(hash != k_max_internal_id);
     return hash;
   }
 
-  static internal_id_type priv_increment_internal_id(
-      const internal_id_type id) {
-    const auto new_id = (id + 1) % k_max_internal_id;
-    assert(new_id != k_max_internal_id);
-    return new_id;
-  }
-
   bool m_unique{false};
   uint64_t m_hash_seed{123};
-  map_type m_map{allocator_type{}};
-  std::size_t m_max_id_probe_distance{0};
+  entry_storage_type m_entries{allocator_type{}};
+  slot_table_type m_slots{allocator_type{}};
+  std::size_t m_max_probe_distance{0};
 };
 
 }  // namespace metall::container
 
-#endif  // METALL_CONTAINER_CONCURRENT_STRING_KEY_STORE_HPP
+#endif  // METALL_CONTAINER_STRING_KEY_STORE_HPP
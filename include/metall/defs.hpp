@@ -64,6 +64,30 @@
 #define METALL_DISABLE_FREE_FILE_SPACE
 #endif
 
+// --------------------
+// Macros for the allocator statistics
+// --------------------
+
+#ifdef DOXYGEN_SKIP
+/// \brief If defined, the segment allocator does not count allocator
+/// statistics, e.g., metall::basic_manager::get_allocator_statistics() returns
+/// only zeros (except for bytes_in_use of objects allocated before opening).
+#define METALL_DISABLE_ALLOCATOR_STATISTICS
+#endif
+
+// --------------------
+// Macros for tracing
+// --------------------
+
+#ifdef DOXYGEN_SKIP
+/// \brief If defined, tracing hooks in the kernel record events
+/// (see metall/tracer.hpp). Otherwise, the hooks are compiled out.
+#define METALL_ENABLE_TRACE
+
+/// \brief The number of records the default trace ring buffer keeps.
+#define METALL_TRACE_BUFFER_SIZE
+#endif
+
 // --------------------
 // Macros for the object cache
 // --------------------
@@ -91,6 +115,19 @@
 #define METALL_DISABLE_CONCURRENCY
 #endif
 
+// --------------------
+// Macros for the JSON library
+// --------------------
+
+#ifdef DOXYGEN_SKIP
+/// \brief If defined, metall::json::object builds a hash index once it holds
+/// more than a few key-value pairs, instead of always searching linearly.
+/// \details
+/// This option changes the persistent layout of JSON objects. Datastores must
+/// be opened by programs built with the same setting as the creator.
+#define METALL_JSON_USE_ADAPTIVE_OBJECT
+#endif
+
 // --------------------
 // Deprecated macros
 
@@ -26,6 +26,15 @@ inline int ctzll(const unsigned long long x) noexcept {
 #endif
 }
 
+/// \brief Population Count.
+inline int popcountll(const unsigned long long x) noexcept {
+#if defined(__GNUG__) || defined(__clang__)
+  return __builtin_popcountll(x);
+#else
+#error "GCC or Clang must be used to use __builtin_popcountll" << std::endl;
+#endif
+}
+
 }  // namespace metall::mtlldetail
 
 #endif  // METALL_DETAIL_UTILITY_BUILTIN_FUNCTIONS_HPP
@@ -7,11 +7,17 @@
 #define METALL_DETAIL_UTILITY_MUTEX_HPP
 
 #include <mutex>
+#include <shared_mutex>
 
 namespace metall::mtlldetail {
 
 using mutex = std::mutex;
 using mutex_lock_guard = std::lock_guard<mutex>;
+using mutex_unique_lock = std::unique_lock<mutex>;
+
+using shared_mutex = std::shared_mutex;
+using shared_mutex_lock_guard = std::lock_guard<shared_mutex>;
+using shared_mutex_shared_lock = std::shared_lock<shared_mutex>;
 
 }  // namespace metall::mtlldetail
 #endif  // METALL_DETAIL_UTILITY_MUTEX_HPP
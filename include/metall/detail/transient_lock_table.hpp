@@ -0,0 +1,157 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_DETAIL_TRANSIENT_LOCK_TABLE_HPP
+#define METALL_DETAIL_TRANSIENT_LOCK_TABLE_HPP
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cassert>
+
+namespace metall::mtlldetail {
+
+/// \brief A table of striped locks for an object that may reside in persistent
+/// memory. The locks themselves are allocated in transient (process-local)
+/// memory; an instance of this class only caches a pointer to them.
+/// A container can be reattached by another process or at another address;
+/// the cached pointer is used only if it was set by the running process for
+/// the same address and no table has been freed since then. Otherwise, the
+/// locks are looked up in a process-wide registry keyed by the address of
+/// this object.
+/// The locks are freed when this object is destructed. A copy of the object
+/// (e.g., in a snapshot) that is reattached at the same address afterward
+/// holds a stale cache; the registry's generation counter, which every
+/// destruction advances, makes it look the locks up again.
+/// An object left in persistent memory is not destructed when its data store
+/// is closed; its locks are kept until the process exits or another object
+/// at the same address is destructed.
+/// \warning An instance of this class holds a few words of cache, which
+/// are part of the (persistent) layout of the object that contains it.
+/// \tparam k_num_locks The number of locks.
+/// \tparam mutex_t A mutex type.
+template <std::size_t k_num_locks, typename mutex_t = std::shared_mutex>
+class transient_lock_table {
+ public:
+  using mutex_type = mutex_t;
+
+  transient_lock_table() = default;
+
+  /// \brief Copy constructor. The copy gets its own locks.
+  transient_lock_table(const transient_lock_table &) noexcept {}
+
+  /// \brief Copy assignment operator. Keeps the locks of this object.
+  transient_lock_table &operator=(const transient_lock_table &) noexcept {
+    return *this;
+  }
+
+  /// \brief Destructor. Frees the locks of this object.
+  /// The locks must not be held.
+  ~transient_lock_table() noexcept {
+    try {
+      auto &registry = priv_registry();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      if (registry.tables.erase(this) > 0) {
+        // Invalidate the caches that may point to the freed table
+        registry.generation.fetch_add(1, std::memory_order_release);
+      }
+    } catch (...) {
+    }
+  }
+
+  /// \brief Returns the number of locks.
+  static constexpr std::size_t size() { return k_num_locks; }
+
+  /// \brief Returns the number of tables allocated in the running process
+  /// for objects of this class.
+  static std::size_t num_allocated_tables() {
+    auto &registry = priv_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    return registry.tables.size();
+  }
+
+  /// \brief Returns a lock.
+  /// \param index The index of the lock.
+  /// \return A reference to the lock.
+  mutex_type &operator[](const std::size_t index) const {
+    assert(index < k_num_locks);
+    return priv_table()[index].mutex;
+  }
+
+ private:
+  // Pads each lock to a cache line to avoid false sharing.
+  struct alignas(64) padded_mutex {
+    mutable mutex_type mutex;
+  };
+  using table_type = std::array<padded_mutex, k_num_locks>;
+
+  // Returns a random token that identifies the running process.
+  static uint64_t priv_process_token() {
+    static const uint64_t token = [] {
+      std::random_device rd;
+      const uint64_t t =
+          (uint64_t(rd()) << 32ULL) ^ uint64_t(rd()) ^
+          uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+      return (t == 0) ? 1 : t;
+    }();
+    return token;
+  }
+
+  table_type &priv_table() const {
+    if (m_token.load(std::memory_order_acquire) == priv_process_token() &&
+        m_owner.load(std::memory_order_relaxed) == this &&
+        m_generation.load(std::memory_order_relaxed) ==
+            priv_registry().generation.load(std::memory_order_acquire)) {
+      return *m_table.load(std::memory_order_relaxed);
+    }
+    return priv_attach();
+  }
+
+  struct registry_type {
+    std::mutex mutex;
+    std::unordered_map<const void *, std::unique_ptr<table_type>> tables;
+    // Advanced every time a table is freed; starts at 1 so that a cache that
+    // has never been set does not match.
+    std::atomic<uint64_t> generation{1};
+  };
+
+  // Never destructed so that objects destructed at exit can still use it.
+  static registry_type &priv_registry() {
+    static auto *const registry = new registry_type;
+    return *registry;
+  }
+
+  // Looks up the table in the process-wide registry and caches it.
+  // The cache is valid only while the registry's generation is unchanged,
+  // i.e., no table (including the one cached) has been freed.
+  table_type &priv_attach() const {
+    auto &registry = priv_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    auto &table = registry.tables[this];
+    if (!table) table = std::make_unique<table_type>();
+    m_table.store(table.get(), std::memory_order_relaxed);
+    m_owner.store(this, std::memory_order_relaxed);
+    m_generation.store(registry.generation.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    m_token.store(priv_process_token(), std::memory_order_release);
+    return *table;
+  }
+
+  // The values are meaningless once the process exits.
+  mutable std::atomic<table_type *> m_table{nullptr};
+  mutable std::atomic<const transient_lock_table *> m_owner{nullptr};
+  mutable std::atomic<uint64_t> m_generation{0};
+  mutable std::atomic<uint64_t> m_token{0};
+};
+
+}  // namespace metall::mtlldetail
+
+#endif  // METALL_DETAIL_TRANSIENT_LOCK_TABLE_HPP
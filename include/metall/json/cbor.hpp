@@ -0,0 +1,681 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_JSON_CBOR_HPP
+#define METALL_JSON_CBOR_HPP
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <optional>
+
+#include <metall/json/json_fwd.hpp>
+
+/// \file
+/// \brief Binary encoding of JSON values in CBOR (RFC 8949).
+/// Arrays and objects are encoded with definite (prefixed) lengths.
+/// Optionally, repeated strings (e.g., object keys) can be replaced by
+/// references to the first occurrence, following the CBOR stringref extension
+/// (tag 256 for the namespace, tag 25 for a reference;
+/// see http://cbor.schmorp.de/stringref).
+
+namespace metall::json {
+
+namespace jsndtl::cbor {
+
+enum major_type : std::uint8_t {
+  k_unsigned = 0,
+  k_negative = 1,
+  k_byte_string = 2,
+  k_text_string = 3,
+  k_array = 4,
+  k_map = 5,
+  k_tag = 6,
+  k_simple = 7
+};
+
+constexpr std::uint8_t k_false = 0xf4;
+constexpr std::uint8_t k_true = 0xf5;
+constexpr std::uint8_t k_null = 0xf6;
+constexpr std::uint8_t k_float16 = 0xf9;
+constexpr std::uint8_t k_float32 = 0xfa;
+constexpr std::uint8_t k_float64 = 0xfb;
+constexpr std::uint64_t k_stringref_tag = 25;
+constexpr std::uint64_t k_stringref_namespace_tag = 256;
+constexpr std::uint64_t k_self_describe_tag = 55799;
+
+/// \brief Returns the minimum length of a string that is added to the
+/// stringref table, when the table has 'table_size' strings.
+inline std::size_t stringref_min_length(const std::size_t table_size) {
+  if (table_size < 24) return 3;
+  if (table_size < 256) return 4;
+  if (table_size < 65536) return 5;
+  if (table_size < 4294967296ULL) return 7;
+  return 11;
+}
+
+/// \brief CBOR encoder that appends to a byte vector.
+class encoder {
+ public:
+  encoder(std::vector<std::uint8_t> *const out, const bool use_stringref)
+      : m_out(out), m_use_stringref(use_stringref) {}
+
+  template <typename allocator_type>
+  void encode_root(const value<allocator_type> &jv) {
+    if (m_use_stringref) {
+      write_head(k_tag, k_stringref_namespace_tag);
+    }
+    encode(jv);
+  }
+
+  template <typename allocator_type>
+  void encode(const value<allocator_type> &jv) {
+    if (jv.is_null()) {
+      m_out->push_back(k_null);
+    } else if (jv.is_bool()) {
+      m_out->push_back(jv.as_bool() ? k_true : k_false);
+    } else if (jv.is_int64()) {
+      const auto n = jv.as_int64();
+      if (n >= 0) {
+        write_head(k_unsigned, static_cast<std::uint64_t>(n));
+      } else {
+        write_head(k_negative, static_cast<std::uint64_t>(-(n + 1)));
+      }
+    } else if (jv.is_uint64()) {
+      write_head(k_unsigned, jv.as_uint64());
+    } else if (jv.is_double()) {
+      std::uint64_t bits;
+      const double d = jv.as_double();
+      std::memcpy(&bits, &d, sizeof(bits));
+      m_out->push_back(k_float64);
+      write_be(bits, 8);
+    } else if (jv.is_string()) {
+      const auto &str = jv.as_string();
+      encode_string(std::string_view(str.data(), str.size()));
+    } else if (jv.is_array()) {
+      const auto &arr = jv.as_array();
+      write_head(k_array, arr.size());
+      for (const auto &elem : arr) {
+        encode(elem);
+      }
+    } else if (jv.is_object()) {
+      const auto &obj = jv.as_object();
+      write_head(k_map, obj.size());
+      for (const auto &elem : obj) {
+        encode_string(elem.key());
+        encode(elem.value());
+      }
+    }
+  }
+
+  void encode_string(const std::string_view str) {
+    if (m_use_stringref) {
+      const auto itr = m_stringref_table.find(str);
+      if (itr != m_stringref_table.end()) {
+        write_head(k_tag, k_stringref_tag);
+        write_head(k_unsigned, itr->second);
+        return;
+      }
+      if (str.size() >= stringref_min_length(m_stringref_table.size())) {
+        const auto index = m_stringref_table.size();
+        m_stringref_table.emplace(str, index);
+      }
+    }
+    write_head(k_text_string, str.size());
+    m_out->insert(m_out->end(), str.begin(), str.end());
+  }
+
+ private:
+  void write_head(const std::uint8_t major, const std::uint64_t arg) {
+    const auto mt = static_cast<std::uint8_t>(major << 5U);
+    if (arg < 24) {
+      m_out->push_back(mt | static_cast<std::uint8_t>(arg));
+    } else if (arg <= 0xffULL) {
+      m_out->push_back(mt | 24);
+      write_be(arg, 1);
+    } else if (arg <= 0xffffULL) {
+      m_out->push_back(mt | 25);
+      write_be(arg, 2);
+    } else if (arg <= 0xffffffffULL) {
+      m_out->push_back(mt | 26);
+      write_be(arg, 4);
+    } else {
+      m_out->push_back(mt | 27);
+      write_be(arg, 8);
+    }
+  }
+
+  void write_be(const std::uint64_t n, const int num_bytes) {
+    for (int i = num_bytes - 1; i >= 0; --i) {
+      m_out->push_back(static_cast<std::uint8_t>(n >> (i * 8U)));
+    }
+  }
+
+  std::vector<std::uint8_t> *m_out;
+  bool m_use_stringref;
+  // The strings point to the encoded JSON value, which outlives the encoder.
+  std::unordered_map<std::string_view, std::size_t> m_stringref_table;
+};
+
+/// \brief The head of a CBOR data item.
+struct head {
+  std::uint8_t major;
+  std::uint8_t info;  // Additional information
+  std::uint64_t arg;
+  std::size_t size;  // Size of the head in bytes
+};
+
+/// \brief Decodes the head of the data item at 'pos'.
+/// \return False if the data is truncated or uses an unsupported encoding.
+inline bool read_head(const std::uint8_t *const data, const std::size_t size,
+                      const std::size_t pos, head *const hd) {
+  if (pos >= size) return false;
+  hd->major = data[pos] >> 5U;
+  hd->info = data[pos] & 0x1fU;
+  if (hd->info < 24) {
+    hd->arg = hd->info;
+    hd->size = 1;
+    return true;
+  }
+  if (hd->info > 27) return false;  // Indefinite lengths are not supported
+  const std::size_t num_bytes = std::size_t(1) << (hd->info - 24U);
+  if (pos + 1 + num_bytes > size) return false;
+  hd->arg = 0;
+  for (std::size_t i = 0; i < num_bytes; ++i) {
+    hd->arg = (hd->arg << 8U) | data[pos + 1 + i];
+  }
+  hd->size = 1 + num_bytes;
+  return true;
+}
+
+/// \brief Decodes the head of a data item that is known to be well-formed.
+inline head read_valid_head(const std::uint8_t *const data,
+                            const std::size_t pos) {
+  head hd{};
+  [[maybe_unused]] const bool ok =
+      read_head(data, std::numeric_limits<std::size_t>::max(), pos, &hd);
+  assert(ok);
+  return hd;
+}
+
+/// \brief Converts an IEEE 754 half-precision float to double.
+/// Follows the decoder in RFC 8949 Appendix D.
+inline double half_to_double(const std::uint16_t half) {
+  const int exp = (half >> 10U) & 0x1fU;
+  const int mant = half & 0x3ffU;
+  double val;
+  if (exp == 0) {
+    val = std::ldexp(mant, -24);
+  } else if (exp != 31) {
+    val = std::ldexp(mant + 1024, exp - 25);
+  } else {
+    val = (mant == 0) ? std::numeric_limits<double>::infinity()
+                      : std::numeric_limits<double>::quiet_NaN();
+  }
+  return (half & 0x8000U) ? -val : val;
+}
+
+/// \brief Decodes the argument of a float data item.
+/// \param byte The initial byte, which must be one of k_float16, k_float32,
+/// or k_float64.
+/// \param bits The argument read from the head.
+inline double to_double(const std::uint8_t byte, const std::uint64_t bits) {
+  if (byte == k_float16) {
+    return half_to_double(static_cast<std::uint16_t>(bits));
+  }
+  if (byte == k_float32) {
+    const auto bits32 = static_cast<std::uint32_t>(bits);
+    float f;
+    std::memcpy(&f, &bits32, sizeof(f));
+    return f;
+  }
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+}  // namespace jsndtl::cbor
+
+/// \brief Encodes a JSON value in CBOR.
+/// The value is read directly; no intermediate representation is made.
+/// \param jv A JSON value to encode.
+/// \param out A byte vector to which the encoded data is appended.
+/// \param use_string_references If true, repeated strings are encoded as
+/// references to their first occurrence (CBOR stringref extension), which
+/// reduces the size of data that has many objects with the same keys.
+template <typename allocator_type>
+inline void to_cbor(const value<allocator_type> &jv,
+                    std::vector<std::uint8_t> &out,
+                    const bool use_string_references = false) {
+  jsndtl::cbor::encoder enc(&out, use_string_references);
+  enc.encode_root(jv);
+}
+
+/// \brief Encodes a JSON value in CBOR.
+/// \param jv A JSON value to encode.
+/// \param use_string_references If true, repeated strings are encoded as
+/// references to their first occurrence.
+/// \return Encoded data.
+template <typename allocator_type>
+inline std::vector<std::uint8_t> to_cbor(
+    const value<allocator_type> &jv, const bool use_string_references = false) {
+  std::vector<std::uint8_t> out;
+  to_cbor(jv, out, use_string_references);
+  return out;
+}
+
+/// \brief A read-only view of a CBOR-encoded JSON document.
+/// Navigates the encoded data in place; strings are returned as
+/// std::string_view pointing into the encoded data.
+/// The encoded data must outlive this object, and this object must outlive
+/// the items obtained from it.
+class cbor_view {
+ public:
+  class item;
+
+  /// \brief Constructor.
+  /// Validates the whole data once; if the data is malformed or contains a
+  /// data item that cannot be represented as a JSON value, good() returns
+  /// false.
+  /// \param data A pointer to encoded data.
+  /// \param size The size of the encoded data in bytes.
+  cbor_view(const std::uint8_t *const data, const std::size_t size)
+      : m_data(data), m_size(size) {
+    std::size_t pos = 0;
+    m_good = priv_validate(0, &pos, false) && pos == m_size;
+    if (!m_good) {
+      std::cerr << "Invalid CBOR data at byte " << pos << std::endl;
+      m_stringref_table.clear();
+    }
+  }
+
+  /// \brief Constructor.
+  /// \param data Encoded data.
+  explicit cbor_view(const std::vector<std::uint8_t> &data)
+      : cbor_view(data.data(), data.size()) {}
+
+  /// \brief Returns true if the data is valid.
+  bool good() const noexcept { return m_good; }
+
+  /// \brief Returns the root item.
+  /// Must not be called if good() is false.
+  item root() const {
+    assert(m_good);
+    return item(this, m_root_pos);
+  }
+
+  /// \brief A data item in a CBOR-encoded JSON document.
+  class item {
+   public:
+    bool is_null() const { return priv_byte() == jsndtl::cbor::k_null; }
+    bool is_bool() const {
+      return priv_byte() == jsndtl::cbor::k_true ||
+             priv_byte() == jsndtl::cbor::k_false;
+    }
+    /// \brief Returns true if this is an integer that fits in std::int64_t.
+    bool is_int64() const {
+      const auto hd = priv_head();
+      return (hd.major == jsndtl::cbor::k_unsigned ||
+              hd.major == jsndtl::cbor::k_negative) &&
+             hd.arg <= std::uint64_t(std::numeric_limits<std::int64_t>::max());
+    }
+    /// \brief Returns true if this is an integer that does not fit in
+    /// std::int64_t but in std::uint64_t.
+    bool is_uint64() const {
+      const auto hd = priv_head();
+      return hd.major == jsndtl::cbor::k_unsigned &&
+             hd.arg > std::uint64_t(std::numeric_limits<std::int64_t>::max());
+    }
+    /// \brief Returns true if this is a half, single, or double precision
+    /// float.
+    bool is_double() const {
+      return priv_byte() == jsndtl::cbor::k_float16 ||
+             priv_byte() == jsndtl::cbor::k_float32 ||
+             priv_byte() == jsndtl::cbor::k_float64;
+    }
+    bool is_string() const {
+      return priv_head().major == jsndtl::cbor::k_text_string ||
+             priv_is_stringref();
+    }
+    bool is_array() const {
+      return priv_head().major == jsndtl::cbor::k_array;
+    }
+    bool is_object() const { return priv_head().major == jsndtl::cbor::k_map; }
+
+    bool as_bool() const {
+      assert(is_bool());
+      return priv_byte() == jsndtl::cbor::k_true;
+    }
+
+    std::int64_t as_int64() const {
+      assert(is_int64());
+      const auto hd = priv_head();
+      if (hd.major == jsndtl::cbor::k_unsigned) {
+        return static_cast<std::int64_t>(hd.arg);
+      }
+      return -static_cast<std::int64_t>(hd.arg) - 1;
+    }
+
+    std::uint64_t as_uint64() const {
+      assert(is_uint64());
+      return priv_head().arg;
+    }
+
+    double as_double() const {
+      assert(is_double());
+      return jsndtl::cbor::to_double(
+          priv_byte(),
+          jsndtl::cbor::read_valid_head(m_view->m_data, m_pos).arg);
+    }
+
+    /// \brief Returns a view of the string. No data is copied.
+    std::string_view as_string() const {
+      assert(is_string());
+      if (priv_is_stringref()) {
+        const auto index_hd =
+            jsndtl::cbor::read_valid_head(m_view->m_data, priv_next_pos(m_pos));
+        return m_view->m_stringref_table[index_hd.arg];
+      }
+      const auto hd = priv_head();
+      return std::string_view(
+          reinterpret_cast<const char *>(m_view->m_data + m_pos + hd.size),
+          hd.arg);
+    }
+
+    /// \brief Returns the number of elements or key-value pairs.
+    std::size_t size() const {
+      assert(is_array() || is_object());
+      return priv_head().arg;
+    }
+
+    /// \brief Calls 'fn(item)' for each element of an array.
+    template <typename function_type>
+    void for_each_element(function_type fn) const {
+      assert(is_array());
+      const auto n = size();
+      auto pos = m_pos + priv_head().size;
+      for (std::size_t i = 0; i < n; ++i) {
+        fn(item(m_view, pos));
+        pos = m_view->priv_skip(pos);
+      }
+    }
+
+    /// \brief Calls 'fn(key, item)' for each key-value pair of an object.
+    /// 'key' is a std::string_view.
+    template <typename function_type>
+    void for_each_member(function_type fn) const {
+      assert(is_object());
+      const auto n = size();
+      auto pos = m_pos + priv_head().size;
+      for (std::size_t i = 0; i < n; ++i) {
+        const item key(m_view, pos);
+        pos = m_view->priv_skip(pos);
+        fn(key.as_string(), item(m_view, pos));
+        pos = m_view->priv_skip(pos);
+      }
+    }
+
+    /// \brief Accesses an array element. Takes linear time.
+    item at(const std::size_t index) const {
+      assert(is_array() && index < size());
+      auto pos = m_pos + priv_head().size;
+      for (std::size_t i = 0; i < index; ++i) {
+        pos = m_view->priv_skip(pos);
+      }
+      return item(m_view, pos);
+    }
+
+    /// \brief Finds the value associated with 'key' in an object.
+    /// Takes linear time.
+    /// \param key A key to find.
+    /// \return The found item or std::nullopt if not found.
+    std::optional<item> find(const std::string_view key) const {
+      assert(is_object());
+      const auto n = size();
+      auto pos = m_pos + priv_head().size;
+      for (std::size_t i = 0; i < n; ++i) {
+        const item k(m_view, pos);
+        pos = m_view->priv_skip(pos);
+        if (k.as_string() == key) {
+          return item(m_view, pos);
+        }
+        pos = m_view->priv_skip(pos);
+      }
+      return std::nullopt;
+    }
+
+   private:
+    friend class cbor_view;
+
+    item(const cbor_view *const view, const std::size_t pos)
+        : m_view(view), m_pos(pos) {}
+
+    std::uint8_t priv_byte() const { return m_view->m_data[m_pos]; }
+
+    jsndtl::cbor::head priv_head() const {
+      return jsndtl::cbor::read_valid_head(m_view->m_data, m_pos);
+    }
+
+    bool priv_is_stringref() const {
+      const auto hd = priv_head();
+      return hd.major == jsndtl::cbor::k_tag &&
+             hd.arg == jsndtl::cbor::k_stringref_tag;
+    }
+
+    std::size_t priv_next_pos(const std::size_t pos) const {
+      return pos + jsndtl::cbor::read_valid_head(m_view->m_data, pos).size;
+    }
+
+    const cbor_view *m_view;
+    std::size_t m_pos;
+  };
+
+ private:
+  // Validates the item at 'pos' and sets the position of the next item to
+  // 'next'. Builds the stringref table.
+  bool priv_validate(const std::size_t depth, std::size_t *const pos,
+                     const bool key) {
+    namespace cbor = jsndtl::cbor;
+    if (depth > k_max_depth) return false;
+
+    cbor::head hd{};
+    if (!read_head(m_data, m_size, *pos, &hd)) return false;
+
+    if (key && hd.major != cbor::k_text_string &&
+        !(hd.major == cbor::k_tag && hd.arg == cbor::k_stringref_tag)) {
+      return false;  // Keys must be strings
+    }
+
+    switch (hd.major) {
+      case cbor::k_unsigned:
+      case cbor::k_negative:
+        if (hd.major == cbor::k_negative &&
+            hd.arg > std::uint64_t(std::numeric_limits<std::int64_t>::max())) {
+          return false;  // Does not fit in int64
+        }
+        *pos += hd.size;
+        return true;
+
+      case cbor::k_text_string: {
+        if (hd.arg > m_size - *pos - hd.size) return false;
+        const std::string_view str(
+            reinterpret_cast<const char *>(m_data + *pos + hd.size), hd.arg);
+        if (m_in_stringref_namespace &&
+            str.size() >=
+                cbor::stringref_min_length(m_stringref_table.size())) {
+          m_stringref_table.push_back(str);
+        }
+        *pos += hd.size + hd.arg;
+        return true;
+      }
+
+      case cbor::k_array:
+        *pos += hd.size;
+        for (std::uint64_t i = 0; i < hd.arg; ++i) {
+          if (!priv_validate(depth + 1, pos, false)) return false;
+        }
+        return true;
+
+      case cbor::k_map:
+        *pos += hd.size;
+        for (std::uint64_t i = 0; i < hd.arg; ++i) {
+          if (!priv_validate(depth + 1, pos, true)) return false;
+          if (!priv_validate(depth + 1, pos, false)) return false;
+        }
+        return true;
+
+      case cbor::k_tag: {
+        *pos += hd.size;
+        if (hd.arg == cbor::k_stringref_tag) {
+          cbor::head index_hd{};
+          if (!m_in_stringref_namespace ||
+              !read_head(m_data, m_size, *pos, &index_hd) ||
+              index_hd.major != cbor::k_unsigned ||
+              index_hd.arg >= m_stringref_table.size()) {
+            return false;
+          }
+          *pos += index_hd.size;
+          return true;
+        }
+        if (depth == 0 && hd.arg == cbor::k_self_describe_tag) {
+          m_root_pos = *pos;
+          return priv_validate(depth, pos, key);
+        }
+        if (depth == 0 && hd.arg == cbor::k_stringref_namespace_tag &&
+            !m_in_stringref_namespace) {
+          // Only the namespace that covers the whole document is supported.
+          m_in_stringref_namespace = true;
+          m_root_pos = *pos;
+          return priv_validate(depth, pos, key);
+        }
+        return false;
+      }
+
+      case cbor::k_simple:
+        if (m_data[*pos] == cbor::k_float16 ||
+            m_data[*pos] == cbor::k_float32 ||
+            m_data[*pos] == cbor::k_float64 || m_data[*pos] == cbor::k_null ||
+            m_data[*pos] == cbor::k_true || m_data[*pos] == cbor::k_false) {
+          *pos += hd.size;
+          return true;
+        }
+        return false;
+
+      default:  // Byte strings cannot be represented in JSON
+        return false;
+    }
+  }
+
+  // Returns the position of the item that follows the (well-formed) item at
+  // 'pos'.
+  std::size_t priv_skip(std::size_t pos) const {
+    namespace cbor = jsndtl::cbor;
+    const auto hd = cbor::read_valid_head(m_data, pos);
+    pos += hd.size;
+    switch (hd.major) {
+      case cbor::k_text_string:
+        return pos + hd.arg;
+      case cbor::k_array:
+        for (std::uint64_t i = 0; i < hd.arg; ++i) pos = priv_skip(pos);
+        return pos;
+      case cbor::k_map:
+        for (std::uint64_t i = 0; i < hd.arg * 2; ++i) pos = priv_skip(pos);
+        return pos;
+      case cbor::k_tag:
+        return priv_skip(pos);
+      default:
+        return pos;
+    }
+  }
+
+  static constexpr std::size_t k_max_depth = 1024;
+
+  const std::uint8_t *m_data;
+  std::size_t m_size;
+  std::size_t m_root_pos{0};
+  bool m_in_stringref_namespace{false};
+  bool m_good{false};
+  std::vector<std::string_view> m_stringref_table;
+};
+
+namespace jsndtl {
+
+template <typename allocator_type>
+inline void value_from_cbor_impl(const cbor_view::item &input,
+                                 value<allocator_type> *const out_value) {
+  if (input.is_null()) {
+    out_value->emplace_null();
+  } else if (input.is_bool()) {
+    *out_value = input.as_bool();
+  } else if (input.is_int64()) {
+    *out_value = input.as_int64();
+  } else if (input.is_uint64()) {
+    *out_value = input.as_uint64();
+  } else if (input.is_double()) {
+    *out_value = input.as_double();
+  } else if (input.is_string()) {
+    const auto str = input.as_string();
+    out_value->emplace_string().assign(str.data(), str.size());
+  } else if (input.is_array()) {
+    auto &out_array = out_value->emplace_array();
+    out_array.resize(input.size());
+    std::size_t i = 0;
+    input.for_each_element([&out_array, &i](const cbor_view::item &elem) {
+      value_from_cbor_impl(elem, &out_array[i++]);
+    });
+  } else if (input.is_object()) {
+    auto &out_obj = out_value->emplace_object();
+    input.for_each_member(
+        [&out_obj](std::string_view key, const cbor_view::item &elem) {
+          value_from_cbor_impl(elem, &out_obj[key]);
+        });
+  }
+}
+
+}  // namespace jsndtl
+
+/// \brief Constructs a JSON value from CBOR-encoded data.
+/// Values are constructed directly using 'allocator'; no intermediate
+/// representation is made.
+/// \param data A pointer to encoded data.
+/// \param size The size of the encoded data in bytes.
+/// \param allocator An allocator object.
+/// \return Returns a constructed value. Returns a null value if the data is
+/// invalid.
+template <typename allocator_type = std::allocator<std::byte>>
+inline value<allocator_type> from_cbor(
+    const std::uint8_t *const data, const std::size_t size,
+    const allocator_type &allocator = allocator_type()) {
+  value<allocator_type> out_value(allocator);
+  const cbor_view view(data, size);
+  if (!view.good()) {
+    return out_value;
+  }
+  jsndtl::value_from_cbor_impl(view.root(), &out_value);
+  return out_value;
+}
+
+/// \brief Constructs a JSON value from CBOR-encoded data.
+/// \param data Encoded data.
+/// \param allocator An allocator object.
+/// \return Returns a constructed value. Returns a null value if the data is
+/// invalid.
+template <typename allocator_type = std::allocator<std::byte>>
+inline value<allocator_type> from_cbor(
+    const std::vector<std::uint8_t> &data,
+    const allocator_type &allocator = allocator_type()) {
+  return from_cbor(data.data(), data.size(), allocator);
+}
+
+}  // namespace metall::json
+
+#endif  // METALL_JSON_CBOR_HPP
@@ -0,0 +1,317 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_JSON_DETAILS_ADAPTIVE_OBJECT_HPP
+#define METALL_JSON_DETAILS_ADAPTIVE_OBJECT_HPP
+
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <cassert>
+
+#include <metall/json/json_fwd.hpp>
+#include <metall/container/scoped_allocator.hpp>
+#include <metall/container/vector.hpp>
+#include <metall/json/details/flat_index.hpp>
+
+namespace metall::json::jsndtl {
+
+namespace {
+namespace mc = metall::container;
+}
+
+// Forward declarations
+template <typename Alloc = std::allocator<std::byte>>
+class adaptive_object;
+
+/// \brief JSON object implementation.
+/// Starts as a compact object, i.e., a vector of key-value pairs searched
+/// linearly, and builds a hash index (flat_index) once the number of
+/// key-value pairs exceeds k_index_threshold. The index is dropped again when
+/// the number of key-value pairs falls to half of the threshold.
+/// Thus, small objects use as little memory as compact_object, and large
+/// objects are looked up as fast as flat_indexed_object.
+/// The number of key-value pairs in an object is limited to 2^32 - 1.
+template <typename Alloc>
+class adaptive_object {
+ public:
+  using allocator_type = Alloc;
+  using value_type =
+      key_value_pair<char, std::char_traits<char>, allocator_type>;
+  using key_type = std::basic_string_view<
+      char, std::char_traits<char>>;          // typename value_type::key_type;
+  using mapped_type = value<allocator_type>;  // typename
+                                              // value_type::value_type;
+
+ private:
+  template <typename alloc, typename T>
+  using other_scoped_allocator = mc::scoped_allocator_adaptor<
+      typename std::allocator_traits<alloc>::template rebind_alloc<T>>;
+
+  using value_storage_alloc_type =
+      other_scoped_allocator<allocator_type, value_type>;
+  using value_storage_type = mc::vector<value_type, value_storage_alloc_type>;
+
+  // Value: the position of the corresponding item in the value_storage
+  using value_postion_type = typename value_storage_type::size_type;
+
+  using index_type = flat_index<allocator_type>;
+
+ public:
+  using iterator = typename value_storage_type::iterator;
+  using const_iterator = typename value_storage_type::const_iterator;
+
+  /// \brief The number of key-value pairs above which the index is built.
+  static constexpr std::size_t k_index_threshold = 8;
+
+  /// \brief Constructor.
+  adaptive_object() {}
+
+  /// \brief Constructor.
+  /// \param alloc An allocator object.
+  explicit adaptive_object(const allocator_type &alloc)
+      : m_index(alloc), m_value_storage(alloc) {}
+
+  /// \brief Copy constructor
+  adaptive_object(const adaptive_object &) = default;
+
+  /// \brief Allocator-extended copy constructor
+  adaptive_object(const adaptive_object &other,
+                  const allocator_type &alloc)
+      : m_index(other.m_index, alloc),
+        m_value_storage(other.m_value_storage, alloc) {}
+
+  /// \brief Move constructor
+  adaptive_object(adaptive_object &&) noexcept = default;
+
+  /// \brief Allocator-extended move constructor
+  adaptive_object(adaptive_object &&other,
+                  const allocator_type &alloc) noexcept
+      : m_index(std::move(other.m_index), alloc),
+        m_value_storage(std::move(other.m_value_storage), alloc) {}
+
+  /// \brief Copy assignment operator
+  adaptive_object &operator=(const adaptive_object &) = default;
+
+  /// \brief Move assignment operator
+  adaptive_object &operator=(adaptive_object &&) noexcept = default;
+
+  /// \brief Swap contents.
+  void swap(adaptive_object &other) noexcept {
+    using std::swap;
+    m_index.swap(other.m_index);
+    swap(m_value_storage, other.m_value_storage);
+  }
+
+  /// \brief Access a mapped value with a key.
+  /// If there is no mapped value that is associated with 'key', allocates it
+  /// first. \param key The key of the mapped value to access. \return A
+  /// reference to the mapped value associated with 'key'.
+  mapped_type &operator[](const key_type &key) {
+    const auto pos = priv_locate_value(key);
+    if (pos < m_value_storage.max_size()) {
+      return m_value_storage[pos].value();
+    }
+
+    const auto emplaced_pos =
+        priv_emplace_value(key, mapped_type{m_value_storage.get_allocator()});
+    return m_value_storage[emplaced_pos].value();
+  }
+
+  /// \brief Access a mapped value.
+  /// \param key The key of the mapped value to access.
+  /// \return A reference to the mapped value associated with 'key'.
+  const mapped_type &operator[](const key_type &key) const {
+    return m_value_storage[priv_locate_value(key)].value();
+  }
+
+  /// \brief Return true if the key is found.
+  /// \return True if found; otherwise, false.
+  bool contains(const key_type &key) const { return count(key) > 0; }
+
+  /// \brief Count the number of elements with a specific key.
+  /// \return The number elements with a specific key.
+  std::size_t count(const key_type &key) const {
+    const auto pos = priv_locate_value(key);
+    return pos < m_value_storage.max_size() ? 1 : 0;
+  }
+
+  /// \brief Access a mapped value.
+  /// \param key The key of the mapped value to access.
+  /// \return A reference to the mapped value associated with 'key'.
+  mapped_type &at(const key_type &key) {
+    return m_value_storage[priv_locate_value(key)].value();
+  }
+
+  /// \brief Access a mapped value.
+  /// \param key The key of the mapped value to access.
+  /// \return A reference to the mapped value associated with 'key'.
+  const mapped_type &at(const key_type &key) const {
+    return m_value_storage[priv_locate_value(key)].value();
+  }
+
+  iterator find(const key_type &key) {
+    const auto pos = priv_locate_value(key);
+    if (pos < m_value_storage.max_size()) {
+      return m_value_storage.begin() + pos;
+    }
+    return m_value_storage.end();
+  }
+
+  const_iterator find(const key_type &key) const {
+    const auto pos = priv_locate_value(key);
+    if (pos < m_value_storage.max_size()) {
+      return m_value_storage.cbegin() + pos;
+    }
+    return m_value_storage.cend();
+  }
+
+  /// \brief Returns an iterator that is at the beginning of the objects.
+  /// \return An iterator that is at the beginning of the objects.
+  iterator begin() { return m_value_storage.begin(); }
+
+  /// \brief Returns an iterator that is at the beginning of the objects.
+  /// \return A const iterator that is at the beginning of the objects.
+  const_iterator begin() const { return m_value_storage.begin(); }
+
+  /// \brief Returns an iterator that is at the end of the objects.
+  /// \return An iterator that is at the end of the objects.
+  iterator end() { return m_value_storage.end(); }
+
+  /// \brief Returns an iterator that is at the end of the objects.
+  /// \return A const iterator that is at the end of the objects.
+  const_iterator end() const { return m_value_storage.end(); }
+
+  /// \brief Returns the number of key-value pairs.
+  /// \return The number of key-values pairs.
+  std::size_t size() const { return m_value_storage.size(); }
+
+  /// \brief Returns the number of slots in the index table.
+  /// \return The number of slots in the index table; 0 if the object has no
+  /// index.
+  std::size_t index_capacity() const { return m_index.capacity(); }
+
+  /// \brief Returns true if the object uses the index for lookups.
+  /// \return True if the object has an index; otherwise, false.
+  bool indexed() const { return !m_index.empty(); }
+
+  /// \brief Erases the element at 'position'.
+  /// \param position The position of the element to erase.
+  /// \return Iterator following the removed element.
+  /// If 'position' refers to the last element, then the end() iterator is
+  /// returned.
+  iterator erase(iterator position) { return priv_erase(position); }
+
+  /// \brief Erases the element at 'position'.
+  /// \param position The position of the element to erase.
+  /// \return Iterator following the removed element.
+  /// If 'position' refers to the last element, then the end() iterator is
+  /// returned.
+  iterator erase(const_iterator position) { return priv_erase(position); }
+
+  /// \brief Erases the element associated with 'key'.
+  /// \param key The key of the element to erase.
+  /// \return Iterator following the removed element.
+  /// If 'position' refers to the last element, then the end() iterator is
+  /// returned.
+  iterator erase(const key_type &key) { return erase(find(key)); }
+
+  /// \brief Return `true` if two objects are equal.
+  /// \param lhs An object to compare.
+  /// \param rhs An object to compare.
+  /// \return True if two objects are equal. Otherwise, false.
+  friend bool operator==(const adaptive_object &lhs,
+                         const adaptive_object &rhs) noexcept {
+    return jsndtl::general_flat_index_object_equal(lhs, rhs);
+  }
+
+  /// \brief Return `true` if two objects are not equal.
+  /// \param lhs An object to compare.
+  /// \param rhs An object to compare.
+  /// \return True if two objects are not equal. Otherwise, false.
+  friend bool operator!=(const adaptive_object &lhs,
+                         const adaptive_object &rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  /// \brief Return an allocator object.
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(m_value_storage.get_allocator());
+  }
+
+ private:
+  value_postion_type priv_locate_value(const key_type &key) const {
+    if (m_index.empty()) {
+      for (value_postion_type i = 0; i < m_value_storage.size(); ++i) {
+        if (m_value_storage[i].key() == key) {
+          return i;  // Found the key
+        }
+      }
+      return m_value_storage.max_size();  // Couldn't find
+    }
+    return m_index.find(key, m_value_storage);
+  }
+
+  value_postion_type priv_emplace_value(const key_type &key,
+                                        mapped_type &&mapped_value) {
+    assert(m_value_storage.size() < std::numeric_limits<std::uint32_t>::max());
+    m_value_storage.emplace_back(key, std::move(mapped_value));
+    const auto position = m_value_storage.size() - 1;
+
+    if (m_index.empty()) {
+      if (m_value_storage.size() > k_index_threshold) {
+        m_index.rebuild(index_type::capacity_for(m_value_storage.size()),
+                        m_value_storage);
+      }
+    } else if (m_index.overloaded(m_value_storage.size())) {
+      m_index.rebuild(m_index.capacity() * 2, m_value_storage);
+    } else {
+      m_index.insert(index_type::hash_key(key), position);
+    }
+    return position;
+  }
+
+  auto priv_erase(const_iterator value_position) {
+    if (value_position == m_value_storage.cend()) {
+      return m_value_storage.end();
+    }
+
+    const auto value_position_raw =
+        std::distance(m_value_storage.cbegin(), value_position);
+    m_value_storage.erase(value_position);
+
+    if (m_index.empty()) {
+      return m_value_storage.begin() + value_position_raw;
+    }
+
+    // The positions of the values after the erased one are shifted;
+    // rebuild the index instead of repairing each probe sequence.
+    if (m_value_storage.size() <= k_index_threshold / 2) {
+      m_index.clear();
+    } else {
+      m_index.rebuild(m_index.capacity(), m_value_storage);
+    }
+
+    return m_value_storage.begin() + value_position_raw;
+  }
+
+  index_type m_index{allocator_type{}};
+  value_storage_type m_value_storage{allocator_type{}};
+};
+
+/// \brief Swap value instances.
+template <typename allocator_type>
+inline void swap(adaptive_object<allocator_type> &lhd,
+                 adaptive_object<allocator_type> &rhd) noexcept {
+  lhd.swap(rhd);
+}
+
+}  // namespace metall::json::jsndtl
+
+#endif  // METALL_JSON_DETAILS_ADAPTIVE_OBJECT_HPP
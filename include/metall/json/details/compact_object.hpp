@@ -220,7 +220,7 @@ class compact_object {
 
   /// \brief Return an allocator object.
   allocator_type get_allocator() const noexcept {
-    return m_value_storage.get_allovator();
+    return allocator_type(m_value_storage.get_allocator());
   }
 
  private:
@@ -0,0 +1,199 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_JSON_DETAILS_FLAT_INDEX_HPP
+#define METALL_JSON_DETAILS_FLAT_INDEX_HPP
+
+#include <memory>
+#include <utility>
+#include <string_view>
+#include <cstdint>
+#include <cassert>
+
+#include <metall/container/vector.hpp>
+#include <metall/utility/hash.hpp>
+
+namespace metall::json::jsndtl {
+
+namespace {
+namespace mc = metall::container;
+}
+
+/// \brief An open-addressing hash index (linear probing) over a vector of
+/// key-value pairs, used by flat_indexed_object and adaptive_object.
+/// Each slot holds a 32-bit hash tag and a 32-bit position of the
+/// key-value pair; thus, a lookup usually touches one or two cache lines and
+/// the index costs a single allocation.
+/// The index does not own the key-value pairs; the owner passes them to the
+/// functions that need them and keeps the index in sync.
+/// The number of key-value pairs is limited to 2^32 - 1.
+template <typename Alloc>
+class flat_index {
+ public:
+  using allocator_type = Alloc;
+  using key_type = std::basic_string_view<char, std::char_traits<char>>;
+
+  /// \brief The minimum number of slots of a non-empty index.
+  static constexpr std::size_t k_min_capacity = 8;
+
+ private:
+  struct slot_type {
+    // Upper 32 bits of the hash value of the key; 0 means empty.
+    std::uint32_t tag;
+    // The position of the corresponding key-value pair
+    std::uint32_t position;
+  };
+  using table_allocator_type = typename std::allocator_traits<
+      allocator_type>::template rebind_alloc<slot_type>;
+  using table_type = mc::vector<slot_type, table_allocator_type>;
+
+  static constexpr std::uint32_t k_empty_tag = 0;
+
+ public:
+  /// \brief Constructor.
+  flat_index() {}
+
+  /// \brief Constructor.
+  /// \param alloc An allocator object.
+  explicit flat_index(const allocator_type &alloc) : m_table(alloc) {}
+
+  /// \brief Copy constructor
+  flat_index(const flat_index &) = default;
+
+  /// \brief Allocator-extended copy constructor
+  flat_index(const flat_index &other, const allocator_type &alloc)
+      : m_table(other.m_table, alloc) {}
+
+  /// \brief Move constructor
+  flat_index(flat_index &&) noexcept = default;
+
+  /// \brief Allocator-extended move constructor
+  flat_index(flat_index &&other, const allocator_type &alloc) noexcept
+      : m_table(std::move(other.m_table), alloc) {}
+
+  /// \brief Copy assignment operator
+  flat_index &operator=(const flat_index &) = default;
+
+  /// \brief Move assignment operator
+  flat_index &operator=(flat_index &&) noexcept = default;
+
+  /// \brief Swap contents.
+  void swap(flat_index &other) noexcept {
+    using std::swap;
+    swap(m_table, other.m_table);
+  }
+
+  /// \brief Returns the number of slots.
+  std::size_t capacity() const { return m_table.size(); }
+
+  /// \brief Returns true if the index has no slots.
+  bool empty() const { return m_table.empty(); }
+
+  /// \brief Returns true if holding 'num_values' key-value pairs exceeds the
+  /// maximum load factor (7/8).
+  bool overloaded(const std::size_t num_values) const {
+    return num_values * 8 > m_table.size() * 7;
+  }
+
+  /// \brief Returns the smallest capacity that holds 'num_values' key-value
+  /// pairs without exceeding the maximum load factor.
+  static std::size_t capacity_for(const std::size_t num_values) {
+    std::size_t capacity = k_min_capacity;
+    while (num_values * 8 > capacity * 7) capacity *= 2;
+    return capacity;
+  }
+
+  /// \brief Hash function used for keys.
+  static std::uint64_t hash_key(const key_type &key) {
+    return metall::mtlldetail::murmur_hash_64a(key.data(), key.length(), 123);
+  }
+
+  /// \brief Finds the position of the key-value pair associated with 'key'.
+  /// \param key A key to find.
+  /// \param values The key-value pairs indexed by this index.
+  /// \return The position of the key-value pair in 'values'; values.max_size()
+  /// if not found or the index is empty.
+  template <typename value_storage_type>
+  typename value_storage_type::size_type find(
+      const key_type &key, const value_storage_type &values) const {
+    if (m_table.empty()) {
+      return values.max_size();
+    }
+
+    const auto hash = hash_key(key);
+    const auto tag = hash_tag(hash);
+    const std::size_t mask = m_table.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+      const auto &slot = m_table[i];
+      if (slot.tag == k_empty_tag) break;
+      if (slot.tag == tag && values[slot.position].key() == key) {
+        return slot.position;  // Found the key
+      }
+    }
+    return values.max_size();  // Couldn't find
+  }
+
+  /// \brief Inserts a position of a key-value pair.
+  /// The index must have a free slot.
+  /// \param hash The hash value of the key, given by hash_key().
+  /// \param position The position of the key-value pair.
+  void insert(const std::uint64_t hash, const std::size_t position) {
+    assert(!m_table.empty());
+    const std::size_t mask = m_table.size() - 1;
+    std::size_t i = hash & mask;
+    while (m_table[i].tag != k_empty_tag) {
+      i = (i + 1) & mask;
+    }
+    m_table[i].tag = hash_tag(hash);
+    m_table[i].position = static_cast<std::uint32_t>(position);
+  }
+
+  /// \brief Rebuilds the index with 'capacity' slots.
+  /// \param capacity The number of slots. Must be a power of 2 that is larger
+  /// than the number of key-value pairs.
+  /// \param values The key-value pairs to index.
+  template <typename value_storage_type>
+  void rebuild(const std::size_t capacity, const value_storage_type &values) {
+    assert(capacity > values.size());
+    assert((capacity & (capacity - 1)) == 0);
+    m_table.assign(capacity, slot_type{k_empty_tag, 0});
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      insert(hash_key(values[i].key()), i);
+    }
+  }
+
+  /// \brief Removes all slots and releases the memory.
+  void clear() { table_type(m_table.get_allocator()).swap(m_table); }
+
+ private:
+  static std::uint32_t hash_tag(const std::uint64_t hash) {
+    const auto tag = static_cast<std::uint32_t>(hash >> 32ULL);
+    return (tag == k_empty_tag) ? 1 : tag;
+  }
+
+  table_type m_table{allocator_type{}};
+};
+
+/// \brief Provides 'equal' calculation for object types that look up
+/// key-value pairs with find(), such as flat_indexed_object and
+/// adaptive_object.
+template <typename object_type, typename other_object_type>
+inline bool general_flat_index_object_equal(
+    const object_type &object,
+    const other_object_type &other_object) noexcept {
+  if (object.size() != other_object.size()) return false;
+
+  for (const auto &key_value : object) {
+    auto itr = other_object.find(key_value.key_c_str());
+    if (itr == other_object.end()) return false;
+    if (key_value.value() != itr->value()) return false;
+  }
+
+  return true;
+}
+
+}  // namespace metall::json::jsndtl
+
+#endif  // METALL_JSON_DETAILS_FLAT_INDEX_HPP
@@ -3,8 +3,8 @@
 //
 // SPDX-License-Identifier: (Apache-2.0 OR MIT)
 
-#ifndef METALL_CONTAINER_EXPERIMENT_JSON_DETAILS_INDEXED_OBJECT_HPP
-#define METALL_CONTAINER_EXPERIMENT_JSON_DETAILS_INDEXED_OBJECT_HPP
+#ifndef METALL_JSON_DETAILS_INDEXED_OBJECT_HPP
+#define METALL_JSON_DETAILS_INDEXED_OBJECT_HPP
 
 #include <iostream>
 #include <memory>
@@ -18,7 +18,7 @@
 #include <metall/container/vector.hpp>
 #include <metall/utility/hash.hpp>
 
-namespace metall::container::experimental::json::jsndtl {
+namespace metall::json::jsndtl {
 
 namespace {
 namespace mc = metall::container;
@@ -84,7 +84,7 @@ class indexed_object {
 
   /// \brief Allocator-extended copy constructor
   indexed_object(const indexed_object &other, const allocator_type &alloc)
-      : m_index_table(other.m_value_storage, alloc),
+      : m_index_table(other.m_index_table, alloc),
         m_value_storage(other.m_value_storage, alloc) {}
 
   /// \brief Move constructor
@@ -232,8 +232,7 @@ class indexed_object {
 
   /// \brief Return an allocator object.
   allocator_type get_allocator() const noexcept {
-    assert(m_index_table.get_allovator() == m_value_storage.m_index_table());
-    return m_index_table.get_allovator();
+    return allocator_type(m_value_storage.get_allocator());
   }
 
  private:
@@ -256,7 +255,7 @@ class indexed_object {
   }
 
   static auto hash_key(const key_type &key) {
-    return metall::mtlldetail::MurmurHash64A(key.data(), key.length(), 123);
+    return metall::mtlldetail::murmur_hash_64a(key.data(), key.length(), 123);
   }
 
   auto priv_erase(const_iterator value_position) {
@@ -317,6 +316,6 @@ inline bool general_indexed_object_equal(
   return true;
 }
 
-}  // namespace metall::container::experimental::json::jsndtl
+}  // namespace metall::json::jsndtl
 
-#endif  // METALL_CONTAINER_EXPERIMENT_JSON_DETAILS_INDEXED_OBJECT_HPP
+#endif  // METALL_JSON_DETAILS_INDEXED_OBJECT_HPP
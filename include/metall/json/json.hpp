@@ -19,6 +19,8 @@
 #include <metall/json/value_to.hpp>
 #include <metall/json/object.hpp>
 #include <metall/json/equal.hpp>
+#include <metall/json/query.hpp>
+#include <metall/json/cbor.hpp>
 
 /// \example json_create.cpp
 /// This is an example of how to create a JSON object with Metall.
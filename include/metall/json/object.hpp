@@ -6,21 +6,38 @@
 #ifndef METALL_OBJECT_HPP
 #define METALL_OBJECT_HPP
 
+#include <metall/defs.hpp>
 #include <metall/json/json_fwd.hpp>
+#ifdef METALL_JSON_USE_ADAPTIVE_OBJECT
+#include <metall/json/details/adaptive_object.hpp>
+#else
 #include <metall/json/details/compact_object.hpp>
+#endif
 
 namespace metall::json {
 
+namespace jsndtl {
+#ifdef METALL_JSON_USE_ADAPTIVE_OBJECT
+template <typename allocator_type>
+using object_base = adaptive_object<allocator_type>;
+#else
+template <typename allocator_type>
+using object_base = compact_object<allocator_type>;
+#endif
+}  // namespace jsndtl
+
 /// \brief JSON object.
 /// An object is a table key and value pairs.
 /// The order of key-value pairs depends on the implementation.
+/// If METALL_JSON_USE_ADAPTIVE_OBJECT is defined, an object builds a hash index
+/// once it holds more than a few key-value pairs.
 #ifdef DOXYGEN_SKIP
 template <typename allocator_type = std::allocator<std::byte>>
 #else
 template <typename allocator_type>
 #endif
-class object : public jsndtl::compact_object<allocator_type> {
-  using jsndtl::compact_object<allocator_type>::compact_object;
+class object : public jsndtl::object_base<allocator_type> {
+  using jsndtl::object_base<allocator_type>::object_base;
 };
 
 /// \brief Swap value instances.
@@ -38,7 +55,11 @@ template <typename allocator_type, typename other_object_type>
 inline bool general_object_equal(
     const object<allocator_type> &object,
     const other_object_type &other_object) noexcept {
+#ifdef METALL_JSON_USE_ADAPTIVE_OBJECT
+  return general_flat_index_object_equal(object, other_object);
+#else
   return general_compact_object_equal(object, other_object);
+#endif
 }
 
 }  // namespace jsndtl
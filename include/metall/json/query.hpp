@@ -0,0 +1,336 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_JSON_QUERY_HPP
+#define METALL_JSON_QUERY_HPP
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+#include <metall/json/json_fwd.hpp>
+#include <metall/utility/open_mp.hpp>
+
+namespace metall::json {
+
+/// \brief A compiled path expression to locate values in a JSON value.
+/// Two notations are accepted:
+/// JSON Pointer (RFC 6901), e.g., "/store/book/0/title",
+/// and a subset of JSONPath, e.g., "$.store.book[0].title",
+/// "$.store.book[*].title", or "$['store']['book']".
+/// The empty string and "$" refer to the root value.
+/// A path is a transient object and does not allocate persistent memory.
+class path {
+ public:
+  /// \brief The kinds of steps in a path.
+  enum class step_kind {
+    /// Object member access; also used as an array index by JSON Pointer if
+    /// the key is a non-negative integer.
+    key,
+    /// Array element access.
+    index,
+    /// All members of an object or all elements of an array.
+    wildcard
+  };
+
+  /// \brief A single step in a path.
+  struct step {
+    step_kind kind;
+    std::string key;
+    std::size_t index;
+  };
+
+  /// \brief Constructor. Constructs a path that refers to the root value.
+  path() = default;
+
+  /// \brief Constructor.
+  /// \param expression A JSON Pointer or JSONPath expression.
+  /// If 'expression' is invalid, good() returns false.
+  explicit path(std::string_view expression) {
+    m_good = priv_parse(expression);
+    if (!m_good) {
+      std::cerr << "Failed to parse path: " << expression << std::endl;
+      m_steps.clear();
+    }
+  }
+
+  /// \brief Returns true if the path was constructed successfully.
+  /// \return True if the path is valid; otherwise, false.
+  bool good() const noexcept { return m_good; }
+
+  /// \brief Returns the parsed steps.
+  /// \return A const reference to the steps.
+  const std::vector<step> &steps() const noexcept { return m_steps; }
+
+  /// \brief Returns true if the path may locate more than one value.
+  /// \return True if the path contains a wildcard; otherwise, false.
+  bool has_wildcard() const noexcept {
+    for (const auto &s : m_steps) {
+      if (s.kind == step_kind::wildcard) return true;
+    }
+    return false;
+  }
+
+  /// \brief Converts a string to an array index.
+  /// Follows the JSON Pointer rule, i.e., no leading zeros or signs.
+  /// \param str A string to convert.
+  /// \param index A pointer to store the converted index.
+  /// \return True on success; otherwise, false.
+  static bool to_index(std::string_view str, std::size_t *const index) {
+    if (str.empty() || (str.size() > 1 && str[0] == '0')) return false;
+    std::size_t n = 0;
+    for (const char c : str) {
+      if (c < '0' || c > '9') return false;
+      if (n > (std::numeric_limits<std::size_t>::max() - (c - '0')) / 10)
+        return false;
+      n = n * 10 + (c - '0');
+    }
+    *index = n;
+    return true;
+  }
+
+ private:
+  bool priv_parse(std::string_view expr) {
+    if (expr.empty()) return true;
+    if (expr[0] == '/') return priv_parse_pointer(expr);
+    if (expr[0] == '$') return priv_parse_json_path(expr.substr(1));
+    return false;
+  }
+
+  bool priv_parse_pointer(std::string_view expr) {
+    while (!expr.empty()) {
+      assert(expr[0] == '/');
+      expr.remove_prefix(1);
+      const auto len = std::min(expr.find('/'), expr.size());
+      std::string key;
+      for (std::size_t i = 0; i < len; ++i) {
+        if (expr[i] != '~') {
+          key.push_back(expr[i]);
+        } else if (i + 1 < len && expr[i + 1] == '0') {
+          key.push_back('~');
+          ++i;
+        } else if (i + 1 < len && expr[i + 1] == '1') {
+          key.push_back('/');
+          ++i;
+        } else {
+          return false;  // Invalid escape sequence
+        }
+      }
+      m_steps.push_back(step{step_kind::key, std::move(key), 0});
+      expr.remove_prefix(len);
+    }
+    return true;
+  }
+
+  bool priv_parse_json_path(std::string_view expr) {
+    while (!expr.empty()) {
+      if (expr[0] == '.') {
+        expr.remove_prefix(1);
+        const auto len = std::min(expr.find_first_of(".["), expr.size());
+        if (len == 0) return false;
+        if (expr.substr(0, len) == "*") {
+          m_steps.push_back(step{step_kind::wildcard, {}, 0});
+        } else {
+          m_steps.push_back(
+              step{step_kind::key, std::string(expr.substr(0, len)), 0});
+        }
+        expr.remove_prefix(len);
+      } else if (expr[0] == '[') {
+        const auto close = expr.find(']');
+        if (close == std::string_view::npos) return false;
+        const auto body = expr.substr(1, close - 1);
+        if (body == "*") {
+          m_steps.push_back(step{step_kind::wildcard, {}, 0});
+        } else if (body.size() >= 2 && (body.front() == '\'' ||
+                                        body.front() == '"') &&
+                   body.back() == body.front()) {
+          m_steps.push_back(step{
+              step_kind::key, std::string(body.substr(1, body.size() - 2)),
+              0});
+        } else {
+          std::size_t index = 0;
+          if (!to_index(body, &index)) return false;
+          m_steps.push_back(step{step_kind::index, {}, index});
+        }
+        expr.remove_prefix(close + 1);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<step> m_steps{};
+  bool m_good{true};
+};
+
+namespace jsndtl {
+
+/// \brief Visits every value located by steps[pos, steps.size()) starting from
+/// 'jv'. 'visitor' receives a reference to each value and returns false to
+/// stop the traversal.
+/// \return False if the traversal was stopped by 'visitor'; otherwise, true.
+template <typename value_type, typename visitor_type>
+inline bool visit_path(value_type &jv, const std::vector<path::step> &steps,
+                       const std::size_t pos, visitor_type &visitor) {
+  if (pos == steps.size()) return visitor(jv);
+
+  const auto &s = steps[pos];
+  if (s.kind == path::step_kind::wildcard) {
+    if (jv.is_object()) {
+      for (auto &elem : jv.as_object()) {
+        if (!visit_path(elem.value(), steps, pos + 1, visitor)) return false;
+      }
+    } else if (jv.is_array()) {
+      for (auto &elem : jv.as_array()) {
+        if (!visit_path(elem, steps, pos + 1, visitor)) return false;
+      }
+    }
+    return true;
+  }
+
+  if (jv.is_object() && s.kind == path::step_kind::key) {
+    auto &obj = jv.as_object();
+    auto itr = obj.find(s.key);
+    if (itr == obj.end()) return true;
+    return visit_path(itr->value(), steps, pos + 1, visitor);
+  }
+
+  if (jv.is_array()) {
+    std::size_t index = s.index;
+    if (s.kind == path::step_kind::key && !path::to_index(s.key, &index)) {
+      return true;
+    }
+    auto &arr = jv.as_array();
+    if (index >= arr.size()) return true;
+    return visit_path(arr[index], steps, pos + 1, visitor);
+  }
+
+  return true;
+}
+
+template <typename value_type>
+inline value_type *find_first(value_type &jv, const path &p) {
+  value_type *found = nullptr;
+  auto visitor = [&found](value_type &v) {
+    found = &v;
+    return false;
+  };
+  visit_path(jv, p.steps(), 0, visitor);
+  return found;
+}
+
+}  // namespace jsndtl
+
+/// \brief Locates a value by a JSON Pointer or JSONPath expression.
+/// No data is copied.
+/// If the path contains wildcards, returns the first value found.
+/// \param jv A JSON value to search.
+/// \param expression A path expression.
+/// \return A pointer to the located value or nullptr if not found or
+/// 'expression' is invalid.
+template <typename allocator_type>
+inline const value<allocator_type> *find_pointer(
+    const value<allocator_type> &jv, std::string_view expression) {
+  const path p(expression);
+  if (!p.good()) return nullptr;
+  return jsndtl::find_first(jv, p);
+}
+
+/// \brief Locates a value by a JSON Pointer or JSONPath expression.
+/// No data is copied.
+/// If the path contains wildcards, returns the first value found.
+/// \param jv A JSON value to search.
+/// \param expression A path expression.
+/// \return A pointer to the located value or nullptr if not found or
+/// 'expression' is invalid.
+template <typename allocator_type>
+inline value<allocator_type> *find_pointer(value<allocator_type> &jv,
+                                           std::string_view expression) {
+  const path p(expression);
+  if (!p.good()) return nullptr;
+  return jsndtl::find_first(jv, p);
+}
+
+/// \brief Locates all values matched by a path.
+/// \param jv A JSON value to search.
+/// \param p A compiled path.
+/// \return Pointers to the matched values, in the traversal order.
+template <typename allocator_type>
+inline std::vector<const value<allocator_type> *> query(
+    const value<allocator_type> &jv, const path &p) {
+  std::vector<const value<allocator_type> *> results;
+  if (!p.good()) return results;
+  auto visitor = [&results](const value<allocator_type> &v) {
+    results.push_back(&v);
+    return true;
+  };
+  jsndtl::visit_path(jv, p.steps(), 0, visitor);
+  return results;
+}
+
+/// \brief Projects every element of an array through a path, in parallel if
+/// OpenMP is enabled.
+/// If the path contains wildcards, the first value found for each element is
+/// returned.
+/// \param arr An array to project.
+/// \param p A compiled path, which is applied to each element of 'arr'.
+/// \return A vector whose i-th item points to the value located from 'arr[i]',
+/// or nullptr if nothing was located.
+template <typename allocator_type>
+inline std::vector<const value<allocator_type> *> project(
+    const array<allocator_type> &arr, const path &p) {
+  const std::size_t size = arr.size();
+  std::vector<const value<allocator_type> *> results(size, nullptr);
+  if (!p.good()) return results;
+
+  OMP_DIRECTIVE(parallel for schedule(static))
+  for (std::size_t i = 0; i < size; ++i) {
+    results[i] = jsndtl::find_first(arr[i], p);
+  }
+  return results;
+}
+
+/// \brief Selects the elements of an array for which 'pred' returns true for
+/// a value located by a path, in parallel if OpenMP is enabled.
+/// \tparam predicate_type A predicate type that takes a const reference to a
+/// JSON value and returns a bool. Must be safe to call concurrently.
+/// \param arr An array to select elements from.
+/// \param p A compiled path, which is applied to each element of 'arr'.
+/// \param pred A predicate.
+/// \return The indices of the selected elements, in ascending order.
+template <typename allocator_type, typename predicate_type>
+inline std::vector<std::size_t> select(const array<allocator_type> &arr,
+                                       const path &p, predicate_type pred) {
+  const std::size_t size = arr.size();
+  std::vector<std::size_t> results;
+  if (!p.good()) return results;
+
+  std::vector<unsigned char> selected(size, 0);
+  OMP_DIRECTIVE(parallel for schedule(static))
+  for (std::size_t i = 0; i < size; ++i) {
+    auto visitor = [&pred, &selected, i](const value<allocator_type> &v) {
+      if (!pred(v)) return true;
+      selected[i] = 1;
+      return false;
+    };
+    jsndtl::visit_path(arr[i], p.steps(), 0, visitor);
+  }
+
+  for (std::size_t i = 0; i < size; ++i) {
+    if (selected[i]) results.push_back(i);
+  }
+  return results;
+}
+
+}  // namespace metall::json
+
+#endif  // METALL_JSON_QUERY_HPP
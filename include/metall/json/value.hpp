@@ -74,6 +74,10 @@ inline bool general_value_equal(const value<allocator_type> &value,
 /// \brief JSON value.
 /// A container that holds a single bool, int64, uint64, double, JSON string,
 /// JSON array, or JSON object.
+/// Short strings (up to string_type's internal buffer size, e.g., 22 chars
+/// with 64-bit pointers) are stored inline without allocating memory.
+/// Assigning a string to a value that already holds a string reuses its
+/// storage.
 #ifdef DOXYGEN_SKIP
 template <typename Alloc = std::allocator<std::byte>>
 #else
@@ -171,7 +175,7 @@ class value {
     } else if (other.is_array()) {
       emplace_array() = other.as_array();
     } else if (other.is_string()) {
-      emplace_string() = other.as_string();
+      priv_string_for_assign() = other.as_string();
     } else {
       m_data = other.m_data;
     }
@@ -305,21 +309,21 @@ class value {
   /// \brief Assign a std::string_view value.
   /// Allocates a memory storage or destroy the old content, if necessary.
   value &operator=(std::string_view s) {
-    emplace_string() = s.data();
+    priv_string_for_assign().assign(s.data(), s.size());
     return *this;
   }
 
   /// \brief Assign a const char* value.
   /// Allocates a memory storage or destroy the old content, if necessary.
   value &operator=(const char *const s) {
-    emplace_string() = s;
+    priv_string_for_assign() = s;
     return *this;
   }
 
   /// \brief Assign a string_type value.
   /// Allocates a memory storage or destroy the old content, if necessary.
   value &operator=(const string_type &s) {
-    emplace_string() = s;
+    priv_string_for_assign() = s;
     return *this;
   }
 
@@ -530,6 +534,13 @@ class value {
     return true;
   }
 
+  /// \brief Returns the held string so that its storage can be reused;
+  /// otherwise, emplaces an empty string.
+  string_type &priv_string_for_assign() {
+    if (is_string()) return as_string();
+    return emplace_string();
+  }
+
   allocator_type m_allocator{allocator_type{}};
   internal_data_type m_data{null_type{}};
 };
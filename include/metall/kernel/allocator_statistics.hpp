@@ -0,0 +1,283 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_KERNEL_ALLOCATOR_STATISTICS_HPP
+#define METALL_KERNEL_ALLOCATOR_STATISTICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <functional>
+
+#include <metall/detail/proc.hpp>
+#include <metall/detail/hash.hpp>
+
+namespace metall {
+namespace kernel {
+
+namespace {
+namespace mdtl = metall::mtlldetail;
+}
+
+/// \brief A snapshot of the allocator statistics.
+/// Counters are runtime values since the datastore was created or opened,
+/// except for bytes_in_use, which also includes the objects that were
+/// allocated before the datastore was opened.
+struct allocator_statistics {
+  /// \brief Statistics of a bin (an internal object size class).
+  struct bin_statistics {
+    std::size_t object_size{0};
+    std::uint64_t num_allocations{0};
+    std::uint64_t num_deallocations{0};
+  };
+
+  /// \brief Statistics of each bin, indexed by bin number.
+  std::vector<bin_statistics> bins;
+
+  std::uint64_t num_allocations{0};
+  std::uint64_t num_deallocations{0};
+  /// \brief The number of objects resized by expand/shrink in place.
+  /// Resized objects are counted in the bins they were allocated from.
+  std::uint64_t num_in_place_resizes{0};
+
+  /// \brief The number of allocations served by the object cache without
+  /// refilling it.
+  std::uint64_t num_cache_hits{0};
+  /// \brief The number of allocations that refilled the object cache.
+  std::uint64_t num_cache_misses{0};
+
+  /// \brief The number of times the global small-object bin locks were
+  /// acquired.
+  std::uint64_t num_bin_lock_acquisitions{0};
+  /// \brief The number of bin lock acquisitions that had to wait.
+  std::uint64_t num_bin_lock_contentions{0};
+  /// \brief The total time spent waiting for bin locks in nanoseconds.
+  std::uint64_t bin_lock_wait_time_ns{0};
+
+  /// \brief The number of times the segment was extended.
+  std::uint64_t num_segment_extensions{0};
+  /// \brief The number of requests to free file/memory space.
+  std::uint64_t num_free_region_calls{0};
+  /// \brief The total size of the space requested to be freed.
+  std::uint64_t free_region_bytes{0};
+
+  /// \brief The total size of the allocated objects,
+  /// including internal fragmentation.
+  std::uint64_t bytes_in_use{0};
+
+  /// \brief Returns the cache hit rate in [0, 1].
+  double cache_hit_rate() const {
+    const auto total = num_cache_hits + num_cache_misses;
+    return (total == 0) ? 0.0 : static_cast<double>(num_cache_hits) / total;
+  }
+};
+
+/// \brief Always-on allocator statistics counters.
+/// Counters are sharded per CPU (per thread if the CPU number is not
+/// available) and updated by relaxed atomic operations,
+/// so that they can be read at any time without stopping allocations.
+/// If METALL_DISABLE_ALLOCATOR_STATISTICS is defined, nothing is counted.
+/// \tparam bin_no_manager A bin number manager type.
+template <typename bin_no_manager>
+class allocator_statistics_counter {
+ public:
+  using size_type = std::size_t;
+  using bin_no_type = typename bin_no_manager::bin_no_type;
+
+ private:
+  using counter_type = std::atomic<std::uint64_t>;
+  static constexpr size_type k_num_bins = bin_no_manager::num_bins();
+  static constexpr size_type k_cache_line_size = 64;
+
+  struct alignas(k_cache_line_size) shard_type {
+    std::array<counter_type, k_num_bins> num_allocations{};
+    std::array<counter_type, k_num_bins> num_deallocations{};
+    counter_type num_in_place_resizes{0};
+    counter_type num_cache_misses{0};
+    counter_type num_cached_allocations{0};
+    counter_type num_bin_lock_acquisitions{0};
+    counter_type num_bin_lock_contentions{0};
+    counter_type bin_lock_wait_time_ns{0};
+    counter_type num_segment_extensions{0};
+    counter_type num_free_region_calls{0};
+    counter_type free_region_bytes{0};
+    // Can be 'negative' in a shard; wraps around as unsigned integers
+    counter_type bytes_in_use_delta{0};
+  };
+
+ public:
+  allocator_statistics_counter()
+      : m_num_shards(std::max(mdtl::get_num_cpus(), 1U)),
+        m_shards(std::make_unique<shard_type[]>(m_num_shards)) {}
+
+  ~allocator_statistics_counter() noexcept = default;
+  allocator_statistics_counter(const allocator_statistics_counter &) = delete;
+  allocator_statistics_counter(allocator_statistics_counter &&) noexcept =
+      default;
+  allocator_statistics_counter &operator=(
+      const allocator_statistics_counter &) = delete;
+  allocator_statistics_counter &operator=(
+      allocator_statistics_counter &&) noexcept = default;
+
+  void count_allocation([[maybe_unused]] const bin_no_type bin_no) {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    auto &shard = priv_shard();
+    priv_add(shard.num_allocations[bin_no], 1);
+    priv_add(shard.bytes_in_use_delta, bin_no_manager::to_object_size(bin_no));
+#endif
+  }
+
+  void count_deallocation([[maybe_unused]] const bin_no_type bin_no) {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    auto &shard = priv_shard();
+    priv_add(shard.num_deallocations[bin_no], 1);
+    priv_add(shard.bytes_in_use_delta,
+             -static_cast<std::uint64_t>(bin_no_manager::to_object_size(bin_no)));
+#endif
+  }
+
+  void count_in_place_resize([[maybe_unused]] const bin_no_type old_bin_no,
+                             [[maybe_unused]] const bin_no_type new_bin_no) {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    auto &shard = priv_shard();
+    priv_add(shard.num_in_place_resizes, 1);
+    priv_add(shard.bytes_in_use_delta,
+             bin_no_manager::to_object_size(new_bin_no) -
+                 bin_no_manager::to_object_size(old_bin_no));
+#endif
+  }
+
+  /// \brief Counts an allocation served through the object cache.
+  void count_cached_allocation() {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    priv_add(priv_shard().num_cached_allocations, 1);
+#endif
+  }
+
+  /// \brief Counts a refill of the object cache.
+  void count_cache_miss() {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    priv_add(priv_shard().num_cache_misses, 1);
+#endif
+  }
+
+  /// \brief Counts a bin lock acquisition.
+  /// \param wait_time_ns The time spent waiting for the lock. 0 means the lock
+  /// was acquired without contention.
+  void count_bin_lock([[maybe_unused]] const std::uint64_t wait_time_ns) {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    auto &shard = priv_shard();
+    priv_add(shard.num_bin_lock_acquisitions, 1);
+    if (wait_time_ns > 0) {
+      priv_add(shard.num_bin_lock_contentions, 1);
+      priv_add(shard.bin_lock_wait_time_ns, wait_time_ns);
+    }
+#endif
+  }
+
+  void count_segment_extension() {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    priv_add(priv_shard().num_segment_extensions, 1);
+#endif
+  }
+
+  void count_free_region([[maybe_unused]] const size_type nbytes) {
+#ifndef METALL_DISABLE_ALLOCATOR_STATISTICS
+    auto &shard = priv_shard();
+    priv_add(shard.num_free_region_calls, 1);
+    priv_add(shard.free_region_bytes, nbytes);
+#endif
+  }
+
+  /// \brief Sets the size of the objects allocated before counting started,
+  /// e.g., the objects in a reopened datastore.
+  void set_initial_bytes_in_use(const size_type nbytes) {
+    m_initial_bytes_in_use = nbytes;
+  }
+
+  /// \brief Takes a snapshot of the counters.
+  /// Can be called concurrently with the counting functions;
+  /// counters are not read atomically as a whole.
+  allocator_statistics snapshot() const {
+    allocator_statistics stats;
+    stats.bins.resize(k_num_bins);
+    for (size_type b = 0; b < k_num_bins; ++b) {
+      stats.bins[b].object_size =
+          bin_no_manager::to_object_size(static_cast<bin_no_type>(b));
+    }
+
+    std::uint64_t num_cached_allocations = 0;
+    std::uint64_t bytes_in_use = m_initial_bytes_in_use;
+    for (size_type s = 0; s < m_num_shards; ++s) {
+      const auto &shard = m_shards[s];
+      for (size_type b = 0; b < k_num_bins; ++b) {
+        stats.bins[b].num_allocations += priv_load(shard.num_allocations[b]);
+        stats.bins[b].num_deallocations +=
+            priv_load(shard.num_deallocations[b]);
+      }
+      stats.num_in_place_resizes += priv_load(shard.num_in_place_resizes);
+      num_cached_allocations += priv_load(shard.num_cached_allocations);
+      stats.num_cache_misses += priv_load(shard.num_cache_misses);
+      stats.num_bin_lock_acquisitions +=
+          priv_load(shard.num_bin_lock_acquisitions);
+      stats.num_bin_lock_contentions +=
+          priv_load(shard.num_bin_lock_contentions);
+      stats.bin_lock_wait_time_ns += priv_load(shard.bin_lock_wait_time_ns);
+      stats.num_segment_extensions += priv_load(shard.num_segment_extensions);
+      stats.num_free_region_calls += priv_load(shard.num_free_region_calls);
+      stats.free_region_bytes += priv_load(shard.free_region_bytes);
+      bytes_in_use += priv_load(shard.bytes_in_use_delta);
+    }
+
+    for (const auto &bin : stats.bins) {
+      stats.num_allocations += bin.num_allocations;
+      stats.num_deallocations += bin.num_deallocations;
+    }
+    // Counters in different shards are not read at the same time
+    stats.num_cache_misses =
+        std::min(stats.num_cache_misses, num_cached_allocations);
+    stats.num_cache_hits = num_cached_allocations - stats.num_cache_misses;
+    stats.bytes_in_use = bytes_in_use;
+
+    return stats;
+  }
+
+ private:
+  static void priv_add(counter_type &counter, const std::uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  static std::uint64_t priv_load(const counter_type &counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  shard_type &priv_shard() const {
+#ifdef METALL_DISABLE_CONCURRENCY
+    return m_shards[0];
+#elif SUPPORT_GET_CPU_NO
+    // The CPU number is cached as calling sched_getcpu() every time is slow;
+    // shards are for reducing contention, not for exactness.
+    thread_local static const unsigned int cpu_no = mdtl::get_cpu_no();
+    return m_shards[cpu_no % m_num_shards];
+#else
+    thread_local static const auto hashed_thread_id = mdtl::hash<>{}(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return m_shards[hashed_thread_id % m_num_shards];
+#endif
+  }
+
+  size_type m_num_shards;
+  std::unique_ptr<shard_type[]> m_shards;
+  size_type m_initial_bytes_in_use{0};
+};
+
+}  // namespace kernel
+}  // namespace metall
+#endif  // METALL_KERNEL_ALLOCATOR_STATISTICS_HPP
@@ -16,6 +16,11 @@
 #include <sstream>
 #include <memory>
 #include <filesystem>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <vector>
 
 #include <boost/container/string.hpp>
 #include <boost/unordered_map.hpp>
@@ -245,6 +250,24 @@ class attributed_object_directory {
     return true;
   }
 
+  /// \brief Reserves the index tables for at least the given number of
+  /// entries so that inserting them does not rehash the tables.
+  /// \param n The number of entries.
+  /// \return Returns false on error.
+  bool reserve(const size_type n) noexcept {
+    if (!good()) return false;
+
+    try {
+      m_offset_index_table->reserve(n);
+      m_name_index_table->reserve(n);
+    } catch (...) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Exception was thrown when reserving tables");
+      return false;
+    }
+    return true;
+  }
+
   /// \brief
   /// \return
   size_type size() const noexcept {
@@ -429,7 +452,7 @@ class attributed_object_directory {
     return true;
   }
 
-  /// \brief
+  /// \brief Writes the entries to a file in the binary format.
   /// \param path
   bool serialize(const fs::path &path) const noexcept {
     try {
@@ -440,7 +463,8 @@ class attributed_object_directory {
     return true;
   }
 
-  /// \brief
+  /// \brief Reads entries from a file written by serialize().
+  /// Files in the JSON format, written by older versions, are also accepted.
   /// \param path
   bool deserialize(const fs::path &path) noexcept {
     try {
@@ -451,12 +475,65 @@ class attributed_object_directory {
     return true;
   }
 
+  /// \brief Checks if a file written by serialize() has the name index,
+  /// which find_in_file() uses.
+  /// Files written by older versions do not have it.
+  /// \param path The file path.
+  /// \return Returns true if the file has the name index.
+  static bool has_name_index(const fs::path &path) noexcept {
+    try {
+      std::ifstream ifs(path, std::ios::binary);
+      std::uint64_t name_index_pos = 0;
+      return priv_read_binary_header(ifs, nullptr, &name_index_pos) &&
+             name_index_pos > 0;
+    } catch (...) {
+      return false;
+    }
+  }
+
+  /// \brief Checks the layout of a file that has the name index
+  /// without reading the entries:
+  /// the header, the file size, and the position and size of the name index.
+  /// Broken entries are detected when the file is read by deserialize().
+  /// \param path The file path.
+  /// \return Returns true if the file has the name index and its layout is
+  /// valid.
+  static bool check_name_index(const fs::path &path) noexcept {
+    try {
+      return priv_check_name_index_throw(path);
+    } catch (...) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Exception was thrown when checking a file");
+      return false;
+    }
+  }
+
+  /// \brief Finds an entry by name in a file written by serialize(),
+  /// reading only the name index items and the entries needed,
+  /// instead of loading the whole directory.
+  /// \param path The file path.
+  /// \param name The name of the entry (must not be empty).
+  /// \param entry A pointer to store the found entry.
+  /// Set to std::nullopt if the entry is not found.
+  /// \return Returns false on error, including when the file does not have
+  /// the name index.
+  static bool find_in_file(const fs::path &path, const name_type &name,
+                           std::optional<entry_type> *entry) noexcept {
+    try {
+      return priv_find_in_file_throw(path, name, entry);
+    } catch (...) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Exception was thrown when finding an entry in a file");
+      return false;
+    }
+  }
+
  private:
   // -------------------- //
   // Private types and static values
   // -------------------- //
 
-  // JSON structure
+  // JSON structure used by older versions (read only)
   // {
   // "attributed_objects" : [
   //  {"name" : "object0", "offset" : 0x845, "length" : 1, "type_id" : "424",
@@ -465,6 +542,23 @@ class attributed_object_directory {
   //  "description" : "..."}
   // ]
   // }
+  // Binary structure (host byte order)
+  // magic (8 bytes) | version (uint64) | #entries (uint64) |
+  // name index position (uint64, version 2 or later) | entries... |
+  // name index
+  // Each entry:
+  // offset (int64) | length (uint64) | type_id (uint64) |
+  // name size (uint64) | name | description size (uint64) | description
+  // Name index:
+  // #items (uint64) | items sorted by hash...
+  // Each item: hash of a name (uint64) | position of the entry (uint64)
+  static constexpr const char *k_binary_magic = "MTLLAOD1";
+  static constexpr std::size_t k_binary_magic_size = 8;
+  static constexpr std::uint64_t k_binary_version = 2;
+  static constexpr std::size_t k_binary_header_size =
+      k_binary_magic_size + sizeof(std::uint64_t) * 3;
+  using name_index_item_type = std::pair<std::uint64_t, std::uint64_t>;
+
   struct json_key {
     static constexpr const char *attributed_objects = "attributed_objects";
     static constexpr const char *name = "name";
@@ -514,45 +608,297 @@ class attributed_object_directory {
       return false;
     }
 
-    json::node_type json_attributed_objects_list;
+    std::string buf;
+    buf.reserve(k_binary_header_size +
+                m_entry_table->size() * sizeof(std::uint64_t) * 8);
+    buf.append(k_binary_magic, k_binary_magic_size);
+    priv_append_binary(k_binary_version, &buf);
+    priv_append_binary(std::uint64_t(m_entry_table->size()), &buf);
+    priv_append_binary(std::uint64_t(0), &buf);  // Set below
+
+    std::vector<name_index_item_type> name_index;
+    name_index.reserve(m_name_index_table->size());
     for (const auto &item : *m_entry_table) {
-      json::node_type json_named_object_entry;
-      if (!json::add_value(json_key::name, item.name(),
-                           &json_named_object_entry) ||
-          !json::add_value(json_key::offset, item.offset(),
-                           &json_named_object_entry) ||
-          !json::add_value(json_key::length, item.length(),
-                           &json_named_object_entry) ||
-          !json::add_value(json_key::type_id, item.type_id(),
-                           &json_named_object_entry) ||
-          !json::add_value(json_key::description, item.description(),
-                           &json_named_object_entry)) {
+      if (!item.name().empty()) {
+        name_index.emplace_back(mdtl::str_hash<>{}(item.name()), buf.size());
+      }
+      priv_append_binary(std::int64_t(item.offset()), &buf);
+      priv_append_binary(std::uint64_t(item.length()), &buf);
+      priv_append_binary(std::uint64_t(item.type_id()), &buf);
+      priv_append_binary(std::uint64_t(item.name().size()), &buf);
+      buf.append(item.name());
+      priv_append_binary(std::uint64_t(item.description().size()), &buf);
+      buf.append(item.description());
+    }
+
+    const std::uint64_t name_index_pos = buf.size();
+    std::memcpy(&buf[k_binary_header_size - sizeof(std::uint64_t)],
+                &name_index_pos, sizeof(std::uint64_t));
+    std::sort(name_index.begin(), name_index.end());
+    priv_append_binary(std::uint64_t(name_index.size()), &buf);
+    for (const auto &[hash, pos] : name_index) {
+      priv_append_binary(hash, &buf);
+      priv_append_binary(pos, &buf);
+    }
+
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  ("Failed to open: " + path.string()).c_str());
+      return false;
+    }
+    ofs.write(buf.data(), std::streamsize(buf.size()));
+    ofs.close();
+    if (!ofs) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  ("Failed to write: " + path.string()).c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+  bool priv_deserialize_throw(const fs::path &path) {
+    if (!good()) {
+      return false;
+    }
+
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  ("Failed to open: " + path.string()).c_str());
+      return false;
+    }
+    std::string buf((std::istreambuf_iterator<char>(ifs)),
+                    std::istreambuf_iterator<char>());
+    ifs.close();
+
+    if (buf.size() < k_binary_magic_size ||
+        std::memcmp(buf.data(), k_binary_magic, k_binary_magic_size) != 0) {
+      return priv_deserialize_json_throw(path);
+    }
+    return priv_deserialize_binary_throw(buf);
+  }
+
+  bool priv_deserialize_binary_throw(const std::string &buf) {
+    std::size_t pos = k_binary_magic_size;
+    std::uint64_t version = 0;
+    std::uint64_t num_entries = 0;
+    std::uint64_t name_index_pos = 0;
+    if (!priv_read_binary(buf, &pos, &version) || version == 0 ||
+        version > k_binary_version ||
+        !priv_read_binary(buf, &pos, &num_entries) ||
+        (version >= 2 && !priv_read_binary(buf, &pos, &name_index_pos))) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Invalid object directory header");
+      return false;
+    }
+    // Each entry takes at least 5 words
+    if (num_entries > (buf.size() - pos) / (sizeof(std::uint64_t) * 5)) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Invalid number of object directory entries");
+      return false;
+    }
+    if (!reserve(size() + num_entries)) {
+      return false;
+    }
+
+    for (std::uint64_t i = 0; i < num_entries; ++i) {
+      std::int64_t offset = 0;
+      std::uint64_t length = 0;
+      std::uint64_t type_id = 0;
+      name_type name;
+      description_type description;
+      if (!priv_read_binary(buf, &pos, &offset) ||
+          !priv_read_binary(buf, &pos, &length) ||
+          !priv_read_binary(buf, &pos, &type_id) ||
+          !priv_read_binary_string(buf, &pos, &name) ||
+          !priv_read_binary_string(buf, &pos, &description)) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Truncated object directory entry");
         return false;
       }
-      if (!json::push_back(json_named_object_entry,
-                           &json_attributed_objects_list)) {
+
+      if (count(name) > 0 ||
+          !insert(name, offset_type(offset), length_type(length),
+                  type_id_type(type_id), description)) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Failed to reconstruct object table");
         return false;
       }
     }
 
-    json::node_type json_root;
-    if (!json::add_child(json_key::attributed_objects,
-                         json_attributed_objects_list, &json_root)) {
+    // The name index follows the entries
+    std::uint64_t num_index_items = 0;
+    if (version >= 2 &&
+        (pos != name_index_pos ||
+         !priv_read_binary(buf, &pos, &num_index_items) ||
+         (buf.size() - pos) / (sizeof(std::uint64_t) * 2) != num_index_items ||
+         (buf.size() - pos) % (sizeof(std::uint64_t) * 2) != 0)) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Broken object directory name index");
+      return false;
+    }
+
+    return true;
+  }
+
+  static bool priv_read_binary_header(std::ifstream &ifs,
+                                      std::uint64_t *num_entries,
+                                      std::uint64_t *name_index_pos) {
+    if (!ifs.is_open()) return false;
+    char header[k_binary_header_size];
+    if (!ifs.read(header, k_binary_header_size) ||
+        std::memcmp(header, k_binary_magic, k_binary_magic_size) != 0) {
       return false;
     }
+    std::uint64_t words[3];
+    std::memcpy(words, header + k_binary_magic_size, sizeof(words));
+    if (words[0] == 0 || words[0] > k_binary_version) return false;
+    if (num_entries) *num_entries = words[1];
+    // Version 1 does not have the name index
+    *name_index_pos = (words[0] >= 2) ? words[2] : 0;
+    return true;
+  }
 
-    if (!json::write_json(json_root, path)) {
+  static bool priv_check_name_index_throw(const fs::path &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    const std::uint64_t file_size = fs::file_size(path);
+    std::uint64_t num_entries = 0;
+    std::uint64_t name_index_pos = 0;
+    std::uint64_t num_items = 0;
+    if (!priv_read_binary_header(ifs, &num_entries, &name_index_pos) ||
+        name_index_pos < k_binary_header_size ||
+        name_index_pos > file_size - sizeof(std::uint64_t) ||
+        !priv_read_binary_at(ifs, name_index_pos, &num_items)) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  ("Invalid object directory header: " + path.string())
+                      .c_str());
+      return false;
+    }
+
+    // Each entry takes at least 5 words and each name index item 2 words
+    const std::uint64_t items_size =
+        file_size - name_index_pos - sizeof(std::uint64_t);
+    if (num_entries > (name_index_pos - k_binary_header_size) /
+                          (sizeof(std::uint64_t) * 5) ||
+        num_items > num_entries ||
+        items_size != num_items * sizeof(std::uint64_t) * 2) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  ("Broken object directory: " + path.string()).c_str());
       return false;
     }
 
     return true;
   }
 
-  bool priv_deserialize_throw(const fs::path &path) {
-    if (!good()) {
+  template <typename word_type>
+  static bool priv_read_binary_at(std::ifstream &ifs, const std::uint64_t pos,
+                                  word_type *value) {
+    ifs.seekg(std::streamoff(pos));
+    return bool(ifs.read(reinterpret_cast<char *>(value), sizeof(word_type)));
+  }
+
+  static bool priv_find_in_file_throw(const fs::path &path,
+                                      const name_type &name,
+                                      std::optional<entry_type> *entry) {
+    *entry = std::nullopt;
+    if (name.empty()) return true;
+
+    std::ifstream ifs(path, std::ios::binary);
+    const std::uint64_t file_size = fs::file_size(path);
+    std::uint64_t name_index_pos = 0;
+    std::uint64_t num_items = 0;
+    if (!priv_read_binary_header(ifs, nullptr, &name_index_pos) ||
+        name_index_pos == 0 ||
+        !priv_read_binary_at(ifs, name_index_pos, &num_items) ||
+        num_items > file_size / (sizeof(std::uint64_t) * 2)) {
       return false;
     }
+    const std::uint64_t items_pos = name_index_pos + sizeof(std::uint64_t);
+    const auto item_pos = [items_pos](const std::uint64_t i) {
+      return items_pos + i * sizeof(std::uint64_t) * 2;
+    };
+
+    // Binary search for the first item of the hash
+    const std::uint64_t hash = mdtl::str_hash<>{}(name);
+    std::uint64_t first = 0;
+    std::uint64_t last = num_items;
+    while (first < last) {
+      const std::uint64_t mid = first + (last - first) / 2;
+      std::uint64_t mid_hash = 0;
+      if (!priv_read_binary_at(ifs, item_pos(mid), &mid_hash)) return false;
+      if (mid_hash < hash) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+
+    // Compares the names of the entries with the same hash
+    for (std::uint64_t i = first; i < num_items; ++i) {
+      name_index_item_type item;
+      if (!priv_read_binary_at(ifs, item_pos(i), &item.first) ||
+          !ifs.read(reinterpret_cast<char *>(&item.second),
+                    sizeof(item.second))) {
+        return false;
+      }
+      if (item.first != hash) break;
+
+      std::uint64_t words[4];  // offset, length, type_id, and name size
+      if (!priv_read_binary_at(ifs, item.second, &words)) return false;
+      if (words[3] != name.size()) continue;  // Also rejects broken sizes
+      name_type entry_name(name.size(), '\0');
+      std::uint64_t description_size = 0;
+      if (!ifs.read(entry_name.data(), std::streamsize(name.size()))) {
+        return false;
+      }
+      if (entry_name != name) continue;
+      if (!ifs.read(reinterpret_cast<char *>(&description_size),
+                    sizeof(description_size))) {
+        return false;
+      }
+      if (description_size > file_size) return false;
+      description_type description(description_size, '\0');
+      if (!ifs.read(description.data(), std::streamsize(description_size))) {
+        return false;
+      }
+
+      std::int64_t offset = 0;
+      std::memcpy(&offset, &words[0], sizeof(offset));
+      entry->emplace(name, offset_type(offset), length_type(words[1]),
+                     type_id_type(words[2]), description);
+      return true;
+    }
+
+    return true;  // Not found
+  }
+
+  template <typename word_type>
+  static void priv_append_binary(const word_type value, std::string *buf) {
+    buf->append(reinterpret_cast<const char *>(&value), sizeof(word_type));
+  }
+
+  template <typename word_type>
+  static bool priv_read_binary(const std::string &buf, std::size_t *pos,
+                               word_type *value) {
+    if (buf.size() - *pos < sizeof(word_type)) return false;
+    std::memcpy(value, buf.data() + *pos, sizeof(word_type));
+    *pos += sizeof(word_type);
+    return true;
+  }
+
+  static bool priv_read_binary_string(const std::string &buf,
+                                      std::size_t *pos, std::string *str) {
+    std::uint64_t len = 0;
+    if (!priv_read_binary(buf, pos, &len)) return false;
+    if (buf.size() - *pos < len) return false;
+    str->assign(buf.data() + *pos, len);
+    *pos += len;
+    return true;
+  }
 
+  bool priv_deserialize_json_throw(const fs::path &path) {
     json::node_type json_root;
     if (!json::read_json(path, &json_root)) {
       return false;
@@ -11,6 +11,7 @@
 #include <cassert>
 #include <type_traits>
 #include <vector>
+#include <string>
 #include <filesystem>
 
 #include <metall/detail/utilities.hpp>
@@ -153,6 +154,77 @@ class chunk_directory {
     }
   }
 
+  /// \brief Extends a large chunk in place so that it holds an object of the
+  /// bin 'new_bin_no', if the chunks that follow it are unused.
+  /// Requires a global lock to avoid race condition.
+  /// \param head_chunk_no The head chunk number of a large chunk.
+  /// \param new_bin_no A new bin number, which must be a large bin.
+  /// \return Returns true on success. On failure, nothing is changed.
+  bool extend_large_chunk(const chunk_no_type head_chunk_no,
+                          const bin_no_type new_bin_no) {
+    assert(m_table[head_chunk_no].type == chunk_type::large_chunk_head);
+    assert(new_bin_no >= bin_no_mngr::num_small_bins());
+
+    const std::size_t num_chunks = priv_num_large_chunks(bin_no(head_chunk_no));
+    const std::size_t new_num_chunks = priv_num_large_chunks(new_bin_no);
+    if (new_num_chunks < num_chunks) return false;
+    if (head_chunk_no + new_num_chunks > m_max_num_chunks) return false;
+
+    for (std::size_t offset = num_chunks; offset < new_num_chunks; ++offset) {
+      const chunk_no_type chunk_no = head_chunk_no + offset;
+      if ((ssize_t)chunk_no <= m_last_used_chunk_no &&
+          !unused_chunk(chunk_no)) {
+        return false;
+      }
+    }
+
+    m_table[head_chunk_no].bin_no = new_bin_no;
+    for (std::size_t offset = 1; offset < new_num_chunks; ++offset) {
+      const chunk_no_type chunk_no = head_chunk_no + offset;
+      if (offset >= num_chunks) {
+        // Initialize it just in case
+        m_table[chunk_no].init();
+        m_table[chunk_no].type = chunk_type::large_chunk_body;
+      }
+      m_table[chunk_no].bin_no = new_bin_no;  // just in case
+    }
+    m_last_used_chunk_no =
+        std::max((ssize_t)(head_chunk_no + new_num_chunks - 1),
+                 m_last_used_chunk_no);
+
+    return true;
+  }
+
+  /// \brief Shrinks a large chunk in place so that it holds an object of the
+  /// bin 'new_bin_no'. The trailing chunks become unused.
+  /// Requires a global lock to avoid race condition.
+  /// \param head_chunk_no The head chunk number of a large chunk.
+  /// \param new_bin_no A new bin number, which must be a large bin and equal
+  /// to or smaller than the current one.
+  void shrink_large_chunk(const chunk_no_type head_chunk_no,
+                          const bin_no_type new_bin_no) {
+    assert(m_table[head_chunk_no].type == chunk_type::large_chunk_head);
+    assert(new_bin_no >= bin_no_mngr::num_small_bins());
+
+    const std::size_t num_chunks = priv_num_large_chunks(bin_no(head_chunk_no));
+    const std::size_t new_num_chunks = priv_num_large_chunks(new_bin_no);
+    assert(new_num_chunks <= num_chunks);
+
+    m_table[head_chunk_no].bin_no = new_bin_no;
+    for (std::size_t offset = 1; offset < num_chunks; ++offset) {
+      if (offset < new_num_chunks) {
+        m_table[head_chunk_no + offset].bin_no = new_bin_no;
+      } else {
+        m_table[head_chunk_no + offset].init();
+      }
+    }
+
+    const chunk_no_type last_chunk_no = head_chunk_no + num_chunks - 1;
+    if (last_chunk_no == m_last_used_chunk_no) {
+      m_last_used_chunk_no = find_next_used_chunk_backward(last_chunk_no);
+    }
+  }
+
   /// \brief Finds an available slot in the chunk whose chunk number is
   /// 'chunk_no' and marks it as occupied. slot in the chunk. This function
   /// modifies only the specified chunk; thus, the global lock is not required.
@@ -269,6 +341,12 @@ class chunk_directory {
     return (m_table[chunk_no].type == chunk_type::unused);
   }
 
+  /// \brief Returns true if a chunk is the first chunk of a large object.
+  /// \param chunk_no Chunk number. Must be less than size().
+  bool head_chunk(const chunk_no_type chunk_no) const {
+    return (m_table[chunk_no].type == chunk_type::large_chunk_head);
+  }
+
   /// \brief
   /// \param chunk_no
   /// \return
@@ -294,6 +372,104 @@ class chunk_directory {
     return m_table[chunk_no].num_occupied_slots;
   }
 
+  /// \brief Checks the consistency of a chunk.
+  /// This function does not modify anything; thus, multiple threads can check
+  /// different chunks at the same time.
+  /// \param chunk_no Chunk number. Must be less than size().
+  /// \return Returns an empty string if the chunk is consistent.
+  /// Otherwise, returns a description of the problem.
+  std::string check_chunk(const chunk_no_type chunk_no) const {
+    const auto &entry = m_table[chunk_no];
+    if (entry.type == chunk_type::unused) return "";
+
+    if (entry.type == chunk_type::small_chunk) {
+      const slot_count_type num_slots = slots(chunk_no);
+      const std::size_t num_marked = entry.slot_occupancy.count(num_slots);
+      if (num_marked != entry.num_occupied_slots) {
+        return "occupied slot count (" +
+               std::to_string(entry.num_occupied_slots) +
+               ") does not match the slot table (" +
+               std::to_string(num_marked) + ")";
+      }
+      if (num_marked == 0) return "small chunk holds no objects";
+      return "";
+    }
+
+    if (entry.bin_no < bin_no_mngr::num_small_bins()) {
+      return "large chunk has a small bin number";
+    }
+
+    if (entry.type == chunk_type::large_chunk_head) {
+      const std::size_t num_chunks = priv_num_large_chunks(entry.bin_no);
+      for (std::size_t offset = 1; offset < num_chunks; ++offset) {
+        if (chunk_no + offset >= size() ||
+            m_table[chunk_no + offset].type != chunk_type::large_chunk_body ||
+            m_table[chunk_no + offset].bin_no != entry.bin_no) {
+          return "large chunk is truncated";
+        }
+      }
+      if (chunk_no + num_chunks < size() &&
+          m_table[chunk_no + num_chunks].type ==
+              chunk_type::large_chunk_body) {
+        return "large chunk has extra body chunks";
+      }
+      return "";
+    }
+
+    // Large chunk body; its head is checked on behalf of it
+    if (chunk_no == 0 ||
+        (m_table[chunk_no - 1].type != chunk_type::large_chunk_head &&
+         m_table[chunk_no - 1].type != chunk_type::large_chunk_body) ||
+        m_table[chunk_no - 1].bin_no != entry.bin_no) {
+      return "large chunk body has no head";
+    }
+    return "";
+  }
+
+  /// \brief Repairs a chunk that check_chunk() reported as inconsistent.
+  /// A small chunk whose occupied slot count is wrong gets the count
+  /// recalculated from its slot table; a small chunk that holds no objects
+  /// is erased. A truncated large chunk is erased as a whole,
+  /// as its size is unknown. Extra body chunks after a large chunk and
+  /// body chunks without a head are released; the large chunk before them,
+  /// if any, is kept.
+  /// Requires a global lock to avoid race condition.
+  /// \param chunk_no Chunk number. Must be less than size().
+  void repair_chunk(const chunk_no_type chunk_no) {
+    auto &entry = m_table[chunk_no];
+    if (entry.type == chunk_type::unused) return;
+
+    if (entry.type == chunk_type::small_chunk) {
+      const slot_count_type num_slots = slots(chunk_no);
+      entry.num_occupied_slots = entry.slot_occupancy.count(num_slots);
+      if (entry.num_occupied_slots == 0) erase(chunk_no);
+      return;
+    }
+
+    if (entry.type == chunk_type::large_chunk_body) {
+      // The following body chunks have no head either
+      priv_release_large_chunk_bodies(chunk_no);
+      return;
+    }
+
+    if (entry.bin_no < bin_no_mngr::num_small_bins()) {
+      erase(chunk_no);
+      return;
+    }
+    const std::size_t num_chunks = priv_num_large_chunks(entry.bin_no);
+    for (std::size_t offset = 1; offset < num_chunks; ++offset) {
+      if (chunk_no + offset >= size() ||
+          m_table[chunk_no + offset].type != chunk_type::large_chunk_body ||
+          m_table[chunk_no + offset].bin_no != entry.bin_no) {
+        erase(chunk_no);  // Truncated
+        return;
+      }
+    }
+    if (chunk_no + num_chunks < size()) {
+      priv_release_large_chunk_bodies(chunk_no + num_chunks);
+    }
+  }
+
   /// \brief
   /// \param path
   bool serialize(const fs::path &path) const {
@@ -373,6 +549,13 @@ class chunk_directory {
     uint64_t buf2;
     uint64_t buf3;
     while (ifs >> buf1 >> buf2 >> buf3) {
+      if (buf1 >= m_max_num_chunks || buf2 >= bin_no_mngr::num_bins()) {
+        std::stringstream ss;
+        ss << "Invalid chunk entry: " << buf1 << " " << buf2;
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    ss.str().c_str());
+        return false;
+      }
       const auto chunk_no = static_cast<chunk_no_type>(buf1);
       const auto bin_no = static_cast<bin_no_type>(buf2);
       m_table[chunk_no].bin_no = bin_no;
@@ -395,6 +578,11 @@ class chunk_directory {
       }
 
       if (m_table[chunk_no].type == chunk_type::small_chunk) {
+        if (bin_no >= bin_no_mngr::num_small_bins()) {
+          logger::out(logger::level::error, __FILE__, __LINE__,
+                      "Small chunk has a large bin number");
+          return false;
+        }
         const slot_count_type num_slots =
             calc_num_slots(bin_no_mngr::to_object_size(bin_no));
         if (!(ifs >> buf1)) {
@@ -500,6 +688,12 @@ class chunk_directory {
     return k_chunk_size / object_size;
   }
 
+  static constexpr std::size_t priv_num_large_chunks(
+      const bin_no_type bin_no) {
+    return (bin_no_mngr::to_object_size(bin_no) + k_chunk_size - 1) /
+           k_chunk_size;
+  }
+
   /// \brief Allocates memory for 'm_max_num_chunks' chunks.
   /// This function assumes that 'm_max_num_chunks' is set.
   /// Allocates 'uncommitted pages' so that not to waste physical memory until
@@ -525,6 +719,20 @@ class chunk_directory {
     return true;
   }
 
+  /// \brief Releases the contiguous large chunk body chunks starting at
+  /// 'chunk_no', without touching the chunks before it.
+  void priv_release_large_chunk_bodies(const chunk_no_type chunk_no) {
+    chunk_no_type last_chunk_no = chunk_no;
+    for (; last_chunk_no < size() &&
+           m_table[last_chunk_no].type == chunk_type::large_chunk_body;
+         ++last_chunk_no) {
+      m_table[last_chunk_no].init();
+    }
+    if (last_chunk_no > chunk_no && last_chunk_no - 1 == m_last_used_chunk_no) {
+      m_last_used_chunk_no = find_next_used_chunk_backward(last_chunk_no - 1);
+    }
+  }
+
   void priv_destroy() noexcept {
     for (chunk_no_type chunk_no = 0; chunk_no < size(); ++chunk_no) {
       try {
@@ -592,7 +800,8 @@ class chunk_directory {
         m_table[chunk_no].init();
       }
 
-      if (chunk_no <= m_last_used_chunk_no && !unused_chunk(chunk_no)) {
+      if ((ssize_t)chunk_no <= m_last_used_chunk_no &&
+          !unused_chunk(chunk_no)) {
         count_continuous_empty_chunks = 0;
         continue;
       }
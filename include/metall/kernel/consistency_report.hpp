@@ -0,0 +1,40 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_KERNEL_CONSISTENCY_REPORT_HPP
+#define METALL_KERNEL_CONSISTENCY_REPORT_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace metall {
+namespace kernel {
+
+/// \brief The result of an in-depth consistency check of a data store.
+struct consistency_report {
+  /// \brief True if the data store was closed properly.
+  bool properly_closed{false};
+  /// \brief True if the management data could be read.
+  /// If false, nothing else was checked.
+  bool readable{false};
+  /// \brief The number of chunks checked.
+  std::size_t num_chunks{0};
+  /// \brief The number of named, unique, and anonymous objects checked.
+  std::size_t num_attributed_objects{0};
+  /// \brief Descriptions of the found problems.
+  std::vector<std::string> errors;
+  /// \brief True if the found problems were repaired and the repaired
+  /// management data was written back.
+  bool repaired{false};
+
+  /// \brief Returns true if no problem was found.
+  /// Whether the data store was closed properly does not matter.
+  bool consistent() const { return readable && errors.empty(); }
+};
+
+}  // namespace kernel
+}  // namespace metall
+#endif  // METALL_KERNEL_CONSISTENCY_REPORT_HPP
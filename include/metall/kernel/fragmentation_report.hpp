@@ -0,0 +1,81 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_KERNEL_FRAGMENTATION_REPORT_HPP
+#define METALL_KERNEL_FRAGMENTATION_REPORT_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace metall {
+namespace kernel {
+
+/// \brief Fragmentation of the chunks holding small objects.
+struct fragmentation_report {
+  /// \brief Fragmentation of a small-object bin.
+  struct bin_fragmentation {
+    std::size_t object_size{0};
+    /// \brief The number of chunks used by the bin.
+    std::size_t num_chunks{0};
+    /// \brief The total number of slots in the chunks.
+    std::size_t num_slots{0};
+    /// \brief The number of slots holding objects.
+    std::size_t num_occupied_slots{0};
+    /// \brief The number of chunks whose occupancy is equal to or less than
+    /// the sparse occupancy threshold given to the analysis.
+    std::size_t num_sparse_chunks{0};
+    /// \brief The number of chunks that perfect compaction would free.
+    std::size_t num_reclaimable_chunks{0};
+
+    /// \brief Returns the slot occupancy in [0, 1].
+    double occupancy() const {
+      return (num_slots == 0)
+                 ? 0.0
+                 : static_cast<double>(num_occupied_slots) / num_slots;
+    }
+  };
+
+  /// \brief Chunk size in bytes.
+  std::size_t chunk_size{0};
+
+  /// \brief Fragmentation of each small-object bin, indexed by bin number.
+  std::vector<bin_fragmentation> bins;
+
+  /// \brief Returns the total number of chunks used for small objects.
+  std::size_t num_chunks() const {
+    std::size_t n = 0;
+    for (const auto &bin : bins) n += bin.num_chunks;
+    return n;
+  }
+
+  /// \brief Returns the total number of chunks perfect compaction would free.
+  std::size_t num_reclaimable_chunks() const {
+    std::size_t n = 0;
+    for (const auto &bin : bins) n += bin.num_reclaimable_chunks;
+    return n;
+  }
+
+  /// \brief Returns the size perfect compaction would free in bytes.
+  std::size_t reclaimable_bytes() const {
+    return num_reclaimable_chunks() * chunk_size;
+  }
+};
+
+/// \brief The result of a small-object compaction.
+struct compaction_result {
+  /// \brief The number of objects moved to other chunks.
+  std::size_t num_relocated_objects{0};
+  /// \brief The number of objects left in place because the relocation
+  /// callback declined to move them.
+  std::size_t num_pinned_objects{0};
+  /// \brief The number of chunks freed.
+  std::size_t num_freed_chunks{0};
+  /// \brief The size of the freed chunks in bytes.
+  std::size_t freed_bytes{0};
+};
+
+}  // namespace kernel
+}  // namespace metall
+#endif  // METALL_KERNEL_FRAGMENTATION_REPORT_HPP
@@ -10,9 +10,12 @@
 #include <fstream>
 #include <streambuf>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <memory>
+#include <atomic>
+#include <mutex>
 #include <future>
 #include <vector>
 #include <map>
@@ -20,11 +23,13 @@
 #include <typeinfo>
 
 #include <metall/logger.hpp>
+#include <metall/tracer.hpp>
 #include <metall/offset_ptr.hpp>
 #include <metall/version.hpp>
 #include <metall/kernel/manager_kernel_fwd.hpp>
 #include <metall/kernel/segment_header.hpp>
 #include <metall/kernel/segment_allocator.hpp>
+#include <metall/kernel/consistency_report.hpp>
 #include <metall/kernel/attributed_object_directory.hpp>
 #include <metall/object_attribute_accessor.hpp>
 #include <metall/detail/utilities.hpp>
@@ -129,8 +134,11 @@ class manager_kernel {
   using json_store = mdtl::ptree::node_type;
 
 #ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
-  using mutex_type = mdtl::mutex;
-  using lock_guard_type = mdtl::mutex_lock_guard;
+  // Finds take the shared lock, so that they can run concurrently with each
+  // other while constructions and destructions take the exclusive lock.
+  using mutex_type = mdtl::shared_mutex;
+  using lock_guard_type = mdtl::shared_mutex_lock_guard;
+  using shared_lock_type = mdtl::shared_mutex_shared_lock;
 #endif
 
  public:
@@ -217,6 +225,41 @@ class manager_kernel {
   /// \param addr
   void deallocate(void *addr);
 
+  /// \brief Returns the size of the memory an allocated object can use.
+  /// \param addr The address of an allocated object.
+  /// \return The usable size, which is equal to or larger than the requested
+  /// size. Returns 0 if addr is nullptr.
+  size_type usable_size(const void *addr) const;
+
+  /// \brief Tries to expand an allocated object without moving it.
+  /// Only an object larger than the chunk size can grow beyond its current
+  /// usable size, by taking over the unused chunks that follow it.
+  /// \param addr The address of an allocated object.
+  /// \param min_nbytes The minimum size required.
+  /// \param nbytes On input, the preferred size.
+  /// On success, the new usable size is stored.
+  /// \return Returns true on success; otherwise, the object is unchanged.
+  bool expand_in_place(void *addr, size_type min_nbytes, size_type *nbytes);
+
+  /// \brief Tries to shrink an allocated object without moving it.
+  /// \param addr The address of an allocated object.
+  /// \param max_nbytes The maximum size acceptable.
+  /// \param nbytes On input, the preferred size.
+  /// On success, the new usable size is stored.
+  /// \return Returns true on success; otherwise, the object is unchanged.
+  bool shrink_in_place(void *addr, size_type max_nbytes, size_type *nbytes);
+
+  /// \brief Changes the size of an allocated object, like std::realloc().
+  /// Tries to expand or shrink the object in place first;
+  /// if it fails, allocates new memory, copies the data, and deallocates the
+  /// old one.
+  /// \param addr The address of an allocated object or nullptr.
+  /// \param nbytes A new size.
+  /// \return On success, returns the address of the object,
+  /// which can be different from addr. On failure, returns nullptr and addr
+  /// is left untouched.
+  void *reallocate(void *addr, size_type nbytes);
+
   /// \brief Check if all allocated memory has been deallocated.
   /// Note that this function clears object cache.
   bool all_memory_deallocated() const;
@@ -228,6 +271,33 @@ class manager_kernel {
   template <typename T>
   std::pair<T *, size_type> find(char_ptr_holder_type name) const;
 
+  /// \brief Finds already constructed named objects,
+  /// taking the object directory lock only once.
+  /// \tparam T The type of the objects.
+  /// \param names The names of the objects.
+  /// \return The pointers to the objects and their lengths,
+  /// in the same order as names. Returns (nullptr, 0) for missing objects.
+  template <typename T>
+  std::vector<std::pair<T *, size_type>> find_many(
+      const std::vector<std::string> &names) const;
+
+  /// \brief Constructs a named object of type T for each name,
+  /// taking the object directory lock only once to register all of them.
+  /// Each object receives the same arguments.
+  /// If T's constructor throws, the objects that have not been constructed
+  /// are freed and the exception is rethrown;
+  /// the objects constructed before are kept.
+  /// \tparam T The type of the objects.
+  /// \param names The names of the objects.
+  /// \param try2find If true, returns the existing object of a name.
+  /// \param args The arguments passed to T's constructor.
+  /// \return The pointers to the objects, in the same order as names.
+  /// Contains nullptr if a name is used (and try2find is false), empty, or
+  /// failed to allocate memory.
+  template <typename T, typename... Args>
+  std::vector<T *> construct_many(const std::vector<std::string> &names,
+                                  bool try2find, const Args &...args);
+
   /// \brief Destroy an already constructed object (named or unique).
   /// Returns true if the object is destroyed.
   /// If name is anonymous, returns false.
@@ -398,6 +468,28 @@ class manager_kernel {
   /// \return Return true if it is consistent; otherwise, returns false.
   static bool consistent(const path_type &dir_path);
 
+  /// \brief Checks the management data of a data store in depth,
+  /// using multiple threads.
+  /// Unlike consistent(), this function also works on a data store that was
+  /// not closed properly, e.g., one left by a crashed process.
+  /// It checks the chunk directory against the bin directory and
+  /// checks that every object in the object directories (named, unique, and
+  /// anonymous objects) points to allocated memory.
+  /// \param base_path Path to a data store.
+  /// \param repair If true, repairs the found problems, writes the repaired
+  /// management data back, and marks the data store as properly closed.
+  /// Broken objects are dropped.
+  /// \param max_num_threads The maximum number of threads to use.
+  /// If <= 0 is given, the value is automatically determined.
+  /// \return A consistency report.
+  /// \warning The management data is written only when a data store is closed.
+  /// Thus, a repaired data store reflects the state at the last close (or
+  /// snapshot); objects allocated after that are not known to the allocator
+  /// even if their data remain in the segment.
+  static consistency_report check_consistency(const path_type &base_path,
+                                              bool repair,
+                                              int max_num_threads);
+
   /// \brief Returns the UUID of the backing data store.
   /// \return Returns UUID in std::string; returns an empty string on error.
   std::string get_uuid() const;
@@ -469,6 +561,31 @@ class manager_kernel {
   template <typename out_stream_type>
   void profile(out_stream_type *log_out);
 
+  /// \brief Takes a snapshot of the allocator statistics.
+  /// Unlike profile(), this method does not release object caches.
+  /// \return A snapshot of the allocator statistics.
+  allocator_statistics get_allocator_statistics() const;
+
+  /// \brief Analyzes the fragmentation of the chunks holding small objects.
+  /// This method releases object caches.
+  /// \param sparse_occupancy A chunk is counted as sparse if its occupancy is
+  /// equal to or less than this value.
+  /// \return A fragmentation report.
+  fragmentation_report analyze_fragmentation(double sparse_occupancy);
+
+  /// \brief Relocates small objects out of sparse chunks and frees the
+  /// emptied chunks. Objects registered in the object directories
+  /// (named, unique, and anonymous objects) are never relocated.
+  /// \tparam relocator_type A callable type whose signature is
+  /// bool(void *src, void *dst, size_type nbytes).
+  /// \param max_occupancy Only chunks whose occupancy is equal to or less than
+  /// this value are evacuated.
+  /// \param relocator Moves an object from src to dst and returns true,
+  /// or returns false to keep the object in place.
+  /// \return The result of the compaction.
+  template <typename relocator_type>
+  compaction_result compact(double max_occupancy, relocator_type relocator);
+
  private:
   // -------------------- //
   // Private methods
@@ -498,7 +615,40 @@ class manager_kernel {
   static bool priv_mark_properly_closed(const path_type &base_path);
   static bool priv_unmark_properly_closed(const path_type &base_path);
 
+  // ---------- For object directories  ---------- //
+  // Object directories are read from the datastore on first use.
+  // Access them through these functions instead of the members.
+  attributed_object_directory_type &priv_named_directory() const {
+    return priv_load_object_directory(instance_kind::named_kind);
+  }
+
+  attributed_object_directory_type &priv_unique_directory() const {
+    return priv_load_object_directory(instance_kind::unique_kind);
+  }
+
+  attributed_object_directory_type &priv_anonymous_directory() const {
+    return priv_load_object_directory(instance_kind::anonymous_kind);
+  }
+
+  /// \brief Reads an object directory from the datastore if it has not been
+  /// read yet. Thread-safe.
+  attributed_object_directory_type &priv_load_object_directory(
+      instance_kind kind) const;
+
+  /// \brief Returns true if an object directory has been read.
+  bool priv_object_directory_loaded(instance_kind kind) const;
+
+  /// \brief Returns true if an object directory could not be read on first
+  /// use. The directory is empty and must not be modified or written back.
+  bool priv_object_directory_failed(instance_kind kind) const;
+
+  path_type priv_object_directory_path(instance_kind kind) const;
+
   // ---------- For constructed objects  ---------- //
+  template <typename T>
+  std::pair<T *, size_type> priv_find_no_mutex(
+      char_ptr_holder_type name) const;
+
   template <typename T, typename proxy>
   T *priv_generic_construct(char_ptr_holder_type name, size_type length,
                             bool try2find, proxy &pr);
@@ -559,9 +709,10 @@ class manager_kernel {
   // -------------------- //
   bool m_good{false};
   path_type m_base_path{};
-  attributed_object_directory_type m_named_object_directory{};
-  attributed_object_directory_type m_unique_object_directory{};
-  attributed_object_directory_type m_anonymous_object_directory{};
+  // Object directories are loaded lazily, see priv_load_object_directory()
+  mutable attributed_object_directory_type m_named_object_directory{};
+  mutable attributed_object_directory_type m_unique_object_directory{};
+  mutable attributed_object_directory_type m_anonymous_object_directory{};
   segment_memory_allocator m_segment_memory_allocator{nullptr};
   std::unique_ptr<json_store> m_manager_metadata{nullptr};
   segment_storage m_segment_storage{};
@@ -569,6 +720,21 @@ class manager_kernel {
 #ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
   std::unique_ptr<mutex_type> m_object_directories_mutex{nullptr};
 #endif
+
+  struct object_directory_load_state {
+    std::once_flag once;
+    std::atomic<bool> loaded{false};
+    std::atomic<bool> failed{false};
+    // The number of lookups done against the file before it is read
+    std::atomic<std::size_t> num_file_lookups{0};
+  };
+  // One for each instance_kind
+  static constexpr std::size_t k_num_object_directories = 3;
+  // Each lookup against a file opens and seeks it; a directory is read after
+  // this many lookups, as the caller is likely to look up more.
+  static constexpr std::size_t k_max_object_directory_file_lookups = 32;
+  std::unique_ptr<object_directory_load_state[]> m_object_directory_load_states{
+      nullptr};
 };
 
 }  // namespace kernel
@@ -26,6 +26,9 @@ manager_kernel<st, sst, cn, cs>::manager_kernel()
     return;
   }
 #endif
+  m_object_directory_load_states =
+      std::make_unique<object_directory_load_state[]>(
+          k_num_object_directories);
   m_good = priv_validate_runtime_configuration();
 }
 
@@ -40,24 +43,28 @@ manager_kernel<st, sst, cn, cs>::~manager_kernel() noexcept {
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::create(const path_type &base_path,
                                              const size_type vm_reserve_size) {
+  METALL_TRACE_SCOPE(manager_create, vm_reserve_size);
   return m_good = priv_create(base_path, vm_reserve_size);
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::open_read_only(
     const path_type &base_path) {
+  METALL_TRACE_SCOPE(manager_open, 0);
   return m_good = priv_open(base_path, true, 0);
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::open(
     const path_type &base_path, const size_type vm_reserve_size_request) {
+  METALL_TRACE_SCOPE(manager_open, vm_reserve_size_request);
   return m_good = priv_open(base_path, false, vm_reserve_size_request);
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 void manager_kernel<st, sst, cn, cs>::close() {
   if (m_segment_storage.is_open()) {
+    METALL_TRACE_SCOPE(manager_close, 0);
     priv_check_sanity();
     if (!m_segment_storage.read_only()) {
       priv_serialize_management_data();
@@ -76,6 +83,7 @@ void manager_kernel<st, sst, cn, cs>::close() {
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 void manager_kernel<st, sst, cn, cs>::flush(const bool synchronous) {
+  METALL_TRACE_SCOPE(manager_flush, synchronous);
   priv_check_sanity();
   m_segment_storage.sync(synchronous);
 }
@@ -126,6 +134,93 @@ void manager_kernel<st, sst, cn, cs>::deallocate(void *const addr) {
   m_segment_memory_allocator.deallocate(priv_to_offset(addr));
 }
 
+template <typename st, typename sst, typename cn, std::size_t cs>
+typename manager_kernel<st, sst, cn, cs>::size_type
+manager_kernel<st, sst, cn, cs>::usable_size(const void *const addr) const {
+  priv_check_sanity();
+  if (!addr) return 0;
+  return m_segment_memory_allocator.usable_size(priv_to_offset(addr));
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+bool manager_kernel<st, sst, cn, cs>::expand_in_place(
+    void *const addr,
+    const manager_kernel<st, sst, cn, cs>::size_type min_nbytes,
+    manager_kernel<st, sst, cn, cs>::size_type *const nbytes) {
+  priv_check_sanity();
+  if (m_segment_storage.read_only()) return false;
+  if (!addr) return false;
+  return m_segment_memory_allocator.expand_in_place(priv_to_offset(addr),
+                                                    min_nbytes, nbytes);
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+bool manager_kernel<st, sst, cn, cs>::shrink_in_place(
+    void *const addr,
+    const manager_kernel<st, sst, cn, cs>::size_type max_nbytes,
+    manager_kernel<st, sst, cn, cs>::size_type *const nbytes) {
+  priv_check_sanity();
+  if (m_segment_storage.read_only()) return false;
+  if (!addr) return false;
+  return m_segment_memory_allocator.shrink_in_place(priv_to_offset(addr),
+                                                    max_nbytes, nbytes);
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+void *manager_kernel<st, sst, cn, cs>::reallocate(
+    void *const addr, const manager_kernel<st, sst, cn, cs>::size_type nbytes) {
+  priv_check_sanity();
+  if (m_segment_storage.read_only()) return nullptr;
+  if (!addr) return allocate(nbytes);
+
+  const size_type current_size = usable_size(addr);
+  size_type new_size = nbytes;
+  if (nbytes <= current_size) {
+    // Releases the trailing chunks if possible; keeps the object as is if not
+    shrink_in_place(addr, current_size, &new_size);
+    return addr;
+  }
+  if (expand_in_place(addr, nbytes, &new_size)) {
+    return addr;
+  }
+
+  void *const new_addr = allocate(nbytes);
+  if (!new_addr) return nullptr;
+  std::memcpy(new_addr, addr, current_size);
+  deallocate(addr);
+
+  return new_addr;
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+template <typename relocator_type>
+compaction_result manager_kernel<st, sst, cn, cs>::compact(
+    const double max_occupancy, relocator_type relocator) {
+  priv_check_sanity();
+  if (m_segment_storage.read_only()) return compaction_result{};
+
+#ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
+  lock_guard_type guard(*m_object_directories_mutex);
+#endif
+  return m_segment_memory_allocator.compact_small_objects(
+      max_occupancy,
+      [this, &relocator](const difference_type src_offset,
+                         const difference_type dst_offset,
+                         const size_type nbytes) -> bool {
+        // Directory entries hold the offsets of the objects
+        if (priv_named_directory().find(src_offset) !=
+                priv_named_directory().end() ||
+            priv_unique_directory().find(src_offset) !=
+                priv_unique_directory().end() ||
+            priv_anonymous_directory().find(src_offset) !=
+                priv_anonymous_directory().end()) {
+          return false;
+        }
+        return relocator(priv_to_address(src_offset),
+                         priv_to_address(dst_offset), nbytes);
+      });
+}
+
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::all_memory_deallocated() const {
   priv_check_sanity();
@@ -138,27 +233,109 @@ std::pair<T *, typename manager_kernel<st, sst, cn, cs>::size_type>
 manager_kernel<st, sst, cn, cs>::find(char_ptr_holder_type name) const {
   priv_check_sanity();
 
-  if (name.is_anonymous()) {
-    return std::make_pair(nullptr, 0);
+#ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
+  shared_lock_type lock(*m_object_directories_mutex);
+#endif
+  return priv_find_no_mutex<T>(name);
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+template <typename T>
+std::vector<std::pair<T *, typename manager_kernel<st, sst, cn, cs>::size_type>>
+manager_kernel<st, sst, cn, cs>::find_many(
+    const std::vector<std::string> &names) const {
+  priv_check_sanity();
+
+  std::vector<std::pair<T *, size_type>> found;
+  found.reserve(names.size());
+#ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
+  shared_lock_type lock(*m_object_directories_mutex);
+#endif
+  // Reads the directory once instead of looking up the file for each name
+  priv_named_directory();
+  for (const auto &name : names) {
+    found.emplace_back(priv_find_no_mutex<T>(name.c_str()));
+  }
+  return found;
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+template <typename T, typename... Args>
+std::vector<T *> manager_kernel<st, sst, cn, cs>::construct_many(
+    const std::vector<std::string> &names, const bool try2find,
+    const Args &...args) {
+  priv_check_sanity();
+
+  std::vector<T *> objects(names.size(), nullptr);
+  if (m_segment_storage.read_only()) return objects;
+
+  // The indices of the objects allocated and registered by this call
+  std::vector<std::size_t> allocated;
+  allocated.reserve(names.size());
+  try {
+#ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
+    lock_guard_type guard(*m_object_directories_mutex);
+#endif
+    auto &named_directory = priv_named_directory();
+    named_directory.reserve(named_directory.size() + names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      const char_ptr_holder_type name(names[i].c_str());
+      if (names[i].empty()) {
+        logger::out(logger::level::warning, __FILE__, __LINE__,
+                    "Empty name is invalid for named object");
+        continue;
+      }
+
+      auto *const found_addr = priv_find_no_mutex<T>(name).first;
+      if (found_addr) {
+        // The same name could appear in names more than once
+        if (try2find) objects[i] = found_addr;
+        continue;
+      }
+
+      void *const ptr = allocate(sizeof(T));
+      if (!ptr) continue;
+      if (!priv_register_attr_object_no_mutex<T>(name, priv_to_offset(ptr),
+                                                 1)) {
+        deallocate(ptr);
+        continue;
+      }
+      objects[i] = static_cast<T *>(ptr);
+      allocated.push_back(i);
+    }
+  } catch (...) {
+    logger::out(logger::level::error, __FILE__, __LINE__,
+                "Exception was thrown when finding or allocating objects");
+    // The objects registered so far are constructed below
   }
 
-  if (name.is_unique()) {
-    auto itr = m_unique_object_directory.find(gen_type_name<T>());
-    if (itr != m_unique_object_directory.end()) {
-      auto *const addr = reinterpret_cast<T *>(priv_to_address(itr->offset()));
-      const auto length = itr->length();
-      return std::make_pair(addr, length);
+  // Constructs the objects outside the lock
+  std::size_t num_constructed = 0;
+  try {
+    for (; num_constructed < allocated.size(); ++num_constructed) {
+      new (objects[allocated[num_constructed]]) T(args...);
     }
-  } else {
-    auto itr = m_named_object_directory.find(name.get());
-    if (itr != m_named_object_directory.end()) {
-      auto *const addr = reinterpret_cast<T *>(priv_to_address(itr->offset()));
-      const auto length = itr->length();
-      return std::make_pair(addr, length);
+  } catch (...) {
+    // Frees the objects that have not been constructed
+    for (std::size_t k = num_constructed; k < allocated.size(); ++k) {
+      auto *const ptr = objects[allocated[k]];
+      try {
+        {
+#ifdef METALL_ENABLE_MUTEX_IN_MANAGER_KERNEL
+          lock_guard_type guard(*m_object_directories_mutex);
+#endif
+          priv_remove_attr_object_no_mutex(priv_to_offset(ptr));
+        }
+        deallocate(ptr);
+      } catch (...) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Exception was thrown when cleaning up an object");
+      }
     }
+    throw;
   }
 
-  return std::make_pair(nullptr, 0);
+  return objects;
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
@@ -179,7 +356,7 @@ bool manager_kernel<st, sst, cn, cs>::destroy(char_ptr_holder_type name) {
     lock_guard_type guard(*m_object_directories_mutex);
 #endif
 
-    std::tie(ptr, length) = find<T>(name);
+    std::tie(ptr, length) = priv_find_no_mutex<T>(name);
     if (!ptr) {
       return false;  // This is not a critical error --- could have been
                      // destroyed by another thread already.
@@ -225,13 +402,13 @@ template <typename st, typename sst, typename cn, std::size_t cs>
 template <typename T>
 const typename manager_kernel<st, sst, cn, cs>::char_type *
 manager_kernel<st, sst, cn, cs>::get_instance_name(const T *ptr) const {
-  auto nitr = m_named_object_directory.find(priv_to_offset(ptr));
-  if (nitr != m_named_object_directory.end()) {
+  auto nitr = priv_named_directory().find(priv_to_offset(ptr));
+  if (nitr != priv_named_directory().end()) {
     return nitr->name().c_str();
   }
 
-  auto uitr = m_unique_object_directory.find(priv_to_offset(ptr));
-  if (uitr != m_unique_object_directory.end()) {
+  auto uitr = priv_unique_directory().find(priv_to_offset(ptr));
+  if (uitr != priv_unique_directory().end()) {
     return uitr->name().c_str();
   }
 
@@ -243,15 +420,15 @@ template <typename st, typename sst, typename cn, std::size_t cs>
 template <typename T>
 typename manager_kernel<st, sst, cn, cs>::instance_kind
 manager_kernel<st, sst, cn, cs>::get_instance_kind(const T *ptr) const {
-  if (m_named_object_directory.count(priv_to_offset(ptr)) > 0) {
+  if (priv_named_directory().count(priv_to_offset(ptr)) > 0) {
     return instance_kind::named_kind;
   }
 
-  if (m_unique_object_directory.count(priv_to_offset(ptr)) > 0) {
+  if (priv_unique_directory().count(priv_to_offset(ptr)) > 0) {
     return instance_kind::unique_kind;
   }
 
-  if (m_anonymous_object_directory.count(priv_to_offset(ptr)) > 0) {
+  if (priv_anonymous_directory().count(priv_to_offset(ptr)) > 0) {
     return instance_kind::anonymous_kind;
   }
 
@@ -264,24 +441,24 @@ template <typename T>
 typename manager_kernel<st, sst, cn, cs>::size_type
 manager_kernel<st, sst, cn, cs>::get_instance_length(const T *ptr) const {
   {
-    auto itr = m_named_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_named_object_directory.end()) {
+    auto itr = priv_named_directory().find(priv_to_offset(ptr));
+    if (itr != priv_named_directory().end()) {
       assert(itr->length() > 0);
       return itr->length();
     }
   }
 
   {
-    auto itr = m_unique_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_unique_object_directory.end()) {
+    auto itr = priv_unique_directory().find(priv_to_offset(ptr));
+    if (itr != priv_unique_directory().end()) {
       assert(itr->length() > 0);
       return itr->length();
     }
   }
 
   {
-    auto itr = m_anonymous_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_anonymous_object_directory.end()) {
+    auto itr = priv_anonymous_directory().find(priv_to_offset(ptr));
+    if (itr != priv_anonymous_directory().end()) {
       assert(itr->length() > 0);
       return itr->length();
     }
@@ -295,22 +472,22 @@ template <typename T>
 bool manager_kernel<st, sst, cn, cs>::is_instance_type(
     const void *const ptr) const {
   {
-    auto itr = m_named_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_named_object_directory.end()) {
+    auto itr = priv_named_directory().find(priv_to_offset(ptr));
+    if (itr != priv_named_directory().end()) {
       return itr->type_id() == gen_type_id<T>();
     }
   }
 
   {
-    auto itr = m_unique_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_unique_object_directory.end()) {
+    auto itr = priv_unique_directory().find(priv_to_offset(ptr));
+    if (itr != priv_unique_directory().end()) {
       return itr->type_id() == gen_type_id<T>();
     }
   }
 
   {
-    auto itr = m_anonymous_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_anonymous_object_directory.end()) {
+    auto itr = priv_anonymous_directory().find(priv_to_offset(ptr));
+    if (itr != priv_anonymous_directory().end()) {
       return itr->type_id() == gen_type_id<T>();
     }
   }
@@ -323,24 +500,24 @@ template <typename T>
 bool manager_kernel<st, sst, cn, cs>::get_instance_description(
     const T *ptr, std::string *description) const {
   {
-    auto itr = m_named_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_named_object_directory.end()) {
+    auto itr = priv_named_directory().find(priv_to_offset(ptr));
+    if (itr != priv_named_directory().end()) {
       *description = itr->description();
       return true;
     }
   }
 
   {
-    auto itr = m_unique_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_unique_object_directory.end()) {
+    auto itr = priv_unique_directory().find(priv_to_offset(ptr));
+    if (itr != priv_unique_directory().end()) {
       *description = itr->description();
       return true;
     }
   }
 
   {
-    auto itr = m_anonymous_object_directory.find(priv_to_offset(ptr));
-    if (itr != m_anonymous_object_directory.end()) {
+    auto itr = priv_anonymous_directory().find(priv_to_offset(ptr));
+    if (itr != priv_anonymous_directory().end()) {
       *description = itr->description();
       return true;
     }
@@ -356,66 +533,66 @@ bool manager_kernel<st, sst, cn, cs>::set_instance_description(
   if (m_segment_storage.read_only()) return false;
 
   return (
-      m_named_object_directory.set_description(
-          m_named_object_directory.find(priv_to_offset(ptr)), description) ||
-      m_unique_object_directory.set_description(
-          m_unique_object_directory.find(priv_to_offset(ptr)), description) ||
-      m_anonymous_object_directory.set_description(
-          m_anonymous_object_directory.find(priv_to_offset(ptr)), description));
+      priv_named_directory().set_description(
+          priv_named_directory().find(priv_to_offset(ptr)), description) ||
+      priv_unique_directory().set_description(
+          priv_unique_directory().find(priv_to_offset(ptr)), description) ||
+      priv_anonymous_directory().set_description(
+          priv_anonymous_directory().find(priv_to_offset(ptr)), description));
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::size_type
 manager_kernel<st, sst, cn, cs>::get_num_named_objects() const {
-  return m_named_object_directory.size();
+  return priv_named_directory().size();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::size_type
 manager_kernel<st, sst, cn, cs>::get_num_unique_objects() const {
-  return m_unique_object_directory.size();
+  return priv_unique_directory().size();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::size_type
 manager_kernel<st, sst, cn, cs>::get_num_anonymous_objects() const {
-  return m_anonymous_object_directory.size();
+  return priv_anonymous_directory().size();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::const_named_iterator
 manager_kernel<st, sst, cn, cs>::named_begin() const {
-  return m_named_object_directory.begin();
+  return priv_named_directory().begin();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::const_named_iterator
 manager_kernel<st, sst, cn, cs>::named_end() const {
-  return m_named_object_directory.end();
+  return priv_named_directory().end();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::const_unique_iterator
 manager_kernel<st, sst, cn, cs>::unique_begin() const {
-  return m_unique_object_directory.begin();
+  return priv_unique_directory().begin();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::const_unique_iterator
 manager_kernel<st, sst, cn, cs>::unique_end() const {
-  return m_unique_object_directory.end();
+  return priv_unique_directory().end();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::const_anonymous_iterator
 manager_kernel<st, sst, cn, cs>::anonymous_begin() const {
-  return m_anonymous_object_directory.begin();
+  return priv_anonymous_directory().begin();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 typename manager_kernel<st, sst, cn, cs>::const_anonymous_iterator
 manager_kernel<st, sst, cn, cs>::anonymous_end() const {
-  return m_anonymous_object_directory.end();
+  return priv_anonymous_directory().end();
 }
 
 template <typename st, typename sst, typename cn, std::size_t cs>
@@ -453,6 +630,7 @@ template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::snapshot(
     const path_type &destination_base_path, const bool clone,
     const int num_max_copy_threads) {
+  METALL_TRACE_SCOPE(manager_snapshot, 0);
   return priv_snapshot(destination_base_path, clone, num_max_copy_threads);
 }
 
@@ -488,6 +666,130 @@ bool manager_kernel<st, sst, cn, cs>::consistent(const path_type &base_path) {
   return priv_consistent(base_path);
 }
 
+template <typename st, typename sst, typename cn, std::size_t cs>
+consistency_report manager_kernel<st, sst, cn, cs>::check_consistency(
+    const path_type &base_path, const bool repair, const int max_num_threads) {
+  consistency_report report;
+  report.properly_closed = priv_properly_closed(base_path);
+
+  json_store metadata;
+  if (!priv_read_management_metadata(base_path, &metadata)) {
+    report.errors.emplace_back("Cannot read management metadata");
+    return report;
+  }
+  if (!priv_check_version(metadata)) {
+    report.errors.emplace_back(
+        "Unsupported data store version: " +
+        to_version_string(priv_get_version(metadata)));
+    return report;
+  }
+
+  // Reads the management data without mapping the segment
+  segment_storage storage;
+  segment_memory_allocator allocator(&storage);
+  attributed_object_directory_type named_directory;
+  attributed_object_directory_type unique_directory;
+  attributed_object_directory_type anonymous_directory;
+  const auto management_path = [&base_path](const char *const prefix) {
+    return storage::get_path(base_path, {k_management_dir_name, prefix});
+  };
+  const std::pair<attributed_object_directory_type *, const char *>
+      directories[] = {
+          {&named_directory, k_named_object_directory_prefix},
+          {&unique_directory, k_unique_object_directory_prefix},
+          {&anonymous_directory, k_anonymous_object_directory_prefix}};
+  for (const auto &[directory, prefix] : directories) {
+    if (!directory->deserialize(management_path(prefix))) {
+      report.errors.emplace_back(std::string("Cannot read ") + prefix);
+      return report;
+    }
+  }
+  if (!allocator.deserialize(
+          management_path(k_segment_memory_allocator_prefix))) {
+    report.errors.emplace_back("Cannot read the allocator management data");
+    return report;
+  }
+  report.readable = true;
+  report.num_chunks = allocator.size() / k_chunk_size;
+
+  allocator.check_consistency(max_num_threads, repair, &report.errors);
+
+  // Segment files cannot be repaired; checked only
+  const auto segment_size = segment_storage::get_size(base_path);
+  if (segment_size < allocator.size()) {
+    report.errors.emplace_back(
+        "segment: the segment files (" + std::to_string(segment_size) +
+        " bytes) do not cover the used chunks (" +
+        std::to_string(allocator.size()) + " bytes)");
+    return report;
+  }
+
+  // Checks the object directories using multiple threads
+  std::vector<std::pair<attributed_object_directory_type *,
+                        attributed_object_directory_type::const_iterator>>
+      objects;
+  for (const auto &[directory, prefix] : directories) {
+    for (auto itr = directory->begin(); itr != directory->end(); ++itr) {
+      objects.emplace_back(directory, itr);
+    }
+  }
+  report.num_attributed_objects = objects.size();
+
+  const std::size_t num_threads = std::max<std::size_t>(
+      std::min<std::size_t>((max_num_threads > 0)
+                                ? max_num_threads
+                                : std::thread::hardware_concurrency(),
+                            objects.size()),
+      1);
+  std::vector<std::vector<std::size_t>> dangling_objects(num_threads);
+  const auto worker = [&](const std::size_t t) {
+    const std::size_t begin = objects.size() * t / num_threads;
+    const std::size_t end = objects.size() * (t + 1) / num_threads;
+    for (std::size_t i = begin; i < end; ++i) {
+      if (!allocator.allocated_object(objects[i].second->offset())) {
+        dangling_objects[t].push_back(i);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto &th : threads) th.join();
+
+  for (const auto &list : dangling_objects) {
+    for (const auto i : list) {
+      const auto &[directory, itr] = objects[i];
+      const std::string kind = (directory == &named_directory) ? "named"
+                               : (directory == &unique_directory)
+                                   ? "unique"
+                                   : "anonymous";
+      report.errors.emplace_back(
+          kind + " object directory: object '" + itr->name() +
+          "' at offset " + std::to_string(itr->offset()) +
+          " does not point to an allocated object");
+      if (repair) directory->erase(itr);
+    }
+  }
+
+  if (!repair || (report.errors.empty() && report.properly_closed)) {
+    return report;
+  }
+
+  // Writes the repaired management data back
+  for (const auto &[directory, prefix] : directories) {
+    if (!directory->serialize(management_path(prefix))) return report;
+  }
+  if (!allocator.serialize(
+          management_path(k_segment_memory_allocator_prefix))) {
+    return report;
+  }
+  report.repaired = report.properly_closed ||
+                    priv_mark_properly_closed(base_path);
+  return report;
+}
+
 template <typename st, typename sst, typename cn, std::size_t cs>
 std::string manager_kernel<st, sst, cn, cs>::get_uuid() const {
   return self_type::get_uuid(m_base_path);
@@ -575,7 +877,13 @@ manager_kernel<st, sst, cn, cs>::access_anonymous_object_attribute(
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::good() const noexcept {
-  return m_good;
+  if (!m_good) return false;
+  for (const auto kind :
+       {instance_kind::named_kind, instance_kind::unique_kind,
+        instance_kind::anonymous_kind}) {
+    if (priv_object_directory_failed(kind)) return false;
+  }
+  return true;
 }
 
 // -------------------- //
@@ -693,6 +1001,102 @@ bool manager_kernel<st, sst, cn, cs>::priv_unmark_properly_closed(
       storage::get_path(base_path, k_properly_closed_mark_file_name));
 }
 
+// ---------- For object directories ---------- //
+template <typename st, typename sst, typename cn, std::size_t cs>
+typename manager_kernel<st, sst, cn, cs>::attributed_object_directory_type &
+manager_kernel<st, sst, cn, cs>::priv_load_object_directory(
+    const instance_kind kind) const {
+  auto &directory = (kind == instance_kind::named_kind)
+                        ? m_named_object_directory
+                        : (kind == instance_kind::unique_kind)
+                              ? m_unique_object_directory
+                              : m_anonymous_object_directory;
+  auto &state = m_object_directory_load_states[kind];
+  std::call_once(state.once, [this, kind, &directory, &state]() {
+    const auto path = priv_object_directory_path(kind);
+    if (!directory.deserialize(path)) {
+      std::stringstream ss;
+      ss << "Failed to deserialize " << path;
+      logger::out(logger::level::error, __FILE__, __LINE__, ss.str().c_str());
+      // Not marked as loaded so that the file is not overwritten at close.
+      // The manager is no longer good and refuses to modify the directory.
+      directory.clear();
+      state.failed.store(true, std::memory_order_release);
+      return;
+    }
+    state.loaded.store(true, std::memory_order_release);
+  });
+  return directory;
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+bool manager_kernel<st, sst, cn, cs>::priv_object_directory_loaded(
+    const instance_kind kind) const {
+  return m_object_directory_load_states[kind].loaded.load(
+      std::memory_order_acquire);
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+bool manager_kernel<st, sst, cn, cs>::priv_object_directory_failed(
+    const instance_kind kind) const {
+  return m_object_directory_load_states &&
+         m_object_directory_load_states[kind].failed.load(
+             std::memory_order_acquire);
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+typename manager_kernel<st, sst, cn, cs>::path_type
+manager_kernel<st, sst, cn, cs>::priv_object_directory_path(
+    const instance_kind kind) const {
+  const char *const prefix = (kind == instance_kind::named_kind)
+                                 ? k_named_object_directory_prefix
+                             : (kind == instance_kind::unique_kind)
+                                 ? k_unique_object_directory_prefix
+                                 : k_anonymous_object_directory_prefix;
+  return storage::get_path(m_base_path, {k_management_dir_name, prefix});
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+template <typename T>
+std::pair<T *, typename manager_kernel<st, sst, cn, cs>::size_type>
+manager_kernel<st, sst, cn, cs>::priv_find_no_mutex(
+    char_ptr_holder_type name) const {
+  if (name.is_anonymous()) {
+    return std::make_pair(nullptr, 0);
+  }
+
+  const auto kind =
+      name.is_unique() ? instance_kind::unique_kind : instance_kind::named_kind;
+  const std::string key = name.is_unique() ? gen_type_name<T>() : name.get();
+
+  // Looks up the file instead of reading the whole directory,
+  // which has not been modified if it has not been read.
+  // Reads the directory once it has been looked up several times.
+  if (!priv_object_directory_loaded(kind) &&
+      m_object_directory_load_states[kind].num_file_lookups.fetch_add(
+          1, std::memory_order_relaxed) < k_max_object_directory_file_lookups) {
+    std::optional<typename attributed_object_directory_type::entry_type> entry;
+    if (attributed_object_directory_type::find_in_file(
+            priv_object_directory_path(kind), key, &entry)) {
+      if (!entry) return std::make_pair(nullptr, 0);
+      auto *const addr =
+          reinterpret_cast<T *>(priv_to_address(entry->offset()));
+      return std::make_pair(addr, entry->length());
+    }
+    // Reads the whole directory if the file could not be looked up
+  }
+
+  const auto &directory = priv_load_object_directory(kind);
+  auto itr = directory.find(key);
+  if (itr != directory.end()) {
+    auto *const addr = reinterpret_cast<T *>(priv_to_address(itr->offset()));
+    const auto length = itr->length();
+    return std::make_pair(addr, length);
+  }
+
+  return std::make_pair(nullptr, 0);
+}
+
 template <typename st, typename sst, typename cn, std::size_t cs>
 template <typename T, typename proxy>
 T *manager_kernel<st, sst, cn, cs>::priv_generic_construct(
@@ -704,7 +1108,7 @@ T *manager_kernel<st, sst, cn, cs>::priv_generic_construct(
 #endif
 
     if (!name.is_anonymous()) {
-      auto *const found_addr = find<T>(name).first;
+      auto *const found_addr = priv_find_no_mutex<T>(name).first;
       if (found_addr) {
         if (try2find) {
           return found_addr;
@@ -772,16 +1176,26 @@ template <typename st, typename sst, typename cn, std::size_t cs>
 template <typename T>
 bool manager_kernel<st, sst, cn, cs>::priv_register_attr_object_no_mutex(
     char_ptr_holder_type name, difference_type offset, size_type length) {
+  const auto kind = name.is_anonymous() ? instance_kind::anonymous_kind
+                    : name.is_unique()  ? instance_kind::unique_kind
+                                        : instance_kind::named_kind;
+  priv_load_object_directory(kind);
+  if (priv_object_directory_failed(kind)) {
+    logger::out(logger::level::error, __FILE__, __LINE__,
+                "Cannot register an object as its directory could not be read");
+    return false;
+  }
+
   if (name.is_anonymous()) {
-    if (!m_anonymous_object_directory.insert("", offset, length,
-                                             gen_type_id<T>())) {
+    if (!priv_anonymous_directory().insert("", offset, length,
+                                           gen_type_id<T>())) {
       logger::out(logger::level::error, __FILE__, __LINE__,
                   "Failed to insert an entry into the anonymous object table");
       return false;
     }
   } else if (name.is_unique()) {
-    if (!m_unique_object_directory.insert(gen_type_name<T>(), offset, length,
-                                          gen_type_id<T>())) {
+    if (!priv_unique_directory().insert(gen_type_name<T>(), offset, length,
+                                        gen_type_id<T>())) {
       logger::out(logger::level::error, __FILE__, __LINE__,
                   "Failed to insert an entry into the unique object table");
       return false;
@@ -793,8 +1207,8 @@ bool manager_kernel<st, sst, cn, cs>::priv_register_attr_object_no_mutex(
       return false;
     }
 
-    if (!m_named_object_directory.insert(name.get(), offset, length,
-                                         gen_type_id<T>())) {
+    if (!priv_named_directory().insert(name.get(), offset, length,
+                                       gen_type_id<T>())) {
       logger::out(logger::level::error, __FILE__, __LINE__,
                   "Failed to insert an entry into the named object table");
       return false;
@@ -807,11 +1221,17 @@ bool manager_kernel<st, sst, cn, cs>::priv_register_attr_object_no_mutex(
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::priv_remove_attr_object_no_mutex(
     difference_type offset) {
+  if (!good()) {
+    logger::out(logger::level::error, __FILE__, __LINE__,
+                "Cannot remove an object as a directory could not be read");
+    return false;
+  }
+
   // As the instance kind of the object is not given,
   // just call the eranse functions in all tables to simplify implementation.
-  if (!m_named_object_directory.erase(offset) &&
-      !m_unique_object_directory.erase(offset) &&
-      !m_anonymous_object_directory.erase(offset)) {
+  if (!priv_named_directory().erase(offset) &&
+      !priv_unique_directory().erase(offset) &&
+      !priv_anonymous_directory().erase(offset)) {
     logger::out(logger::level::error, __FILE__, __LINE__,
                 "Failed to erase an entry from object directories");
     return false;
@@ -931,6 +1351,14 @@ bool manager_kernel<st, sst, cn, cs>::priv_create(
     return false;
   }
 
+  // New object directories have nothing to read
+  for (std::size_t i = 0; i < k_num_object_directories; ++i) {
+    auto &state = m_object_directory_load_states[i];
+    std::call_once(state.once, [&state]() {
+      state.loaded.store(true, std::memory_order_release);
+    });
+  }
+
   return true;
 }
 
@@ -941,28 +1369,26 @@ bool manager_kernel<st, sst, cn, cs>::priv_serialize_management_data() {
 
   if (m_segment_storage.read_only()) return true;
 
-  if (!m_named_object_directory.serialize(
-          storage::get_path(m_base_path, {k_management_dir_name,
-                                          k_named_object_directory_prefix})
-              .c_str())) {
+  // A directory that has not been read is the same as its file
+  if (priv_object_directory_loaded(instance_kind::named_kind) &&
+      !m_named_object_directory.serialize(
+          priv_object_directory_path(instance_kind::named_kind))) {
     logger::out(logger::level::error, __FILE__, __LINE__,
                 "Failed to serialize named object directory");
     return false;
   }
 
-  if (!m_unique_object_directory.serialize(
-          storage::get_path(m_base_path, {k_management_dir_name,
-                                          k_unique_object_directory_prefix})
-              .c_str())) {
+  if (priv_object_directory_loaded(instance_kind::unique_kind) &&
+      !m_unique_object_directory.serialize(
+          priv_object_directory_path(instance_kind::unique_kind))) {
     logger::out(logger::level::error, __FILE__, __LINE__,
                 "Failed to serialize unique object directory");
     return false;
   }
 
-  if (!m_anonymous_object_directory.serialize(
-          storage::get_path(m_base_path, {k_management_dir_name,
-                                          k_anonymous_object_directory_prefix})
-              .c_str())) {
+  if (priv_object_directory_loaded(instance_kind::anonymous_kind) &&
+      !m_anonymous_object_directory.serialize(
+          priv_object_directory_path(instance_kind::anonymous_kind))) {
     logger::out(logger::level::error, __FILE__, __LINE__,
                 "Failed to serialize anonymous object directory");
     return false;
@@ -979,31 +1405,32 @@ bool manager_kernel<st, sst, cn, cs>::priv_serialize_management_data() {
 
 template <typename st, typename sst, typename cn, std::size_t cs>
 bool manager_kernel<st, sst, cn, cs>::priv_deserialize_management_data() {
-  if (!m_named_object_directory.deserialize(
-          storage::get_path(m_base_path, {k_management_dir_name,
-                                          k_named_object_directory_prefix})
-              .c_str())) {
-    logger::out(logger::level::error, __FILE__, __LINE__,
-                "Failed to deserialize named object directory");
-    return false;
-  }
-
-  if (!m_unique_object_directory.deserialize(
-          storage::get_path(m_base_path, {k_management_dir_name,
-                                          k_unique_object_directory_prefix})
-              .c_str())) {
-    logger::out(logger::level::error, __FILE__, __LINE__,
-                "Failed to deserialize unique object directory");
-    return false;
-  }
-
-  if (!m_anonymous_object_directory.deserialize(
-          storage::get_path(m_base_path, {k_management_dir_name,
-                                          k_anonymous_object_directory_prefix})
-              .c_str())) {
-    logger::out(logger::level::error, __FILE__, __LINE__,
-                "Failed to deserialize anonymous object directory");
-    return false;
+  // Object directories are read on first use.
+  // Only the layout of the files is checked here so that broken files are
+  // detected at open time.
+  // Files written by older versions, which do not have the name index,
+  // are read here to check them as before.
+  for (const auto kind :
+       {instance_kind::named_kind, instance_kind::unique_kind,
+        instance_kind::anonymous_kind}) {
+    const auto path = priv_object_directory_path(kind);
+    if (attributed_object_directory_type::has_name_index(path)) {
+      if (!attributed_object_directory_type::check_name_index(path)) {
+        std::stringstream ss;
+        ss << "Broken object directory " << path;
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    ss.str().c_str());
+        return false;
+      }
+      continue;
+    }
+    priv_load_object_directory(kind);
+    if (!priv_object_directory_loaded(kind)) {
+      std::stringstream ss;
+      ss << "Failed to deserialize " << path;
+      logger::out(logger::level::error, __FILE__, __LINE__, ss.str().c_str());
+      return false;
+    }
   }
 
   if (!m_segment_memory_allocator.deserialize(storage::get_path(
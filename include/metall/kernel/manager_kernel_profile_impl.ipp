@@ -17,6 +17,20 @@ void manager_kernel<st, sst, cn, cs>::profile(out_stream_type *log_out) {
   m_segment_memory_allocator.profile(log_out);
 }
 
+template <typename st, typename sst, typename cn, std::size_t cs>
+allocator_statistics
+manager_kernel<st, sst, cn, cs>::get_allocator_statistics() const {
+  priv_check_sanity();
+  return m_segment_memory_allocator.statistics();
+}
+
+template <typename st, typename sst, typename cn, std::size_t cs>
+fragmentation_report manager_kernel<st, sst, cn, cs>::analyze_fragmentation(
+    const double sparse_occupancy) {
+  priv_check_sanity();
+  return m_segment_memory_allocator.analyze_fragmentation(sparse_occupancy);
+}
+
 }  // namespace kernel
 }  // namespace metall
 
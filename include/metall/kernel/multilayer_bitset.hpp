@@ -211,6 +211,25 @@ class multilayer_bitset {
     }
   }
 
+  /// \brief Counts the bits whose values are true.
+  /// \param size The number of bits this bitset holds.
+  /// \return The number of true bits.
+  std::size_t count(const std::size_t size) const {
+    if (size <= block_size()) {
+      return mdtl::popcountll(m_data.block);
+    }
+    // Only the last layer holds the actual bits
+    const std::size_t idx = mdtl::log2_dynamic(mdtl::next_power_of_2(size));
+    assert(idx < mlbs::k_num_index_blocks_table.size());
+    const std::size_t first_block = mlbs::k_num_index_blocks_table[idx];
+    const std::size_t last_block = num_all_blocks(size);
+    std::size_t num_bits = 0;
+    for (std::size_t i = first_block; i < last_block; ++i) {
+      num_bits += mdtl::popcountll(m_data.array[i]);
+    }
+    return num_bits;
+  }
+
   /// \brief Serializes the internal data.
   /// \param size The number of bits this bitset holds.
   /// \return Serialized data as std::string.
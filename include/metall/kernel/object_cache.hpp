@@ -17,6 +17,7 @@
 
 #include <metall/detail/proc.hpp>
 #include <metall/detail/hash.hpp>
+#include <metall/tracer.hpp>
 
 #ifndef METALL_DISABLE_CONCURRENCY
 #define METALL_ENABLE_MUTEX_IN_OBJECT_CACHE
@@ -638,8 +639,11 @@ class object_cache {
         assert(new_block);
         new_block->clear();
         new_block->bin_no = bin_no;
-        (allocator_instance->*allocator_function)(bin_no, num_new_objects,
-                                                  new_block->cache);
+        {
+          METALL_TRACE_SCOPE(cache_refill, bin_no);
+          (allocator_instance->*allocator_function)(bin_no, num_new_objects,
+                                                    new_block->cache);
+        }
 
         // Link the new block to the existing blocks
         new_block->link_to_older(cache_header.newest_block(),
@@ -733,8 +737,11 @@ class object_cache {
       const auto num_objects = (bin_header.active_block() == oldest_block)
                                    ? bin_header.active_block_size()
                                    : cache_block_type::k_capacity;
-      (allocator_instance->*deallocator_function)(bin_no, num_objects,
-                                                  oldest_block->cache);
+      {
+        METALL_TRACE_SCOPE(cache_evict, bin_no);
+        (allocator_instance->*deallocator_function)(bin_no, num_objects,
+                                                    oldest_block->cache);
+      }
       assert(total_size >= num_objects * object_size);
       total_size -= num_objects * object_size;
 
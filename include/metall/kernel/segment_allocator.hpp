@@ -16,14 +16,21 @@
 #include <limits>
 #include <set>
 #include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <thread>
 
 #include <metall/kernel/bin_number_manager.hpp>
 #include <metall/kernel/bin_directory.hpp>
 #include <metall/kernel/chunk_directory.hpp>
 #include <metall/kernel/object_size_manager.hpp>
+#include <metall/kernel/allocator_statistics.hpp>
+#include <metall/kernel/fragmentation_report.hpp>
 #include <metall/detail/char_ptr_holder.hpp>
 #include <metall/detail/utilities.hpp>
 #include <metall/logger.hpp>
+#include <metall/tracer.hpp>
 
 #ifndef METALL_DISABLE_CONCURRENCY
 #define METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
@@ -101,6 +108,7 @@ class segment_allocator {
 #ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
   using mutex_type = mdtl::mutex;
   using lock_guard_type = mdtl::mutex_lock_guard;
+  using unique_lock_type = mdtl::mutex_unique_lock;
 #endif
 
   // Threshold to enable the many allocation feature internally
@@ -155,6 +163,7 @@ class segment_allocator {
                             ? priv_allocate_small_object(bin_no)
                             : priv_allocate_large_object(bin_no);
     assert(offset >= 0 || offset == k_null_offset);
+    if (offset != k_null_offset) m_statistics.count_allocation(bin_no);
 
     return offset;
   }
@@ -214,6 +223,7 @@ class segment_allocator {
 
     const chunk_no_type chunk_no = offset / k_chunk_size;
     const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+    m_statistics.count_deallocation(bin_no);
 
     if (priv_small_object_bin(bin_no)) {
       priv_deallocate_small_object(offset, bin_no);
@@ -222,6 +232,115 @@ class segment_allocator {
     }
   }
 
+  /// \brief Returns the size of the memory an allocated object can use,
+  /// which is equal to or larger than the requested size.
+  /// \param offset The offset of an allocated object.
+  /// \return The usable size of the object.
+  size_type usable_size(const difference_type offset) const {
+    assert(offset >= 0);
+    const chunk_no_type chunk_no = offset / k_chunk_size;
+    return bin_no_mngr::to_object_size(m_chunk_directory.bin_no(chunk_no));
+  }
+
+  /// \brief Tries to expand an allocated object in place.
+  /// A large object grows by taking over the unused chunks that follow it;
+  /// a small object can 'grow' only within its current object size.
+  /// Tries the preferred size first, then the minimum size.
+  /// \param offset The offset of an allocated object.
+  /// \param min_nbytes The minimum size required.
+  /// \param nbytes On input, the preferred size.
+  /// On success, the new usable size of the object is stored.
+  /// \return Returns true on success. On failure, the object is unchanged.
+  bool expand_in_place(const difference_type offset, const size_type min_nbytes,
+                       size_type *const nbytes) {
+    if (offset == k_null_offset || !nbytes) return false;
+    assert(offset >= 0);
+
+    const chunk_no_type chunk_no = offset / k_chunk_size;
+    const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+    const size_type current_size = bin_no_mngr::to_object_size(bin_no);
+    if (min_nbytes <= current_size) {
+      *nbytes = current_size;
+      return true;
+    }
+    if (priv_small_object_bin(bin_no) || min_nbytes > k_max_size) {
+      return false;
+    }
+    assert(offset % k_chunk_size == 0);
+
+#ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
+    lock_guard_type chunk_guard(*m_chunk_mutex);
+#endif
+    const size_type preferred_nbytes =
+        std::min(std::max(*nbytes, min_nbytes), k_max_size);
+    for (const auto request : {preferred_nbytes, min_nbytes}) {
+      const bin_no_type new_bin_no = bin_no_mngr::to_bin_no(request);
+      if (!m_chunk_directory.extend_large_chunk(chunk_no, new_bin_no)) {
+        continue;
+      }
+      if (!priv_extend_segment_without_lock(chunk_no,
+                                            priv_num_chunks(new_bin_no))) {
+        m_chunk_directory.shrink_large_chunk(chunk_no, bin_no);
+        return false;
+      }
+      *nbytes = bin_no_mngr::to_object_size(new_bin_no);
+      m_statistics.count_in_place_resize(bin_no, new_bin_no);
+      return true;
+    }
+    return false;
+  }
+
+  /// \brief Tries to shrink an allocated object in place.
+  /// Only a large object can shrink, by releasing its trailing chunks.
+  /// \param offset The offset of an allocated object.
+  /// \param max_nbytes The maximum size acceptable after shrinking.
+  /// \param nbytes On input, the preferred size.
+  /// On success, the new usable size of the object is stored.
+  /// \return Returns true on success, i.e., the usable size is equal to or
+  /// smaller than max_nbytes. On failure, the object is unchanged.
+  bool shrink_in_place(const difference_type offset, const size_type max_nbytes,
+                       size_type *const nbytes) {
+    if (offset == k_null_offset || !nbytes || *nbytes > max_nbytes) {
+      return false;
+    }
+    assert(offset >= 0);
+
+    const chunk_no_type chunk_no = offset / k_chunk_size;
+    const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+    const size_type current_size = bin_no_mngr::to_object_size(bin_no);
+    if (*nbytes > current_size) return false;
+
+    // A large object cannot become a small one
+    const bin_no_type new_bin_no = std::max(
+        bin_no_mngr::to_bin_no(std::max(*nbytes, size_type(1))),
+        priv_small_object_bin(bin_no) ? bin_no
+                                      : static_cast<bin_no_type>(
+                                            k_num_small_bins));
+    if (new_bin_no >= bin_no) {
+      if (current_size > max_nbytes) return false;
+      *nbytes = current_size;
+      return true;
+    }
+
+    const size_type new_size = bin_no_mngr::to_object_size(new_bin_no);
+    if (new_size > max_nbytes) return false;
+
+#ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
+    lock_guard_type chunk_guard(*m_chunk_mutex);
+#endif
+    m_chunk_directory.shrink_large_chunk(chunk_no, new_bin_no);
+    priv_free_chunk(chunk_no + priv_num_chunks(new_bin_no),
+                    priv_num_chunks(bin_no) - priv_num_chunks(new_bin_no));
+    m_statistics.count_in_place_resize(bin_no, new_bin_no);
+    *nbytes = new_size;
+    return true;
+  }
+
+  /// \brief Takes a snapshot of the allocator statistics.
+  /// Unlike profile(), this function does not stop or disturb allocations.
+  /// \return A snapshot of the statistics.
+  allocator_statistics statistics() const { return m_statistics.snapshot(); }
+
   /// \brief Checks if all memory is deallocated.
   /// This function is not cheap if many objects are allocated.
   /// \return Returns true if all memory is deallocated.
@@ -289,6 +408,7 @@ class segment_allocator {
                   "Failed to deserialize chunk directory");
       return false;
     }
+    m_statistics.set_initial_bytes_in_use(priv_count_bytes_in_use());
     return true;
   }
 
@@ -358,6 +478,203 @@ class segment_allocator {
     }
   }
 
+  /// \brief Analyzes the fragmentation of the chunks holding small objects.
+  /// As profile() does, this function releases the object cache.
+  /// This function is not thread safe.
+  /// \param sparse_occupancy A chunk is counted as sparse if its occupancy is
+  /// equal to or less than this value.
+  /// \return A fragmentation report.
+  fragmentation_report analyze_fragmentation(const double sparse_occupancy) {
+#ifndef METALL_DISABLE_OBJECT_CACHE
+    priv_clear_object_cache();
+#endif
+
+    fragmentation_report report;
+    report.chunk_size = k_chunk_size;
+    report.bins.resize(k_num_small_bins);
+    for (size_type b = 0; b < k_num_small_bins; ++b) {
+      report.bins[b].object_size = bin_no_mngr::to_object_size(b);
+    }
+
+    for (chunk_no_type chunk_no = 0; chunk_no < m_chunk_directory.size();) {
+      if (m_chunk_directory.unused_chunk(chunk_no)) {
+        ++chunk_no;
+        continue;
+      }
+      const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+      if (!priv_small_object_bin(bin_no)) {
+        chunk_no += priv_num_chunks(bin_no);
+        continue;
+      }
+
+      auto &bin = report.bins[bin_no];
+      const size_type num_slots = m_chunk_directory.slots(chunk_no);
+      const size_type num_occupied_slots =
+          m_chunk_directory.occupied_slots(chunk_no);
+      ++bin.num_chunks;
+      bin.num_slots += num_slots;
+      bin.num_occupied_slots += num_occupied_slots;
+      if (num_occupied_slots <= sparse_occupancy * num_slots) {
+        ++bin.num_sparse_chunks;
+      }
+      ++chunk_no;
+    }
+
+    for (auto &bin : report.bins) {
+      if (bin.num_chunks == 0) continue;
+      const size_type num_slots_per_chunk = bin.num_slots / bin.num_chunks;
+      const size_type num_required_chunks =
+          (bin.num_occupied_slots + num_slots_per_chunk - 1) /
+          num_slots_per_chunk;
+      bin.num_reclaimable_chunks = bin.num_chunks - num_required_chunks;
+    }
+
+    return report;
+  }
+
+  /// \brief Relocates small objects out of sparse chunks into denser chunks
+  /// of the same bin and frees the emptied chunks.
+  /// The object cache is released beforehand.
+  /// This function is not thread safe: no other thread may allocate,
+  /// deallocate, or access objects while it runs.
+  /// \tparam relocator_type A callable type whose signature is
+  /// bool(difference_type src_offset, difference_type dst_offset,
+  /// size_type object_size).
+  /// \param max_occupancy Only chunks whose occupancy is equal to or less than
+  /// this value are evacuated.
+  /// \param relocator Called for each object to relocate.
+  /// It must move the object at src_offset to dst_offset and return true,
+  /// or return false to keep the object in place.
+  /// It must not allocate or deallocate memory.
+  /// \return The result of the compaction.
+  template <typename relocator_type>
+  compaction_result compact_small_objects(const double max_occupancy,
+                                          relocator_type &&relocator) {
+#ifndef METALL_DISABLE_OBJECT_CACHE
+    priv_clear_object_cache();
+#endif
+
+    compaction_result result;
+    for (size_type b = 0; b < k_num_small_bins; ++b) {
+      priv_compact_small_object_bin(static_cast<bin_no_type>(b), max_occupancy,
+                                    relocator, &result);
+    }
+    result.freed_bytes = result.num_freed_chunks * k_chunk_size;
+    return result;
+  }
+
+  /// \brief Checks the consistency between the chunk directory and
+  /// the bin directory (the list of non-full chunks).
+  /// Chunks are checked by multiple threads.
+  /// Intended to be called on deserialized management data before it is used;
+  /// this function is not thread safe.
+  /// \param max_num_threads The maximum number of threads to use.
+  /// If <= 0 is given, the value is determined automatically.
+  /// \param repair If true, repairs the found problems.
+  /// \param errors A buffer to append descriptions of the found problems.
+  /// \return The number of found problems.
+  size_type check_consistency(const int max_num_threads, const bool repair,
+                              std::vector<std::string> *const errors) {
+    const size_type num_chunks = m_chunk_directory.size();
+    std::vector<std::string> found_errors;
+    std::vector<chunk_no_type> broken_chunks;
+    bool broken_bin_directory = false;
+
+    // The number of times each chunk is listed in the bin directory
+    std::vector<uint8_t> num_listed(num_chunks, 0);
+    for (size_type b = 0; b < k_num_small_bins; ++b) {
+      const auto bin_no = static_cast<bin_no_type>(b);
+      for (auto itr = m_non_full_chunk_bin.begin(bin_no);
+           itr != m_non_full_chunk_bin.end(bin_no); ++itr) {
+        const chunk_no_type chunk_no = *itr;
+        if (chunk_no >= num_chunks ||
+            m_chunk_directory.unused_chunk(chunk_no) ||
+            m_chunk_directory.bin_no(chunk_no) != bin_no) {
+          found_errors.emplace_back("bin directory: bin " + std::to_string(b) +
+                                    " lists chunk " +
+                                    std::to_string(chunk_no) +
+                                    ", which does not belong to the bin");
+          broken_bin_directory = true;
+        } else if (num_listed[chunk_no] > 0) {
+          found_errors.emplace_back("bin directory: chunk " +
+                                    std::to_string(chunk_no) +
+                                    " is listed more than once");
+          broken_bin_directory = true;
+        } else {
+          num_listed[chunk_no] = 1;
+        }
+      }
+    }
+
+    const auto results = priv_check_chunks_in_parallel(
+        max_num_threads, [this, &num_listed](const chunk_no_type chunk_no) {
+          auto error = m_chunk_directory.check_chunk(chunk_no);
+          if (!error.empty() || m_chunk_directory.unused_chunk(chunk_no) ||
+              !priv_small_object_bin(m_chunk_directory.bin_no(chunk_no))) {
+            return error;
+          }
+          const bool full = m_chunk_directory.all_slots_marked(chunk_no);
+          if (!full && num_listed[chunk_no] == 0) {
+            return std::string("non-full chunk is not in the bin directory");
+          }
+          if (full && num_listed[chunk_no] > 0) {
+            return std::string("full chunk is in the bin directory");
+          }
+          return error;
+        });
+    for (const auto &[chunk_no, error] : results) {
+      found_errors.emplace_back("chunk directory: chunk " +
+                                std::to_string(chunk_no) + ": " + error);
+      broken_chunks.push_back(chunk_no);
+    }
+
+    if (repair && !found_errors.empty()) {
+      for (const auto chunk_no : broken_chunks) {
+        m_chunk_directory.repair_chunk(chunk_no);
+      }
+      if (!broken_chunks.empty() || broken_bin_directory) {
+        priv_rebuild_non_full_chunk_bin();
+      }
+      m_statistics.set_initial_bytes_in_use(priv_count_bytes_in_use());
+    }
+
+    if (errors) {
+      errors->insert(errors->end(), found_errors.begin(), found_errors.end());
+    }
+    return found_errors.size();
+  }
+
+  /// \brief Checks if an object is allocated at an offset.
+  /// The offset must point to the beginning of a small object slot or
+  /// a large chunk.
+  /// This function does not modify anything; thus, it can be called by
+  /// multiple threads at the same time if no other thread modifies the
+  /// allocator.
+  /// \param offset An offset.
+  /// \return Returns true if an object is allocated at the offset.
+  bool allocated_object(const difference_type offset) const {
+    if (offset < 0) return false;
+    const auto chunk_no = static_cast<chunk_no_type>(offset / k_chunk_size);
+    if (chunk_no >= m_chunk_directory.size() ||
+        m_chunk_directory.unused_chunk(chunk_no)) {
+      return false;
+    }
+
+    const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+    const difference_type offset_in_chunk = offset % k_chunk_size;
+    if (!priv_small_object_bin(bin_no)) {
+      return offset_in_chunk == 0 &&
+             m_chunk_directory.head_chunk(chunk_no);
+    }
+
+    const size_type object_size = bin_no_mngr::to_object_size(bin_no);
+    if (offset_in_chunk % object_size != 0) return false;
+    const auto slot_no =
+        static_cast<chunk_slot_no_type>(offset_in_chunk / object_size);
+    return slot_no < m_chunk_directory.slots(chunk_no) &&
+           m_chunk_directory.marked_slot(chunk_no, slot_no);
+  }
+
  private:
   // -------------------- //
   // Private methods (not designed to be used by the base class)
@@ -366,6 +683,105 @@ class segment_allocator {
     return bin_no < k_num_small_bins;
   }
 
+  static size_type priv_num_chunks(const bin_no_type bin_no) {
+    return (bin_no_mngr::to_object_size(bin_no) + k_chunk_size - 1) /
+           k_chunk_size;
+  }
+
+#ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
+  /// \brief Locks a bin, measuring the wait time only if it is contended.
+  unique_lock_type priv_lock_bin(const bin_no_type bin_no) {
+    unique_lock_type lock(m_bin_mutex->at(bin_no), std::try_to_lock);
+    if (lock.owns_lock()) {
+      m_statistics.count_bin_lock(0);
+      return lock;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    {
+      METALL_TRACE_SCOPE(allocator_bin_lock_wait, bin_no);
+      lock.lock();
+    }
+    const auto wait_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    m_statistics.count_bin_lock(std::max<std::uint64_t>(wait_time.count(), 1));
+    return lock;
+  }
+#endif
+
+  /// \brief Applies 'check' to each used chunk by multiple threads.
+  /// \return Chunk numbers and the non-empty strings returned by 'check',
+  /// sorted by chunk number.
+  template <typename check_function>
+  std::vector<std::pair<chunk_no_type, std::string>>
+  priv_check_chunks_in_parallel(const int max_num_threads,
+                                const check_function &check) const {
+    const size_type num_chunks = m_chunk_directory.size();
+    const size_type num_threads = std::max<size_type>(
+        std::min<size_type>(
+            (max_num_threads > 0) ? max_num_threads
+                                  : std::thread::hardware_concurrency(),
+            num_chunks),
+        1);
+
+    std::vector<std::vector<std::pair<chunk_no_type, std::string>>> results(
+        num_threads);
+    const auto worker = [&](const size_type t) {
+      const size_type begin = num_chunks * t / num_threads;
+      const size_type end = num_chunks * (t + 1) / num_threads;
+      for (size_type c = begin; c < end; ++c) {
+        const auto chunk_no = static_cast<chunk_no_type>(c);
+        auto error = check(chunk_no);
+        if (!error.empty()) results[t].emplace_back(chunk_no, std::move(error));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_type t = 1; t < num_threads; ++t) threads.emplace_back(worker, t);
+    worker(0);
+    for (auto &th : threads) th.join();
+
+    std::vector<std::pair<chunk_no_type, std::string>> merged;
+    for (auto &r : results) {
+      std::move(r.begin(), r.end(), std::back_inserter(merged));
+    }
+    return merged;
+  }
+
+  /// \brief Rebuilds the bin directory from the chunk directory.
+  void priv_rebuild_non_full_chunk_bin() {
+    m_non_full_chunk_bin.clear();
+    for (chunk_no_type chunk_no = 0; chunk_no < m_chunk_directory.size();
+         ++chunk_no) {
+      if (m_chunk_directory.unused_chunk(chunk_no)) continue;
+      const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+      if (priv_small_object_bin(bin_no) &&
+          !m_chunk_directory.all_slots_marked(chunk_no)) {
+        m_non_full_chunk_bin.insert(bin_no, chunk_no);
+      }
+    }
+  }
+
+  /// \brief Returns the total size of the objects in the chunk directory.
+  size_type priv_count_bytes_in_use() const {
+    size_type nbytes = 0;
+    for (chunk_no_type chunk_no = 0; chunk_no < m_chunk_directory.size();) {
+      if (m_chunk_directory.unused_chunk(chunk_no)) {
+        ++chunk_no;
+        continue;
+      }
+      const bin_no_type bin_no = m_chunk_directory.bin_no(chunk_no);
+      if (priv_small_object_bin(bin_no)) {
+        nbytes += bin_no_mngr::to_object_size(bin_no) *
+                  m_chunk_directory.occupied_slots(chunk_no);
+        ++chunk_no;
+      } else {
+        nbytes += bin_no_mngr::to_object_size(bin_no);
+        chunk_no += priv_num_chunks(bin_no);
+      }
+    }
+    return nbytes;
+  }
+
   fs::path priv_make_file_name(const fs::path &base_name,
                                const std::string &item_name) {
     return base_name.string() + "_" + item_name;
@@ -376,9 +792,10 @@ class segment_allocator {
 #ifndef METALL_DISABLE_OBJECT_CACHE
     if (bin_no <= m_object_cache.max_bin_no()) {
       const auto offset = m_object_cache.pop(
-          bin_no, this, &myself::priv_allocate_small_objects_from_global,
+          bin_no, this, &myself::priv_refill_object_cache,
           &myself::priv_deallocate_small_objects_from_global);
       assert(offset >= 0 || offset == k_null_offset);
+      m_statistics.count_cached_allocation();
       return offset;
     }
 #endif
@@ -387,11 +804,21 @@ class segment_allocator {
     return offset;
   }
 
+#ifndef METALL_DISABLE_OBJECT_CACHE
+  void priv_refill_object_cache(const bin_no_type bin_no,
+                                const size_type num_allocates,
+                                difference_type *const allocated_offsets) {
+    m_statistics.count_cache_miss();
+    priv_allocate_small_objects_from_global(bin_no, num_allocates,
+                                            allocated_offsets);
+  }
+#endif
+
   void priv_allocate_small_objects_from_global(
       const bin_no_type bin_no, const size_type num_allocates,
       difference_type *const allocated_offsets) {
 #ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
-    lock_guard_type bin_guard(m_bin_mutex->at(bin_no));
+    const auto bin_guard = priv_lock_bin(bin_no);
 #endif
 
     if (num_allocates >= k_many_allocations_threshold) {
@@ -488,6 +915,7 @@ class segment_allocator {
   }
 
   difference_type priv_allocate_large_object(const bin_no_type bin_no) {
+    METALL_TRACE_SCOPE(allocator_allocate_large, bin_no);
 #ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
     lock_guard_type chunk_guard(*m_chunk_mutex);
 #endif
@@ -519,6 +947,7 @@ class segment_allocator {
       logger::out(logger::level::error, __FILE__, __LINE__, ss.str().c_str());
       return false;
     }
+    m_statistics.count_segment_extension();
 
     return true;
   }
@@ -542,7 +971,7 @@ class segment_allocator {
       const bin_no_type bin_no, const size_type num_deallocates,
       const difference_type offsets[]) {
 #ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
-    lock_guard_type bin_guard(m_bin_mutex->at(bin_no));
+    const auto bin_guard = priv_lock_bin(bin_no);
 #endif
     for (size_type i = 0; i < num_deallocates; ++i) {
       priv_deallocate_small_object_from_global_without_bin_lock(offsets[i],
@@ -641,10 +1070,12 @@ class segment_allocator {
     assert(free_size % m_segment_storage->page_size() == 0);
 
     m_segment_storage->free_region(range_begin, free_size);
+    m_statistics.count_free_region(free_size);
   }
 
   void priv_deallocate_large_object(const chunk_no_type chunk_no,
                                     const bin_no_type bin_no) {
+    METALL_TRACE_SCOPE(allocator_deallocate_large, bin_no);
 #ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
     lock_guard_type chunk_guard(*m_chunk_mutex);
 #endif
@@ -660,6 +1091,74 @@ class segment_allocator {
     const size_type length = num_chunks * k_chunk_size;
     assert(offset + length <= m_segment_storage->size());
     m_segment_storage->free_region(offset, length);
+    m_statistics.count_free_region(length);
+  }
+
+  // ---------- For compaction ---------- //
+  /// \brief Moves objects from the sparsest non-full chunks of a bin to the
+  /// densest ones until they meet.
+  template <typename relocator_type>
+  void priv_compact_small_object_bin(const bin_no_type bin_no,
+                                     const double max_occupancy,
+                                     relocator_type &relocator,
+                                     compaction_result *const result) {
+    // Full chunks can be neither sources nor destinations
+    std::vector<chunk_no_type> chunks(m_non_full_chunk_bin.begin(bin_no),
+                                      m_non_full_chunk_bin.end(bin_no));
+    if (chunks.size() < 2) return;
+    std::sort(chunks.begin(), chunks.end(),
+              [this](const chunk_no_type lhs, const chunk_no_type rhs) {
+                return m_chunk_directory.occupied_slots(lhs) <
+                       m_chunk_directory.occupied_slots(rhs);
+              });
+
+    const size_type object_size = bin_no_mngr::to_object_size(bin_no);
+    const size_type num_slots = m_chunk_directory.slots(chunks.front());
+    std::size_t src = 0;
+    std::size_t dst = chunks.size() - 1;
+    for (; src < dst; ++src) {
+      const chunk_no_type src_chunk_no = chunks[src];
+      if (m_chunk_directory.occupied_slots(src_chunk_no) >
+          max_occupancy * num_slots) {
+        break;  // The rest are denser
+      }
+
+      for (size_type slot_no = 0; slot_no < num_slots; ++slot_no) {
+        if (!m_chunk_directory.marked_slot(src_chunk_no, slot_no)) continue;
+
+        while (src < dst && m_chunk_directory.all_slots_marked(chunks[dst])) {
+          --dst;
+        }
+        if (src == dst) break;
+
+        const chunk_no_type dst_chunk_no = chunks[dst];
+        const auto dst_slot_no =
+            m_chunk_directory.find_and_mark_slot(dst_chunk_no);
+        const difference_type src_offset =
+            k_chunk_size * src_chunk_no + object_size * slot_no;
+        const difference_type dst_offset =
+            k_chunk_size * dst_chunk_no + object_size * dst_slot_no;
+        if (!relocator(src_offset, dst_offset, object_size)) {
+          m_chunk_directory.unmark_slot(dst_chunk_no, dst_slot_no);
+          ++result->num_pinned_objects;
+          continue;
+        }
+        ++result->num_relocated_objects;
+
+        if (m_chunk_directory.all_slots_marked(dst_chunk_no)) {
+          m_non_full_chunk_bin.erase(bin_no, dst_chunk_no);
+        }
+        // The source chunk is erased when its last object leaves
+        const bool last_object =
+            m_chunk_directory.occupied_slots(src_chunk_no) == 1;
+        priv_deallocate_small_object_from_global_without_bin_lock(src_offset,
+                                                                  bin_no);
+        if (last_object) {
+          ++result->num_freed_chunks;
+          break;
+        }
+      }
+    }
   }
 
   // ---------- For object cache ---------- //
@@ -714,6 +1213,8 @@ class segment_allocator {
   small_object_cache_type m_object_cache;
 #endif
 
+  allocator_statistics_counter<bin_no_mngr> m_statistics;
+
 #ifdef METALL_ENABLE_MUTEX_IN_SEGMENT_ALLOCATOR
   std::unique_ptr<mutex_type> m_chunk_mutex{nullptr};
   std::unique_ptr<std::array<mutex_type, k_num_small_bins>> m_bin_mutex{
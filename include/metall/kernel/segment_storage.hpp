@@ -19,6 +19,7 @@
 #include "metall/detail/mmap.hpp"
 #include "metall/detail/utilities.hpp"
 #include "metall/logger.hpp"
+#include "metall/tracer.hpp"
 #include "metall/kernel/storage.hpp"
 #include "metall/kernel/segment_header.hpp"
 
@@ -127,6 +128,13 @@ class segment_storage {
                      max_num_threads);
   }
 
+  /// \brief Returns the total size of the files of an existing segment.
+  /// \param base_path A base directory path of a segment.
+  /// \return The total file size. Returns 0 if no file exists.
+  static std::size_t get_size(const path_type &base_path) {
+    return priv_get_size(priv_top_dir_path(base_path));
+  }
+
   /// \brief Creates a new segment.
   /// Calling this function fails if this class already manages an opened
   /// segment.
@@ -555,6 +563,7 @@ class segment_storage {
       return true;  // Already has enough segment size
     }
 
+    METALL_TRACE_SCOPE(storage_extend, request_size);
     while (m_current_segment_size < request_size) {
       if (!priv_create_new_map(m_top_path, m_num_blocks, k_block_size,
                                std::ptrdiff_t(m_current_segment_size))) {
@@ -717,6 +726,7 @@ class segment_storage {
   }
 
   bool priv_sync(const bool sync) {
+    METALL_TRACE_SCOPE(storage_sync, sync);
     if (!priv_sync_segment(
             sync)) {  // Failing this operation is not a critical error
       logger::out(logger::level::error, __FILE__, __LINE__,
@@ -770,6 +780,7 @@ class segment_storage {
 #endif
           const auto map =
               static_cast<char *>(m_segment) + block_no * k_block_size;
+          METALL_TRACE_SCOPE(storage_msync_block, block_no);
           num_successes.fetch_add(mdtl::os_msync(map, k_block_size, sync) ? 1
                                                                           : 0);
         } else {
@@ -804,6 +815,7 @@ class segment_storage {
 
     if (offset + nbytes > m_current_segment_size) return false;
 
+    METALL_TRACE_SCOPE(storage_free_region, nbytes);
 #ifdef METALL_USE_ANONYMOUS_NEW_MAP
     const auto block_no = offset / k_block_size;
     assert(m_anonymous_map_flag_list.size() > block_no);
@@ -12,6 +12,11 @@
 #include <limits>
 #include <new>
 
+#include <boost/container/container_fwd.hpp>
+#include <boost/container/detail/version_type.hpp>
+#include <boost/container/detail/allocator_version_traits.hpp>
+#include <boost/container/detail/multiallocation_chain.hpp>
+
 #include <metall/offset_ptr.hpp>
 #include <metall/logger.hpp>
 
@@ -51,6 +56,16 @@ class stl_allocator {
   using size_type = typename std::make_unsigned<difference_type>::type;
   using manager_kernel_type = metall_manager_kernel_type;
 
+  /// \brief Boost.Container allocator version.
+  /// Version 2 allocators support in-place expansion via allocation_command().
+  using version = boost::container::dtl::version_type<stl_allocator, 2>;
+
+  /// \brief A chain of individually allocated objects (Boost.Container).
+  using multiallocation_chain =
+      boost::container::dtl::transform_multiallocation_chain<
+          boost::container::dtl::basic_multiallocation_chain<void_pointer>,
+          value_type>;
+
   /// \brief Makes another allocator type for type T2
   /// \tparam T2 The type of the object
   template <typename T2>
@@ -126,6 +141,57 @@ class stl_allocator {
     return priv_deallocate(ptr, size);
   }
 
+  /// \brief Allocates, expands, or shrinks storage, following the
+  /// Boost.Container version 2 allocator protocol.
+  /// Only storage larger than the internal chunk size can be expanded
+  /// forward in place; expand_bwd is not supported.
+  /// \param command A combination of boost::container::allocation_type flags.
+  /// \param limit_size The minimum (expansion and allocation) or maximum
+  /// (shrink) number of elements acceptable.
+  /// \param prefer_in_recvd_out_size On input, the preferred number of
+  /// elements. On success, the number of elements the storage can hold.
+  /// \param reuse On input, the storage to expand or shrink.
+  /// Set to nullptr if new storage is allocated.
+  /// \return Returns the pointer to the storage on success.
+  /// Returns nullptr if the storage cannot be expanded or shrunk in place.
+  /// Throws std::bad_alloc if allocate_new is specified but fails,
+  /// unless nothrow_allocation is specified.
+  pointer allocation_command(const boost::container::allocation_type command,
+                             const size_type limit_size,
+                             size_type &prefer_in_recvd_out_size,
+                             pointer &reuse) const {
+    return priv_allocation_command(command, limit_size,
+                                   prefer_in_recvd_out_size, reuse);
+  }
+
+  /// \brief Returns the number of elements the storage pointed by ptr can
+  /// hold.
+  /// \param ptr A pointer to storage allocated by this allocator.
+  /// \return The number of elements.
+  size_type size(const pointer &ptr) const {
+    return priv_manager_kernel()->usable_size(to_raw_pointer(ptr)) /
+           sizeof(value_type);
+  }
+
+  /// \brief Allocates storage for a single object (Boost.Container).
+  pointer allocate_one() const { return priv_allocate(1); }
+
+  /// \brief Deallocates storage allocated by allocate_one().
+  void deallocate_one(const pointer &ptr) const { priv_deallocate(ptr, 1); }
+
+  /// \brief Allocates n objects individually (Boost.Container).
+  void allocate_individual(const size_type n,
+                           multiallocation_chain &chain) const {
+    stl_allocator self(*this);
+    version_1_traits::allocate_individual(self, n, chain);
+  }
+
+  /// \brief Deallocates the objects in chain (Boost.Container).
+  void deallocate_individual(multiallocation_chain &chain) const {
+    stl_allocator self(*this);
+    version_1_traits::deallocate_individual(self, chain);
+  }
+
   /// \brief The size of the theoretical maximum allocation size
   /// \return The size of the theoretical maximum allocation size
   size_type max_size() const noexcept { return priv_max_size(); }
@@ -151,27 +217,34 @@ class stl_allocator {
   }
 
  private:
+  using version_1_traits =
+      boost::container::dtl::allocator_version_traits<stl_allocator, 1>;
+
   // -------------------- //
   // Private methods
   // -------------------- //
 
-  pointer priv_allocate(const size_type n) const {
-    if (priv_max_size() < n) {
-      throw std::bad_array_new_length();
-    }
-
+  manager_kernel_type *priv_manager_kernel() const {
     if (!get_pointer_to_manager_kernel()) {
       logger::out(logger::level::error, __FILE__, __LINE__,
                   "nullptr: cannot access to manager kernel");
       throw std::bad_alloc();
     }
-    auto* manager_kernel = *get_pointer_to_manager_kernel();
+    auto *manager_kernel = *get_pointer_to_manager_kernel();
     if (!manager_kernel) {
       logger::out(logger::level::error, __FILE__, __LINE__,
                   "nullptr: cannot access to manager kernel");
       throw std::bad_alloc();
     }
+    return manager_kernel;
+  }
+
+  pointer priv_allocate(const size_type n) const {
+    if (priv_max_size() < n) {
+      throw std::bad_array_new_length();
+    }
 
+    auto *manager_kernel = priv_manager_kernel();
     auto addr = pointer(
         static_cast<value_type *>(manager_kernel->allocate(n * sizeof(T))));
     if (!addr) {
@@ -197,6 +270,61 @@ class stl_allocator {
     manager_kernel->deallocate(to_raw_pointer(ptr));
   }
 
+  pointer priv_allocation_command(
+      const boost::container::allocation_type command,
+      const size_type limit_size, size_type &prefer_in_recvd_out_size,
+      pointer &reuse) const {
+    namespace bc = boost::container;
+    auto *manager_kernel = priv_manager_kernel();
+    const size_type preferred_size = prefer_in_recvd_out_size;
+
+    if (command & (bc::shrink_in_place | bc::try_shrink_in_place)) {
+      // try_shrink_in_place (a dry run) is reported as a failure
+      if (!reuse || !(command & bc::shrink_in_place) ||
+          preferred_size > limit_size) {
+        return pointer();
+      }
+      size_type nbytes = preferred_size * sizeof(value_type);
+      if (!manager_kernel->shrink_in_place(to_raw_pointer(reuse),
+                                           limit_size * sizeof(value_type),
+                                           &nbytes)) {
+        return pointer();
+      }
+      prefer_in_recvd_out_size = nbytes / sizeof(value_type);
+      return reuse;
+    }
+
+    if (limit_size <= preferred_size && preferred_size <= priv_max_size()) {
+      if ((command & bc::expand_fwd) && reuse) {
+        size_type nbytes = preferred_size * sizeof(value_type);
+        if (manager_kernel->expand_in_place(to_raw_pointer(reuse),
+                                            limit_size * sizeof(value_type),
+                                            &nbytes)) {
+          prefer_in_recvd_out_size = nbytes / sizeof(value_type);
+          return reuse;
+        }
+      }
+
+      if (command & bc::allocate_new) {
+        for (const auto n : {preferred_size, limit_size}) {
+          void *const addr = manager_kernel->allocate(n * sizeof(value_type));
+          if (addr) {
+            reuse = pointer();
+            prefer_in_recvd_out_size =
+                manager_kernel->usable_size(addr) / sizeof(value_type);
+            return pointer(static_cast<value_type *>(addr));
+          }
+        }
+      }
+    }
+
+    // Failing to expand or shrink in place is not an error
+    if (!(command & bc::allocate_new) || (command & bc::nothrow_allocation)) {
+      return pointer();
+    }
+    throw std::bad_alloc();
+  }
+
   size_type priv_max_size() const noexcept {
     return std::numeric_limits<size_type>::max() / sizeof(value_type);
   }
@@ -0,0 +1,333 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_TRACER_HPP
+#define METALL_TRACER_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+/// \file tracer.hpp
+/// \brief Hot-path tracing hooks.
+/// Tracing is enabled only if METALL_ENABLE_TRACE is defined at compile time.
+/// Otherwise, the hook macros below expand to nothing and cost nothing.
+///
+/// \details
+/// By default, events are recorded into tracer::default_ring_buffer(),
+/// a fixed-size binary ring buffer that keeps the latest events.
+/// If the environment variable METALL_TRACE_FILE is set, the buffer is dumped
+/// to the file at program exit. A dumped file can be converted to the Chrome
+/// trace (Perfetto) JSON format by tracer::convert_to_chrome_trace()
+/// or the trace_to_chrome_json utility.
+
+#ifdef METALL_ENABLE_TRACE
+#define METALL_TRACE_CONCAT_IMPL(a, b) a##b
+#define METALL_TRACE_CONCAT(a, b) METALL_TRACE_CONCAT_IMPL(a, b)
+/// \brief Records the duration of the enclosing scope as an event.
+#define METALL_TRACE_SCOPE(event_name, arg)                      \
+  const ::metall::tracer::scoped_event METALL_TRACE_CONCAT(      \
+      metall_trace_scope_, __LINE__)(                            \
+      ::metall::tracer::event::event_name, static_cast<std::uint64_t>(arg))
+/// \brief Records an instant event.
+#define METALL_TRACE_INSTANT(event_name, arg)              \
+  ::metall::tracer::record_event(                          \
+      ::metall::tracer::event::event_name,                 \
+      ::metall::tracer::now_ns(), 0,                       \
+      static_cast<std::uint64_t>(arg), true)
+#else
+#define METALL_TRACE_SCOPE(event_name, arg) ((void)0)
+#define METALL_TRACE_INSTANT(event_name, arg) ((void)0)
+#endif
+
+namespace metall {
+
+/// \brief Tracer for allocator and storage events.
+class tracer {
+ public:
+  /// \brief Traced events.
+  enum struct event : std::uint16_t {
+    storage_extend = 0,
+    storage_free_region,
+    storage_sync,
+    storage_msync_block,
+    allocator_bin_lock_wait,
+    allocator_allocate_large,
+    allocator_deallocate_large,
+    cache_refill,
+    cache_evict,
+    manager_create,
+    manager_open,
+    manager_close,
+    manager_flush,
+    manager_snapshot,
+    num_events
+  };
+
+  /// \brief A trace record (32 bytes).
+  struct record {
+    /// \brief Start time in nanoseconds (steady clock).
+    std::uint64_t start_ns;
+    /// \brief Duration in nanoseconds. 0 for instant events.
+    std::uint64_t duration_ns;
+    /// \brief An event-specific argument, e.g., the size or bin number.
+    std::uint64_t arg;
+    std::uint32_t thread_id;
+    std::uint16_t event_id;
+    /// \brief 1 if this is an instant event; otherwise, 0.
+    std::uint16_t instant;
+  };
+  static_assert(sizeof(record) == 32, "Unexpected record size");
+
+  /// \brief Sink function type.
+  using sink_type = std::function<void(const record &)>;
+
+  /// \brief A lock-free ring buffer that keeps the latest records.
+  class ring_buffer {
+   public:
+    /// \brief Constructor.
+    /// \param capacity The number of records to keep.
+    /// Rounded up to a power of 2.
+    explicit ring_buffer(const std::size_t capacity) {
+      std::size_t c = 1;
+      while (c < capacity) c <<= 1;
+      m_mask = c - 1;
+      m_records = std::make_unique<record[]>(c);
+    }
+
+    ~ring_buffer() noexcept = default;
+
+    ring_buffer(const ring_buffer &) = delete;
+    ring_buffer(ring_buffer &&) noexcept = delete;
+    ring_buffer &operator=(const ring_buffer &) = delete;
+    ring_buffer &operator=(ring_buffer &&) noexcept = delete;
+
+    /// \brief Stores a record, overwriting the oldest one if full.
+    /// Thread safe.
+    void push(const record &r) noexcept {
+      const auto pos = m_next.fetch_add(1, std::memory_order_relaxed);
+      m_records[pos & m_mask] = r;
+    }
+
+    /// \brief Returns the number of records held.
+    std::size_t size() const noexcept {
+      return std::min<std::uint64_t>(m_next.load(std::memory_order_relaxed),
+                                     capacity());
+    }
+
+    std::size_t capacity() const noexcept { return m_mask + 1; }
+
+    /// \brief Returns the number of records that have been overwritten.
+    std::uint64_t num_dropped() const noexcept {
+      return m_next.load(std::memory_order_relaxed) - size();
+    }
+
+    /// \brief Discards all records.
+    void clear() noexcept { m_next.store(0, std::memory_order_relaxed); }
+
+    /// \brief Writes the records, from the oldest one, into a binary file.
+    /// Records being pushed concurrently may be torn;
+    /// call this function when no events are being recorded.
+    /// \param path A file path to write.
+    /// \return Returns true on success; otherwise, false.
+    bool dump(const std::string &path) const {
+      std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+      if (!ofs) return false;
+
+      const std::uint64_t next = m_next.load(std::memory_order_acquire);
+      const std::uint64_t num_records = size();
+      ofs.write(k_file_magic, sizeof(k_file_magic));
+      ofs.write(reinterpret_cast<const char *>(&num_records),
+                sizeof(num_records));
+      for (std::uint64_t i = next - num_records; i < next; ++i) {
+        ofs.write(reinterpret_cast<const char *>(&m_records[i & m_mask]),
+                  sizeof(record));
+      }
+      return !!ofs;
+    }
+
+   private:
+    std::size_t m_mask{0};
+    std::unique_ptr<record[]> m_records{nullptr};
+    std::atomic<std::uint64_t> m_next{0};
+  };
+
+  tracer() = delete;
+  ~tracer() = delete;
+  tracer(const tracer &) = delete;
+  tracer(tracer &&) = delete;
+  tracer &operator=(const tracer &) = delete;
+  tracer &operator=(tracer &&) = delete;
+
+  /// \brief Returns the name of an event.
+  static const char *event_name(const event e) noexcept {
+    static constexpr const char *k_names[] = {"storage_extend",
+                                              "storage_free_region",
+                                              "storage_sync",
+                                              "storage_msync_block",
+                                              "allocator_bin_lock_wait",
+                                              "allocator_allocate_large",
+                                              "allocator_deallocate_large",
+                                              "cache_refill",
+                                              "cache_evict",
+                                              "manager_create",
+                                              "manager_open",
+                                              "manager_close",
+                                              "manager_flush",
+                                              "manager_snapshot"};
+    static_assert(sizeof(k_names) / sizeof(k_names[0]) ==
+                      static_cast<std::size_t>(event::num_events),
+                  "Event name table is out of date");
+    const auto i = static_cast<std::size_t>(e);
+    return (i < static_cast<std::size_t>(event::num_events)) ? k_names[i]
+                                                             : "unknown";
+  }
+
+  /// \brief Returns the ring buffer used by the default sink.
+  /// Its capacity is METALL_TRACE_BUFFER_SIZE records.
+  static ring_buffer &default_ring_buffer() {
+    // Dumps the records at program exit if METALL_TRACE_FILE is set
+    struct dumping_ring_buffer : ring_buffer {
+      dumping_ring_buffer() : ring_buffer(k_default_buffer_size) {}
+      ~dumping_ring_buffer() noexcept {
+        if (const char *path = std::getenv(k_dump_path_env)) {
+          try {
+            dump(path);
+          } catch (...) {
+          }
+        }
+      }
+    };
+    static dumping_ring_buffer buffer;
+    return buffer;
+  }
+
+  /// \brief Replaces the sink. Not thread safe with recording events.
+  /// \param sink A new sink. An empty function restores the default sink.
+  static void set_sink(sink_type sink) { s_sink = std::move(sink); }
+
+  /// \brief Returns the current time in nanoseconds (steady clock).
+  static std::uint64_t now_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /// \brief Records an event to the current sink.
+  static void record_event(const event e, const std::uint64_t start_ns,
+                           const std::uint64_t duration_ns,
+                           const std::uint64_t arg,
+                           const bool instant = false) noexcept {
+    const record r{start_ns, duration_ns, arg, priv_thread_id(),
+                   static_cast<std::uint16_t>(e),
+                   static_cast<std::uint16_t>(instant ? 1 : 0)};
+    if (s_sink) {
+      try {
+        s_sink(r);
+      } catch (...) {
+      }
+    } else {
+      default_ring_buffer().push(r);
+    }
+  }
+
+  /// \brief Records the lifetime of this object as an event.
+  class scoped_event {
+   public:
+    scoped_event(const event e, const std::uint64_t arg) noexcept
+        : m_event(e), m_arg(arg), m_start_ns(now_ns()) {}
+
+    ~scoped_event() noexcept {
+      record_event(m_event, m_start_ns, now_ns() - m_start_ns, m_arg);
+    }
+
+    scoped_event(const scoped_event &) = delete;
+    scoped_event(scoped_event &&) = delete;
+    scoped_event &operator=(const scoped_event &) = delete;
+    scoped_event &operator=(scoped_event &&) = delete;
+
+   private:
+    event m_event;
+    std::uint64_t m_arg;
+    std::uint64_t m_start_ns;
+  };
+
+  /// \brief Converts a binary file dumped by ring_buffer::dump() into
+  /// the Chrome trace event (JSON) format, which Perfetto and
+  /// chrome://tracing can load.
+  /// \param binary_path A path to a binary trace file.
+  /// \param json_path A path to write the JSON file.
+  /// \return Returns true on success; otherwise, false.
+  static bool convert_to_chrome_trace(const std::string &binary_path,
+                                      const std::string &json_path) {
+    std::ifstream ifs(binary_path, std::ios::binary);
+    if (!ifs) return false;
+    char magic[sizeof(k_file_magic)];
+    std::uint64_t num_records = 0;
+    ifs.read(magic, sizeof(magic));
+    ifs.read(reinterpret_cast<char *>(&num_records), sizeof(num_records));
+    if (!ifs || std::memcmp(magic, k_file_magic, sizeof(magic)) != 0) {
+      return false;
+    }
+
+    std::ofstream ofs(json_path, std::ios::trunc);
+    if (!ofs) return false;
+    ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (std::uint64_t i = 0; i < num_records; ++i) {
+      record r;
+      if (!ifs.read(reinterpret_cast<char *>(&r), sizeof(r))) return false;
+      // Timestamps are in microseconds in the Chrome trace format
+      ofs << (i == 0 ? "\n" : ",\n") << "{\"name\":\""
+          << event_name(static_cast<event>(r.event_id))
+          << "\",\"cat\":\"metall\",\"pid\":0,\"tid\":" << r.thread_id
+          << ",\"ts\":" << priv_to_us(r.start_ns);
+      if (r.instant) {
+        ofs << ",\"ph\":\"i\",\"s\":\"t\"";
+      } else {
+        ofs << ",\"ph\":\"X\",\"dur\":" << priv_to_us(r.duration_ns);
+      }
+      ofs << ",\"args\":{\"arg\":" << r.arg << "}}";
+    }
+    ofs << "\n]}\n";
+    return !!ofs;
+  }
+
+ private:
+#ifndef METALL_TRACE_BUFFER_SIZE
+  static constexpr std::size_t k_default_buffer_size = 1ULL << 20ULL;
+#else
+  static constexpr std::size_t k_default_buffer_size = METALL_TRACE_BUFFER_SIZE;
+#endif
+  static constexpr const char *k_dump_path_env = "METALL_TRACE_FILE";
+  static constexpr char k_file_magic[8] = {'M', 'T', 'L', 'T',
+                                           'R', 'C', '0', '1'};
+
+  static std::uint32_t priv_thread_id() noexcept {
+    thread_local static const auto id = static_cast<std::uint32_t>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return id;
+  }
+
+  static std::string priv_to_us(const std::uint64_t ns) {
+    return std::to_string(ns / 1000) + "." +
+           std::to_string(ns % 1000 + 1000).substr(1);
+  }
+
+  static sink_type s_sink;
+};
+
+inline tracer::sink_type tracer::s_sink{};
+
+}  // namespace metall
+
+#endif  // METALL_TRACER_HPP
@@ -59,9 +59,9 @@ class container_of_containers_iterator_adaptor {
     }
   }
 
-  reference operator++() {
+  container_of_containers_iterator_adaptor &operator++() {
     next();
-    return *m_inner_iterator;
+    return *this;
   }
 
   container_of_containers_iterator_adaptor operator++(int) {
@@ -72,8 +72,12 @@ class container_of_containers_iterator_adaptor {
 
   pointer operator->() { return &(*m_inner_iterator); }
 
+  pointer operator->() const { return &(*m_inner_iterator); }
+
   reference operator*() { return (*m_inner_iterator); }
 
+  reference operator*() const { return (*m_inner_iterator); }
+
   bool equal(const container_of_containers_iterator_adaptor &other) const {
     return (m_outer_iterator == m_outer_end &&
             other.m_outer_iterator == other.m_outer_end) ||
@@ -0,0 +1,492 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_UTILITY_DATASTORE_STAT_HPP
+#define METALL_UTILITY_DATASTORE_STAT_HPP
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <metall/metall.hpp>
+#include <metall/kernel/bin_number_manager.hpp>
+#include <metall/utility/datastore_ls.hpp>
+
+/// \file datastore_stat.hpp
+/// \brief Offline allocator-level statistics of a datastore.
+/// The statistics are computed only from the files in the datastore
+/// directory; the segment is not mapped.
+
+namespace metall::utility {
+
+/// \brief Allocator-level statistics of a datastore.
+struct datastore_stat {
+  /// \brief The number of occupancy histogram buckets.
+  static constexpr std::size_t k_num_occupancy_buckets = 10;
+
+  /// \brief Statistics of a bin (an internal object size class).
+  struct bin_stat {
+    std::size_t object_size{0};
+    /// \brief The number of chunks used by the bin.
+    std::size_t num_chunks{0};
+    /// \brief The number of allocated objects.
+    std::size_t num_objects{0};
+    /// \brief Histogram of the slot occupancy of the chunks.
+    /// Bucket i holds chunks whose occupancy is in
+    /// [i / k_num_occupancy_buckets, (i + 1) / k_num_occupancy_buckets).
+    /// Full chunks are counted in the last bucket.
+    /// Empty for large-object bins.
+    std::array<std::size_t, k_num_occupancy_buckets> occupancy_histogram{};
+  };
+
+  /// \brief Statistics of a segment block file.
+  struct block_file_stat {
+    std::filesystem::path path;
+    /// \brief The file size.
+    std::size_t size{0};
+    /// \brief The size of the storage space allocated to the file.
+    /// Smaller than 'size' if the file is sparse.
+    std::size_t allocated_size{0};
+  };
+
+  /// \brief A large object.
+  struct large_object {
+    /// \brief The offset from the beginning of the segment.
+    std::size_t offset{0};
+    /// \brief The allocated size, including internal fragmentation.
+    std::size_t size{0};
+    /// \brief The name if the object is a named or unique object.
+    std::string name;
+  };
+
+  std::filesystem::path path;
+  bool properly_closed{false};
+  std::size_t chunk_size{0};
+  /// \brief The number of chunks the chunk directory covers.
+  std::size_t num_chunks{0};
+  std::size_t num_small_object_chunks{0};
+  std::size_t num_large_object_chunks{0};
+  /// \brief Statistics of each bin, indexed by bin number.
+  std::vector<bin_stat> bins;
+
+  /// \brief Histogram of the lengths of the runs of free chunks below the
+  /// last used chunk. Bucket i holds runs whose lengths are in
+  /// [2^i, 2^(i+1)).
+  std::vector<std::size_t> free_chunk_run_histogram;
+  std::size_t num_free_chunks{0};
+  std::size_t longest_free_chunk_run{0};
+
+  std::vector<block_file_stat> block_files;
+
+  /// \brief The largest objects in descending order of size.
+  std::vector<large_object> largest_objects;
+
+  /// \brief Returns the total size of the allocated objects in bytes.
+  std::size_t allocated_bytes() const {
+    std::size_t n = 0;
+    for (const auto &bin : bins) n += bin.object_size * bin.num_objects;
+    return n;
+  }
+
+  /// \brief Returns the total size of the segment block files in bytes.
+  std::size_t file_bytes() const {
+    std::size_t n = 0;
+    for (const auto &file : block_files) n += file.size;
+    return n;
+  }
+
+  /// \brief Returns the total storage space allocated to the segment block
+  /// files in bytes.
+  std::size_t allocated_file_bytes() const {
+    std::size_t n = 0;
+    for (const auto &file : block_files) n += file.allocated_size;
+    return n;
+  }
+};
+
+#ifndef DOXYGEN_SKIP
+namespace datastore_stat_detail {
+
+namespace fs = std::filesystem;
+
+// Must be the same as the ones in the kernel
+enum chunk_type : std::uint8_t {
+  unused = 0,
+  small_chunk = 1,
+  large_chunk_head = 2,
+  large_chunk_body = 3
+};
+
+struct chunk_entry {
+  std::uint64_t chunk_no;
+  std::uint64_t bin_no;
+  std::uint64_t type;
+  std::uint64_t num_occupied_slots;
+};
+
+// Parses the chunk directory lines in [begin, end).
+// Each line is 'chunk_no bin_no type [num_occupied_slots slot_bitset]'.
+// The slot bitsets, which are the majority of the file, are skipped.
+template <typename callback_type>
+inline bool parse_chunk_directory(const char *begin, const char *const end,
+                                  callback_type callback) {
+  while (begin < end) {
+    const char *const line_end =
+        std::find(begin, end, '\n');  // Not found -> end
+    if (line_end == begin) {
+      ++begin;
+      continue;
+    }
+
+    std::uint64_t values[4] = {0, 0, 0, 0};
+    const char *p = begin;
+    for (int i = 0; i < 4 && p < line_end; ++i) {
+      char *next = nullptr;
+      values[i] = std::strtoull(p, &next, 10);
+      if (next == p) return false;
+      p = next;
+      if (i == 2 && values[2] != chunk_type::small_chunk) break;
+    }
+    callback(chunk_entry{values[0], values[1], values[2], values[3]});
+    begin = line_end + 1;
+  }
+  return true;
+}
+
+inline std::size_t num_threads(const int requested) {
+  if (requested > 0) return requested;
+  return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+inline bool get_block_file_stat(const fs::path &path,
+                                datastore_stat::block_file_stat *out) {
+  struct stat buf;
+  if (::stat(path.c_str(), &buf) != 0) return false;
+  out->path = path;
+  out->size = buf.st_size;
+  // st_blocks is in 512-byte units regardless of the file system block size
+  out->allocated_size = std::size_t(buf.st_blocks) * 512;
+  return true;
+}
+
+}  // namespace datastore_stat_detail
+#endif  // DOXYGEN_SKIP
+
+/// \brief Computes allocator-level statistics of a datastore offline,
+/// without mapping the segment.
+/// The chunk directory and the block files are processed in parallel.
+/// \tparam manager_type A manager type that created the datastore.
+/// \param datastore_path A path to a datastore.
+/// \param stat A buffer to store the statistics.
+/// \param num_largest_objects The number of the largest objects to report.
+/// \param max_num_threads The maximum number of threads to use.
+/// If <= 0 is given, the value is automatically determined.
+/// \return Returns true on success; otherwise, false.
+template <typename manager_type = metall::manager>
+inline bool get_datastore_stat(const std::filesystem::path &datastore_path,
+                               datastore_stat *const stat,
+                               const std::size_t num_largest_objects = 10,
+                               const int max_num_threads = 0) {
+  namespace fs = std::filesystem;
+  namespace dsd = datastore_stat_detail;
+  using bin_no_mngr =
+      kernel::bin_number_manager<manager_type::chunk_size(),
+                                 METALL_MAX_CAPACITY>;
+  constexpr std::size_t k_chunk_size = manager_type::chunk_size();
+
+  *stat = datastore_stat{};
+  stat->path = datastore_path;
+  stat->chunk_size = k_chunk_size;
+  stat->properly_closed = manager_type::consistent(datastore_path);
+  stat->bins.resize(bin_no_mngr::num_bins());
+  for (std::size_t b = 0; b < stat->bins.size(); ++b) {
+    stat->bins[b].object_size = bin_no_mngr::to_object_size(b);
+  }
+
+  // Must be the same paths as the ones the kernel uses
+  const fs::path chunk_directory_path = kernel::storage::get_path(
+      datastore_path,
+      {"management", "segment_memory_allocator_chunk_directory"});
+  const fs::path segment_path =
+      kernel::storage::get_path(datastore_path, "segment");
+
+  std::string buf;
+  {
+    std::ifstream ifs(chunk_directory_path, std::ios::binary);
+    if (!ifs) {
+      std::cerr << "Cannot open " << chunk_directory_path << std::endl;
+      return false;
+    }
+    buf.assign(std::istreambuf_iterator<char>(ifs),
+               std::istreambuf_iterator<char>());
+  }
+
+  std::vector<fs::path> block_file_names;
+  if (!mtlldetail::get_regular_file_names(segment_path, &block_file_names)) {
+    std::cerr << "Cannot read " << segment_path << std::endl;
+    return false;
+  }
+  block_file_names.erase(
+      std::remove_if(block_file_names.begin(), block_file_names.end(),
+                     [](const fs::path &p) {
+                       return p.string().rfind("block-", 0) != 0;
+                     }),
+      block_file_names.end());
+  std::sort(block_file_names.begin(), block_file_names.end(),
+            [](const fs::path &lhs, const fs::path &rhs) {
+              return std::stoull(lhs.string().substr(6)) <
+                     std::stoull(rhs.string().substr(6));
+            });
+  stat->block_files.resize(block_file_names.size());
+
+  // Per-thread results, merged afterward
+  struct local_result {
+    std::vector<datastore_stat::bin_stat> bins;
+    std::vector<datastore_stat::large_object> large_objects;
+    std::vector<std::uint64_t> used_chunks;
+    bool good{true};
+  };
+  const std::size_t num_threads = dsd::num_threads(max_num_threads);
+  std::vector<local_result> results(num_threads);
+
+  // Splits the chunk directory at line boundaries
+  const char *const buf_begin = buf.data();
+  const char *const buf_end = buf_begin + buf.size();
+  std::vector<const char *> boundaries(num_threads + 1);
+  boundaries[0] = buf_begin;
+  for (std::size_t t = 1; t < num_threads; ++t) {
+    const char *pos =
+        std::max(buf_begin + buf.size() * t / num_threads, boundaries[t - 1]);
+    pos = std::find(pos, buf_end, '\n');
+    boundaries[t] = (pos == buf_end) ? buf_end : pos + 1;
+  }
+  boundaries[num_threads] = buf_end;
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      auto &result = results[t];
+      result.bins.resize(bin_no_mngr::num_bins());
+      result.good = dsd::parse_chunk_directory(
+          boundaries[t], boundaries[t + 1], [&](const dsd::chunk_entry &e) {
+            result.used_chunks.push_back(e.chunk_no);
+            if (e.bin_no >= bin_no_mngr::num_bins()) {
+              result.good = false;
+              return;
+            }
+            auto &bin = result.bins[e.bin_no];
+            const auto object_size = bin_no_mngr::to_object_size(e.bin_no);
+            if (e.type == dsd::small_chunk) {
+              const std::size_t num_slots = k_chunk_size / object_size;
+              ++bin.num_chunks;
+              bin.num_objects += e.num_occupied_slots;
+              constexpr auto k_num_buckets =
+                  datastore_stat::k_num_occupancy_buckets;
+              const auto bucket =
+                  std::min(e.num_occupied_slots * k_num_buckets / num_slots,
+                           k_num_buckets - 1);
+              ++bin.occupancy_histogram[bucket];
+            } else if (e.type == dsd::large_chunk_head) {
+              ++bin.num_chunks;
+              ++bin.num_objects;
+              result.large_objects.push_back(datastore_stat::large_object{
+                  e.chunk_no * k_chunk_size, object_size, ""});
+            } else if (e.type == dsd::large_chunk_body) {
+              ++bin.num_chunks;
+            } else {
+              result.good = false;
+            }
+          });
+
+      // Block files are also split among the threads
+      for (std::size_t i = t; i < block_file_names.size(); i += num_threads) {
+        if (!dsd::get_block_file_stat(segment_path / block_file_names[i],
+                                      &stat->block_files[i])) {
+          result.good = false;
+        }
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+
+  std::vector<datastore_stat::large_object> large_objects;
+  std::vector<std::uint64_t> used_chunks;
+  for (auto &result : results) {
+    if (!result.good) {
+      std::cerr << "Broken datastore: " << datastore_path << std::endl;
+      return false;
+    }
+    for (std::size_t b = 0; b < result.bins.size(); ++b) {
+      auto &bin = stat->bins[b];
+      bin.num_chunks += result.bins[b].num_chunks;
+      bin.num_objects += result.bins[b].num_objects;
+      for (std::size_t i = 0; i < datastore_stat::k_num_occupancy_buckets;
+           ++i) {
+        bin.occupancy_histogram[i] += result.bins[b].occupancy_histogram[i];
+      }
+      if (b < bin_no_mngr::num_small_bins()) {
+        stat->num_small_object_chunks += result.bins[b].num_chunks;
+      } else {
+        stat->num_large_object_chunks += result.bins[b].num_chunks;
+      }
+    }
+    large_objects.insert(large_objects.end(), result.large_objects.begin(),
+                         result.large_objects.end());
+    // Lines are sorted by chunk number and so are the per-thread ranges
+    used_chunks.insert(used_chunks.end(), result.used_chunks.begin(),
+                       result.used_chunks.end());
+  }
+
+  // Free chunk runs
+  stat->num_chunks = used_chunks.empty() ? 0 : used_chunks.back() + 1;
+  std::uint64_t next_chunk_no = 0;
+  for (const auto chunk_no : used_chunks) {
+    if (chunk_no > next_chunk_no) {
+      const std::size_t run_length = chunk_no - next_chunk_no;
+      std::size_t bucket = 0;
+      while ((std::size_t(1) << (bucket + 1)) <= run_length) ++bucket;
+      if (stat->free_chunk_run_histogram.size() <= bucket) {
+        stat->free_chunk_run_histogram.resize(bucket + 1, 0);
+      }
+      ++stat->free_chunk_run_histogram[bucket];
+      stat->num_free_chunks += run_length;
+      stat->longest_free_chunk_run =
+          std::max(stat->longest_free_chunk_run, run_length);
+    }
+    next_chunk_no = chunk_no + 1;
+  }
+
+  // Largest objects
+  const auto num_largest = std::min(num_largest_objects, large_objects.size());
+  std::partial_sort(
+      large_objects.begin(), large_objects.begin() + num_largest,
+      large_objects.end(),
+      [](const auto &lhs, const auto &rhs) { return lhs.size > rhs.size; });
+  large_objects.resize(num_largest);
+  {
+    // Names are read from the attribute files
+    auto named = manager_type::access_named_object_attribute(datastore_path);
+    auto unique = manager_type::access_unique_object_attribute(datastore_path);
+    for (auto &object : large_objects) {
+      if (named.good()) {
+        for (const auto &attr : named) {
+          if (std::size_t(attr.offset()) == object.offset) {
+            object.name = attr.name();
+          }
+        }
+      }
+      if (unique.good()) {
+        for (const auto &attr : unique) {
+          if (std::size_t(attr.offset()) == object.offset) {
+            object.name = attr.name();
+          }
+        }
+      }
+    }
+  }
+  stat->largest_objects = std::move(large_objects);
+
+  return true;
+}
+
+/// \brief Shows the statistics of a datastore to the standard output.
+/// \param stat Statistics to show.
+inline void show_datastore_stat(const datastore_stat &stat) {
+  using datastore_ls_detail::aligned_show;
+  std::cout << "[Datastore] " << stat.path.string() << std::endl;
+  std::cout << "Properly closed: " << (stat.properly_closed ? "yes" : "no")
+            << std::endl;
+  std::cout << "Chunk size: " << stat.chunk_size << std::endl;
+  std::cout << "#of chunks: " << stat.num_chunks
+            << " (small object: " << stat.num_small_object_chunks
+            << ", large object: " << stat.num_large_object_chunks
+            << ", free: " << stat.num_free_chunks << ")" << std::endl;
+  std::cout << "Allocated object bytes: " << stat.allocated_bytes()
+            << std::endl;
+  std::cout << "Segment file bytes: " << stat.file_bytes()
+            << " (allocated: " << stat.allocated_file_bytes() << ")"
+            << std::endl;
+  std::cout << std::endl;
+
+  {
+    std::cout << "[Bins]" << std::endl;
+    std::vector<std::vector<std::string>> buf;
+    std::vector<std::string> title{"Bin", "Object Size", "#Chunks",
+                                   "#Objects"};
+    for (std::size_t i = 0; i < datastore_stat::k_num_occupancy_buckets; ++i) {
+      title.push_back(std::to_string(i * 100 /
+                                     datastore_stat::k_num_occupancy_buckets) +
+                      "%-");
+    }
+    buf.emplace_back(std::move(title));
+    for (std::size_t b = 0; b < stat.bins.size(); ++b) {
+      const auto &bin = stat.bins[b];
+      if (bin.num_chunks == 0) continue;
+      std::vector<std::string> row{
+          std::to_string(b), std::to_string(bin.object_size),
+          std::to_string(bin.num_chunks), std::to_string(bin.num_objects)};
+      for (const auto n : bin.occupancy_histogram) {
+        row.push_back(std::to_string(n));
+      }
+      buf.emplace_back(std::move(row));
+    }
+    aligned_show(buf);
+    std::cout << std::endl;
+  }
+
+  {
+    std::cout << "[Free Chunk Runs]" << std::endl;
+    std::cout << "Longest run: " << stat.longest_free_chunk_run << std::endl;
+    std::vector<std::vector<std::string>> buf;
+    buf.emplace_back(std::vector<std::string>{"Run Length", "#Runs"});
+    for (std::size_t i = 0; i < stat.free_chunk_run_histogram.size(); ++i) {
+      buf.emplace_back(std::vector<std::string>{
+          std::to_string(std::size_t(1) << i) + "-",
+          std::to_string(stat.free_chunk_run_histogram[i])});
+    }
+    aligned_show(buf);
+    std::cout << std::endl;
+  }
+
+  {
+    std::cout << "[Block Files]" << std::endl;
+    std::vector<std::vector<std::string>> buf;
+    buf.emplace_back(
+        std::vector<std::string>{"File", "Size", "Allocated Size"});
+    for (const auto &file : stat.block_files) {
+      buf.emplace_back(std::vector<std::string>{
+          file.path.filename().string(), std::to_string(file.size),
+          std::to_string(file.allocated_size)});
+    }
+    aligned_show(buf);
+    std::cout << std::endl;
+  }
+
+  {
+    std::cout << "[Largest Objects]" << std::endl;
+    std::vector<std::vector<std::string>> buf;
+    buf.emplace_back(std::vector<std::string>{"Offset", "Size", "Name"});
+    for (const auto &object : stat.largest_objects) {
+      buf.emplace_back(std::vector<std::string>{std::to_string(object.offset),
+                                                std::to_string(object.size),
+                                                object.name});
+    }
+    aligned_show(buf);
+  }
+}
+
+}  // namespace metall::utility
+
+#endif  // METALL_UTILITY_DATASTORE_STAT_HPP
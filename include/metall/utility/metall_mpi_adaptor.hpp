@@ -7,6 +7,10 @@
 #define METALL_UTILITY_METALL_MPI_ADAPTOR_HPP
 
 #include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <filesystem>
+#include <vector>
 
 #include <metall/metall.hpp>
 #include <metall/detail/file.hpp>
@@ -17,6 +21,7 @@ namespace metall::utility {
 
 namespace {
 namespace ds = metall::utility::mpi_datastore;
+namespace fs = std::filesystem;
 }
 
 /// \brief A utility class for using Metall with MPI
@@ -29,6 +34,49 @@ class metall_mpi_adaptor {
   /// \brief Metall manager type
   using manager_type = metall::manager;
 
+  /// \brief Options for the collective open.
+  struct collective_open_options {
+    /// \brief The maximum number of ranks on a compute node that open their
+    /// datastores at the same time. The same limit applies to closing them
+    /// in the destructor. If <= 0 is given, all ranks open at once.
+    int max_concurrent_per_node{0};
+  };
+
+  /// \brief Options for the throttled collective copy and snapshot.
+  struct collective_copy_options {
+    /// \brief The maximum number of ranks on a compute node that copy their
+    /// datastores at the same time. If <= 0 is given, all ranks copy at once.
+    int max_concurrent_per_node{0};
+    /// \brief If true, uses clone (reflink) to copy data.
+    bool clone{true};
+    /// \brief The maximum number of copy threads each rank uses.
+    /// If <= 0 is given, the value is automatically determined.
+    int num_copy_threads{0};
+  };
+
+  /// \brief Timing and throughput of a collective copy or snapshot.
+  /// Values are aggregated over all ranks and are the same on all ranks.
+  struct collective_copy_report {
+    /// \brief True if all ranks succeeded.
+    bool succeeded{false};
+    int num_nodes{0};
+    /// \brief The total allocated size of the source local datastores.
+    std::size_t total_bytes{0};
+    /// \brief The time from the collective start until the last rank
+    /// finished copying, in seconds.
+    double elapsed_time_sec{0.0};
+    /// \brief The time a rank spent copying its own datastore, excluding
+    /// waiting for its turn, in seconds.
+    double min_rank_time_sec{0.0};
+    double max_rank_time_sec{0.0};
+    double mean_rank_time_sec{0.0};
+
+    /// \brief Returns the aggregated throughput in bytes per second.
+    double throughput() const {
+      return (elapsed_time_sec > 0.0) ? total_bytes / elapsed_time_sec : 0.0;
+    }
+  };
+
   // -------------------- //
   // Constructor & assign operator
   // -------------------- //
@@ -67,6 +115,39 @@ class metall_mpi_adaptor {
             .c_str());
   }
 
+  /// \brief Opens an existing Metall datastore collectively, limiting the
+  /// number of ranks on each compute node that open their datastores at the
+  /// same time to reduce the load on the filesystem metadata server.
+  /// The datastore-level files are read only by rank 0.
+  /// \param root_dir_prefix A root directory path of a Metall datastore.
+  /// \param options Throttling options.
+  /// \param comm A MPI communicator.
+  metall_mpi_adaptor(metall::open_only_t, const std::string &root_dir_prefix,
+                     const collective_open_options &options,
+                     const MPI_Comm &comm = MPI_COMM_WORLD)
+      : m_mpi_comm(comm),
+        m_root_dir_prefix(root_dir_prefix),
+        m_local_metall_manager(nullptr),
+        m_max_concurrent_per_node(options.max_concurrent_per_node) {
+    priv_collective_open(false);
+  }
+
+  /// \brief Opens an existing Metall datastore collectively with the
+  /// read-only mode. See the other collective open constructor for details.
+  /// \param root_dir_prefix A root directory path of a Metall datastore.
+  /// \param options Throttling options.
+  /// \param comm A MPI communicator.
+  metall_mpi_adaptor(metall::open_read_only_t,
+                     const std::string &root_dir_prefix,
+                     const collective_open_options &options,
+                     const MPI_Comm &comm = MPI_COMM_WORLD)
+      : m_mpi_comm(comm),
+        m_root_dir_prefix(root_dir_prefix),
+        m_local_metall_manager(nullptr),
+        m_max_concurrent_per_node(options.max_concurrent_per_node) {
+    priv_collective_open(true);
+  }
+
   /// \brief Creates a new Metall datastore.
   /// \param root_dir_prefix A root directory path of a Metall datastore.
   /// The same name of file or directory must not exist.
@@ -112,8 +193,16 @@ class metall_mpi_adaptor {
 
   /// \brief Destructor that globally synchronizes the close operations of all
   /// sub-Metall datastores.
+  /// If the datastore was opened collectively, closes the sub-Metall
+  /// datastores with the same throttling.
   ~metall_mpi_adaptor() {
-    m_local_metall_manager.reset(nullptr);
+    if (m_node_comm != MPI_COMM_NULL) {
+      priv_run_in_node_streams(m_node_comm, m_max_concurrent_per_node, 1,
+                               [this]() { m_local_metall_manager.reset(); });
+      ::MPI_Comm_free(&m_node_comm);
+    } else {
+      m_local_metall_manager.reset(nullptr);
+    }
     priv_mpi_barrier(m_mpi_comm);
   }
 
@@ -203,6 +292,71 @@ class metall_mpi_adaptor {
         m_mpi_comm);
   }
 
+  /// \brief Copies a Metall datastore to another location, limiting the
+  /// number of ranks on each compute node that copy at the same time.
+  /// Ranks on a node are scheduled onto 'max_concurrent_per_node' copy
+  /// streams so that the streams copy similar amounts of data.
+  /// This avoids thrashing a node-local or shared storage device
+  /// with too many concurrent copies.
+  /// The behavior of copying a data store that is open without the read-only
+  /// mode is undefined.
+  /// \param source_dir_path A path to a source datastore.
+  /// \param destination_dir_path A path to a destination datastore.
+  /// \param options Throttling and copy options.
+  /// \param comm A MPI communicator.
+  /// \param overwrite If true, overwrite an existing datastore.
+  /// This mode does not overwrite an existing datastore if it is not Metall
+  /// datastore created by the same number of MPI processes.
+  /// \return Returns an aggregated report.
+  static collective_copy_report copy(const std::string &source_dir_path,
+                                     const std::string &destination_dir_path,
+                                     const collective_copy_options &options,
+                                     const MPI_Comm &comm = MPI_COMM_WORLD,
+                                     bool overwrite = false) {
+    if (!consistent(source_dir_path, comm)) {
+      if (priv_mpi_comm_rank(comm) == 0) {
+        std::stringstream ss;
+        ss << "Source directory is not consistnt (may not have closed properly "
+              "or may still be open): "
+           << source_dir_path;
+        logger::out(logger::level::error, __FILE__, __LINE__, ss.str().c_str());
+      }
+      return collective_copy_report{};
+    }
+    priv_setup_root_dir(destination_dir_path, overwrite, comm);
+    const int rank = priv_mpi_comm_rank(comm);
+    const auto source_path = ds::make_local_dir_path(source_dir_path, rank);
+    return priv_throttled_copy(source_path, options, comm, [&]() {
+      return manager_type::copy(
+          source_path.c_str(),
+          ds::make_local_dir_path(destination_dir_path, rank).c_str(),
+          options.clone, options.num_copy_threads);
+    });
+  }
+
+  /// \brief Takes a snapshot of the current Metall datastore to another
+  /// location, limiting the number of ranks on each compute node that copy
+  /// at the same time. See the throttled copy() for the scheduling.
+  /// \param destination_dir_path A path to a destination datastore.
+  /// \param options Throttling and copy options.
+  /// \param overwrite If true, overwrite an existing datastore.
+  /// This mode does not overwrite an existing datastore if it is not Metall
+  /// datastore created by the same number of MPI processes.
+  /// \return Returns an aggregated report.
+  collective_copy_report snapshot(const std::string &destination_dir_path,
+                                  const collective_copy_options &options,
+                                  bool overwrite = false) {
+    priv_setup_root_dir(destination_dir_path, overwrite, m_mpi_comm);
+    const int rank = priv_mpi_comm_rank(m_mpi_comm);
+    return priv_throttled_copy(
+        ds::make_local_dir_path(m_root_dir_prefix, rank), options, m_mpi_comm,
+        [&]() {
+          return m_local_metall_manager->snapshot(
+              ds::make_local_dir_path(destination_dir_path, rank).c_str(),
+              options.clone, options.num_copy_threads);
+        });
+  }
+
   /// \brief Removes Metall datastore.
   /// \param root_dir_prefix A root directory path of datastore.
   /// \param comm A MPI communicator.
@@ -291,6 +445,31 @@ class metall_mpi_adaptor {
   // -------------------- //
   // Private methods
   // -------------------- //
+  void priv_collective_open(const bool read_only) {
+    if (!priv_verify_num_partitions(m_root_dir_prefix, m_mpi_comm)) {
+      ::MPI_Abort(m_mpi_comm, -1);
+    }
+    m_node_comm = priv_make_node_comm(m_mpi_comm);
+    const auto local_path = ds::make_local_dir_path(
+        m_root_dir_prefix, priv_mpi_comm_rank(m_mpi_comm));
+    priv_run_in_node_streams(
+        m_node_comm, m_max_concurrent_per_node, 1, [&]() {
+          try {
+            if (read_only) {
+              m_local_metall_manager = std::make_unique<manager_type>(
+                  metall::open_read_only, local_path.c_str());
+            } else {
+              m_local_metall_manager = std::make_unique<manager_type>(
+                  metall::open_only, local_path.c_str());
+            }
+          } catch (...) {
+            logger::out(logger::level::error, __FILE__, __LINE__,
+                        "An exception has been thrown");
+            ::MPI_Abort(m_mpi_comm, -1);
+          }
+        });
+  }
+
   static void priv_remove_for_overwrite(const std::string &root_dir_prefix,
                                         const MPI_Comm &comm) {
     if (!remove(root_dir_prefix, comm)) {
@@ -446,6 +625,163 @@ class metall_mpi_adaptor {
     return ret.second;
   }
 
+  /// \brief Runs 'copy_local' on every rank, limiting the number of ranks on
+  /// each node that run it at the same time, and aggregates the timings.
+  template <typename copy_function>
+  static collective_copy_report priv_throttled_copy(
+      const std::string &source_local_path,
+      const collective_copy_options &options, const MPI_Comm &comm,
+      copy_function &&copy_local) {
+    const unsigned long long local_bytes =
+        priv_get_datastore_bytes(source_local_path);
+
+    MPI_Comm node_comm = priv_make_node_comm(comm);
+    int num_nodes = (priv_mpi_comm_rank(node_comm) == 0) ? 1 : 0;
+    priv_all_reduce(&num_nodes, MPI_INT, MPI_SUM, comm);
+
+    priv_mpi_barrier(comm);
+    const double start_time = ::MPI_Wtime();
+    double copy_start_time = 0.0;
+    bool local_ret = false;
+    priv_run_in_node_streams(node_comm, options.max_concurrent_per_node,
+                             local_bytes, [&]() {
+                               copy_start_time = ::MPI_Wtime();
+                               local_ret = copy_local();
+                             });
+    const double end_time = ::MPI_Wtime();
+    ::MPI_Comm_free(&node_comm);
+
+    collective_copy_report report;
+    report.succeeded = priv_global_and(local_ret, comm);
+    report.num_nodes = num_nodes;
+    unsigned long long total_bytes = local_bytes;
+    priv_all_reduce(&total_bytes, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    report.total_bytes = total_bytes;
+    report.elapsed_time_sec = end_time - start_time;
+    priv_all_reduce(&report.elapsed_time_sec, MPI_DOUBLE, MPI_MAX, comm);
+    const double rank_time = end_time - copy_start_time;
+    report.min_rank_time_sec = rank_time;
+    priv_all_reduce(&report.min_rank_time_sec, MPI_DOUBLE, MPI_MIN, comm);
+    report.max_rank_time_sec = rank_time;
+    priv_all_reduce(&report.max_rank_time_sec, MPI_DOUBLE, MPI_MAX, comm);
+    report.mean_rank_time_sec = rank_time;
+    priv_all_reduce(&report.mean_rank_time_sec, MPI_DOUBLE, MPI_SUM, comm);
+    report.mean_rank_time_sec /= priv_mpi_comm_size(comm);
+
+    return report;
+  }
+
+  /// \brief Runs 'func' on every rank, letting at most 'max_concurrent' ranks
+  /// on each node run it at the same time.
+  /// The ranks on a node are assigned to 'max_concurrent' streams,
+  /// heaviest first, each to the stream with the least weight so far.
+  /// The ranks in a stream run one after another, passing a token.
+  /// \param node_comm A communicator of the ranks on the same node.
+  /// \param max_concurrent If <= 0 is given, all ranks run at once.
+  /// \param weight The weight of the work of this rank, e.g., bytes to copy.
+  template <typename function_type>
+  static void priv_run_in_node_streams(const MPI_Comm &node_comm,
+                                       const int max_concurrent,
+                                       const unsigned long long weight,
+                                       function_type &&func) {
+    const int node_rank = priv_mpi_comm_rank(node_comm);
+    const int node_size = priv_mpi_comm_size(node_comm);
+    if (max_concurrent <= 0 || max_concurrent >= node_size) {
+      func();
+      return;
+    }
+
+    std::vector<unsigned long long> node_weights(node_size);
+    if (::MPI_Allgather(&weight, 1, MPI_UNSIGNED_LONG_LONG,
+                        node_weights.data(), 1, MPI_UNSIGNED_LONG_LONG,
+                        node_comm) != MPI_SUCCESS) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Failed MPI_Allgather");
+      ::MPI_Abort(node_comm, -1);
+    }
+
+    // Every rank on the node computes the same schedule
+    std::vector<int> order(node_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) {
+      return node_weights[a] > node_weights[b];
+    });
+    std::vector<unsigned long long> stream_weights(max_concurrent, 0);
+    std::vector<std::vector<int>> streams(max_concurrent);
+    for (const int r : order) {
+      const auto s =
+          std::min_element(stream_weights.begin(), stream_weights.end()) -
+          stream_weights.begin();
+      stream_weights[s] += node_weights[r];
+      streams[s].push_back(r);
+    }
+    int predecessor = -1;
+    int successor = -1;
+    for (const auto &stream : streams) {
+      const auto itr = std::find(stream.begin(), stream.end(), node_rank);
+      if (itr == stream.end()) continue;
+      if (itr != stream.begin()) predecessor = *(itr - 1);
+      if (itr + 1 != stream.end()) successor = *(itr + 1);
+    }
+
+    if (predecessor >= 0) {
+      if (::MPI_Recv(nullptr, 0, MPI_BYTE, predecessor, 0, node_comm,
+                     MPI_STATUS_IGNORE) != MPI_SUCCESS) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Failed MPI_Recv");
+        ::MPI_Abort(node_comm, -1);
+      }
+    }
+    func();
+    // 'func' must not throw; otherwise, the successor is blocked forever
+    if (successor >= 0) {
+      if (::MPI_Send(nullptr, 0, MPI_BYTE, successor, 0, node_comm) !=
+          MPI_SUCCESS) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Failed MPI_Send");
+        ::MPI_Abort(node_comm, -1);
+      }
+    }
+  }
+
+  /// \brief Returns the total allocated size of the files in a datastore.
+  static unsigned long long priv_get_datastore_bytes(
+      const std::string &local_dir_path) {
+    unsigned long long nbytes = 0;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator itr(local_dir_path, ec), end;
+         !ec && itr != end; itr.increment(ec)) {
+      if (!itr->is_regular_file(ec)) continue;
+      const auto size = metall::mtlldetail::get_actual_file_size(itr->path());
+      if (size > 0) nbytes += size;
+    }
+    return nbytes;
+  }
+
+  /// \brief Makes a communicator of the ranks on the same compute node.
+  static MPI_Comm priv_make_node_comm(const MPI_Comm &comm) {
+    const int local_root = priv_determine_local_root_rank(comm);
+    MPI_Comm node_comm;
+    if (::MPI_Comm_split(comm, local_root, priv_mpi_comm_rank(comm),
+                         &node_comm) != MPI_SUCCESS) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Failed MPI_Comm_split");
+      ::MPI_Abort(comm, -1);
+    }
+    return node_comm;
+  }
+
+  template <typename T>
+  static void priv_all_reduce(T *const value, const MPI_Datatype type,
+                              const MPI_Op op, const MPI_Comm &comm) {
+    if (::MPI_Allreduce(MPI_IN_PLACE, value, 1, type, op, comm) !=
+        MPI_SUCCESS) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "Failed MPI_Allreduce");
+      ::MPI_Abort(comm, -1);
+    }
+  }
+
   static int priv_determine_local_root_rank(const MPI_Comm &comm) {
     const int rank = mpi::determine_local_root(comm);
     if (rank == -1) {
@@ -459,6 +795,9 @@ class metall_mpi_adaptor {
   MPI_Comm m_mpi_comm;
   std::string m_root_dir_prefix;
   std::unique_ptr<manager_type> m_local_metall_manager;
+  // Used only when opened collectively
+  MPI_Comm m_node_comm{MPI_COMM_NULL};
+  int m_max_concurrent_per_node{0};
 };
 
 }  // namespace metall::utility
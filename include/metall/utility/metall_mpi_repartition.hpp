@@ -0,0 +1,252 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#ifndef METALL_UTILITY_METALL_MPI_REPARTITION_HPP
+#define METALL_UTILITY_METALL_MPI_REPARTITION_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <metall/metall.hpp>
+#include <metall/utility/mpi.hpp>
+#include <metall/utility/metall_mpi_adaptor.hpp>
+#include <metall/utility/metall_mpi_datastore.hpp>
+
+namespace metall::utility {
+
+namespace mpi_repartition_detail {
+template <typename record_type>
+using storage_type =
+    std::aligned_storage_t<sizeof(record_type), alignof(record_type)>;
+
+template <typename record_type>
+const record_type &as_record(const storage_type<record_type> &storage) {
+  return *std::launder(reinterpret_cast<const record_type *>(&storage));
+}
+
+/// \brief Defines how an element is sent to other ranks.
+/// An element is sent as it is.
+template <typename value_type>
+struct record_traits {
+  static_assert(std::is_trivially_copyable_v<value_type>,
+                "Only trivially copyable elements can be sent to other ranks");
+  using record_type = value_type;
+
+  static const record_type &to_record(const value_type &value) { return value; }
+  static const value_type &to_value(const record_type &record) {
+    return record;
+  }
+};
+
+/// \brief An element of a map, std::pair<const key, mapped value>, is not
+/// trivially copyable; thus, its members are sent as a plain structure.
+template <typename first_type, typename second_type>
+struct record_traits<std::pair<first_type, second_type>> {
+  using value_type = std::pair<first_type, second_type>;
+  struct record_type {
+    std::remove_const_t<first_type> first;
+    second_type second;
+  };
+  static_assert(std::is_trivially_copyable_v<record_type>,
+                "Only trivially copyable elements can be sent to other ranks");
+
+  static record_type to_record(const value_type &value) {
+    return record_type{value.first, value.second};
+  }
+  static value_type to_value(const record_type &record) {
+    return value_type(record.first, record.second);
+  }
+};
+}  // namespace mpi_repartition_detail
+
+/// \brief Redistributes the elements of a named container in an MPI-distributed
+/// Metall datastore to a datastore with a different number of partitions.
+/// This is an experimental implementation.
+///
+/// \details
+/// This function must be called by all ranks in 'comm' collectively.
+/// The number of ranks in 'comm' is the new number of partitions and
+/// can differ from the number of partitions of the source datastore.
+/// The source partitions are read by the ranks in a round-robin manner,
+/// one partition per rank at a time.
+/// The elements are streamed to their destination ranks in batches with
+/// MPI_Alltoallv and inserted into the container in the destination
+/// datastore; thus, the memory used for the transfer is bounded by
+/// 'max_batch_size' elements for sending and receiving each,
+/// regardless of the size of the partitions.
+/// To move multiple containers, call this function for each name.
+/// \tparam container_type A container type that is stored in the source
+/// datastore. Its value_type must be trivially copyable, or a std::pair whose
+/// members are trivially copyable, i.e., the elements must not hold pointers.
+/// The container must be constructible from the allocator of metall::manager
+/// and support insert(end(), value), e.g., vector, deque, set,
+/// and (unordered) map.
+/// \tparam partitioner_type A callable type whose signature is
+/// int(const container_type::value_type &value, int num_partitions).
+/// It must return a partition number in [0, num_partitions).
+/// \param source_root_dir_prefix A root directory path of a source
+/// datastore created by metall_mpi_adaptor.
+/// \param name The name of the container in the source datastore.
+/// The container is found or constructed with the same name in the
+/// destination datastore.
+/// \param destination A destination datastore opened by all ranks in 'comm'.
+/// \param partitioner Determines the destination partition of each element.
+/// \param comm A MPI communicator.
+/// \param max_batch_size The maximum number of elements each rank sends, and
+/// receives, in an exchange. Must be the same on all ranks.
+/// \return Returns true if all ranks succeeded; otherwise, returns false.
+template <typename container_type, typename partitioner_type>
+inline bool repartition_named_container(
+    const std::string &source_root_dir_prefix, const std::string &name,
+    metall_mpi_adaptor &destination, partitioner_type partitioner,
+    const MPI_Comm &comm = MPI_COMM_WORLD,
+    const std::size_t max_batch_size = 1ULL << 22ULL) {
+  using value_type = typename container_type::value_type;
+  using traits = mpi_repartition_detail::record_traits<value_type>;
+  using record_type = typename traits::record_type;
+  using storage_type = mpi_repartition_detail::storage_type<record_type>;
+
+  const int rank = mpi::comm_rank(comm);
+  const int size = mpi::comm_size(comm);
+  const int num_source_partitions =
+      metall_mpi_adaptor::partitions(source_root_dir_prefix, comm);
+
+  // Counts and displacements of MPI_Alltoallv are int
+  const std::size_t batch_size = std::max(
+      std::size_t(size),
+      std::min(max_batch_size, std::size_t(std::numeric_limits<int>::max())));
+  // Bounds the number of elements each rank receives as well
+  const std::size_t max_per_destination = batch_size / size;
+
+  auto &manager = destination.get_local_manager();
+  auto *const container = manager.find_or_construct<container_type>(
+      name.c_str())(manager.get_allocator());
+  bool succeeded = (container != nullptr);
+
+  MPI_Datatype mpi_record_type;
+  ::MPI_Type_contiguous(sizeof(record_type), MPI_BYTE, &mpi_record_type);
+  ::MPI_Type_commit(&mpi_record_type);
+
+  std::vector<std::vector<storage_type>> outgoing(size);
+  std::vector<storage_type> send_buf;
+  std::vector<storage_type> recv_buf;
+  std::vector<int> send_counts(size);
+  std::vector<int> send_displs(size);
+  std::vector<int> recv_counts(size);
+  std::vector<int> recv_displs(size);
+
+  // Every rank takes part in every round to call the collectives
+  const int num_rounds = (num_source_partitions + size - 1) / size;
+  for (int round = 0; round < num_rounds; ++round) {
+    std::unique_ptr<metall_mpi_adaptor::manager_type> source_manager;
+    const container_type *source = nullptr;
+    const int source_partition = round * size + rank;
+    if (source_partition < num_source_partitions) {
+      source_manager = std::make_unique<metall_mpi_adaptor::manager_type>(
+          metall::open_read_only,
+          mpi_datastore::make_local_dir_path(source_root_dir_prefix,
+                                             source_partition)
+              .c_str());
+      source = source_manager->template find<container_type>(name.c_str())
+                   .first;
+      if (!source) {
+        std::string s("Cannot find " + name + " in partition " +
+                      std::to_string(source_partition));
+        logger::out(logger::level::error, __FILE__, __LINE__, s.c_str());
+        succeeded = false;
+      }
+    }
+
+    // Streams the partition in batches until every rank has sent all
+    bool valid_partitions = true;
+    typename container_type::const_iterator itr{};
+    if (source) itr = source->begin();
+    while (true) {
+      bool batch_full = false;
+      std::size_t num_batched = 0;
+      for (; source && itr != source->end() && !batch_full; ++itr) {
+        const int dst = partitioner(*itr, size);
+        if (dst < 0 || dst >= size) {
+          valid_partitions = false;
+          continue;
+        }
+        outgoing[dst].emplace_back();
+        const record_type record = traits::to_record(*itr);
+        std::memcpy(&outgoing[dst].back(), &record, sizeof(record_type));
+        ++num_batched;
+        batch_full = (outgoing[dst].size() >= max_per_destination ||
+                      num_batched >= batch_size);
+      }
+      const bool local_done = !source || itr == source->end();
+      const auto all_done = mpi::global_logical_and(local_done, comm);
+      if (!all_done.first) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Failed to synchronize batches");
+        ::MPI_Abort(comm, -1);
+      }
+
+      send_buf.clear();
+      for (int r = 0; r < size; ++r) {
+        send_counts[r] = int(outgoing[r].size());
+        send_displs[r] = int(send_buf.size());
+        send_buf.insert(send_buf.end(), outgoing[r].begin(),
+                        outgoing[r].end());
+        outgoing[r].clear();
+      }
+
+      if (::MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(),
+                         1, MPI_INT, comm) != MPI_SUCCESS) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Failed MPI_Alltoall");
+        ::MPI_Abort(comm, -1);
+      }
+      recv_displs[0] = 0;
+      for (int r = 1; r < size; ++r) {
+        recv_displs[r] = recv_displs[r - 1] + recv_counts[r - 1];
+      }
+      recv_buf.resize(std::size_t(recv_displs[size - 1]) +
+                      recv_counts[size - 1]);
+      if (::MPI_Alltoallv(send_buf.data(), send_counts.data(),
+                          send_displs.data(), mpi_record_type, recv_buf.data(),
+                          recv_counts.data(), recv_displs.data(),
+                          mpi_record_type, comm) != MPI_SUCCESS) {
+        logger::out(logger::level::error, __FILE__, __LINE__,
+                    "Failed MPI_Alltoallv");
+        ::MPI_Abort(comm, -1);
+      }
+
+      if (container) {
+        for (const auto &storage : recv_buf) {
+          container->insert(
+              container->end(),
+              traits::to_value(
+                  mpi_repartition_detail::as_record<record_type>(storage)));
+        }
+      }
+
+      if (all_done.second) break;
+    }
+
+    if (!valid_partitions) {
+      logger::out(logger::level::error, __FILE__, __LINE__,
+                  "The partitioner returned invalid partition numbers");
+      succeeded = false;
+    }
+  }
+
+  ::MPI_Type_free(&mpi_record_type);
+  const auto ret = mpi::global_logical_and(succeeded, comm);
+  return ret.first && ret.second;
+}
+
+}  // namespace metall::utility
+
+#endif  // METALL_UTILITY_METALL_MPI_REPARTITION_HPP
@@ -0,0 +1,132 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <metall/metall.hpp>
+
+namespace fs = std::filesystem;
+
+void show_report(const std::string &path,
+                 const metall::manager::consistency_report_type &report) {
+  std::cout << "[Datastore] " << path << std::endl;
+  std::cout << "Properly closed: " << (report.properly_closed ? "yes" : "no")
+            << std::endl;
+  std::cout << "#of chunks: " << report.num_chunks << std::endl;
+  std::cout << "#of named/unique/anonymous objects: "
+            << report.num_attributed_objects << std::endl;
+  std::cout << "#of problems: " << report.errors.size() << std::endl;
+  for (const auto &error : report.errors) {
+    std::cout << "  " << error << std::endl;
+  }
+}
+
+/// Replaces a data store with a copy of a snapshot.
+bool restore_snapshot(const std::string &snapshot_path,
+                      const std::string &datastore_path,
+                      const int num_threads) {
+  // Copies to a temporary path first not to lose the data store on failure
+  const std::string tmp_path = datastore_path + ".fsck_restoring";
+  metall::manager::remove(tmp_path);
+  if (!metall::manager::copy(snapshot_path, tmp_path, true, num_threads)) {
+    std::cerr << "Failed to copy " << snapshot_path << std::endl;
+    return false;
+  }
+  std::error_code ec;
+  const std::string broken_path = datastore_path + ".fsck_broken";
+  fs::remove_all(broken_path, ec);
+  fs::rename(datastore_path, broken_path, ec);
+  if (ec) {
+    std::cerr << "Failed to move " << datastore_path << ": " << ec.message()
+              << std::endl;
+    return false;
+  }
+  fs::rename(tmp_path, datastore_path, ec);
+  if (ec) {
+    std::cerr << "Failed to move " << tmp_path << ": " << ec.message()
+              << std::endl;
+    return false;
+  }
+  fs::remove_all(broken_path, ec);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  bool repair = false;
+  std::string snapshot_path;
+  int num_threads = 0;
+
+  int opt;
+  while ((opt = ::getopt(argc, argv, "rs:t:")) != -1) {
+    switch (opt) {
+      case 'r':
+        repair = true;
+        break;
+      case 's':
+        snapshot_path = optarg;
+        break;
+      case 't':
+        num_threads = std::stoi(optarg);
+        break;
+      default:
+        std::cerr << "Usage: " << argv[0]
+                  << " [-r] [-s /path/to/snapshot] [-t #of threads]"
+                     " /path/to/datastore"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+  }
+
+  if (optind + 1 != argc) {
+    std::cerr << "Specify one datastore path" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string datastore_path = argv[optind];
+
+  const auto report =
+      metall::manager::check_consistency(datastore_path, false, num_threads);
+  show_report(datastore_path, report);
+  if (report.consistent() && report.properly_closed) return 0;
+  if (!repair) return EXIT_FAILURE;
+
+  std::cout << std::endl;
+  if (!snapshot_path.empty()) {
+    // A clean snapshot keeps objects that in-place repair would drop
+    const auto snapshot_report =
+        metall::manager::check_consistency(snapshot_path, false, num_threads);
+    if (snapshot_report.consistent() && snapshot_report.properly_closed) {
+      std::cout << "Restoring the snapshot " << snapshot_path << std::endl;
+      return restore_snapshot(snapshot_path, datastore_path, num_threads)
+                 ? 0
+                 : EXIT_FAILURE;
+    }
+    std::cout << "The snapshot " << snapshot_path
+              << " is not consistent; repairing in place" << std::endl;
+  }
+
+  if (!report.readable) {
+    std::cerr << "Cannot repair: the management data cannot be read"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  const auto repair_report =
+      metall::manager::check_consistency(datastore_path, true, num_threads);
+  if (!repair_report.repaired) {
+    std::cerr << "Failed to repair " << datastore_path << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Repaired " << datastore_path << std::endl;
+
+  return metall::manager::check_consistency(datastore_path, false,
+                                            num_threads)
+                 .consistent()
+             ? 0
+             : EXIT_FAILURE;
+}
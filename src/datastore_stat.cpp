@@ -0,0 +1,57 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <metall/utility/datastore_stat.hpp>
+
+int main(int argc, char *argv[]) {
+  std::size_t num_largest_objects = 10;
+  int num_threads = 0;
+
+  int opt;
+  while ((opt = ::getopt(argc, argv, "n:t:")) != -1) {
+    switch (opt) {
+      case 'n':
+        num_largest_objects = std::stoull(optarg);
+        break;
+      case 't':
+        num_threads = std::stoi(optarg);
+        break;
+      default:
+        std::cerr << "Usage: " << argv[0]
+                  << " [-n #of largest objects] [-t #of threads]"
+                     " /path/to/datastore..."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+  }
+
+  if (optind == argc) {
+    std::cerr << "Empty datastore path" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool succeeded = true;
+  for (int i = optind; i < argc; ++i) {
+    metall::utility::datastore_stat stat;
+    if (!metall::utility::get_datastore_stat(argv[i], &stat,
+                                             num_largest_objects,
+                                             num_threads)) {
+      std::cerr << "Failed to read " << argv[i] << std::endl;
+      succeeded = false;
+      continue;
+    }
+    metall::utility::show_datastore_stat(stat);
+    std::cout << std::endl;
+  }
+
+  return succeeded ? 0 : EXIT_FAILURE;
+}
@@ -108,4 +108,29 @@ bool metall_named_free(metall_manager* manager, const char* name) {
   }
 
   return res;
-}
\ No newline at end of file
+}
+
+bool metall_get_allocator_statistics(metall_manager* manager,
+                                     metall_allocator_statistics* stats) {
+  auto* const m = reinterpret_cast<metall::manager*>(manager);
+  if (stats == nullptr || !m->check_sanity()) {
+    errno = EINVAL;
+    return false;
+  }
+
+  const auto snapshot = m->get_allocator_statistics();
+  stats->num_allocations = snapshot.num_allocations;
+  stats->num_deallocations = snapshot.num_deallocations;
+  stats->num_in_place_resizes = snapshot.num_in_place_resizes;
+  stats->num_cache_hits = snapshot.num_cache_hits;
+  stats->num_cache_misses = snapshot.num_cache_misses;
+  stats->num_bin_lock_acquisitions = snapshot.num_bin_lock_acquisitions;
+  stats->num_bin_lock_contentions = snapshot.num_bin_lock_contentions;
+  stats->bin_lock_wait_time_ns = snapshot.bin_lock_wait_time_ns;
+  stats->num_segment_extensions = snapshot.num_segment_extensions;
+  stats->num_free_region_calls = snapshot.num_free_region_calls;
+  stats->free_region_bytes = snapshot.free_region_bytes;
+  stats->bytes_in_use = snapshot.bytes_in_use;
+
+  return true;
+}
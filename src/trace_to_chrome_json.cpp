@@ -0,0 +1,24 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include <cstdlib>
+#include <iostream>
+
+#include <metall/tracer.hpp>
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " trace_file output_json_file"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!metall::tracer::convert_to_chrome_trace(argv[1], argv[2])) {
+    std::cerr << "Failed to convert " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return 0;
+}
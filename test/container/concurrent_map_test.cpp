@@ -6,6 +6,8 @@
 #include "gtest/gtest.h"
 
 #include <filesystem>
+#include <thread>
+#include <vector>
 
 #include <boost/interprocess/managed_mapped_file.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
@@ -102,6 +104,71 @@ TEST(ConcurrentMapTest, Find) {
   GTEST_ASSERT_EQ(itr2->second, v2.second);
 }
 
+TEST(ConcurrentMapTest, Visit) {
+  metall::container::concurrent_map<char, int> map;
+
+  int read_value = -1;
+  GTEST_ASSERT_FALSE(map.visit('a', [&read_value](const int& v) {
+    read_value = v;
+  }));
+  GTEST_ASSERT_EQ(read_value, -1);
+
+  map.insert(std::make_pair('a', 10));
+  GTEST_ASSERT_TRUE(map.visit('a', [&read_value](const int& v) {
+    read_value = v;
+  }));
+  GTEST_ASSERT_EQ(read_value, 10);
+}
+
+TEST(ConcurrentMapTest, IndependentLocks) {
+  metall::container::concurrent_map<char, int> map1;
+  metall::container::concurrent_map<char, int> map2;
+
+  // Locking a bank of one container must not block the same bank of another
+  // container.
+  auto ret = map1.scoped_edit('a');
+  ret.first = 1;
+  map2.edit('a', [](int& v) { v = 2; });
+  GTEST_ASSERT_TRUE(map2.visit('a', [](const int& v) { ASSERT_EQ(v, 2); }));
+}
+
+TEST(ConcurrentMapTest, FreeLocks) {
+  using lock_table_type = metall::mtlldetail::transient_lock_table<1024>;
+  const auto num_tables = lock_table_type::num_allocated_tables();
+  for (int i = 0; i < 100; ++i) {
+    metall::container::concurrent_map<char, int> map;
+    map.edit('a', [](int& v) { v = 1; });
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables + 1);
+  }
+  GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables);
+}
+
+TEST(ConcurrentMapTest, ConcurrentReadWrite) {
+  metall::container::concurrent_map<int, int> map;
+  const int num_keys = 1000;
+  const int num_threads = 4;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&map, t]() {
+      for (int i = 0; i < num_keys; ++i) {
+        if (i % num_threads == t) {
+          map.edit(i, [i](int& v) { v = i; });
+        } else {
+          // The value is either not inserted yet or completely written
+          map.visit(i, [i](const int& v) { ASSERT_EQ(v, i); });
+        }
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  GTEST_ASSERT_EQ(map.size(), num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    GTEST_ASSERT_TRUE(map.visit(i, [i](const int& v) { ASSERT_EQ(v, i); }));
+  }
+}
+
 TEST(ConcurrentMapTest, Iterator) {
   boost::container::map<char, int> ref_map;
   metall::container::concurrent_map<char, int> map;
@@ -167,4 +234,52 @@ TEST(ConcurrentMapTest, Persistence) {
     }
   }
 }
+
+TEST(ConcurrentMapTest, LocksAfterDestroyAndReopenCopy) {
+  using allocator_type =
+      bip::allocator<std::pair<const char, int>,
+                     bip::managed_mapped_file::segment_manager>;
+  using map_type =
+      metall::container::concurrent_map<char, int, std::less<char>,
+                                        std::hash<char>, allocator_type, 3>;
+  // Uses a number of banks no other test uses to count the tables
+  using lock_table_type = metall::mtlldetail::transient_lock_table<3>;
+
+  const std::filesystem::path file_path(test_utility::make_test_path());
+  const std::filesystem::path copy_path(test_utility::make_test_path("copy"));
+
+  test_utility::create_test_dir();
+  metall::mtlldetail::remove_file(file_path);
+  metall::mtlldetail::remove_file(copy_path);
+
+  const auto num_tables = lock_table_type::num_allocated_tables();
+  {
+    bip::managed_mapped_file mfile(bip::create_only, file_path.c_str(),
+                                   1 << 20);
+    auto pmap = mfile.construct<map_type>("map")(
+        mfile.get_allocator<typename allocator_type::value_type>());
+    // Takes a lock, which caches the lock table in the map
+    pmap->edit('a', [](int& v) { v = 1; });
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables + 1);
+    mfile.flush();
+    std::filesystem::copy_file(file_path, copy_path);
+
+    // Frees the lock table the copy's cache points to
+    mfile.destroy<map_type>("map");
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables);
+  }
+
+  {
+    // The map is likely to be mapped at the same address as before
+    bip::managed_mapped_file mfile(bip::open_only, copy_path.c_str());
+    const auto pmap = mfile.find<map_type>("map").first;
+    GTEST_ASSERT_NE(pmap, nullptr);
+    // Must not use the freed table; a new one is allocated
+    pmap->edit('b', [](int& v) { v = 2; });
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables + 1);
+    GTEST_ASSERT_TRUE(pmap->visit('a', [](const int& v) { ASSERT_EQ(v, 1); }));
+    mfile.destroy<map_type>("map");
+  }
+  GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables);
+}
 }  // namespace
@@ -0,0 +1,178 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <metall/metall.hpp>
+#include <metall/container/string.hpp>
+#include <metall/container/concurrent_segmented_vector.hpp>
+#include "../test_utility.hpp"
+
+namespace {
+
+namespace mc = metall::container;
+
+// Small segments to test segment boundaries
+using vector_type =
+    mc::concurrent_segmented_vector<int, std::allocator<int>, 3>;
+
+TEST(ConcurrentSegmentedVectorTest, Append) {
+  vector_type vec;
+  ASSERT_TRUE(vec.empty());
+  ASSERT_EQ(vec.num_segments(), 0);
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(vec.push_back(i), i);
+  }
+  ASSERT_EQ(vec.size(), 100);
+  ASSERT_EQ(vec.num_segments(), (100 + 7) / 8);
+
+  const int *const first = &vec[0];
+  const std::vector<int> input{100, 101, 102, 103, 104, 105, 106, 107, 108};
+  ASSERT_EQ(vec.append(input.begin(), input.end()), 100);
+  ASSERT_EQ(vec.grow_by(3, 109), 109);
+  ASSERT_EQ(vec.emplace_back(112), 112);
+  ASSERT_EQ(vec.size(), 113);
+  // Elements are never relocated
+  ASSERT_EQ(first, &vec[0]);
+
+  for (int i = 0; i < 109; ++i) {
+    ASSERT_EQ(vec[i], i);
+    ASSERT_EQ(vec.at(i), i);
+  }
+  for (int i = 109; i < 112; ++i) {
+    ASSERT_EQ(vec[i], 109);
+  }
+  ASSERT_EQ(vec[112], 112);
+  ASSERT_THROW(vec.at(113), std::out_of_range);
+}
+
+TEST(ConcurrentSegmentedVectorTest, Iterator) {
+  vector_type vec;
+  for (int i = 0; i < 50; ++i) vec.push_back(i);
+
+  ASSERT_EQ(vec.end() - vec.begin(), 50);
+  ASSERT_EQ(std::accumulate(vec.cbegin(), vec.cend(), 0), 49 * 50 / 2);
+  ASSERT_EQ(*(vec.begin() + 20), 20);
+  ASSERT_EQ(vec.begin()[30], 30);
+
+  std::reverse(vec.begin(), vec.end());
+  ASSERT_EQ(vec[0], 49);
+  std::sort(vec.begin(), vec.end());
+  ASSERT_TRUE(std::is_sorted(vec.cbegin(), vec.cend()));
+
+  vector_type::const_iterator citr = vec.begin();
+  ASSERT_EQ(*citr, 0);
+}
+
+TEST(ConcurrentSegmentedVectorTest, ClearAndReserve) {
+  mc::concurrent_segmented_vector<std::string, std::allocator<std::string>, 2>
+      vec;
+  vec.reserve(10);
+  ASSERT_EQ(vec.num_segments(), 3);
+  ASSERT_TRUE(vec.empty());
+
+  for (int i = 0; i < 10; ++i) vec.push_back(std::to_string(i));
+  ASSERT_EQ(vec.num_segments(), 3);
+  vec.clear();
+  ASSERT_TRUE(vec.empty());
+  // Segments are reused
+  ASSERT_EQ(vec.num_segments(), 3);
+
+  vec.push_back("a");
+  ASSERT_EQ(vec[0], "a");
+}
+
+TEST(ConcurrentSegmentedVectorTest, ConcurrentAppend) {
+  vector_type vec;
+  constexpr int k_num_threads = 8;
+  constexpr int k_num_items_per_thread = 10000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < k_num_threads; ++t) {
+    threads.emplace_back([&vec, t]() {
+      for (int i = 0; i < k_num_items_per_thread; ++i) {
+        if (i % 100 == 0) {
+          const std::vector<int> batch(5, t * k_num_items_per_thread + i);
+          vec.append(batch.begin(), batch.end());
+        } else {
+          vec.push_back(t * k_num_items_per_thread + i);
+        }
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+
+  constexpr int k_num_batches = k_num_items_per_thread / 100;
+  ASSERT_EQ(vec.size(),
+            k_num_threads * (k_num_items_per_thread + k_num_batches * 4));
+
+  std::vector<int> counts(k_num_threads * k_num_items_per_thread, 0);
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    ++counts[vec[i]];
+  }
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    ASSERT_EQ(counts[i], (i % 100 == 0) ? 5 : 1);
+  }
+
+  // Batches are stored contiguously
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    if (vec[i] % 100 == 0) {
+      for (int j = 1; j < 5; ++j) ASSERT_EQ(vec[i + j], vec[i]);
+      i += 4;
+    }
+  }
+}
+
+TEST(ConcurrentSegmentedVectorTest, Persistence) {
+  using string_type = mc::string;
+  using persistent_vector_type = mc::concurrent_segmented_vector<
+      string_type, metall::manager::allocator_type<string_type>, 4>;
+  const auto dir_path = test_utility::make_test_path();
+
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    auto *vec = manager.construct<persistent_vector_type>("log")(
+        manager.get_allocator());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([vec, &manager, t]() {
+        for (int i = 0; i < 100; ++i) {
+          vec->emplace_back(std::to_string(t * 100 + i).c_str(),
+                            manager.get_allocator());
+        }
+      });
+    }
+    for (auto &th : threads) th.join();
+  }
+
+  {
+    metall::manager manager(metall::open_only, dir_path);
+    auto *vec = manager.find<persistent_vector_type>("log").first;
+    ASSERT_NE(vec, nullptr);
+    ASSERT_EQ(vec->size(), 400);
+    std::vector<int> values;
+    for (const auto &str : *vec) values.push_back(std::stoi(str.c_str()));
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < 400; ++i) ASSERT_EQ(values[i], i);
+
+    // Appends after reopening
+    vec->emplace_back("400", manager.get_allocator());
+    ASSERT_EQ((*vec)[400], "400");
+    ASSERT_TRUE(manager.destroy<persistent_vector_type>("log"));
+  }
+
+  {
+    metall::manager manager(metall::open_read_only, dir_path);
+    ASSERT_TRUE(manager.all_memory_deallocated());
+  }
+}
+}  // namespace
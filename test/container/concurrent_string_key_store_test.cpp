@@ -0,0 +1,220 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include <metall/metall.hpp>
+#include <metall/container/concurrent_string_key_store.hpp>
+#include "../test_utility.hpp"
+
+namespace {
+
+using store_type = metall::container::concurrent_string_key_store<
+    int, std::allocator<std::byte>, 8>;
+
+TEST(ConcurrentStringKeyStoreTest, DuplicateInsert) {
+  store_type store(false, 111);
+  ASSERT_FALSE(store.unique());
+  ASSERT_EQ(store.hash_seed(), 111);
+
+  ASSERT_TRUE(store.insert("a"));
+  ASSERT_TRUE(store.insert("a", 1));
+  ASSERT_TRUE(store.insert("b", 2));
+  ASSERT_EQ(store.count("a"), 2);
+  ASSERT_EQ(store.count("b"), 1);
+  ASSERT_EQ(store.count("c"), 0);
+  ASSERT_EQ(store.size(), 3);
+
+  int sum = 0;
+  ASSERT_EQ(store.visit("a", [&sum](const int &v) { sum += v; }), 2);
+  ASSERT_EQ(sum, 1);
+
+  ASSERT_EQ(store.erase("a"), 2);
+  ASSERT_EQ(store.count("a"), 0);
+  ASSERT_EQ(store.size(), 1);
+
+  store.clear();
+  ASSERT_EQ(store.size(), 0);
+}
+
+TEST(ConcurrentStringKeyStoreTest, UniqueInsert) {
+  store_type store(true, 111);
+  ASSERT_TRUE(store.unique());
+
+  ASSERT_TRUE(store.insert("a"));
+  ASSERT_FALSE(store.insert("a"));
+  ASSERT_TRUE(store.insert("a", 10));  // Overwrites the value
+  ASSERT_EQ(store.count("a"), 1);
+  ASSERT_EQ(store.visit("a", [](const int &v) { ASSERT_EQ(v, 10); }), 1);
+
+  ASSERT_EQ(store.edit("a", [](int &v) { v += 1; }), 1);
+  ASSERT_EQ(store.edit("b", [](int &v) { v += 1; }), 0);
+  ASSERT_EQ(store.visit("a", [](const int &v) { ASSERT_EQ(v, 11); }), 1);
+  ASSERT_EQ(store.size(), 1);
+}
+
+TEST(ConcurrentStringKeyStoreTest, StringValue) {
+  metall::container::concurrent_string_key_store<
+      std::string, std::allocator<std::byte>, 8>
+      store(true, 111);
+  ASSERT_TRUE(store.insert("key", "value"));
+  ASSERT_TRUE(store.insert("key", "value2"));
+  ASSERT_EQ(store.size(), 1);
+  ASSERT_EQ(store.visit("key",
+                        [](const std::string &v) { ASSERT_EQ(v, "value2"); }),
+            1);
+
+  const std::vector<std::pair<std::string, std::string>> inputs{{"a", "b"},
+                                                                {"c", "d"}};
+  ASSERT_EQ(store.bulk_insert(inputs.begin(), inputs.end()), 2);
+  ASSERT_EQ(store.size(), 3);
+  ASSERT_EQ(
+      store.visit("c", [](const std::string &v) { ASSERT_EQ(v, "d"); }), 1);
+}
+
+TEST(ConcurrentStringKeyStoreTest, ForEach) {
+  store_type store(true, 111);
+  std::unordered_map<std::string, int> ref;
+  for (int i = 0; i < 1000; ++i) {
+    store.insert(std::to_string(i), i);
+    ref[std::to_string(i)] = i;
+  }
+
+  std::mutex mutex;
+  std::unordered_map<std::string, int> found;
+  store.for_each([&](const std::string_view &key, const int &value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    found[std::string(key)] = value;
+  });
+  ASSERT_EQ(found, ref);
+
+  std::size_t num_visited = 0;
+  for (std::size_t s = 0; s < store_type::num_shards(); ++s) {
+    store.for_each_in_shard(
+        s, [&num_visited](const auto &, const auto &) { ++num_visited; });
+  }
+  ASSERT_EQ(num_visited, ref.size());
+}
+
+TEST(ConcurrentStringKeyStoreTest, BulkInsert) {
+  for (const bool unique : {true, false}) {
+    store_type store(unique, 111);
+    store.insert("0", -1);
+
+    std::vector<std::pair<std::string, int>> inputs;
+    for (int i = 0; i < 10000; ++i) {
+      inputs.emplace_back(std::to_string(i), i);
+    }
+    inputs.emplace_back("5", 5);  // Duplicate key
+
+    // Use a small chunk size to process multiple chunks
+    ASSERT_EQ(store.bulk_insert(inputs.begin(), inputs.end(), 1000),
+              inputs.size());
+    if (unique) {
+      ASSERT_EQ(store.size(), 10000);
+      ASSERT_EQ(store.count("5"), 1);
+      // The last inserted value wins
+      ASSERT_EQ(store.visit("0", [](const int &v) { ASSERT_EQ(v, 0); }), 1);
+    } else {
+      ASSERT_EQ(store.size(), 10002);
+      ASSERT_EQ(store.count("5"), 2);
+      ASSERT_EQ(store.count("0"), 2);
+    }
+    for (int i = 1; i < 10000; ++i) {
+      ASSERT_EQ(store.visit(std::to_string(i),
+                            [i](const int &v) { ASSERT_EQ(v, i); }),
+                (unique || i != 5) ? 1 : 2);
+    }
+  }
+}
+
+TEST(ConcurrentStringKeyStoreTest, BulkInsertReallocations) {
+  using counting_store_type = metall::container::concurrent_string_key_store<
+      int, test_utility::counting_allocator<std::byte>, 4>;
+  counting_store_type store(true, 111);
+
+  // Short keys are stored inline, so only the shards' storage is allocated
+  const int num_items = 1 << 15;
+  std::vector<std::pair<std::string, int>> inputs;
+  for (int i = 0; i < num_items; ++i) {
+    inputs.emplace_back(std::to_string(i), i);
+  }
+
+  // Many small chunks; each shard must grow geometrically rather than
+  // reallocating for every chunk
+  const auto num_allocations_before =
+      test_utility::allocation_counter::num_allocations.load();
+  ASSERT_EQ(store.bulk_insert(inputs.begin(), inputs.end(), 128), num_items);
+  ASSERT_EQ(store.size(), num_items);
+  const auto num_allocations =
+      test_utility::allocation_counter::num_allocations.load() -
+      num_allocations_before;
+
+  // Element storage and hash table of each shard: O(log n) each
+  std::size_t log_num_items = 0;
+  while ((1ULL << log_num_items) < std::size_t(num_items)) ++log_num_items;
+  ASSERT_LE(num_allocations,
+            counting_store_type::num_shards() * 2 * (log_num_items + 1));
+}
+
+TEST(ConcurrentStringKeyStoreTest, ConcurrentInsert) {
+  store_type store(false, 111);
+  const int num_keys = 1000;
+  const int num_threads = 4;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&store]() {
+      for (int i = 0; i < num_keys; ++i) {
+        store.insert(std::to_string(i), i);
+        store.visit(std::to_string(i), [i](const int &v) { ASSERT_EQ(v, i); });
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+
+  ASSERT_EQ(store.size(), num_keys * num_threads);
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_EQ(store.count(std::to_string(i)), num_threads);
+  }
+}
+
+TEST(ConcurrentStringKeyStoreTest, Persistence) {
+  using persistent_store_type =
+      metall::container::concurrent_string_key_store<int>;
+  const auto dir_path = test_utility::make_test_path();
+
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    auto *store = manager.construct<persistent_store_type>("store")(
+        true, 111, manager.get_allocator());
+    for (int i = 0; i < 100; ++i) {
+      store->insert(std::to_string(i), i);
+    }
+  }
+
+  {
+    metall::manager manager(metall::open_only, dir_path);
+    auto *store = manager.find<persistent_store_type>("store").first;
+    ASSERT_NE(store, nullptr);
+    ASSERT_TRUE(store->unique());
+    ASSERT_EQ(store->size(), 100);
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_EQ(store->visit(std::to_string(i),
+                             [i](const int &v) { ASSERT_EQ(v, i); }),
+                1);
+    }
+    store->insert("100", 100);
+    ASSERT_EQ(store->size(), 101);
+  }
+}
+}  // namespace
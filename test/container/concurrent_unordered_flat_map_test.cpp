@@ -0,0 +1,202 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
+
+#include <metall/metall.hpp>
+#include <metall/container/concurrent_unordered_flat_map.hpp>
+#include "../test_utility.hpp"
+
+namespace {
+
+using map_type = metall::container::concurrent_unordered_flat_map<
+    int, int, std::hash<int>, std::equal_to<int>,
+    std::allocator<std::pair<const int, int>>, 16>;
+
+TEST(ConcurrentUnorderedFlatMapTest, Insert) {
+  map_type map;
+  GTEST_ASSERT_TRUE(map.empty());
+
+  GTEST_ASSERT_TRUE(map.insert(std::make_pair(1, 10)));
+  GTEST_ASSERT_FALSE(map.insert(std::make_pair(1, 20)));  // Duplicate key
+  const std::pair<const int, int> v2(2, 20);
+  GTEST_ASSERT_TRUE(map.insert(v2));
+
+  GTEST_ASSERT_EQ(map.size(), 2);
+  GTEST_ASSERT_EQ(map.count(1), 1);
+  GTEST_ASSERT_EQ(map.count(2), 1);
+  GTEST_ASSERT_EQ(map.count(3), 0);
+
+  int value = 0;
+  GTEST_ASSERT_TRUE(map.visit(1, [&value](const int &v) { value = v; }));
+  GTEST_ASSERT_EQ(value, 10);
+  GTEST_ASSERT_FALSE(map.visit(3, [](const int &) {}));
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, Edit) {
+  map_type map;
+  {
+    auto ret = map.scoped_edit(1);
+    ret.first = 10;
+  }
+  map.edit(2, [](int &v) { v = 20; });
+  map.edit(2, [](int &v) { v += 1; });
+  GTEST_ASSERT_EQ(map.size(), 2);
+  GTEST_ASSERT_TRUE(map.visit(1, [](const int &v) { ASSERT_EQ(v, 10); }));
+  GTEST_ASSERT_TRUE(map.visit(2, [](const int &v) { ASSERT_EQ(v, 21); }));
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, Erase) {
+  map_type map;
+  map.insert(std::make_pair(1, 10));
+  map.insert(std::make_pair(2, 20));
+  GTEST_ASSERT_EQ(map.erase(1), 1);
+  GTEST_ASSERT_EQ(map.erase(1), 0);
+  GTEST_ASSERT_EQ(map.size(), 1);
+  GTEST_ASSERT_EQ(map.count(1), 0);
+  GTEST_ASSERT_EQ(map.count(2), 1);
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, BulkInsert) {
+  map_type map;
+  map.insert(std::make_pair(0, -1));
+
+  std::vector<std::pair<int, int>> inputs;
+  for (int i = 0; i < 10000; ++i) {
+    inputs.emplace_back(i, i);
+  }
+  inputs.emplace_back(5, 5);  // Duplicate key
+  GTEST_ASSERT_EQ(map.insert(inputs.begin(), inputs.end()), 9999);
+  GTEST_ASSERT_EQ(map.size(), 10000);
+
+  // The existing element is not overwritten
+  GTEST_ASSERT_TRUE(map.visit(0, [](const int &v) { ASSERT_EQ(v, -1); }));
+  for (int i = 1; i < 10000; ++i) {
+    GTEST_ASSERT_TRUE(map.visit(i, [i](const int &v) { ASSERT_EQ(v, i); }));
+  }
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, Iterate) {
+  map_type map;
+  std::unordered_map<int, int> ref_map;
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(std::make_pair(i, i * 2));
+    ref_map[i] = i * 2;
+  }
+
+  std::size_t num_elems = 0;
+  for (auto itr = map.cbegin(), end = map.cend(); itr != end; ++itr) {
+    GTEST_ASSERT_EQ(ref_map.at(itr->first), itr->second);
+    ++num_elems;
+  }
+  GTEST_ASSERT_EQ(num_elems, ref_map.size());
+
+  std::atomic<std::size_t> num_visited{0};
+  std::atomic<long> sum{0};
+  map.for_each([&](const auto &elem) {
+    ++num_visited;
+    sum += elem.second;
+  });
+  GTEST_ASSERT_EQ(num_visited.load(), ref_map.size());
+  GTEST_ASSERT_EQ(sum.load(), 999 * 1000);
+
+  num_visited = 0;
+  for (std::size_t b = 0; b < map_type::num_banks(); ++b) {
+    map.for_each_in_bank(b, [&](const auto &) { ++num_visited; });
+  }
+  GTEST_ASSERT_EQ(num_visited.load(), ref_map.size());
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, ConcurrentReadWrite) {
+  map_type map;
+  const int num_keys = 1000;
+  const int num_threads = 4;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&map, t]() {
+      for (int i = 0; i < num_keys; ++i) {
+        if (i % num_threads == t) {
+          map.edit(i, [i](int &v) { v = i; });
+        } else {
+          map.visit(i, [i](const int &v) { ASSERT_EQ(v, i); });
+        }
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+  GTEST_ASSERT_EQ(map.size(), num_keys);
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, Persistence) {
+  using persistent_map_type =
+      metall::container::concurrent_unordered_flat_map<int, int>;
+  const auto dir_path = test_utility::make_test_path();
+
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    auto *map = manager.construct<persistent_map_type>("map")(
+        manager.get_allocator());
+    for (int i = 0; i < 100; ++i) {
+      map->insert(std::make_pair(i, i));
+    }
+  }
+
+  {
+    metall::manager manager(metall::open_only, dir_path);
+    auto *map = manager.find<persistent_map_type>("map").first;
+    ASSERT_NE(map, nullptr);
+    GTEST_ASSERT_EQ(map->size(), 100);
+    for (int i = 0; i < 100; ++i) {
+      GTEST_ASSERT_TRUE(map->visit(i, [i](const int &v) { ASSERT_EQ(v, i); }));
+    }
+    map->edit(100, [](int &v) { v = 100; });
+    GTEST_ASSERT_EQ(map->size(), 101);
+  }
+}
+
+TEST(ConcurrentUnorderedFlatMapTest, LocksAfterDestroyAndReopenSnapshot) {
+  using persistent_map_type =
+      metall::container::concurrent_unordered_flat_map<int, int>;
+  using lock_table_type =
+      metall::mtlldetail::transient_lock_table<persistent_map_type::num_banks()>;
+  const auto dir_path = test_utility::make_test_path();
+  const auto snapshot_path = test_utility::make_test_path("snapshot");
+
+  const auto num_tables = lock_table_type::num_allocated_tables();
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    auto *map = manager.construct<persistent_map_type>("map")(
+        manager.get_allocator());
+    // Takes a lock, which caches the lock table in the map
+    map->edit(1, [](int &v) { v = 1; });
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables + 1);
+    ASSERT_TRUE(manager.snapshot(snapshot_path));
+
+    // Frees the lock table the snapshot's cache points to
+    ASSERT_TRUE(manager.destroy<persistent_map_type>("map"));
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables);
+  }
+
+  {
+    // The map is likely to be mapped at the same address as before
+    metall::manager manager(metall::open_only, snapshot_path);
+    auto *map = manager.find<persistent_map_type>("map").first;
+    ASSERT_NE(map, nullptr);
+    // Must not use the freed table; a new one is allocated
+    map->edit(2, [](int &v) { v = 2; });
+    GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables + 1);
+    GTEST_ASSERT_TRUE(map->visit(1, [](const int &v) { ASSERT_EQ(v, 1); }));
+    GTEST_ASSERT_TRUE(map->visit(2, [](const int &v) { ASSERT_EQ(v, 2); }));
+    ASSERT_TRUE(manager.destroy<persistent_map_type>("map"));
+  }
+  GTEST_ASSERT_EQ(lock_table_type::num_allocated_tables(), num_tables);
+}
+}  // namespace
@@ -0,0 +1,188 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <metall/metall.hpp>
+#include <metall/container/experimental/jgraph/jgraph.hpp>
+#include <metall/container/experimental/jgraph/bulk_loader.hpp>
+#include "../../test_utility.hpp"
+
+namespace {
+
+namespace jg = metall::container::experimental::jgraph;
+
+constexpr int k_num_vertices = 200;
+
+std::string vertex_id(const int i) { return "v" + std::to_string(i); }
+
+// Returns the source and destination of the i-th edge.
+// Includes duplicate edges and self loops.
+std::pair<int, int> edge(const int i) {
+  return {i % k_num_vertices, (i * 7 + 3) % (k_num_vertices + 50)};
+}
+
+constexpr int k_num_edges = 1000;
+
+// Writes vertex and edge JSON Lines files.
+// Vertices whose numbers are equal to or larger than k_num_vertices appear only
+// in the edge file.
+std::pair<std::string, std::string> write_files() {
+  test_utility::create_test_dir();
+  const auto vertex_file = test_utility::make_test_path("vertices.jsonl");
+  const auto edge_file = test_utility::make_test_path("edges.jsonl");
+
+  {
+    std::ofstream ofs(vertex_file);
+    for (int i = 0; i < k_num_vertices; ++i) {
+      ofs << R"({"id":")" << vertex_id(i) << R"(", "n":)" << i << "}\n";
+      if (i % 50 == 0) {
+        ofs << "\n";                    // Empty line
+        ofs << "[0, 1]\n";              // Not an object
+        ofs << R"({"name":"x"})" << "\n";  // No ID
+      }
+    }
+  }
+
+  {
+    std::ofstream ofs(edge_file);
+    for (int i = 0; i < k_num_edges; ++i) {
+      const auto [s, d] = edge(i);
+      ofs << R"({"start":")" << vertex_id(s) << R"(", "end":")" << vertex_id(d)
+          << R"(", "n":)" << i << "}\n";
+    }
+  }
+
+  return {vertex_file.string(), edge_file.string()};
+}
+
+template <typename graph_type>
+void build_reference(graph_type *graph, const bool undirected) {
+  for (int i = 0; i < k_num_vertices; ++i) {
+    graph->register_vertex(vertex_id(i));
+  }
+  for (int i = 0; i < k_num_edges; ++i) {
+    const auto [s, d] = edge(i);
+    graph->register_edge(vertex_id(s), vertex_id(d), undirected);
+  }
+}
+
+template <typename graph_type>
+void check(graph_type &graph, const bool undirected) {
+  jg::jgraph<> ref;
+  build_reference(&ref, undirected);
+
+  ASSERT_EQ(graph.num_vertices(), ref.num_vertices());
+  ASSERT_EQ(graph.num_edges(), ref.num_edges());
+  for (auto itr = ref.vertices_begin(); itr != ref.vertices_end(); ++itr) {
+    const auto &id = itr->id();
+    ASSERT_TRUE(graph.has_vertex(id));
+    ASSERT_EQ(graph.degree(id), ref.degree(id));
+  }
+
+  for (int i = 0; i < k_num_vertices; ++i) {
+    const auto &value = graph.find_vertex(vertex_id(i))->value();
+    ASSERT_EQ(value.as_object().at("n").as_int64(), i);
+  }
+  ASSERT_TRUE(graph.find_vertex(vertex_id(k_num_vertices))->value().is_null());
+
+  for (int i = 0; i < k_num_edges; ++i) {
+    const auto [s, d] = edge(i);
+    ASSERT_EQ(graph.has_edges(vertex_id(s), vertex_id(d)),
+              ref.has_edges(vertex_id(s), vertex_id(d)));
+
+    bool found = false;
+    auto range = graph.find_edges(vertex_id(s), vertex_id(d));
+    for (auto itr = range.first; itr != range.second; ++itr) {
+      // Undirected edges are also found from their destination vertices
+      const bool forward = itr->source_id() == vertex_id(s) &&
+                           itr->destination_id() == vertex_id(d);
+      const bool backward = itr->source_id() == vertex_id(d) &&
+                            itr->destination_id() == vertex_id(s);
+      ASSERT_TRUE(forward || (undirected && backward));
+      found |= (itr->value().as_object().at("n").as_int64() == i);
+    }
+    ASSERT_TRUE(found);
+  }
+}
+
+TEST(JGraphBulkLoaderTest, Directed) {
+  const auto [vertex_file, edge_file] = write_files();
+
+  jg::jgraph<> graph;
+  jg::bulk_loader<jg::jgraph<>> loader(&graph);
+  // Small chunks to test lines across chunks
+  loader.set_chunk_size(17);
+  loader.set_num_chunks_per_round(5);
+  ASSERT_EQ(loader.load_vertices({vertex_file}), k_num_vertices);
+  ASSERT_EQ(loader.load_edges({edge_file}), k_num_edges);
+  check(graph, false);
+}
+
+TEST(JGraphBulkLoaderTest, Undirected) {
+  const auto [vertex_file, edge_file] = write_files();
+
+  jg::jgraph<> graph;
+  jg::bulk_loader<jg::jgraph<>> loader(&graph);
+  ASSERT_EQ(loader.load_vertices({vertex_file}), k_num_vertices);
+  ASSERT_EQ(loader.load_edges({edge_file}, true), k_num_edges);
+  check(graph, true);
+}
+
+TEST(JGraphBulkLoaderTest, EdgesFirst) {
+  const auto [vertex_file, edge_file] = write_files();
+
+  jg::jgraph<> graph;
+  jg::bulk_loader<jg::jgraph<>> loader(&graph);
+  ASSERT_EQ(loader.load_edges({edge_file}), k_num_edges);
+  // Overwrites the values of the vertices registered by the edges
+  ASSERT_EQ(loader.load_vertices({vertex_file}), k_num_vertices);
+  check(graph, false);
+}
+
+TEST(JGraphBulkLoaderTest, IntegerIDAndCustomKeys) {
+  test_utility::create_test_dir();
+  const auto file = test_utility::make_test_path("graph.jsonl");
+  {
+    std::ofstream ofs(file);
+    ofs << R"({"src":0, "dst":1})" << "\n";
+    ofs << R"({"src":"1", "dst":2})" << "\n";
+    ofs << R"({"src":0.5, "dst":1})" << "\n";  // Invalid ID type
+  }
+
+  jg::jgraph<> graph;
+  jg::bulk_loader<jg::jgraph<>> loader(&graph, "id", "src", "dst");
+  ASSERT_EQ(loader.load_edges({file.string()}), 2);
+  ASSERT_EQ(graph.num_vertices(), 3);
+  ASSERT_EQ(graph.has_edges("0", "1"), 1);
+  ASSERT_EQ(graph.has_edges("1", "2"), 1);
+}
+
+TEST(JGraphBulkLoaderTest, Persistence) {
+  using graph_type = jg::jgraph<metall::manager::allocator_type<std::byte>>;
+  const auto [vertex_file, edge_file] = write_files();
+  const auto dir_path = test_utility::make_test_path();
+
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    auto *graph =
+        manager.construct<graph_type>("graph")(manager.get_allocator());
+    jg::bulk_loader<graph_type> loader(graph);
+    loader.load_vertices({vertex_file});
+    loader.load_edges({edge_file});
+  }
+
+  {
+    metall::manager manager(metall::open_only, dir_path);
+    auto *graph = manager.find<graph_type>("graph").first;
+    ASSERT_NE(graph, nullptr);
+    check(*graph, false);
+  }
+}
+}  // namespace
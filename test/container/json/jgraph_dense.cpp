@@ -0,0 +1,203 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <set>
+
+#include <metall/metall.hpp>
+#include <metall/container/experimental/jgraph/dense_jgraph.hpp>
+#include "../../test_utility.hpp"
+
+namespace {
+
+namespace jg = metall::container::experimental::jgraph;
+using graph_type = jg::dense_jgraph<>;
+
+TEST(DenseJGraphTest, ToIndex) {
+  ASSERT_EQ(graph_type::to_index("0"), 0);
+  ASSERT_EQ(graph_type::to_index("123"), 123);
+  ASSERT_EQ(graph_type::to_index(""), graph_type::k_invalid_index);
+  ASSERT_EQ(graph_type::to_index("-1"), graph_type::k_invalid_index);
+  ASSERT_EQ(graph_type::to_index("1a"), graph_type::k_invalid_index);
+  ASSERT_EQ(graph_type::to_index("a"), graph_type::k_invalid_index);
+  // Non-canonical decimals
+  ASSERT_EQ(graph_type::to_index("007"), graph_type::k_invalid_index);
+  ASSERT_EQ(graph_type::to_index("00"), graph_type::k_invalid_index);
+  ASSERT_EQ(graph_type::to_index("+7"), graph_type::k_invalid_index);
+  ASSERT_EQ(graph_type::to_index("7"), 7);
+}
+
+TEST(DenseJGraphTest, Vertex) {
+  graph_type graph;
+  ASSERT_FALSE(graph.has_vertex("0"));
+  ASSERT_EQ(graph.register_vertex("x"), graph.vertices_end());
+
+  graph.register_vertex("2")->value() = "v2";
+  ASSERT_EQ(graph.num_vertices(), 3);
+  ASSERT_TRUE(graph.has_vertex("0"));
+  ASSERT_TRUE(graph.has_vertex(1));
+  ASSERT_TRUE(graph.has_vertex("2"));
+  ASSERT_FALSE(graph.has_vertex("3"));
+
+  ASSERT_EQ(graph.find_vertex("1")->id(), "1");
+  ASSERT_TRUE(graph.find_vertex("1")->value().is_null());
+  ASSERT_EQ(graph.find_vertex(2)->value().as_string(), "v2");
+  ASSERT_EQ(graph.find_vertex("3"), graph.vertices_end());
+
+  // Registering an existing vertex does not change its value
+  graph.register_vertex("2");
+  ASSERT_EQ(graph.find_vertex("2")->value().as_string(), "v2");
+
+  std::size_t count = 0;
+  for (auto itr = graph.vertices_begin(); itr != graph.vertices_end(); ++itr) {
+    ASSERT_EQ(itr->id(), std::to_string(count));
+    ++count;
+  }
+  ASSERT_EQ(count, 3);
+}
+
+TEST(DenseJGraphTest, Edge) {
+  graph_type graph;
+  graph.register_edge("0", "1")->value() = "e0";
+  graph.register_edge("0", "2", true)->value() = "e1";
+  graph.register_edge(0, 1)->value() = "e2";
+  ASSERT_EQ(graph.register_edge("0", "x"), graph_type::edge_iterator());
+
+  ASSERT_EQ(graph.num_vertices(), 3);
+  ASSERT_EQ(graph.num_edges(), 3);
+  ASSERT_EQ(graph.degree("0"), 3);
+  ASSERT_EQ(graph.degree("1"), 0);
+  ASSERT_EQ(graph.degree(2), 1);
+  ASSERT_EQ(graph.has_edges("0", "1"), 2);
+  ASSERT_EQ(graph.has_edges("2", "0"), 1);
+  ASSERT_EQ(graph.has_edges("1", "0"), 0);
+
+  std::set<std::string> values;
+  auto range = graph.find_edges("0", "1");
+  for (auto itr = range.first; itr != range.second; ++itr) {
+    ASSERT_EQ(itr->source_index(), 0);
+    ASSERT_EQ(itr->destination_index(), 1);
+    ASSERT_EQ(itr.neighbor_index(), 1);
+    values.insert(itr->value().as_string().c_str());
+  }
+  ASSERT_EQ(values, std::set<std::string>({"e0", "e2"}));
+
+  // The undirected edge is shared
+  auto itr = graph.edges_begin("2");
+  ASSERT_EQ(itr.neighbor_index(), 0);
+  ASSERT_EQ(itr->value().as_string(), "e1");
+  itr->value() = "e1-updated";
+  ASSERT_EQ(graph.find_edges("0", "2").first->value().as_string(),
+            "e1-updated");
+  ++itr;
+  ASSERT_EQ(itr, graph.edges_end("2"));
+}
+
+TEST(DenseJGraphTest, Compact) {
+  using sparse_graph_type = jg::jgraph<>;
+  sparse_graph_type sparse;
+  sparse.register_vertex("3")->value() = "v3";
+  sparse.register_vertex("1")->value() = "v1";
+  sparse.register_edge("1", "3")->value() = "e0";
+  sparse.register_edge("3", "0", true)->value() = "e1";
+  sparse.register_edge("3", "3", true)->value() = "e2";
+
+  graph_type dense;
+  ASSERT_TRUE(dense.compact(sparse));
+  ASSERT_EQ(dense.num_vertices(), 4);
+  ASSERT_EQ(dense.num_edges(), sparse.num_edges());
+  ASSERT_EQ(dense.find_vertex("3")->value().as_string(), "v3");
+  ASSERT_EQ(dense.find_vertex("1")->value().as_string(), "v1");
+  ASSERT_TRUE(dense.find_vertex("2")->value().is_null());
+
+  for (const auto *vid : {"0", "1", "2", "3"}) {
+    ASSERT_EQ(dense.degree(vid), sparse.degree(vid));
+  }
+  ASSERT_EQ(dense.has_edges("1", "3"), 1);
+  ASSERT_EQ(dense.has_edges("3", "1"), 0);
+  ASSERT_EQ(dense.has_edges("0", "3"), 1);
+  ASSERT_EQ(dense.has_edges("3", "0"), 1);
+  ASSERT_EQ(dense.has_edges("3", "3"), 2);
+
+  // The undirected edge is stored once
+  dense.find_edges("0", "3").first->value() = "e1-updated";
+  ASSERT_EQ(dense.find_edges("3", "0").first->value().as_string(),
+            "e1-updated");
+
+  sparse.register_vertex("a");
+  ASSERT_FALSE(dense.compact(sparse));
+  ASSERT_EQ(dense.num_vertices(), 0);
+  ASSERT_EQ(dense.num_edges(), 0);
+}
+
+TEST(DenseJGraphTest, CompactNonCanonicalIDs) {
+  // "7" and "007" are distinct vertices in jgraph; they must not be merged
+  jg::jgraph<> sparse;
+  sparse.register_vertex("7")->value() = "v7";
+  sparse.register_vertex("007")->value() = "v007";
+  sparse.register_edge("7", "007")->value() = "e0";
+
+  graph_type dense;
+  ASSERT_FALSE(dense.compact(sparse));
+  ASSERT_EQ(dense.num_vertices(), 0);
+  ASSERT_EQ(dense.num_edges(), 0);
+  ASSERT_FALSE(dense.has_vertex("007"));
+}
+
+TEST(DenseJGraphTest, MaxVertexIndex) {
+  {
+    graph_type graph;
+    ASSERT_EQ(graph.max_vertex_index(), graph_type::k_default_max_vertex_index);
+    ASSERT_TRUE(graph.register_vertex("4000000000") == graph.vertices_end());
+    ASSERT_TRUE(graph.register_edge("0", "4000000000") ==
+                graph_type::edge_iterator());
+    ASSERT_EQ(graph.num_vertices(), 0);
+    ASSERT_EQ(graph.num_edges(), 0);
+  }
+
+  {
+    graph_type graph(9);
+    ASSERT_EQ(graph.max_vertex_index(), 9);
+    ASSERT_EQ(graph.register_vertex("9")->id(), "9");
+    ASSERT_TRUE(graph.register_vertex("10") == graph.vertices_end());
+    ASSERT_EQ(graph.num_vertices(), 10);
+
+    jg::jgraph<> sparse;
+    sparse.register_vertex("10");
+    ASSERT_FALSE(graph.compact(sparse));
+    ASSERT_EQ(graph.num_vertices(), 0);
+  }
+}
+
+TEST(DenseJGraphTest, Persistence) {
+  using persistent_graph_type =
+      jg::dense_jgraph<metall::manager::allocator_type<std::byte>>;
+  const auto dir_path = test_utility::make_test_path();
+
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    auto *graph = manager.construct<persistent_graph_type>("graph")(
+        manager.get_allocator());
+    for (int i = 0; i < 100; ++i) {
+      graph->register_edge(i, (i + 1) % 100)->value() = i;
+    }
+  }
+
+  {
+    metall::manager manager(metall::open_read_only, dir_path);
+    const auto *graph = manager.find<persistent_graph_type>("graph").first;
+    ASSERT_NE(graph, nullptr);
+    ASSERT_EQ(graph->num_vertices(), 100);
+    ASSERT_EQ(graph->num_edges(), 100);
+    for (int i = 0; i < 100; ++i) {
+      auto itr = graph->edges_begin(i);
+      ASSERT_EQ(itr.neighbor_index(), (i + 1) % 100);
+      ASSERT_EQ(itr->value().as_int64(), i);
+    }
+  }
+}
+}  // namespace
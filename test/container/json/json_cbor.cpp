@@ -0,0 +1,208 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <metall/json/json.hpp>
+
+namespace mj = metall::json;
+
+namespace {
+
+using value_type = mj::value<std::allocator<std::byte>>;
+using bytes = std::vector<std::uint8_t>;
+
+template <typename T>
+bytes encode(const T &data) {
+  value_type jv;
+  jv = data;
+  return mj::to_cbor(jv);
+}
+
+// The encoded values are taken from RFC 8949 Appendix A.
+TEST(JSONCBORTest, EncodeScalar) {
+  GTEST_ASSERT_EQ(mj::to_cbor(value_type{}), bytes({0xf6}));
+  GTEST_ASSERT_EQ(encode(false), bytes({0xf4}));
+  GTEST_ASSERT_EQ(encode(true), bytes({0xf5}));
+  GTEST_ASSERT_EQ(encode(0), bytes({0x00}));
+  GTEST_ASSERT_EQ(encode(23), bytes({0x17}));
+  GTEST_ASSERT_EQ(encode(24), bytes({0x18, 0x18}));
+  GTEST_ASSERT_EQ(encode(1000), bytes({0x19, 0x03, 0xe8}));
+  GTEST_ASSERT_EQ(encode(1000000), bytes({0x1a, 0x00, 0x0f, 0x42, 0x40}));
+  GTEST_ASSERT_EQ(encode(std::numeric_limits<std::uint64_t>::max()),
+                  bytes({0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}));
+  GTEST_ASSERT_EQ(encode(-1), bytes({0x20}));
+  GTEST_ASSERT_EQ(encode(-1000), bytes({0x39, 0x03, 0xe7}));
+  GTEST_ASSERT_EQ(encode(1.1), bytes({0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99,
+                                      0x99, 0x9a}));
+  GTEST_ASSERT_EQ(encode(""), bytes({0x60}));
+  GTEST_ASSERT_EQ(encode("IETF"), bytes({0x64, 0x49, 0x45, 0x54, 0x46}));
+}
+
+TEST(JSONCBORTest, EncodeContainer) {
+  value_type jv;
+  auto &arr = jv.emplace_array();
+  arr.resize(3);
+  arr[0] = 1;
+  arr[1].emplace_array().resize(1);
+  arr[1].as_array()[0] = 2;
+  arr[2].emplace_object()["a"] = 3;
+  GTEST_ASSERT_EQ(mj::to_cbor(jv),
+                  bytes({0x83, 0x01, 0x81, 0x02, 0xa1, 0x61, 0x61, 0x03}));
+}
+
+value_type make_records(const std::size_t num_records) {
+  value_type jv;
+  auto &arr = jv.emplace_array();
+  arr.resize(num_records);
+  for (std::size_t i = 0; i < num_records; ++i) {
+    auto &obj = arr[i].emplace_object();
+    obj["identifier"] = i;
+    obj["name"] = "name-" + std::to_string(i % 10);
+    obj["score"] = -1.5 * i;
+    obj["valid"] = (i % 2 == 0);
+    obj["note"] = nullptr;
+    obj["offset"] = -static_cast<std::int64_t>(i) * 100000;
+    obj["tags"].emplace_array().resize(2);
+    obj["tags"].as_array()[0] = "t";
+    obj["tags"].as_array()[1] = "tag-long-enough";
+  }
+  return jv;
+}
+
+TEST(JSONCBORTest, RoundTrip) {
+  const auto jv = make_records(100);
+  for (const bool use_refs : {false, true}) {
+    const auto encoded = mj::to_cbor(jv, use_refs);
+    GTEST_ASSERT_TRUE(mj::cbor_view(encoded).good());
+    GTEST_ASSERT_EQ(mj::from_cbor(encoded), jv);
+  }
+}
+
+TEST(JSONCBORTest, StringReferences) {
+  const auto jv = make_records(100);
+  const auto plain = mj::to_cbor(jv, false);
+  const auto with_refs = mj::to_cbor(jv, true);
+  GTEST_ASSERT_LT(with_refs.size(), plain.size() * 2 / 3);
+
+  // Tag 256, ["abc", "abc"] -> [ "abc", 25(0) ]
+  value_type arr;
+  arr.emplace_array().resize(2);
+  arr.as_array()[0] = "abc";
+  arr.as_array()[1] = "abc";
+  GTEST_ASSERT_EQ(mj::to_cbor(arr, true),
+                  bytes({0xd9, 0x01, 0x00, 0x82, 0x63, 0x61, 0x62, 0x63, 0xd8,
+                         0x19, 0x00}));
+}
+
+TEST(JSONCBORTest, View) {
+  const auto jv = make_records(10);
+  const auto encoded = mj::to_cbor(jv, true);
+  const mj::cbor_view view(encoded);
+  GTEST_ASSERT_TRUE(view.good());
+
+  const auto root = view.root();
+  GTEST_ASSERT_TRUE(root.is_array());
+  GTEST_ASSERT_EQ(root.size(), 10);
+
+  const auto rec = root.at(7);
+  GTEST_ASSERT_TRUE(rec.is_object());
+  GTEST_ASSERT_EQ(rec.size(), 7);
+  GTEST_ASSERT_EQ(rec.find("identifier")->as_int64(), 7);
+  GTEST_ASSERT_EQ(rec.find("name")->as_string(), "name-7");
+  GTEST_ASSERT_EQ(rec.find("score")->as_double(), -10.5);
+  GTEST_ASSERT_FALSE(rec.find("valid")->as_bool());
+  GTEST_ASSERT_TRUE(rec.find("note")->is_null());
+  GTEST_ASSERT_EQ(rec.find("offset")->as_int64(), -700000);
+  GTEST_ASSERT_EQ(rec.find("tags")->at(1).as_string(), "tag-long-enough");
+  GTEST_ASSERT_FALSE(rec.find("none").has_value());
+
+  // Strings are views of the encoded data
+  const auto name = rec.find("name")->as_string();
+  GTEST_ASSERT_TRUE(reinterpret_cast<const std::uint8_t *>(name.data()) >=
+                        encoded.data() &&
+                    reinterpret_cast<const std::uint8_t *>(name.data()) <
+                        encoded.data() + encoded.size());
+
+  std::size_t count = 0;
+  root.for_each_element([&count](const mj::cbor_view::item &item) {
+    item.for_each_member([](std::string_view key, const auto &) {
+      GTEST_ASSERT_FALSE(key.empty());
+    });
+    ++count;
+  });
+  GTEST_ASSERT_EQ(count, 10);
+}
+
+double decode_double(const bytes &data) {
+  const mj::cbor_view view(data);
+  EXPECT_TRUE(view.good());
+  EXPECT_TRUE(view.root().is_double());
+  return view.root().as_double();
+}
+
+// Half and single precision floats are written by other encoders.
+// The encoded values are taken from RFC 8949 Appendix A.
+TEST(JSONCBORTest, DecodeFloat) {
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x00, 0x00})), 0.0);
+  GTEST_ASSERT_TRUE(std::signbit(decode_double(bytes({0xf9, 0x80, 0x00}))));
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x3c, 0x00})), 1.0);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x3e, 0x00})), 1.5);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x7b, 0xff})), 65504.0);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x00, 0x01})),
+                  5.960464477539063e-8);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x04, 0x00})), 6.103515625e-5);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0xc4, 0x00})), -4.0);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0x7c, 0x00})),
+                  std::numeric_limits<double>::infinity());
+  GTEST_ASSERT_EQ(decode_double(bytes({0xf9, 0xfc, 0x00})),
+                  -std::numeric_limits<double>::infinity());
+  GTEST_ASSERT_TRUE(std::isnan(decode_double(bytes({0xf9, 0x7e, 0x00}))));
+
+  GTEST_ASSERT_EQ(decode_double(bytes({0xfa, 0x47, 0xc3, 0x50, 0x00})),
+                  100000.0);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xfa, 0x7f, 0x7f, 0xff, 0xff})),
+                  3.4028234663852886e+38);
+  GTEST_ASSERT_EQ(decode_double(bytes({0xfa, 0x7f, 0x80, 0x00, 0x00})),
+                  std::numeric_limits<double>::infinity());
+
+  // [1.5, 100000.0]
+  const auto jv = mj::from_cbor(
+      bytes({0x82, 0xf9, 0x3e, 0x00, 0xfa, 0x47, 0xc3, 0x50, 0x00}));
+  GTEST_ASSERT_TRUE(jv.is_array());
+  GTEST_ASSERT_EQ(jv.as_array()[0].as_double(), 1.5);
+  GTEST_ASSERT_EQ(jv.as_array()[1].as_double(), 100000.0);
+
+  // Truncated
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0xf9, 0x3c})).good());
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0xfa, 0x47, 0xc3, 0x50})).good());
+}
+
+TEST(JSONCBORTest, Invalid) {
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes{}).good());
+  // Truncated
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0x19, 0x03})).good());
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0x64, 0x49, 0x45})).good());
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0x82, 0x01})).good());
+  // Trailing data
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0x01, 0x01})).good());
+  // Byte string
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0x41, 0x00})).good());
+  // Indefinite-length array
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0x9f, 0xff})).good());
+  // Non-string key
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0xa1, 0x01, 0x01})).good());
+  // String reference without a namespace or to an unknown string
+  GTEST_ASSERT_FALSE(mj::cbor_view(bytes({0xd8, 0x19, 0x00})).good());
+  GTEST_ASSERT_FALSE(
+      mj::cbor_view(bytes({0xd9, 0x01, 0x00, 0xd8, 0x19, 0x00})).good());
+
+  GTEST_ASSERT_TRUE(mj::from_cbor(bytes({0x82, 0x01})).is_null());
+}
+}  // namespace
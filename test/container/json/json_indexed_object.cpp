@@ -0,0 +1,159 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <metall/json/json.hpp>
+#include <metall/json/details/indexed_object.hpp>
+#include <metall/json/details/flat_indexed_object.hpp>
+#include <metall/json/details/adaptive_object.hpp>
+
+namespace mj = metall::json;
+
+namespace {
+
+template <typename T>
+class JSONIndexedObjectTest : public ::testing::Test {};
+
+using object_types = ::testing::Types<
+    mj::jsndtl::indexed_object<std::allocator<std::byte>>,
+    mj::jsndtl::flat_indexed_object<std::allocator<std::byte>>,
+    mj::jsndtl::adaptive_object<std::allocator<std::byte>>>;
+TYPED_TEST_SUITE(JSONIndexedObjectTest, object_types);
+
+TYPED_TEST(JSONIndexedObjectTest, Brackets) {
+  TypeParam obj;
+
+  obj["0"].emplace_bool() = true;
+  obj["0123456789"].emplace_uint64() = 10;
+  GTEST_ASSERT_TRUE(obj["0"].as_bool());
+  GTEST_ASSERT_EQ(obj["0123456789"].as_uint64(), 10);
+
+  // Override
+  obj["0123456789"].emplace_double() = 20.5;
+  GTEST_ASSERT_EQ(obj["0123456789"].as_double(), 20.5);
+  GTEST_ASSERT_EQ(obj.size(), 2);
+
+  const auto cnt_obj(obj);
+  GTEST_ASSERT_TRUE(cnt_obj["0"].as_bool());
+  GTEST_ASSERT_EQ(cnt_obj["0123456789"].as_double(), 20.5);
+}
+
+TYPED_TEST(JSONIndexedObjectTest, ManyKeys) {
+  TypeParam obj;
+  const std::size_t num_keys = 5000;
+  for (std::size_t i = 0; i < num_keys; ++i) {
+    obj["key-" + std::to_string(i)] = i;
+  }
+  GTEST_ASSERT_EQ(obj.size(), num_keys);
+
+  for (std::size_t i = 0; i < num_keys; ++i) {
+    const auto key = "key-" + std::to_string(i);
+    GTEST_ASSERT_TRUE(obj.contains(key));
+    GTEST_ASSERT_EQ(obj.at(key).as_uint64(), i);
+    GTEST_ASSERT_EQ(obj.find(key)->key(), key);
+  }
+  GTEST_ASSERT_FALSE(obj.contains("key-" + std::to_string(num_keys)));
+  GTEST_ASSERT_EQ(obj.find("none"), obj.end());
+}
+
+TYPED_TEST(JSONIndexedObjectTest, Erase) {
+  TypeParam obj;
+
+  obj["0"].emplace_bool() = true;
+  obj["0123456789"].emplace_uint64() = 10;
+  obj["2"].emplace_double() = 20.5;
+
+  obj.erase("0");
+  GTEST_ASSERT_FALSE(obj.contains("0"));
+  GTEST_ASSERT_EQ(obj.size(), 2);
+  GTEST_ASSERT_EQ(obj.at("0123456789").as_uint64(), 10);
+  GTEST_ASSERT_EQ(obj.at("2").as_double(), 20.5);
+
+  auto itr = obj.find("0123456789");
+  GTEST_ASSERT_EQ(obj.erase(itr)->key(), "2");
+  GTEST_ASSERT_FALSE(obj.contains("0123456789"));
+  GTEST_ASSERT_EQ(obj.size(), 1);
+
+  const auto &const_ref = obj;
+  auto const_itr = const_ref.find("2");
+  auto next_pos = obj.erase(const_itr);
+  GTEST_ASSERT_EQ(next_pos, obj.end());
+  GTEST_ASSERT_FALSE(obj.contains("2"));
+  GTEST_ASSERT_EQ(obj.size(), 0);
+
+  // Reuse after all elements were erased
+  obj["3"] = 3;
+  GTEST_ASSERT_EQ(obj.at("3").as_int64(), 3);
+}
+
+TYPED_TEST(JSONIndexedObjectTest, EraseMany) {
+  TypeParam obj;
+  const std::size_t num_keys = 1000;
+  for (std::size_t i = 0; i < num_keys; ++i) {
+    obj[std::to_string(i)] = i;
+  }
+  for (std::size_t i = 0; i < num_keys; i += 2) {
+    obj.erase(std::to_string(i));
+  }
+  GTEST_ASSERT_EQ(obj.size(), num_keys / 2);
+  for (std::size_t i = 0; i < num_keys; ++i) {
+    GTEST_ASSERT_EQ(obj.contains(std::to_string(i)), i % 2 == 1);
+    if (i % 2 == 1) {
+      GTEST_ASSERT_EQ(obj.at(std::to_string(i)).as_uint64(), i);
+    }
+  }
+}
+
+TYPED_TEST(JSONIndexedObjectTest, CopyAndEqual) {
+  TypeParam obj;
+  obj["0"].emplace_bool() = true;
+  obj["0123456789"].emplace_uint64() = 10;
+
+  TypeParam obj_cpy(obj, std::allocator<std::byte>{});
+  GTEST_ASSERT_TRUE(obj == obj_cpy);
+  GTEST_ASSERT_FALSE(obj != obj_cpy);
+
+  obj["0"].as_bool() = false;
+  GTEST_ASSERT_FALSE(obj == obj_cpy);
+  GTEST_ASSERT_TRUE(obj != obj_cpy);
+
+  TypeParam obj_mv(std::move(obj_cpy));
+  GTEST_ASSERT_TRUE(obj_mv.at("0").as_bool());
+  GTEST_ASSERT_EQ(obj_mv.at("0123456789").as_uint64(), 10);
+}
+
+TEST(JSONAdaptiveObjectTest, Threshold) {
+  using object_type = mj::jsndtl::adaptive_object<std::allocator<std::byte>>;
+  constexpr std::size_t threshold = object_type::k_index_threshold;
+
+  object_type obj;
+  for (std::size_t i = 0; i < threshold; ++i) {
+    obj[std::to_string(i)] = i;
+  }
+  GTEST_ASSERT_FALSE(obj.indexed());
+  GTEST_ASSERT_EQ(obj.index_capacity(), 0);
+
+  obj[std::to_string(threshold)] = threshold;
+  GTEST_ASSERT_TRUE(obj.indexed());
+  GTEST_ASSERT_GT(obj.index_capacity(), obj.size());
+  for (std::size_t i = 0; i <= threshold; ++i) {
+    GTEST_ASSERT_EQ(obj.at(std::to_string(i)).as_uint64(), i);
+  }
+
+  // Stays indexed until the size falls to half of the threshold
+  for (std::size_t i = threshold; i > threshold / 2; --i) {
+    obj.erase(std::to_string(i));
+    GTEST_ASSERT_TRUE(obj.indexed());
+  }
+  obj.erase(std::to_string(threshold / 2));
+  GTEST_ASSERT_FALSE(obj.indexed());
+  GTEST_ASSERT_EQ(obj.size(), threshold / 2);
+  for (std::size_t i = 0; i < threshold / 2; ++i) {
+    GTEST_ASSERT_EQ(obj.at(std::to_string(i)).as_uint64(), i);
+  }
+}
+}  // namespace
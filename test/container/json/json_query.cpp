@@ -0,0 +1,132 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+#include <memory>
+#include <metall/json/json.hpp>
+
+namespace mj = metall::json;
+
+namespace {
+
+using value_type = mj::value<std::allocator<std::byte>>;
+
+// {"store": {"book": [{"title": "A", "price": 10},
+//                     {"title": "B", "price": 20},
+//                     {"title": "C"}],
+//            "a/b": 1, "m~n": 2}}
+value_type make_store() {
+  value_type jv;
+  auto &store = jv.emplace_object()["store"].emplace_object();
+  auto &books = store["book"].emplace_array();
+  books.resize(3);
+  books[0].emplace_object()["title"] = "A";
+  books[0].as_object()["price"] = 10;
+  books[1].emplace_object()["title"] = "B";
+  books[1].as_object()["price"] = 20;
+  books[2].emplace_object()["title"] = "C";
+  store["a/b"] = 1;
+  store["m~n"] = 2;
+  return jv;
+}
+
+TEST(JSONQueryTest, Path) {
+  GTEST_ASSERT_TRUE(mj::path("").good());
+  GTEST_ASSERT_TRUE(mj::path("$").good());
+  GTEST_ASSERT_EQ(mj::path("/a/0/b").steps().size(), 3);
+  GTEST_ASSERT_EQ(mj::path("$.a[0]['b c']").steps().size(), 3);
+  GTEST_ASSERT_TRUE(mj::path("$.a[*].b").has_wildcard());
+  GTEST_ASSERT_FALSE(mj::path("/a/b").has_wildcard());
+
+  GTEST_ASSERT_FALSE(mj::path("a").good());
+  GTEST_ASSERT_FALSE(mj::path("/a~2").good());
+  GTEST_ASSERT_FALSE(mj::path("$.a[01]").good());
+  GTEST_ASSERT_FALSE(mj::path("$.a[0").good());
+  GTEST_ASSERT_FALSE(mj::path("$..a").good());
+}
+
+TEST(JSONQueryTest, FindPointer) {
+  const auto jv = make_store();
+
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, ""), &jv);
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "$"), &jv);
+
+  const auto *title = mj::find_pointer(jv, "/store/book/1/title");
+  GTEST_ASSERT_NE(title, nullptr);
+  GTEST_ASSERT_EQ(title,
+                  &jv.as_object().at("store").as_object().at("book").as_array()
+                       [1].as_object().at("title"));
+  GTEST_ASSERT_EQ(title, mj::find_pointer(jv, "$.store.book[1].title"));
+  GTEST_ASSERT_EQ(title, mj::find_pointer(jv, "$['store'][\"book\"][1].title"));
+
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "/store/a~1b")->as_int64(), 1);
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "/store/m~0n")->as_int64(), 2);
+
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "/store/book/3"), nullptr);
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "/store/book/x"), nullptr);
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "/store/none"), nullptr);
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "/store/a~1b/c"), nullptr);
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "invalid"), nullptr);
+}
+
+TEST(JSONQueryTest, FindPointerMutable) {
+  auto jv = make_store();
+  auto *price = mj::find_pointer(jv, "/store/book/0/price");
+  GTEST_ASSERT_NE(price, nullptr);
+  *price = 15;
+  GTEST_ASSERT_EQ(mj::find_pointer(jv, "$.store.book[0].price")->as_int64(),
+                  15);
+}
+
+TEST(JSONQueryTest, Query) {
+  const auto jv = make_store();
+
+  const auto titles = mj::query(jv, mj::path("$.store.book[*].title"));
+  GTEST_ASSERT_EQ(titles.size(), 3);
+  GTEST_ASSERT_EQ(titles[0]->as_string(), "A");
+  GTEST_ASSERT_EQ(titles[1]->as_string(), "B");
+  GTEST_ASSERT_EQ(titles[2]->as_string(), "C");
+
+  const auto prices = mj::query(jv, mj::path("$.store.book[*].price"));
+  GTEST_ASSERT_EQ(prices.size(), 2);
+
+  GTEST_ASSERT_EQ(mj::query(jv, mj::path("$.store.*")).size(), 3);
+  GTEST_ASSERT_TRUE(mj::query(jv, mj::path("$.none[*]")).empty());
+}
+
+TEST(JSONQueryTest, Project) {
+  const auto jv = make_store();
+  const auto &books = *mj::find_pointer(jv, "/store/book");
+
+  const auto prices = mj::project(books.as_array(), mj::path("/price"));
+  GTEST_ASSERT_EQ(prices.size(), 3);
+  GTEST_ASSERT_EQ(prices[0]->as_int64(), 10);
+  GTEST_ASSERT_EQ(prices[1]->as_int64(), 20);
+  GTEST_ASSERT_EQ(prices[2], nullptr);
+}
+
+TEST(JSONQueryTest, Select) {
+  value_type jv;
+  auto &arr = jv.emplace_array();
+  const std::size_t num_elements = 10000;
+  arr.resize(num_elements);
+  for (std::size_t i = 0; i < num_elements; ++i) {
+    arr[i].emplace_object()["id"] = i;
+  }
+
+  const auto selected =
+      mj::select(arr, mj::path("$.id"),
+                 [](const value_type &v) { return v.as_uint64() % 3 == 0; });
+  GTEST_ASSERT_EQ(selected.size(), (num_elements + 2) / 3);
+  for (std::size_t i = 0; i < selected.size(); ++i) {
+    GTEST_ASSERT_EQ(selected[i], i * 3);
+  }
+
+  GTEST_ASSERT_TRUE(
+      mj::select(arr, mj::path("$.none"), [](const value_type &) {
+        return true;
+      }).empty());
+}
+}  // namespace
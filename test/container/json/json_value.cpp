@@ -241,6 +241,39 @@ TEST(JSONValueTest, Emplace) {
   }
 }
 
+TEST(JSONValueTest, StringStorage) {
+  using value_type = mj::value<test_utility::counting_allocator<std::byte>>;
+  auto &num_allocations = test_utility::allocation_counter::num_allocations;
+
+  value_type val;
+  const std::size_t inline_capacity = val.emplace_string().capacity();
+  GTEST_ASSERT_GT(inline_capacity, 0);
+
+  // Short strings are stored inline
+  num_allocations = 0;
+  val = std::string(inline_capacity, 'a').c_str();
+  GTEST_ASSERT_EQ(val.as_string().size(), inline_capacity);
+  val = std::string_view("short");
+  GTEST_ASSERT_EQ(num_allocations, 0);
+
+  // The storage of a long string is reused by the following assignments
+  val = std::string(inline_capacity * 2, 'b').c_str();
+  GTEST_ASSERT_EQ(num_allocations, 1);
+  val = std::string_view(std::string(inline_capacity + 1, 'c'));
+  GTEST_ASSERT_EQ(val.as_string(), std::string(inline_capacity + 1, 'c'));
+  value_type other;
+  other = std::string(inline_capacity * 2, 'd').c_str();
+  num_allocations = 0;
+  val = other;
+  GTEST_ASSERT_EQ(val.as_string(), other.as_string());
+  GTEST_ASSERT_EQ(num_allocations, 0);
+
+  // Only the viewed characters are copied
+  const char chars[] = {'x', 'y', 'z', 'w'};
+  val = std::string_view(chars, 3);
+  GTEST_ASSERT_EQ(val.as_string(), "xyz");
+}
+
 std::string json_string = R"(
       {
         "pi": 3.141,
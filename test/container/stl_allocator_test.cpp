@@ -10,6 +10,9 @@
 #include <filesystem>
 
 #include <boost/container/scoped_allocator.hpp>
+#include <boost/container/vector.hpp>
+#include <boost/container/map.hpp>
+#include <boost/container/string.hpp>
 #include <boost/interprocess/containers/vector.hpp>
 #include <boost/unordered_map.hpp>
 #include <metall/metall.hpp>
@@ -168,6 +171,46 @@ TEST(StlAllocatorTest, Container) {
   }
 }
 
+TEST(StlAllocatorTest, ExpandInPlace) {
+  {
+    metall::manager manager(metall::create_only, dir_path(), 1UL << 30UL);
+    constexpr std::size_t k_chunk_size = metall::manager::chunk_size();
+
+    boost::container::vector<uint64_t, alloc_type<uint64_t>> vector(
+        manager.get_allocator<>());
+    vector.reserve(k_chunk_size / sizeof(uint64_t));
+    const auto *const data = vector.data();
+    ASSERT_EQ(vector.capacity(), k_chunk_size / sizeof(uint64_t));
+
+    // Grows without moving, as the following chunks are free
+    const std::size_t num_elements = vector.capacity() * 4;
+    for (uint64_t i = 0; i < num_elements; ++i) {
+      vector.push_back(i);
+    }
+    ASSERT_EQ(vector.data(), data);
+    for (uint64_t i = 0; i < vector.size(); ++i) {
+      ASSERT_EQ(vector[i], i);
+    }
+
+    vector.resize(k_chunk_size / sizeof(uint64_t));
+    vector.shrink_to_fit();
+    ASSERT_EQ(vector.data(), data);
+    ASSERT_EQ(vector.capacity(), k_chunk_size / sizeof(uint64_t));
+
+    // Node-based containers still work
+    boost::container::map<uint64_t, uint64_t, std::less<>,
+                          alloc_type<std::pair<const uint64_t, uint64_t>>>
+        map(manager.get_allocator<>());
+    for (uint64_t i = 0; i < 1024; ++i) map[i] = i;
+    map.clear();
+    boost::container::basic_string<char, std::char_traits<char>,
+                                   alloc_type<char>>
+        string("init", manager.get_allocator<>());
+    for (int i = 0; i < 1024; ++i) string += "abcdefgh";
+    ASSERT_EQ(string.size(), 4 + 1024 * 8);
+  }
+}
+
 TEST(StlAllocatorTest, NestedContainer) {
   using element_type = uint64_t;
   using vector_type =
@@ -5,6 +5,9 @@
 
 #include "gtest/gtest.h"
 #include <scoped_allocator>
+#include <random>
+#include <string>
+#include <unordered_map>
 #include <boost/interprocess/managed_mapped_file.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
 #include <boost/container/vector.hpp>
@@ -293,6 +296,51 @@ TEST(StringKeyStoreTest, EraseMultipleWithLocator) {
   ASSERT_EQ(itr = store.erase(itr), store.end());
 }
 
+TEST(StringKeyStoreTest, EraseRangeWithLocator) {
+  metall::container::string_key_store<std::string, std::allocator<std::byte>>
+      store(false, 111);
+  for (const auto *key : {"a", "x", "y", "a", "z"}) {
+    store.insert(key);
+  }
+  {
+    const auto range = store.equal_range("a");
+    for (auto itr = range.first; itr != range.second;) {
+      itr = store.erase(itr);
+    }
+  }
+  ASSERT_EQ(store.size(), 3);
+  ASSERT_EQ(store.count("a"), 0);
+  ASSERT_EQ(store.count("x"), 1);
+  ASSERT_EQ(store.count("y"), 1);
+  ASSERT_EQ(store.count("z"), 1);
+
+  // Erases some of the elements with the same key, with many collisions
+  for (int i = 0; i < 100; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      store.insert("k" + std::to_string(i), std::to_string(k));
+    }
+  }
+  for (int i = 0; i < 100; i += 2) {
+    const auto key = "k" + std::to_string(i);
+    const auto range = store.equal_range(key);
+    std::size_t num_visited = 0;
+    for (auto itr = range.first; itr != range.second; ++num_visited) {
+      ASSERT_EQ(store.key(itr), key);
+      if (store.value(itr) != "1") {
+        itr = store.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+    ASSERT_EQ(num_visited, 3);
+  }
+  for (int i = 0; i < 100; ++i) {
+    const auto key = "k" + std::to_string(i);
+    ASSERT_EQ(store.count(key), (i % 2 == 0) ? 1 : 3);
+  }
+  ASSERT_EQ(store.size(), 3 + 50 * 1 + 50 * 3);
+}
+
 TEST(StringKeyStoreTest, EraseSingleWithLocator) {
   metall::container::string_key_store<std::string, std::allocator<std::byte>>
       store(true, 111);
@@ -456,6 +504,68 @@ TEST(StringKeyStoreTest, Rehash) {
   ASSERT_EQ(store.value(store.find("c")), "2");
 }
 
+TEST(StringKeyStoreTest, Reserve) {
+  metall::container::string_key_store<int, std::allocator<std::byte>> store;
+  store.insert("a", 0);
+  store.reserve(1000);
+  for (int i = 1; i < 1000; ++i) {
+    store.insert(std::to_string(i), i);
+  }
+  ASSERT_EQ(store.size(), 1000);
+  ASSERT_EQ(store.value(store.find("a")), 0);
+  ASSERT_EQ(store.value(store.find("999")), 999);
+}
+
+TEST(StringKeyStoreTest, ManyKeys) {
+  for (const bool unique : {true, false}) {
+    metall::container::string_key_store<std::size_t, std::allocator<std::byte>>
+        store(unique, 111);
+    std::unordered_multimap<std::string, std::size_t> ref;
+
+    std::mt19937_64 rnd(123);
+    for (std::size_t i = 0; i < 20000; ++i) {
+      // Mix of short and long keys with duplicates
+      const auto n = rnd() % 5000;
+      const auto key = (n % 2 == 0) ? std::to_string(n)
+                                    : "long-key-" + std::to_string(n) +
+                                          "-that-is-not-stored-inline";
+      if (rnd() % 4 == 0) {
+        ASSERT_EQ(store.erase(key), ref.erase(key));
+      } else {
+        store.insert(key, i);
+        if (unique) ref.erase(key);
+        ref.emplace(key, i);
+      }
+    }
+
+    ASSERT_EQ(store.size(), ref.size());
+    for (auto loc = store.begin(); loc != store.end(); ++loc) {
+      const std::string key(store.key(loc));
+      ASSERT_EQ(store.count(key), ref.count(key));
+      std::size_t num_found = 0;
+      const auto range = store.equal_range(key);
+      for (auto itr = range.first; itr != range.second; ++itr) {
+        ASSERT_EQ(store.key(itr), key);
+        ++num_found;
+      }
+      ASSERT_EQ(num_found, ref.count(key));
+    }
+    ASSERT_EQ(store.count("none"), 0);
+  }
+}
+
+TEST(StringKeyStoreTest, KeyView) {
+  metall::container::string_key_store<int, std::allocator<std::byte>> store(
+      true, 111);
+  const std::string keys = "abcabd";
+  store.insert(std::string_view(keys.data(), 3), 1);
+  store.insert(std::string_view(keys.data() + 3, 3), 2);
+  ASSERT_EQ(store.size(), 2);
+  ASSERT_EQ(store.value(store.find("abc")), 1);
+  ASSERT_EQ(store.value(store.find("abd")), 2);
+  ASSERT_EQ(store.key(store.find("abd")), "abd");
+}
+
 TEST(StringKeyStoreTest, Persistence) {
   using value_type = boost::container::vector<
       int, bip::allocator<int, bip::managed_mapped_file::segment_manager>>;
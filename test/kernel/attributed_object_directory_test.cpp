@@ -5,6 +5,9 @@
 
 #include "gtest/gtest.h"
 #include <memory>
+#include <fstream>
+#include <filesystem>
+#include <optional>
 #include <metall/kernel/attributed_object_directory.hpp>
 #include "../test_utility.hpp"
 
@@ -210,6 +213,101 @@ TEST(AttributedObjectDirectoryTest, Deserialize) {
   }
 }
 
+TEST(AttributedObjectDirectoryTest, DeserializeJSON) {
+  test_utility::create_test_dir();
+  const auto file(test_utility::make_test_path());
+
+  // The format written by older versions
+  {
+    std::ofstream ofs(file);
+    ofs << R"({"attributed_objects": [)"
+        << R"({"name": "item1", "offset": "1", "length": "2",)"
+        << R"( "type_id": "5", "description": ""},)"
+        << R"({"name": "", "offset": "3", "length": "4",)"
+        << R"( "type_id": "6", "description": "description2"}]})";
+  }
+
+  directory_type obj;
+  ASSERT_TRUE(obj.deserialize(file));
+  ASSERT_EQ(obj.size(), 2);
+  ASSERT_EQ(obj.find("item1")->offset(), 1);
+  ASSERT_EQ(obj.find("item1")->type_id(), 5);
+  ASSERT_EQ(obj.find(ssize_t(3))->length(), 4);
+  ASSERT_EQ(obj.find(ssize_t(3))->description(), "description2");
+}
+
+TEST(AttributedObjectDirectoryTest, DeserializeTruncated) {
+  test_utility::create_test_dir();
+  const auto file(test_utility::make_test_path());
+
+  {
+    directory_type obj;
+    obj.reserve(1000);
+    for (int i = 0; i < 1000; ++i) {
+      ASSERT_TRUE(obj.insert("item" + std::to_string(i), i, 1, 5));
+    }
+    ASSERT_TRUE(obj.serialize(file));
+  }
+  {
+    directory_type obj;
+    ASSERT_TRUE(obj.deserialize(file));
+    ASSERT_EQ(obj.size(), 1000);
+    ASSERT_EQ(obj.find("item999")->offset(), 999);
+  }
+
+  std::filesystem::resize_file(file, std::filesystem::file_size(file) - 1);
+  {
+    directory_type obj;
+    ASSERT_FALSE(obj.deserialize(file));
+  }
+}
+
+TEST(AttributedObjectDirectoryTest, FindInFile) {
+  test_utility::create_test_dir();
+  const auto file(test_utility::make_test_path());
+
+  {
+    directory_type obj;
+    for (int i = 0; i < 1000; ++i) {
+      ASSERT_TRUE(obj.insert("item" + std::to_string(i), i, i + 1, 5,
+                             "desc" + std::to_string(i)));
+    }
+    ASSERT_TRUE(obj.insert("", 1000, 1, 6));  // Not in the name index
+    ASSERT_TRUE(obj.serialize(file));
+  }
+  ASSERT_TRUE(directory_type::has_name_index(file));
+  ASSERT_TRUE(directory_type::check_name_index(file));
+
+  std::optional<directory_type::entry_type> entry;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(
+        directory_type::find_in_file(file, "item" + std::to_string(i), &entry));
+    ASSERT_TRUE(entry);
+    ASSERT_EQ(entry->name(), "item" + std::to_string(i));
+    ASSERT_EQ(entry->offset(), i);
+    ASSERT_EQ(entry->length(), i + 1);
+    ASSERT_EQ(entry->type_id(), 5);
+    ASSERT_EQ(entry->description(), "desc" + std::to_string(i));
+  }
+  ASSERT_TRUE(directory_type::find_in_file(file, "item1000", &entry));
+  ASSERT_FALSE(entry);
+  ASSERT_TRUE(directory_type::find_in_file(file, "", &entry));
+  ASSERT_FALSE(entry);
+
+  // A truncated file still has the header
+  std::filesystem::resize_file(file, std::filesystem::file_size(file) - 5);
+  ASSERT_TRUE(directory_type::has_name_index(file));
+  ASSERT_FALSE(directory_type::check_name_index(file));
+
+  // Files in the JSON format do not have the name index
+  {
+    std::ofstream ofs(file);
+    ofs << R"({"attributed_objects": []})";
+  }
+  ASSERT_FALSE(directory_type::has_name_index(file));
+  ASSERT_FALSE(directory_type::find_in_file(file, "item0", &entry));
+}
+
 TEST(AttributedObjectDirectoryTest, Clear) {
   test_utility::create_test_dir();
   const auto file(test_utility::make_test_path());
@@ -5,6 +5,7 @@
 
 #include "gtest/gtest.h"
 #include <cstdint>
+#include <fstream>
 #include <memory>
 #include <metall/kernel/chunk_directory.hpp>
 #include <metall/kernel/bin_number_manager.hpp>
@@ -66,6 +67,39 @@ TEST(ChunkDirectoryTest, EraseChunk) {
   ASSERT_EQ(directory.size(), 0);
 }
 
+TEST(ChunkDirectoryTest, ExtendAndShrinkLargeChunk) {
+  chunk_directory_type directory(16);
+
+  // 1 chunk
+  const auto chno0 = directory.insert(k_num_small_bins);
+  // Extends to 2 and 4 chunks
+  ASSERT_TRUE(directory.extend_large_chunk(chno0, k_num_small_bins + 1));
+  ASSERT_EQ(directory.bin_no(chno0), k_num_small_bins + 1);
+  ASSERT_EQ(directory.size(), 2);
+  ASSERT_TRUE(directory.extend_large_chunk(chno0, k_num_small_bins + 2));
+  ASSERT_EQ(directory.size(), 4);
+
+  // The new chunk is placed after the extended chunk
+  const auto chno1 = directory.insert(k_num_small_bins);
+  ASSERT_EQ(chno1, 4);
+  ASSERT_FALSE(directory.extend_large_chunk(chno0, k_num_small_bins + 3));
+  ASSERT_EQ(directory.bin_no(chno0), k_num_small_bins + 2);
+
+  // Cannot exceed the max number of chunks
+  ASSERT_FALSE(directory.extend_large_chunk(chno1, k_num_small_bins + 4));
+
+  directory.shrink_large_chunk(chno0, k_num_small_bins);
+  ASSERT_EQ(directory.bin_no(chno0), k_num_small_bins);
+  for (chunk_no_type c = 1; c < 4; ++c) {
+    ASSERT_TRUE(directory.unused_chunk(c));
+  }
+  ASSERT_EQ(directory.insert(k_num_small_bins + 1), 1);
+
+  directory.erase(chno1);
+  directory.shrink_large_chunk(1, k_num_small_bins);
+  ASSERT_EQ(directory.size(), 2);
+}
+
 TEST(ChunkDirectoryTest, MarkSlot) {
   chunk_directory_type directory(bin_no_mngr::num_small_bins() + 1);
 
@@ -176,4 +210,80 @@ TEST(ChunkDirectoryTest, Deserialize) {
               large_chunk2_no + 2);
   }
 }
+TEST(ChunkDirectoryTest, CheckAndRepairChunk) {
+  ASSERT_TRUE(test_utility::create_test_dir());
+  const auto file(test_utility::make_test_path());
+  const auto large_bin_no = bin_no_mngr::num_small_bins() + 1;  // 2 chunks
+
+  {
+    chunk_directory_type directory(8);
+    const auto chunk0 = directory.insert(0);
+    directory.find_and_mark_slot(chunk0);
+    const auto chunk1 = directory.insert(1);  // No objects
+    const auto chunk2 = directory.insert(large_bin_no);
+    ASSERT_TRUE(directory.check_chunk(chunk0).empty());
+    ASSERT_FALSE(directory.check_chunk(chunk1).empty());
+    ASSERT_TRUE(directory.check_chunk(chunk2).empty());
+    ASSERT_TRUE(directory.check_chunk(chunk2 + 1).empty());
+
+    directory.repair_chunk(chunk1);
+    ASSERT_TRUE(directory.unused_chunk(chunk1));
+    ASSERT_TRUE(directory.check_chunk(chunk1).empty());
+    ASSERT_EQ(directory.occupied_slots(chunk0), 1);
+  }
+
+  // A wrong occupied slot count and a large chunk body without its head
+  {
+    // The largest small bin has 2 slots, which fit in a single bitset block
+    const auto small_bin_no = bin_no_mngr::num_small_bins() - 1;
+    std::ofstream ofs(file);
+    ofs << "0 " << small_bin_no << " 1 2 1\n"
+        << "2 " << large_bin_no << " 3\n";
+  }
+  {
+    chunk_directory_type directory(8);
+    ASSERT_TRUE(directory.deserialize(file));
+    ASSERT_FALSE(directory.check_chunk(0).empty());
+    ASSERT_FALSE(directory.check_chunk(2).empty());
+
+    directory.repair_chunk(0);
+    directory.repair_chunk(2);
+    ASSERT_TRUE(directory.check_chunk(0).empty());
+    ASSERT_EQ(directory.occupied_slots(0), 1);
+    ASSERT_EQ(directory.size(), 1);
+  }
+
+  // A valid large chunk followed by an extra body chunk and by body chunks
+  // of another bin without a head
+  {
+    std::ofstream ofs(file);
+    ofs << "0 " << large_bin_no << " 2\n"
+        << "1 " << large_bin_no << " 3\n"
+        << "2 " << large_bin_no << " 3\n"
+        << "4 " << large_bin_no << " 2\n"
+        << "5 " << large_bin_no << " 3\n"
+        << "6 " << large_bin_no - 1 << " 3\n"
+        << "7 " << large_bin_no - 1 << " 3\n";
+  }
+  {
+    chunk_directory_type directory(8);
+    ASSERT_TRUE(directory.deserialize(file));
+    ASSERT_FALSE(directory.check_chunk(0).empty());
+    ASSERT_FALSE(directory.check_chunk(4).empty());
+    ASSERT_FALSE(directory.check_chunk(6).empty());
+
+    directory.repair_chunk(0);
+    directory.repair_chunk(6);
+    directory.repair_chunk(4);
+    for (const auto chunk_no : {0, 4}) {
+      ASSERT_TRUE(directory.head_chunk(chunk_no));
+      ASSERT_FALSE(directory.unused_chunk(chunk_no + 1));
+      ASSERT_TRUE(directory.check_chunk(chunk_no).empty());
+    }
+    ASSERT_TRUE(directory.unused_chunk(2));
+    ASSERT_TRUE(directory.unused_chunk(6));
+    ASSERT_TRUE(directory.unused_chunk(7));
+    ASSERT_EQ(directory.size(), 6);
+  }
+}
 }  // namespace
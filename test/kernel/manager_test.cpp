@@ -5,11 +5,17 @@
 
 #include "gtest/gtest.h"
 
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <unordered_set>
+#include <vector>
 
 #include <metall/metall.hpp>
 #include <metall/kernel/object_size_manager.hpp>
+#include <metall/kernel/bin_number_manager.hpp>
 #include "../test_utility.hpp"
 
 namespace {
@@ -280,6 +286,86 @@ TEST(ManagerTest, FindOrConstructWithIterator) {
   }
 }
 
+TEST(ManagerTest, ConstructMany) {
+  std::vector<std::string> names;
+  for (int i = 0; i < 1000; ++i) names.push_back("obj" + std::to_string(i));
+
+  {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path(), 1UL << 30UL);
+    ASSERT_NE(manager.construct<int>("obj10")(-1), nullptr);
+
+    auto ptrs = manager.construct_many<int>(names, 5);
+    ASSERT_EQ(ptrs.size(), names.size());
+    for (std::size_t i = 0; i < ptrs.size(); ++i) {
+      if (i == 10) {
+        ASSERT_EQ(ptrs[i], nullptr);  // Already used
+        continue;
+      }
+      ASSERT_NE(ptrs[i], nullptr);
+      ASSERT_EQ(*ptrs[i], 5);
+      *ptrs[i] = int(i);
+    }
+    ASSERT_EQ(manager.get_num_named_objects(), names.size());
+
+    // Empty names are invalid
+    ASSERT_EQ(manager.construct_many<int>({""}, 0)[0], nullptr);
+  }
+
+  {
+    manager_type manager(metall::open_only, dir_path());
+    names.push_back("obj1000");
+    names.push_back("obj1000");
+    const auto ptrs = manager.find_or_construct_many<int>(names, 7);
+    ASSERT_EQ(ptrs.size(), names.size());
+    ASSERT_EQ(*ptrs[10], -1);
+    ASSERT_EQ(*ptrs[999], 999);
+    ASSERT_EQ(*ptrs[1000], 7);
+    ASSERT_EQ(ptrs[1000], ptrs[1001]);
+  }
+
+  {
+    manager_type manager(metall::open_read_only, dir_path());
+    ASSERT_EQ(manager.construct_many<int>({"obj1001"}, 0)[0], nullptr);
+
+    names.push_back("none");
+    const auto found = manager.find_many<int>(names);
+    ASSERT_EQ(found.size(), names.size());
+    for (std::size_t i = 0; i + 1 < found.size(); ++i) {
+      ASSERT_EQ(found[i], manager.find<int>(names[i].c_str()));
+      ASSERT_NE(found[i].first, nullptr);
+      ASSERT_EQ(found[i].second, 1);
+    }
+    ASSERT_EQ(found.back().first, nullptr);
+    ASSERT_EQ(found.back().second, 0);
+  }
+}
+
+TEST(ManagerTest, ConstructManyException) {
+  struct object {
+    object(int *count, const int limit) {
+      if (++*count > limit) throw std::runtime_error("");
+    }
+  };
+
+  manager_type::remove(dir_path());
+  {
+    manager_type manager(metall::create_only, dir_path(), 1UL << 30UL);
+    int count = 0;
+    ASSERT_THROW(manager.construct_many<object>({"obj0", "obj1", "obj2"},
+                                                &count, 1),
+                 std::exception);
+    // The object constructed before the exception is kept
+    ASSERT_NE(manager.find<object>("obj0").first, nullptr);
+    ASSERT_EQ(manager.find<object>("obj1").first, nullptr);
+    ASSERT_EQ(manager.find<object>("obj2").first, nullptr);
+    ASSERT_EQ(manager.get_num_named_objects(), 1);
+
+    ASSERT_TRUE(manager.destroy<object>("obj0"));
+    ASSERT_TRUE(manager.all_memory_deallocated());
+  }
+}
+
 TEST(ManagerTest, Destroy) {
   {
     manager_type::remove(dir_path());
@@ -922,6 +1008,114 @@ TEST(ManagerTest, AnonymoustObjectIterator) {
   }
 }
 
+TEST(ManagerTest, LazyObjectDirectory) {
+  {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path(), 1UL << 30UL);
+    for (int i = 0; i < 100; ++i) {
+      manager.construct<int>(("named" + std::to_string(i)).c_str())(i);
+    }
+    manager.construct<double>(metall::unique_instance)(1.5);
+    for (int i = 0; i < 100; ++i) {
+      manager.construct<int>(metall::anonymous_instance)(i);
+    }
+  }
+
+  // Finds objects without reading the whole directories
+  {
+    manager_type manager(metall::open_read_only, dir_path());
+    ASSERT_EQ(*manager.find<int>("named10").first, 10);
+    ASSERT_EQ(manager.find<int>("named10").second, 1);
+    ASSERT_EQ(manager.find<int>("named100").first, nullptr);
+    ASSERT_EQ(*manager.find<double>(metall::unique_instance).first, 1.5);
+    ASSERT_EQ(manager.find<int>(metall::unique_instance).first, nullptr);
+
+    // Read on first use
+    ASSERT_EQ(manager.get_num_anonymous_objects(), 100);
+    ASSERT_EQ(manager.get_num_named_objects(), 100);
+  }
+
+  // Modifies only the named object directory
+  {
+    manager_type manager(metall::open_only, dir_path());
+    ASSERT_TRUE(manager.destroy<int>("named0"));
+    ASSERT_EQ(*manager.find<int>("named1").first, 1);
+    ASSERT_EQ(manager.find<int>("named0").first, nullptr);
+  }
+
+  // The directories that were not read are kept
+  {
+    manager_type manager(metall::open_only, dir_path());
+    ASSERT_EQ(manager.find<int>("named0").first, nullptr);
+    ASSERT_EQ(manager.get_num_named_objects(), 99);
+    ASSERT_EQ(manager.get_num_unique_objects(), 1);
+    ASSERT_EQ(manager.get_num_anonymous_objects(), 100);
+    std::vector<const int *> ptrs;
+    for (auto itr = manager.anonymous_begin(); itr != manager.anonymous_end();
+         ++itr) {
+      ptrs.push_back(reinterpret_cast<const int *>(
+          static_cast<const char *>(manager.get_address()) + itr->offset()));
+    }
+    for (const auto *ptr : ptrs) {
+      ASSERT_TRUE(manager.destroy_ptr(ptr));
+    }
+  }
+
+  {
+    manager_type manager(metall::open_read_only, dir_path());
+    ASSERT_EQ(manager.get_num_anonymous_objects(), 0);
+    ASSERT_EQ(manager.get_num_named_objects(), 99);
+  }
+}
+
+TEST(ManagerTest, LazyObjectDirectoryBroken) {
+  const auto named_directory_path = metall::kernel::storage::get_path(
+      dir_path(), {"management", "named_object_directory"});
+  const auto create = []() {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path());
+    manager.construct<int>("a")(1);
+    manager.construct<int>("b")(2);
+  };
+
+  // A truncated file is detected at open
+  create();
+  fs::resize_file(named_directory_path,
+                  fs::file_size(named_directory_path) - 5);
+  {
+    manager_type manager(metall::open_only, dir_path());
+    ASSERT_FALSE(manager.check_sanity());
+  }
+  {
+    manager_type manager(metall::open_read_only, dir_path());
+    ASSERT_FALSE(manager.check_sanity());
+  }
+
+  // A broken entry is detected when the directory is read
+  create();
+  {
+    // Breaks the name size of the first entry, after the 32-byte header and
+    // the offset, length, and type ID
+    std::fstream fs(named_directory_path,
+                    std::ios::binary | std::ios::in | std::ios::out);
+    const std::uint64_t broken_size = ~std::uint64_t(0);
+    fs.seekp(32 + 8 * 3);
+    fs.write(reinterpret_cast<const char *>(&broken_size),
+             sizeof(broken_size));
+  }
+  const auto broken_file_size = fs::file_size(named_directory_path);
+  {
+    manager_type manager(metall::open_only, dir_path());
+    ASSERT_TRUE(manager.check_sanity());
+    // Refuses changes instead of running on an empty directory
+    ASSERT_EQ(manager.construct<int>("c")(3), nullptr);
+    ASSERT_FALSE(manager.check_sanity());
+    ASSERT_EQ(manager.get_num_named_objects(), 0);
+  }
+  // The file is not overwritten at close
+  ASSERT_EQ(fs::file_size(named_directory_path), broken_file_size);
+}
+
 TEST(ManagerTest, GetSegment) {
   manager_type::remove(dir_path());
   {
@@ -1129,6 +1323,275 @@ TEST(ManagerTest, LargeAllocation) {
   }
 }
 
+TEST(ManagerTest, Reallocation) {
+  {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path());
+
+    // Large object
+    auto *large = static_cast<char *>(manager.allocate(k_chunk_size));
+    std::fill(large, large + k_chunk_size, 'b');
+    // Expands into the following free chunks
+    ASSERT_EQ(manager.reallocate(large, k_chunk_size * 2), large);
+    ASSERT_EQ(manager.reallocate(large, k_chunk_size * 3), large);
+    std::fill(large + k_chunk_size, large + k_chunk_size * 4, 'c');
+
+    // Blocks the expansion
+    auto *blocker = static_cast<char *>(manager.allocate(k_chunk_size));
+    ASSERT_EQ(blocker - large, k_chunk_size * 4);
+    auto *moved =
+        static_cast<char *>(manager.reallocate(large, k_chunk_size * 8));
+    ASSERT_NE(moved, large);
+    for (std::size_t i = 0; i < k_chunk_size; ++i) ASSERT_EQ(moved[i], 'b');
+    for (std::size_t i = k_chunk_size; i < k_chunk_size * 4; ++i) {
+      ASSERT_EQ(moved[i], 'c');
+    }
+
+    // Shrinks in place and frees the trailing chunks
+    ASSERT_EQ(manager.reallocate(moved, k_chunk_size * 2), moved);
+    auto *reused = static_cast<char *>(manager.allocate(k_chunk_size * 4));
+    ASSERT_EQ(reused, large);
+    auto *next = static_cast<char *>(manager.allocate(k_chunk_size * 4));
+    ASSERT_EQ(next - moved, k_chunk_size * 2);
+
+    // Small object; allocated after the large objects as freed small-object
+    // chunks can be reused by them
+    auto *small = static_cast<char *>(manager.allocate(8));
+    std::fill(small, small + 8, 'a');
+    small = static_cast<char *>(manager.reallocate(small, 64));
+    ASSERT_NE(small, nullptr);
+    for (int i = 0; i < 8; ++i) ASSERT_EQ(small[i], 'a');
+
+    auto *null_realloc = manager.reallocate(nullptr, 8);
+    ASSERT_NE(null_realloc, nullptr);
+
+    manager.deallocate(next);
+    manager.deallocate(reused);
+    manager.deallocate(moved);
+    manager.deallocate(blocker);
+    manager.deallocate(small);
+    manager.deallocate(null_realloc);
+    ASSERT_TRUE(manager.all_memory_deallocated());
+  }
+}
+
+TEST(ManagerTest, AllocatorStatistics) {
+#ifdef METALL_DISABLE_ALLOCATOR_STATISTICS
+  GTEST_SKIP() << "Allocator statistics are disabled";
+#endif
+  using bin_no_mngr =
+      metall::kernel::bin_number_manager<k_chunk_size, 1ULL << 48>;
+  const auto small_bin_no = bin_no_mngr::to_bin_no(k_min_object_size);
+  const auto large_bin_no = bin_no_mngr::to_bin_no(k_chunk_size);
+  std::vector<void *> addrs;
+
+  {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path());
+
+    for (int i = 0; i < 100; ++i) {
+      addrs.push_back(manager.allocate(k_min_object_size));
+    }
+    auto *large = manager.allocate(k_chunk_size);
+    const auto stats = manager.get_allocator_statistics();
+    ASSERT_GT(stats.bins.size(), large_bin_no);
+    ASSERT_EQ(stats.bins[small_bin_no].object_size, k_min_object_size);
+    ASSERT_EQ(stats.bins[small_bin_no].num_allocations, 100);
+    ASSERT_EQ(stats.bins[large_bin_no].num_allocations, 1);
+    ASSERT_EQ(stats.num_allocations, 101);
+    ASSERT_EQ(stats.num_deallocations, 0);
+    ASSERT_EQ(stats.bytes_in_use, k_min_object_size * 100 + k_chunk_size);
+#ifndef METALL_DISABLE_OBJECT_CACHE
+    ASSERT_EQ(stats.num_cache_hits + stats.num_cache_misses, 100);
+    ASSERT_GT(stats.num_cache_misses, 0);
+    ASSERT_GT(stats.cache_hit_rate(), 0.5);
+#endif
+#ifndef METALL_DISABLE_CONCURRENCY
+    ASSERT_GT(stats.num_bin_lock_acquisitions, 0);
+#endif
+
+    manager.deallocate(large);
+    manager.deallocate(addrs.back());
+    addrs.pop_back();
+    const auto stats2 = manager.get_allocator_statistics();
+    ASSERT_EQ(stats2.bins[small_bin_no].num_deallocations, 1);
+    ASSERT_EQ(stats2.bins[large_bin_no].num_deallocations, 1);
+    ASSERT_EQ(stats2.num_deallocations, 2);
+    ASSERT_EQ(stats2.bytes_in_use, k_min_object_size * 99);
+    ASSERT_GT(stats2.num_free_region_calls, 0);
+    ASSERT_GE(stats2.free_region_bytes, k_chunk_size);
+  }
+
+  {
+    manager_type manager(metall::open_only, dir_path());
+    // Objects allocated before reopening are still in use
+    auto stats = manager.get_allocator_statistics();
+    ASSERT_EQ(stats.num_allocations, 0);
+    ASSERT_EQ(stats.bytes_in_use, k_min_object_size * 99);
+
+    for (auto *addr : addrs) manager.deallocate(addr);
+    stats = manager.get_allocator_statistics();
+    ASSERT_EQ(stats.num_deallocations, 99);
+    ASSERT_EQ(stats.bytes_in_use, 0);
+  }
+}
+
+TEST(ManagerTest, Compaction) {
+  // Few slots per chunk to make a few sparse chunks quickly
+  static constexpr std::size_t k_object_size = k_chunk_size / 32;
+  constexpr std::size_t k_num_objects = 32 * 8;
+  using pinned_type = std::array<char, k_object_size>;
+  std::vector<std::size_t *> addrs;
+
+  {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path());
+
+    pinned_type *pinned = nullptr;
+    for (std::size_t i = 0; i < k_num_objects; ++i) {
+      auto *addr = static_cast<std::size_t *>(manager.allocate(k_object_size));
+      *addr = i;
+      addrs.push_back(addr);
+      if (i == k_num_objects / 2) {
+        pinned = manager.construct<pinned_type>("pinned")();
+      }
+    }
+    // Leave every fourth object
+    std::vector<std::size_t *> live;
+    for (std::size_t i = 0; i < k_num_objects; ++i) {
+      if (i % 4 == 0) {
+        live.push_back(addrs[i]);
+      } else {
+        manager.deallocate(addrs[i]);
+      }
+    }
+    addrs = live;
+
+    const auto report = manager.analyze_fragmentation(0.5);
+    ASSERT_EQ(report.chunk_size, k_chunk_size);
+    ASSERT_GE(report.num_chunks(), 8);
+    ASSERT_GE(report.num_reclaimable_chunks(), 5);
+    ASSERT_EQ(report.reclaimable_bytes(),
+              report.num_reclaimable_chunks() * k_chunk_size);
+
+    const auto bytes_in_use = manager.get_allocator_statistics().bytes_in_use;
+    const auto result = manager.compact(
+        [&addrs](void *src, void *dst, const std::size_t nbytes) {
+          EXPECT_EQ(nbytes, k_object_size);
+          std::memcpy(dst, src, nbytes);
+          const auto i = *static_cast<std::size_t *>(dst);
+          EXPECT_EQ(addrs[i / 4], src);
+          addrs[i / 4] = static_cast<std::size_t *>(dst);
+          return true;
+        });
+    ASSERT_GT(result.num_relocated_objects, 0);
+    ASSERT_GE(result.num_freed_chunks, 5);
+    ASSERT_EQ(result.freed_bytes, result.num_freed_chunks * k_chunk_size);
+    ASSERT_EQ(manager.find<pinned_type>("pinned").first, pinned);
+    ASSERT_EQ(manager.get_allocator_statistics().bytes_in_use, bytes_in_use);
+    ASSERT_LT(manager.analyze_fragmentation().num_chunks(),
+              report.num_chunks());
+    // Compaction does nothing for dense chunks
+    ASSERT_EQ(manager.compact([](void *, void *, std::size_t) { return true; })
+                  .num_freed_chunks,
+              0);
+  }
+
+  {
+    manager_type manager(metall::open_only, dir_path());
+    for (std::size_t i = 0; i < addrs.size(); ++i) {
+      ASSERT_EQ(*addrs[i], i * 4);
+      manager.deallocate(addrs[i]);
+    }
+    ASSERT_TRUE(manager.destroy<pinned_type>("pinned"));
+    ASSERT_TRUE(manager.all_memory_deallocated());
+  }
+}
+
+TEST(ManagerTest, CheckConsistency) {
+  static constexpr std::size_t k_object_size = k_chunk_size / 32;
+  using large_type = std::array<char, k_chunk_size * 2>;
+  const auto management_file = [](const std::string &name) {
+    return metall::kernel::storage::get_path(dir_path(),
+                                             {"management", name});
+  };
+  const auto truncate = [](const fs::path &path) {
+    std::ofstream ofs(path, std::ios::trunc);
+  };
+
+  {
+    manager_type::remove(dir_path());
+    manager_type manager(metall::create_only, dir_path());
+    // A full chunk and a non-full chunk
+    for (std::size_t i = 0; i < 40; ++i) {
+      *static_cast<std::size_t *>(manager.allocate(k_object_size)) = i;
+    }
+    *manager.construct<int>("int")() = 10;
+    manager.construct<large_type>("large")();
+  }
+
+  {
+    const auto report = manager_type::check_consistency(dir_path());
+    ASSERT_TRUE(report.consistent());
+    ASSERT_TRUE(report.properly_closed);
+    ASSERT_GT(report.num_chunks, 0);
+    ASSERT_EQ(report.num_attributed_objects, 2);
+  }
+
+  // Lose the bin directory and the properly closed mark, as if crashed
+  truncate(management_file("segment_memory_allocator_non_full_chunk_bin"));
+  fs::remove(
+      metall::kernel::storage::get_path(dir_path(), "properly_closed_mark"));
+  ASSERT_FALSE(manager_type::consistent(dir_path()));
+  {
+    const auto report = manager_type::check_consistency(dir_path());
+    ASSERT_FALSE(report.consistent());
+    ASSERT_FALSE(report.properly_closed);
+    ASSERT_FALSE(report.repaired);
+  }
+  {
+    const auto report = manager_type::check_consistency(dir_path(), true, 2);
+    ASSERT_FALSE(report.consistent());
+    ASSERT_TRUE(report.repaired);
+  }
+  ASSERT_TRUE(manager_type::consistent(dir_path()));
+  ASSERT_TRUE(manager_type::check_consistency(dir_path()).consistent());
+
+  // Drop the large object from the chunk directory
+  {
+    const auto path =
+        management_file("segment_memory_allocator_chunk_directory");
+    std::ifstream ifs(path);
+    std::string kept;
+    for (std::string line; std::getline(ifs, line);) {
+      std::istringstream iss(line);
+      uint64_t chunk_no, bin_no, type;
+      iss >> chunk_no >> bin_no >> type;
+      if (type == 1) kept += line + "\n";
+    }
+    ifs.close();
+    std::ofstream(path, std::ios::trunc) << kept;
+  }
+  {
+    const auto report = manager_type::check_consistency(dir_path(), true);
+    ASSERT_EQ(report.errors.size(), 1);
+    ASSERT_NE(report.errors[0].find("'large'"), std::string::npos);
+    ASSERT_TRUE(report.repaired);
+  }
+
+  {
+    manager_type manager(metall::open_only, dir_path());
+    ASSERT_EQ(manager.find<large_type>("large").first, nullptr);
+    ASSERT_EQ(*manager.find<int>("int").first, 10);
+    // The repaired bin directory lets the non-full chunk be reused
+    std::unordered_set<void *> addrs;
+    for (std::size_t i = 0; i < 64; ++i) {
+      ASSERT_TRUE(addrs.insert(manager.allocate(k_object_size)).second);
+    }
+  }
+  ASSERT_TRUE(manager_type::check_consistency(dir_path()).consistent());
+}
+
 TEST(ManagerTest, AllMemoryDeallocated) {
   {
     manager_type::remove(dir_path());
@@ -184,4 +184,26 @@ TEST(MultilayerBitsetTest, RandomSetAndReset2) {
 
   // 4 layers
   RandomSetAndResetHelper2(64 * 64 * 64 + 1);
-}
\ No newline at end of file
+}
+TEST(MultilayerBitsetTest, Count) {
+  for (std::size_t num_bits : {1ULL, 63ULL, 64ULL, 65ULL, 64ULL * 64,
+                               64ULL * 64 + 1, 64ULL * 64 * 64 + 1}) {
+    metall::kernel::multilayer_bitset bitset;
+    bitset.allocate(num_bits);
+    ASSERT_EQ(bitset.count(num_bits), 0);
+
+    for (std::size_t i = 0; i < num_bits; ++i) {
+      bitset.find_and_set(num_bits);
+    }
+    ASSERT_EQ(bitset.count(num_bits), num_bits);
+
+    std::mt19937_64 rnd(num_bits);
+    std::unordered_set<std::size_t> reset_bits;
+    for (std::size_t i = 0; i < num_bits / 2 + 1; ++i) {
+      const std::size_t pos = rnd() % num_bits;
+      if (reset_bits.insert(pos).second) bitset.reset(num_bits, pos);
+    }
+    ASSERT_EQ(bitset.count(num_bits), num_bits - reset_bits.size());
+    bitset.free(num_bits);
+  }
+}
@@ -0,0 +1,123 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <metall/metall.hpp>
+#include <metall/tracer.hpp>
+#include "../test_utility.hpp"
+
+namespace {
+
+using metall::tracer;
+
+std::vector<tracer::record> run_and_collect() {
+  std::vector<tracer::record> records;
+  tracer::set_sink(
+      [&records](const tracer::record &r) { records.push_back(r); });
+  {
+    metall::manager manager(metall::create_only,
+                            test_utility::make_test_path());
+    auto *large = manager.allocate(1ULL << 22ULL);
+    manager.flush();
+    manager.deallocate(large);
+  }
+  tracer::set_sink(nullptr);
+  return records;
+}
+
+std::size_t count(const std::vector<tracer::record> &records,
+                  const tracer::event e) {
+  std::size_t n = 0;
+  for (const auto &r : records) {
+    if (r.event_id == static_cast<std::uint16_t>(e)) ++n;
+  }
+  return n;
+}
+
+TEST(TracerTest, RingBuffer) {
+  tracer::ring_buffer buffer(3);
+  ASSERT_EQ(buffer.capacity(), 4);
+  ASSERT_EQ(buffer.size(), 0);
+
+  for (std::uint64_t i = 0; i < 6; ++i) {
+    buffer.push(tracer::record{i, 1, i, 0, 0, 0});
+  }
+  ASSERT_EQ(buffer.size(), 4);
+  ASSERT_EQ(buffer.num_dropped(), 2);
+
+  test_utility::create_test_dir();
+  const auto path = test_utility::make_test_path("trace.bin").string();
+  ASSERT_TRUE(buffer.dump(path));
+
+  std::ifstream ifs(path, std::ios::binary);
+  char magic[8];
+  std::uint64_t num_records = 0;
+  ifs.read(magic, sizeof(magic));
+  ifs.read(reinterpret_cast<char *>(&num_records), sizeof(num_records));
+  ASSERT_EQ(num_records, 4);
+  // Oldest first
+  for (std::uint64_t i = 2; i < 6; ++i) {
+    tracer::record r;
+    ifs.read(reinterpret_cast<char *>(&r), sizeof(r));
+    ASSERT_EQ(r.arg, i);
+  }
+
+  buffer.clear();
+  ASSERT_EQ(buffer.size(), 0);
+}
+
+TEST(TracerTest, CustomSink) {
+  const auto records = run_and_collect();
+  ASSERT_EQ(count(records, tracer::event::manager_create), 1);
+  ASSERT_EQ(count(records, tracer::event::manager_flush), 1);
+  ASSERT_EQ(count(records, tracer::event::manager_close), 1);
+  ASSERT_EQ(count(records, tracer::event::allocator_allocate_large), 1);
+  ASSERT_EQ(count(records, tracer::event::allocator_deallocate_large), 1);
+  ASSERT_GE(count(records, tracer::event::storage_sync), 2);
+
+  for (const auto &r : records) {
+    ASSERT_LT(r.event_id,
+              static_cast<std::uint16_t>(tracer::event::num_events));
+    ASSERT_EQ(r.instant, 0);
+  }
+}
+
+TEST(TracerTest, DefaultSinkAndChromeTrace) {
+  auto &buffer = tracer::default_ring_buffer();
+  buffer.clear();
+  {
+    metall::manager manager(metall::create_only,
+                            test_utility::make_test_path());
+    manager.flush();
+  }
+  METALL_TRACE_INSTANT(manager_snapshot, 7);
+  ASSERT_GT(buffer.size(), 0);
+
+  const auto bin_path = test_utility::make_test_path("trace.bin").string();
+  const auto json_path = test_utility::make_test_path("trace.json").string();
+  ASSERT_TRUE(buffer.dump(bin_path));
+  ASSERT_TRUE(tracer::convert_to_chrome_trace(bin_path, json_path));
+
+  std::ifstream ifs(json_path);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  const auto json = ss.str();
+  ASSERT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0);
+  ASSERT_NE(json.find("\"name\":\"manager_create\""), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"manager_flush\""), std::string::npos);
+  ASSERT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+  ASSERT_NE(json.find("\"ph\":\"i\""), std::string::npos);
+  ASSERT_NE(json.find("\"args\":{\"arg\":7}"), std::string::npos);
+
+  // Not a trace file
+  ASSERT_FALSE(tracer::convert_to_chrome_trace(json_path, json_path + ".json"));
+}
+}  // namespace
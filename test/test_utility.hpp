@@ -10,6 +10,8 @@
 
 #include <string>
 #include <cstdlib>
+#include <memory>
+#include <atomic>
 #include_next <sstream>
 #include <filesystem>
 
@@ -49,5 +51,49 @@ inline fs::path make_test_path(const fs::path &name = fs::path()) {
   return detail::get_test_dir() / file_name.str();
 }
 
+/// \brief Counters updated by counting_allocator.
+/// Shared by all counting_allocator instances.
+struct allocation_counter {
+  /// \brief The number of allocate() calls.
+  static inline std::atomic<std::size_t> num_allocations{0};
+  /// \brief The number of bytes currently allocated.
+  static inline std::atomic<std::size_t> num_allocated_bytes{0};
+};
+
+/// \brief An allocator that allocates memory using std::allocator and counts
+/// the allocations in allocation_counter.
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  counting_allocator() = default;
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U> &) noexcept {}
+
+  T *allocate(const std::size_t n) {
+    ++allocation_counter::num_allocations;
+    allocation_counter::num_allocated_bytes += n * sizeof(T);
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T *const p, const std::size_t n) noexcept {
+    allocation_counter::num_allocated_bytes -= n * sizeof(T);
+    std::allocator<T>{}.deallocate(p, n);
+  }
+};
+
+template <typename T, typename U>
+inline bool operator==(const counting_allocator<T> &,
+                       const counting_allocator<U> &) noexcept {
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const counting_allocator<T> &,
+                       const counting_allocator<U> &) noexcept {
+  return false;
+}
+
 }  // namespace test_utility
 #endif  // METALL_TEST_UTILITY_HPP
@@ -0,0 +1,94 @@
+// Copyright 2024 Lawrence Livermore National Security, LLC and other Metall
+// Project Developers. See the top-level COPYRIGHT file for details.
+//
+// SPDX-License-Identifier: (Apache-2.0 OR MIT)
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <numeric>
+#include <vector>
+
+#include <metall/metall.hpp>
+#include <metall/kernel/bin_number_manager.hpp>
+#include <metall/utility/datastore_stat.hpp>
+#include "../test_utility.hpp"
+
+namespace {
+
+constexpr std::size_t k_chunk_size = metall::manager::chunk_size();
+using bin_no_mngr =
+    metall::kernel::bin_number_manager<k_chunk_size, METALL_MAX_CAPACITY>;
+
+TEST(DatastoreStatTest, Stat) {
+  const auto dir_path = test_utility::make_test_path();
+  constexpr std::size_t k_small_size = 64;
+  constexpr std::size_t k_num_small_objects = 100;
+  using large_type = std::array<char, k_chunk_size * 4>;
+
+  {
+    metall::manager manager(metall::create_only, dir_path);
+    for (std::size_t i = 0; i < k_num_small_objects; ++i) {
+      manager.allocate(k_small_size);
+    }
+    // Makes a free chunk run of length 2 and 1
+    auto *free0 = manager.allocate(k_chunk_size * 2);
+    manager.construct<large_type>("large")();
+    auto *free1 = manager.allocate(k_chunk_size);
+    manager.allocate(k_chunk_size);
+    manager.deallocate(free0);
+    manager.deallocate(free1);
+  }
+
+  for (const int num_threads : {1, 3, 64}) {
+    metall::utility::datastore_stat stat;
+    ASSERT_TRUE(metall::utility::get_datastore_stat(dir_path, &stat, 1,
+                                                    num_threads));
+    ASSERT_TRUE(stat.properly_closed);
+    ASSERT_EQ(stat.chunk_size, k_chunk_size);
+
+    const auto small_bin_no = bin_no_mngr::to_bin_no(k_small_size);
+    const auto &small_bin = stat.bins[small_bin_no];
+    ASSERT_EQ(small_bin.object_size, k_small_size);
+    ASSERT_EQ(small_bin.num_chunks, 1);
+    ASSERT_EQ(small_bin.num_objects, k_num_small_objects);
+    // 100 objects in 32768 slots
+    ASSERT_EQ(small_bin.occupancy_histogram[0], 1);
+    ASSERT_EQ(std::accumulate(small_bin.occupancy_histogram.begin(),
+                              small_bin.occupancy_histogram.end(), 0ULL),
+              1);
+
+    const auto large_bin_no = bin_no_mngr::to_bin_no(k_chunk_size * 4);
+    const auto &large_bin = stat.bins[large_bin_no];
+    ASSERT_EQ(large_bin.num_objects, 1);
+    ASSERT_EQ(large_bin.num_chunks, 4);
+    ASSERT_EQ(stat.num_small_object_chunks, 1);
+    ASSERT_EQ(stat.num_large_object_chunks, 5);
+
+    // Chunks: small, free x 2, large x 4, free, large
+    ASSERT_EQ(stat.num_chunks, 9);
+    ASSERT_EQ(stat.num_free_chunks, 3);
+    ASSERT_EQ(stat.longest_free_chunk_run, 2);
+    ASSERT_EQ(stat.free_chunk_run_histogram.size(), 2);
+    ASSERT_EQ(stat.free_chunk_run_histogram[0], 1);
+    ASSERT_EQ(stat.free_chunk_run_histogram[1], 1);
+
+    ASSERT_EQ(stat.allocated_bytes(),
+              k_small_size * k_num_small_objects + k_chunk_size * 5);
+    ASSERT_FALSE(stat.block_files.empty());
+    ASSERT_EQ(stat.block_files[0].path.filename(), "block-0");
+    ASSERT_GT(stat.file_bytes(), 0);
+
+    ASSERT_EQ(stat.largest_objects.size(), 1);
+    ASSERT_EQ(stat.largest_objects[0].offset, k_chunk_size * 3);
+    ASSERT_EQ(stat.largest_objects[0].size, k_chunk_size * 4);
+    ASSERT_EQ(stat.largest_objects[0].name, "large");
+  }
+}
+
+TEST(DatastoreStatTest, NoDatastore) {
+  metall::utility::datastore_stat stat;
+  ASSERT_FALSE(metall::utility::get_datastore_stat(
+      test_utility::make_test_path(), &stat));
+}
+}  // namespace